@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <aio.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+#define AIO_TEST_CHUNK		1024
+#define AIO_TEST_NCHUNKS	64
+#define AIO_TEST_SIZE		(AIO_TEST_CHUNK * AIO_TEST_NCHUNKS)
+
+/* Keep a batch within the pre-allocated AIO containers */
+
+#if CONFIG_FS_NAIOC < 8
+#define AIO_TEST_BATCH		CONFIG_FS_NAIOC
+#else
+#define AIO_TEST_BATCH		8
+#endif
+
+enum aio_test_mode_e {
+	AIO_TEST_SYNC,				/* write() / read() */
+	AIO_TEST_SINGLE,			/* aio_write() / aio_read() and aio_suspend() per chunk */
+	AIO_TEST_LISTIO,			/* lio_listio(LIO_WAIT) per batch */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *g_mode_names[] = { "read/write", "aio per chunk", "lio_listio" };
+
+static struct aiocb g_aiocbs[AIO_TEST_BATCH];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static long aio_test_elapsed(FAR const struct timespec *stime)
+{
+	struct timespec etime;
+
+	clock_gettime(CLOCK_REALTIME, &etime);
+	return (long)(etime.tv_sec - stime->tv_sec) * 1000000 + (etime.tv_nsec - stime->tv_nsec) / 1000;
+}
+
+static void aio_test_setup(FAR struct aiocb *cb, int fd, FAR uint8_t *buf, int chunk, int opcode)
+{
+	memset(cb, 0, sizeof(struct aiocb));
+	cb->aio_fildes = fd;
+	cb->aio_buf = buf + chunk * AIO_TEST_CHUNK;
+	cb->aio_nbytes = AIO_TEST_CHUNK;
+	cb->aio_offset = chunk * AIO_TEST_CHUNK;
+	cb->aio_lio_opcode = opcode;
+	cb->aio_sigevent.sigev_notify = SIGEV_NONE;
+}
+
+static int aio_test_single(FAR struct aiocb *cb)
+{
+	FAR const struct aiocb *list[1];
+	int ret;
+
+	ret = cb->aio_lio_opcode == LIO_WRITE ? aio_write(cb) : aio_read(cb);
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	list[0] = cb;
+	while (aio_error(cb) == EINPROGRESS) {
+		(void)aio_suspend(list, 1, NULL);
+	}
+
+	return aio_return(cb) == AIO_TEST_CHUNK ? OK : ERROR;
+}
+
+static int aio_test_listio(int fd, FAR uint8_t *buf, int chunk, int nchunks, int opcode)
+{
+	FAR struct aiocb *list[AIO_TEST_BATCH];
+	int i;
+
+	for (i = 0; i < nchunks; i++) {
+		aio_test_setup(&g_aiocbs[i], fd, buf, chunk + i, opcode);
+		list[i] = &g_aiocbs[i];
+	}
+
+	if (lio_listio(LIO_WAIT, list, nchunks, NULL) < 0) {
+		return ERROR;
+	}
+
+	for (i = 0; i < nchunks; i++) {
+		if (aio_return(&g_aiocbs[i]) != AIO_TEST_CHUNK) {
+			return ERROR;
+		}
+	}
+
+	return OK;
+}
+
+/* Transfer the whole file with one method, returns the elapsed microseconds */
+
+static long aio_test_run(int fd, FAR uint8_t *buf, int mode, int opcode)
+{
+	struct timespec stime;
+	int nchunks;
+	int chunk;
+	int ret = OK;
+
+	clock_gettime(CLOCK_REALTIME, &stime);
+	for (chunk = 0; chunk < AIO_TEST_NCHUNKS && ret == OK; ) {
+		switch (mode) {
+		case AIO_TEST_SYNC:
+			if (opcode == LIO_WRITE) {
+				ret = pwrite(fd, buf + chunk * AIO_TEST_CHUNK, AIO_TEST_CHUNK, chunk * AIO_TEST_CHUNK) == AIO_TEST_CHUNK ? OK : ERROR;
+			} else {
+				ret = pread(fd, buf + chunk * AIO_TEST_CHUNK, AIO_TEST_CHUNK, chunk * AIO_TEST_CHUNK) == AIO_TEST_CHUNK ? OK : ERROR;
+			}
+			chunk++;
+			break;
+
+		case AIO_TEST_SINGLE:
+			aio_test_setup(&g_aiocbs[0], fd, buf, chunk, opcode);
+			ret = aio_test_single(&g_aiocbs[0]);
+			chunk++;
+			break;
+
+		default:
+			nchunks = AIO_TEST_NCHUNKS - chunk < AIO_TEST_BATCH ? AIO_TEST_NCHUNKS - chunk : AIO_TEST_BATCH;
+			ret = aio_test_listio(fd, buf, chunk, nchunks, opcode);
+			chunk += nchunks;
+			break;
+		}
+	}
+
+	if (ret != OK) {
+		printf("%s %s failed at chunk %d, errno %d\n", g_mode_names[mode], opcode == LIO_WRITE ? "write" : "read", chunk, errno);
+		return -1;
+	}
+
+	return aio_test_elapsed(&stime);
+}
+
+static void aio_test_report(FAR const char *what, long usec)
+{
+	if (usec > 0) {
+		printf("  %-6s %8ld us  %6ld KB/s\n", what, usec, (long)((long long)AIO_TEST_SIZE * 1000000 / 1024 / usec));
+	}
+}
+
+/****************************************************************************
+ * aio_test_main
+ ****************************************************************************/
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int aio_test_main(int argc, char *argv[])
+#endif
+{
+	FAR const char *path = argc > 1 ? argv[1] : CONFIG_AIO_TEST_FILEPATH;
+	FAR uint8_t *wbuf;
+	FAR uint8_t *rbuf;
+	long usec;
+	int mode;
+	int fd;
+	int i;
+
+	wbuf = (FAR uint8_t *)malloc(AIO_TEST_SIZE);
+	rbuf = (FAR uint8_t *)malloc(AIO_TEST_SIZE);
+	if (!wbuf || !rbuf) {
+		printf("Failed to allocate %d byte buffers\n", AIO_TEST_SIZE);
+		goto errout;
+	}
+
+	for (i = 0; i < AIO_TEST_SIZE; i++) {
+		wbuf[i] = (uint8_t)(i * 7 + (i >> 10));
+	}
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		printf("Failed to open %s : %d\n", path, errno);
+		goto errout;
+	}
+
+	printf("AIO Test START!! %d KB in %d byte chunks, %d per lio_listio()\n", AIO_TEST_SIZE / 1024, AIO_TEST_CHUNK, AIO_TEST_BATCH);
+
+	for (mode = AIO_TEST_SYNC; mode <= AIO_TEST_LISTIO; mode++) {
+		printf("%s\n", g_mode_names[mode]);
+
+		usec = aio_test_run(fd, wbuf, mode, LIO_WRITE);
+		aio_test_report("write", usec);
+		if (usec < 0) {
+			continue;
+		}
+
+		fsync(fd);
+		memset(rbuf, 0, AIO_TEST_SIZE);
+		usec = aio_test_run(fd, rbuf, mode, LIO_READ);
+		aio_test_report("read", usec);
+		if (usec > 0 && memcmp(wbuf, rbuf, AIO_TEST_SIZE) != 0) {
+			printf("  read back data mismatch\n");
+		}
+	}
+
+	close(fd);
+	unlink(path);
+	printf("AIO Test END!!\n");
+
+errout:
+	free(wbuf);
+	free(rbuf);
+	return 0;
+}
@@ -26,6 +26,8 @@
 #include <tinyara/config.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 
 /* The number of memory sizes we are handling.
@@ -41,6 +43,16 @@
 /* Seed for random number */
 #define SEED 1
 
+/* Latency of the malloc()/free() calls made by the test */
+struct latency_s {
+	uint32_t max;
+	uint64_t total;
+	uint32_t count;
+};
+
+static struct latency_s g_malloc_latency;
+static struct latency_s g_free_latency;
+
 /* Data structure to store allocated memory segments */
 struct alloc_list {
 	char *data;
@@ -48,6 +60,53 @@ struct alloc_list {
 	struct alloc_list *prev;
 };
 
+static void update_latency(struct latency_s *latency, struct timespec *start, struct timespec *end)
+{
+	uint32_t usec;
+
+	usec = (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_nsec - start->tv_nsec) / 1000;
+	if (usec > latency->max) {
+		latency->max = usec;
+	}
+	latency->total += usec;
+	latency->count++;
+}
+
+static void *timed_malloc(size_t size)
+{
+	struct timespec start;
+	struct timespec end;
+	void *ptr;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ptr = malloc(size);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	update_latency(&g_malloc_latency, &start, &end);
+
+	return ptr;
+}
+
+static void timed_free(void *ptr)
+{
+	struct timespec start;
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	free(ptr);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	update_latency(&g_free_latency, &start, &end);
+}
+
+static void print_latency(const char *name, struct latency_s *latency)
+{
+	if (latency->count == 0) {
+		return;
+	}
+
+	printf("%s	worst %u usec, average %u usec over %u calls\n", name, latency->max,
+		(uint32_t)(latency->total / latency->count), latency->count);
+}
+
 static bool memory_allocation(struct alloc_list list[], int numof_size[], int num_alloc[])
 {
 	struct alloc_list *next[MAX_SIZE_EXPONENT];
@@ -95,9 +154,9 @@ static bool memory_allocation(struct alloc_list list[], int numof_size[], int nu
 					continue;
 				}
 					
-				item = (struct alloc_list *)malloc(sizeof(struct alloc_list));
+				item = (struct alloc_list *)timed_malloc(sizeof(struct alloc_list));
 				if (item) {
-					item->data = (char *)malloc((1 << (i + 4) * sizeof(char)));
+					item->data = (char *)timed_malloc((1 << (i + 4) * sizeof(char)));
 					/* add a new item at the tail */
 					if (item->data) {
 						item->next = NULL;
@@ -106,7 +165,7 @@ static bool memory_allocation(struct alloc_list list[], int numof_size[], int nu
 						next[i] = item;
 						++num_alloc[i];
 					} else {
-						free(item);
+						timed_free(item);
 						printf("Size %d's %d-th allocation failed.\n", 1 << (i + 4), num_alloc[i]);
 						printf("Too many memory allocations were tried.\n");
 						return false;
@@ -145,8 +204,8 @@ static bool memory_free(int num[], int num_alloc[], struct alloc_list list[])
 				if (temp->next) {
 					temp->next->prev = temp->prev;
 				} 
-				free(temp->data);
-				free(temp);
+				timed_free(temp->data);
+				timed_free(temp);
 				--num_alloc[i];
 			} else {
 				return false;
@@ -256,6 +315,9 @@ static int memory_fragmentation_test(int argc, char *argv[])
 
 	srand(SEED);
 
+	memset(&g_malloc_latency, 0, sizeof(g_malloc_latency));
+	memset(&g_free_latency, 0, sizeof(g_free_latency));
+
 	/* Allocate memory according to 'numof_size' */
 	if (memory_allocation(list, numof_size, num_alloc) == false) {
 		printf("memory_allocation failed!\n");
@@ -320,6 +382,11 @@ static int memory_fragmentation_test(int argc, char *argv[])
 			printf("%d		%d			%d\n", 1 << (i + 4), num_free[i], num_alloc[i]);
 		}
 	}
+
+	printf("\nAllocator latency:\n");
+	print_latency("malloc()", &g_malloc_latency);
+	print_latency("free()  ", &g_free_latency);
+
 	printf("\nPlease, use 'heapinfo' to see how the heap memory is fragmented in detail.\n");
 
 	return 0;
@@ -63,6 +63,7 @@
 
 #define EXEC_NORMAL   0
 #define EXEC_INFINITE 1
+#define EXEC_PERF     2
 
 static volatile bool inf_flag;
 static volatile bool is_running;
@@ -138,7 +139,7 @@ int messaging_main(int argc, char *argv[])
 		goto usage;
 	}
 
-	while ((option = getopt(argc, argv, "r:n:")) != ERROR) {
+	while ((option = getopt(argc, argv, "r:n:p:")) != ERROR) {
 		switch (option) {
 		case 'r':
 			execution_type = EXEC_INFINITE;
@@ -148,6 +149,10 @@ int messaging_main(int argc, char *argv[])
 			execution_type = EXEC_NORMAL;
 			cnt_arg = optarg;
 			break;
+		case 'p':
+			execution_type = EXEC_PERF;
+			cnt_arg = optarg;
+			break;
 		case '?':
 		default:
 			goto usage;
@@ -172,6 +177,19 @@ int messaging_main(int argc, char *argv[])
 			goto usage;
 		}
 
+	} else if (execution_type == EXEC_PERF) {
+		if (is_running) {
+			goto already_running;
+		}
+
+		repetition_num = atoi(cnt_arg);
+		if (repetition_num <= 0) {
+			goto usage;
+		}
+
+		is_running = true;
+		perf_messaging_sample(repetition_num);
+		is_running = false;
 	} else {
 		if (is_running) {
 			goto already_running;
@@ -196,6 +214,7 @@ usage:
 	printf(" -r start : Execute messaging sample infinitely until stop cmd.\n");
 	printf("    stop  : Stop the messaging sample infinite execution.\n");
 	printf(" -n COUNT : Execute messaging sample COUNT-iterations.\n");
+	printf(" -p COUNT : Measure latency and throughput with COUNT sync messages per size.\n");
 	return -1;
 already_running:
 	printf("There is already running Messaging Sample.\n");
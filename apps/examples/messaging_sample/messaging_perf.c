@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <messaging/messaging.h>
+#include "messaging_sample_internal.h"
+
+#define PERF_PORT "perf_port"
+#define PERF_QUIT 'Q'
+#define PERF_DATA 'D'
+#define PERF_ACK "ACK"
+
+#define MSG_PRIO 10
+/* The receiver must wait again before the sender sends the next message. */
+#define RECV_TASK_PRIO 110
+#define SEND_TASK_PRIO 100
+#define STACKSIZE 2048
+#define PERF_MAX_SIZE 1024
+#define PERF_RETRY 10
+
+extern int fail_cnt;
+
+static const int g_perf_sizes[] = { 16, 128, 1024 };
+static int g_perf_count;
+static sem_t g_perf_done;
+
+static long perf_elapsed_us(struct timespec *stime)
+{
+	struct timespec etime;
+
+	clock_gettime(CLOCK_REALTIME, &etime);
+	return (long)(etime.tv_sec - stime->tv_sec) * 1000000 + (etime.tv_nsec - stime->tv_nsec) / 1000;
+}
+
+static int perf_send(msg_send_data_t *send_data, msg_recv_buf_t *reply_data)
+{
+	int retry;
+
+	/* The receiver may not wait yet for the first message. */
+	for (retry = 0; retry < PERF_RETRY; retry++) {
+		if (messaging_send_sync(PERF_PORT, send_data, reply_data) == OK) {
+			return OK;
+		}
+		usleep(1000);
+	}
+	return ERROR;
+}
+
+static int perf_recv(int argc, FAR char *argv[])
+{
+	int ret;
+	msg_recv_buf_t recv_data;
+	msg_send_data_t reply_data;
+
+	recv_data.buf = (char *)malloc(PERF_MAX_SIZE);
+	if (recv_data.buf == NULL) {
+		fail_cnt++;
+		printf("Fail to receive, because out of memory.\n");
+		return ERROR;
+	}
+
+	reply_data.msg = PERF_ACK;
+	reply_data.msglen = sizeof(PERF_ACK);
+	reply_data.priority = MSG_PRIO;
+
+	do {
+		recv_data.buflen = PERF_MAX_SIZE;
+		ret = messaging_recv_block(PERF_PORT, &recv_data);
+		if (ret < 0) {
+			fail_cnt++;
+			printf("Fail to receive with block mode.\n");
+			break;
+		}
+		if (ret == MSG_REPLY_REQUIRED && messaging_reply(PERF_PORT, recv_data.sender_pid, &reply_data) != OK) {
+			fail_cnt++;
+			printf("Fail to reply.\n");
+			break;
+		}
+	} while (recv_data.buf[0] != PERF_QUIT);
+
+	free(recv_data.buf);
+	return OK;
+}
+
+static int perf_run(char *msg, int msglen, const char *mode)
+{
+	int idx;
+	long usec;
+	char reply[sizeof(PERF_ACK)];
+	msg_send_data_t send_data;
+	msg_recv_buf_t reply_data;
+	struct timespec stime;
+
+	memset(msg, PERF_DATA, msglen);
+	send_data.msg = msg;
+	send_data.msglen = msglen;
+	send_data.priority = MSG_PRIO;
+	reply_data.buf = reply;
+	reply_data.buflen = sizeof(reply);
+
+	clock_gettime(CLOCK_REALTIME, &stime);
+	for (idx = 0; idx < g_perf_count; idx++) {
+		if (perf_send(&send_data, &reply_data) != OK) {
+			fail_cnt++;
+			printf("Fail to sync send message.\n");
+			return ERROR;
+		}
+	}
+	usec = perf_elapsed_us(&stime);
+	if (usec <= 0) {
+		usec = 1;
+	}
+
+	printf("%4d bytes %-6s : %ld us/msg, %lld bytes/s\n", msglen, mode, usec / g_perf_count, (long long)msglen * g_perf_count * 1000000 / usec);
+	return OK;
+}
+
+static int perf_send_task(int argc, FAR char *argv[])
+{
+	int idx;
+	char *msg;
+	char quit = PERF_QUIT;
+	msg_send_data_t send_data;
+	msg_recv_buf_t reply_data;
+	char reply[sizeof(PERF_ACK)];
+
+	msg = (char *)malloc(PERF_MAX_SIZE);
+	if (msg == NULL) {
+		fail_cnt++;
+		printf("Fail to sync send message : out of memory.\n");
+		goto quit;
+	}
+
+	for (idx = 0; idx < sizeof(g_perf_sizes) / sizeof(g_perf_sizes[0]); idx++) {
+		if (perf_run(msg, g_perf_sizes[idx], "copy") != OK) {
+			break;
+		}
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+		{
+			char *shmbuf = messaging_shmbuf_alloc(g_perf_sizes[idx]);
+			if (shmbuf == NULL) {
+				fail_cnt++;
+				printf("Fail to allocate shared buffer.\n");
+				break;
+			}
+			if (perf_run(shmbuf, g_perf_sizes[idx], "shared") != OK) {
+				messaging_shmbuf_free(shmbuf);
+				break;
+			}
+			messaging_shmbuf_free(shmbuf);
+		}
+#endif
+	}
+
+	free(msg);
+
+quit:
+	/* Let the receiver finish, even when nothing was measured. */
+	send_data.msg = &quit;
+	send_data.msglen = 1;
+	send_data.priority = MSG_PRIO;
+	reply_data.buf = reply;
+	reply_data.buflen = sizeof(reply);
+	(void)perf_send(&send_data, &reply_data);
+
+	sem_post(&g_perf_done);
+	return OK;
+}
+
+void perf_messaging_sample(int count)
+{
+	int receiver_pid;
+
+	printf("\n--- Start the messaging performance test, %d sync messages per size. ---\n", count);
+
+	g_perf_count = count;
+	sem_init(&g_perf_done, 0, 0);
+
+	receiver_pid = task_create("perf_recv", RECV_TASK_PRIO, STACKSIZE, perf_recv, NULL);
+	if (receiver_pid < 0) {
+		fail_cnt++;
+		printf("Fail to create perf_recv task.\n");
+		goto errout;
+	}
+
+	if (task_create("perf_send", SEND_TASK_PRIO, STACKSIZE, perf_send_task, NULL) < 0) {
+		fail_cnt++;
+		task_delete(receiver_pid);
+		printf("Fail to create perf_send task.\n");
+		goto errout;
+	}
+
+	while (sem_wait(&g_perf_done) != OK) {
+	}
+
+errout:
+	sem_destroy(&g_perf_done);
+}
@@ -0,0 +1,227 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/// @file epoll_performance_main.c
+
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/select.h>
+#include <sys/epoll.h>
+
+#define NUM_LOOPS	1000
+#define FIFO_PATH	"/dev/epoll_perf%d"
+#define FIFO_PATHLEN	24
+
+/* stdin, stdout and stderr are already open */
+
+#define MAX_FIFOS	(CONFIG_NFILE_DESCRIPTORS - 3)
+
+static const int g_nfifos[] = { 8, 32, 64 };
+
+static int g_fds[MAX_FIFOS];
+
+/*
+ * @fn                   :epoll_perf_elapsed
+ * @description          :Return the microseconds from stime to now
+ * @return               :long
+ */
+static long epoll_perf_elapsed(FAR const struct timespec *stime)
+{
+	struct timespec etime;
+
+	clock_gettime(CLOCK_REALTIME, &etime);
+	return (long)(etime.tv_sec - stime->tv_sec) * 1000000 + (etime.tv_nsec - stime->tv_nsec) / 1000;
+}
+
+/*
+ * @fn                   :epoll_perf_open
+ * @description          :Create and open nfifos non-blocking FIFOs
+ * @return               :int, the number opened
+ */
+static int epoll_perf_open(int nfifos)
+{
+	char path[FIFO_PATHLEN];
+	int i;
+
+	for (i = 0; i < nfifos; i++) {
+		snprintf(path, FIFO_PATHLEN, FIFO_PATH, i);
+		if (mkfifo(path, 0666) < 0 && errno != EEXIST) {
+			printf("mkfifo %s failed, errno %d\n", path, errno);
+			break;
+		}
+
+		g_fds[i] = open(path, O_RDWR | O_NONBLOCK);
+		if (g_fds[i] < 0) {
+			printf("open %s failed, errno %d\n", path, errno);
+			unlink(path);
+			break;
+		}
+	}
+
+	return i;
+}
+
+/*
+ * @fn                   :epoll_perf_close
+ * @description          :Close and remove the FIFOs opened by epoll_perf_open
+ * @return               :void
+ */
+static void epoll_perf_close(int nfifos)
+{
+	char path[FIFO_PATHLEN];
+	int i;
+
+	for (i = 0; i < nfifos; i++) {
+		close(g_fds[i]);
+		snprintf(path, FIFO_PATHLEN, FIFO_PATH, i);
+		unlink(path);
+	}
+}
+
+/*
+ * @fn                   :epoll_perf_select
+ * @description          :Find the one ready FIFO with select(), all descriptors
+ *                        are set up and torn down on every call
+ * @return               :long, elapsed microseconds or -1
+ */
+static long epoll_perf_select(int nfifos)
+{
+	struct timespec stime;
+	fd_set rfds;
+	char ch = 0;
+	int maxfd = 0;
+	int loop;
+	int i;
+
+	for (i = 0; i < nfifos; i++) {
+		if (g_fds[i] > maxfd) {
+			maxfd = g_fds[i];
+		}
+	}
+
+	clock_gettime(CLOCK_REALTIME, &stime);
+	for (loop = 0; loop < NUM_LOOPS; loop++) {
+		write(g_fds[loop % nfifos], &ch, 1);
+
+		FD_ZERO(&rfds);
+		for (i = 0; i < nfifos; i++) {
+			FD_SET(g_fds[i], &rfds);
+		}
+
+		if (select(maxfd + 1, &rfds, NULL, NULL, NULL) != 1) {
+			printf("select failed, errno %d\n", errno);
+			return -1;
+		}
+
+		for (i = 0; i < nfifos; i++) {
+			if (FD_ISSET(g_fds[i], &rfds)) {
+				read(g_fds[i], &ch, 1);
+				break;
+			}
+		}
+	}
+
+	return epoll_perf_elapsed(&stime);
+}
+
+/*
+ * @fn                   :epoll_perf_epoll
+ * @description          :Find the one ready FIFO with epoll_wait(), the
+ *                        descriptors stay registered across calls
+ * @return               :long, elapsed microseconds or -1
+ */
+static long epoll_perf_epoll(int nfifos)
+{
+	struct epoll_event ev;
+	struct timespec stime;
+	long usec = -1;
+	char ch = 0;
+	int epfd;
+	int loop;
+	int i;
+
+	epfd = epoll_create(nfifos);
+	if (epfd < 0) {
+		printf("epoll_create failed, errno %d\n", errno);
+		return -1;
+	}
+
+	for (i = 0; i < nfifos; i++) {
+		ev.events = EPOLLIN;
+		ev.data.fd = g_fds[i];
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, g_fds[i], &ev) < 0) {
+			printf("epoll_ctl failed, errno %d\n", errno);
+			goto errout;
+		}
+	}
+
+	clock_gettime(CLOCK_REALTIME, &stime);
+	for (loop = 0; loop < NUM_LOOPS; loop++) {
+		write(g_fds[loop % nfifos], &ch, 1);
+
+		if (epoll_wait(epfd, &ev, 1, -1) != 1) {
+			printf("epoll_wait failed, errno %d\n", errno);
+			goto errout;
+		}
+
+		read(ev.data.fd, &ch, 1);
+	}
+
+	usec = epoll_perf_elapsed(&stime);
+
+errout:
+	epoll_close(epfd);
+	return usec;
+}
+
+/****************************************************************************
+ * Name: epoll Performance
+ ****************************************************************************/
+int epoll_performance_main(int argc, char *argv[])
+{
+	long select_us;
+	long epoll_us;
+	int nfifos;
+	int i;
+
+	printf("%d loops, one ready descriptor per wait\n", NUM_LOOPS);
+
+	for (i = 0; i < sizeof(g_nfifos) / sizeof(g_nfifos[0]); i++) {
+		if (g_nfifos[i] > MAX_FIFOS) {
+			printf("%2d fds - skipped, CONFIG_NFILE_DESCRIPTORS is %d\n", g_nfifos[i], CONFIG_NFILE_DESCRIPTORS);
+			continue;
+		}
+
+		nfifos = epoll_perf_open(g_nfifos[i]);
+		if (nfifos == g_nfifos[i]) {
+			select_us = epoll_perf_select(nfifos);
+			epoll_us = epoll_perf_epoll(nfifos);
+			printf("%2d fds - select %ld us, epoll_wait %ld us\n", nfifos, select_us, epoll_us);
+		}
+
+		epoll_perf_close(nfifos);
+	}
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/// @file inode_lookup_performance_main.c
+
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#define NUM_LOOPS	1000
+#define FIFO_PATH	"/dev/lookup%03d"
+#define FIFO_PATHLEN	24
+
+/* "null" sorts after "lookup", so an ordered walk of /dev passes all FIFOs */
+
+#define NULL_PATH	"/dev/null"
+
+static const int g_nfifos[] = { 16, 128, 512 };
+
+/*
+ * @fn                   :lookup_perf_elapsed
+ * @description          :Return the nanoseconds per loop from stime to now
+ * @return               :long
+ */
+static long lookup_perf_elapsed(FAR const struct timespec *stime)
+{
+	struct timespec etime;
+
+	clock_gettime(CLOCK_REALTIME, &etime);
+	return ((long)(etime.tv_sec - stime->tv_sec) * 1000000000 + (etime.tv_nsec - stime->tv_nsec)) / NUM_LOOPS;
+}
+
+/*
+ * @fn                   :lookup_perf_create
+ * @description          :Create nfifos FIFOs, they are never opened so no
+ *                        pipe buffer is allocated
+ * @return               :int, the number created
+ */
+static int lookup_perf_create(int nfifos)
+{
+	char path[FIFO_PATHLEN];
+	int i;
+
+	for (i = 0; i < nfifos; i++) {
+		snprintf(path, FIFO_PATHLEN, FIFO_PATH, i);
+		if (mkfifo(path, 0666) < 0 && errno != EEXIST) {
+			printf("mkfifo %s failed, errno %d\n", path, errno);
+			break;
+		}
+	}
+
+	return i;
+}
+
+/*
+ * @fn                   :lookup_perf_remove
+ * @description          :Remove the FIFOs created by lookup_perf_create
+ * @return               :void
+ */
+static void lookup_perf_remove(int nfifos)
+{
+	char path[FIFO_PATHLEN];
+	int i;
+
+	for (i = 0; i < nfifos; i++) {
+		snprintf(path, FIFO_PATHLEN, FIFO_PATH, i);
+		unlink(path);
+	}
+}
+
+/*
+ * @fn                   :lookup_perf_stat
+ * @description          :stat() the first and the last FIFO in turn
+ * @return               :long, nanoseconds per stat() or -1
+ */
+static long lookup_perf_stat(int nfifos)
+{
+	char path[2][FIFO_PATHLEN];
+	struct timespec stime;
+	struct stat st;
+	int loop;
+
+	snprintf(path[0], FIFO_PATHLEN, FIFO_PATH, 0);
+	snprintf(path[1], FIFO_PATHLEN, FIFO_PATH, nfifos - 1);
+
+	clock_gettime(CLOCK_REALTIME, &stime);
+	for (loop = 0; loop < NUM_LOOPS; loop++) {
+		if (stat(path[loop & 1], &st) < 0) {
+			printf("stat %s failed, errno %d\n", path[loop & 1], errno);
+			return -1;
+		}
+	}
+
+	return lookup_perf_elapsed(&stime);
+}
+
+/*
+ * @fn                   :lookup_perf_open
+ * @description          :open() and close() /dev/null
+ * @return               :long, nanoseconds per open() and close() or -1
+ */
+static long lookup_perf_open(void)
+{
+	struct timespec stime;
+	int loop;
+	int fd;
+
+	clock_gettime(CLOCK_REALTIME, &stime);
+	for (loop = 0; loop < NUM_LOOPS; loop++) {
+		fd = open(NULL_PATH, O_RDONLY);
+		if (fd < 0) {
+			printf("open %s failed, errno %d\n", NULL_PATH, errno);
+			return -1;
+		}
+
+		close(fd);
+	}
+
+	return lookup_perf_elapsed(&stime);
+}
+
+/****************************************************************************
+ * Name: inode lookup Performance
+ ****************************************************************************/
+int inode_lookup_performance_main(int argc, char *argv[])
+{
+	int nfifos;
+	int i;
+
+#ifdef CONFIG_FS_INODE_HASH
+	printf("%d loops, hashed inode lookup, %d buckets\n", NUM_LOOPS, CONFIG_FS_INODE_HASH_BUCKETS);
+#else
+	printf("%d loops, ordered inode lookup\n", NUM_LOOPS);
+#endif
+
+	for (i = 0; i < sizeof(g_nfifos) / sizeof(g_nfifos[0]); i++) {
+		nfifos = lookup_perf_create(g_nfifos[i]);
+		if (nfifos == g_nfifos[i]) {
+			printf("%3d FIFOs in /dev - stat %ld ns, open/close %ld ns\n", nfifos, lookup_perf_stat(nfifos), lookup_perf_open());
+		}
+
+		lookup_perf_remove(nfifos);
+	}
+
+	return 0;
+}
@@ -30,6 +30,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <tinyara/timer.h>
 
 /****************************************************************************
@@ -42,11 +43,14 @@
 #define TEST_FLAG_READ			3
 #define TEST_FLAG_GC_EFFECT		4
 #define TEST_FLAG_APPEND		5
+#define TEST_FLAG_RANDOM_READ		6
+#define TEST_FLAG_SMALL_APPEND		7
 #define TEST_FILE_NAME_LEN_MAX		15
 #define ITR_OVE				5
 #define ITR_APP				5
 #define ITR_READ			100
 #define ITR_GC				10
+#define ITR_RAND			100
 #define N_MULTIPLE_FILES		2
 #define TIMER_DEVNAME			"/dev/timer%d"
 
@@ -65,6 +69,7 @@ static char g_file[N_MULTIPLE_FILES][TEST_FILE_NAME_LEN_MAX];
 static char g_rw_buf[MAX_BUF_SIZE];
 static char g_read_buf[MAX_RD_BUF_SIZE];
 static char g_timer_path[_POSIX_PATH_MAX];
+static const int g_small_app_sz[] = { 32, 128, 512 };
 
 /****************************************************************************
  * Private Functions
@@ -290,6 +295,53 @@ static int do_test(int option, int fsz, int bsz)
 		printf("\n****************************************************************************************\n");
 		break;
 
+	case TEST_FLAG_SMALL_APPEND :
+		printf("\n****************************************************************************************\n");
+		printf("*********************************  TEST SMALL APPEND  **********************************\n\n");
+		printf("Testing jSmartfs Small Append with file size: %d bytes\n", fsz);
+		printf("The test appends a file of given size with records of 32, 128 and 512 bytes.\n\n");
+		for (i = 0; i < sizeof(g_small_app_sz) / sizeof(g_small_app_sz[0]); i++) {
+			ret = ioctl(frt_fd, TCIOC_GETSTATUS, (unsigned long)(uintptr_t)&before);
+			if (ret < 0) {
+				goto error_with_frt_status;
+			}
+
+			fd = open(g_file[0], O_WROK | O_CREAT | O_APPEND);
+			if (fd < 0) {
+				printf("Unable to open file: %s, fd: %d\n", g_file[0], fd);
+				ret = ERROR;
+				goto close_with_frt;
+			}
+
+			for (j = 0; j < (fsz / g_small_app_sz[i]); j++) {
+				ret = write(fd, g_rw_buf, g_small_app_sz[i]);
+				if (ret != g_small_app_sz[i]) {
+					printf("Unable to append to file: %s, ret: %d\n", g_file[0], ret);
+					ret = ERROR;
+					goto close_with_fd;
+				}
+			}
+			close(fd);
+
+			ret = ioctl(frt_fd, TCIOC_GETSTATUS, (unsigned long)(uintptr_t)&after);
+			if (ret < 0) {
+				goto error_with_frt_status;
+			}
+
+			itr_time = after.timeleft - before.timeleft;
+			printf("record: %d bytes, time: %lu us, throughput: %lu bytes/s\n", g_small_app_sz[i], itr_time,
+				   itr_time ? (unsigned long)((unsigned long long)j * g_small_app_sz[i] * 1000000 / itr_time) : 0);
+
+			ret = unlink(g_file[0]);
+			if (ret != OK) {
+				printf("Failed to unlink file %s, errno: %d\n", g_file[0], errno);
+				ret = ERROR;
+				goto close_with_frt;
+			}
+		}
+		printf("\n****************************************************************************************\n");
+		break;
+
 	case TEST_FLAG_READ :
 		printf("\n****************************************************************************************\n");
 		printf("************************************  TEST READ  ***************************************\n\n");
@@ -349,6 +401,101 @@ static int do_test(int option, int fsz, int bsz)
 		printf("\n****************************************************************************************\n");
 		break;
 
+	case TEST_FLAG_RANDOM_READ :
+		printf("\n****************************************************************************************\n");
+		printf("********************************  TEST RANDOM READ  ************************************\n\n");
+		printf("Testing jSmartfs Random Read with file size: %d bytes, buffer size: %d bytes\n", fsz, bsz);
+		printf("The test seeks to a random offset and reads one buffer %d times, then gets the file size.\n\n", ITR_RAND);
+		memset(g_read_buf, '1', MAX_RD_BUF_SIZE);
+
+		fd = open(g_file[0], O_WROK | O_CREAT);
+		if (fd < 0) {
+			printf("Unable to open file: %s, errno: %d\n", g_file[0], errno);
+			ret = ERROR;
+			goto close_with_frt;
+		}
+
+		ret = write(fd, g_rw_buf, fsz);
+		if (ret != (fsz)) {
+			printf("Unable to write in file: %s, ret: %d\n", g_file[0], ret);
+			ret = ERROR;
+			goto close_with_fd;
+		}
+		close(fd);
+
+		fd = open(g_file[0], O_RDOK);
+		if (fd < 0) {
+			printf("Unable to open file: %s to read, fd: %d\n", g_file[0], fd);
+			ret = ERROR;
+			goto close_with_frt;
+		}
+
+		/* The same offsets are used on every run so that results compare */
+
+		srand(1);
+		ret = ioctl(frt_fd, TCIOC_GETSTATUS, (unsigned long)(uintptr_t)&before);
+		if (ret < 0) {
+			goto error_with_frt_status;
+		}
+
+		for (i = 1; i <= ITR_RAND; i++) {
+			j = rand() % (fsz - bsz + 1);
+			if (lseek(fd, j, SEEK_SET) != j) {
+				printf("Unable to move file pointer to %d\n", j);
+				ret = ERROR;
+				goto close_with_fd;
+			}
+
+			ret = read(fd, g_read_buf, bsz);
+			if (ret != bsz) {
+				printf("Unable to read file: %s at %d, ret: %d\n", g_file[0], j, ret);
+				ret = ERROR;
+				goto close_with_fd;
+			}
+		}
+
+		ret = ioctl(frt_fd, TCIOC_GETSTATUS, (unsigned long)(uintptr_t)&after);
+		if (ret < 0) {
+			goto error_with_frt_status;
+		}
+
+		tot_time = after.timeleft - before.timeleft;
+		printf("Random read time: %lu us\n", tot_time);
+
+		ret = ioctl(frt_fd, TCIOC_GETSTATUS, (unsigned long)(uintptr_t)&before);
+		if (ret < 0) {
+			goto error_with_frt_status;
+		}
+
+		{
+			struct stat st;
+
+			ret = fstat(fd, &st);
+			if (ret != OK || st.st_size != fsz) {
+				printf("Unable to get size of file: %s, ret: %d\n", g_file[0], ret);
+				ret = ERROR;
+				goto close_with_fd;
+			}
+		}
+
+		ret = ioctl(frt_fd, TCIOC_GETSTATUS, (unsigned long)(uintptr_t)&after);
+		if (ret < 0) {
+			goto error_with_frt_status;
+		}
+
+		itr_time = after.timeleft - before.timeleft;
+		printf("fstat time: %lu us\n", itr_time);
+		close(fd);
+
+		ret = unlink(g_file[0]);
+		if (ret < 0) {
+			printf("Failed to unlink file %s, errno: %d\n", g_file[0], errno);
+			ret = ERROR;
+			goto close_with_frt;
+		}
+		printf("\n****************************************************************************************\n");
+		break;
+
 	case TEST_FLAG_GC_EFFECT :
 		printf("\n****************************************************************************************\n");
 		printf("**************************  TEST GARBAGE COLLECTION EFFECT  ****************************\n\n");
@@ -432,7 +579,7 @@ static void fs_performance_show_usage(void) {
 	printf("This test example executes one of the test cases and prints the time taken (for each iteration)\n");
 	printf("\nUSAGE:  fs_performance [Timer device no.] [Test case no.] [File size(bytes)] [Buffer size(bytes)]\n\n");
 	printf("	Timer Device no. :	FRT Timer device\n");
-	printf("	Test Case        :	Test case to be executed. Range[1-5].\n");
+	printf("	Test Case        :	Test case to be executed. Range[1-7].\n");
 	printf("      		1. File Creation Test : Creates a file of given file size in one go.\n");
 	printf("			The buffer used in the test is equal to file size.\n");
 	printf("      		2. Overwrite Test : Overwrite a file from start of given file with given buffer size.\n");
@@ -440,6 +587,8 @@ static void fs_performance_show_usage(void) {
 	printf("      		4. Read Test : Read a file of given file size with given buffer size.\n");
 	printf("      		5. Garbage Collection Effect Test : Creates a file and unlink it to trigger GC.\n");
 	printf("			The buffer used in test is equal to file size.\n");
+	printf("      		6. Random Read Test : Reads one buffer at random offsets of a file of given size.\n");
+	printf("      		7. Small Append Test : Appends a file of given size with 32, 128 and 512 byte records.\n");
 	printf("	File Size        :	File size(in bytes). Range[512-65536].\n");
 	printf("	Buffer Size      :	Buffer size(in bytes). Range[512-File size].\n");
 	printf("\n****************************************************************************************\n");
@@ -466,7 +615,7 @@ int fs_performance_main(int argc, char *argv[])
 	if (argc > 4) {
 		timer_devno = atoi(argv[1]);
 		option = atoi(argv[2]);
-		if (option < 1 || option > 5) {
+		if (option < 1 || option > 7) {
 			goto show_usage;
 		}
 
@@ -506,6 +655,12 @@ int fs_performance_main(int argc, char *argv[])
 	case 5: selected_opt = TEST_FLAG_GC_EFFECT;
 		break;
 
+	case 6: selected_opt = TEST_FLAG_RANDOM_READ;
+		break;
+
+	case 7: selected_opt = TEST_FLAG_SMALL_APPEND;
+		break;
+
 	default:
 		goto show_usage;
 
@@ -66,6 +66,10 @@ int tc_drivers_main(int argc, char *argv[])
 	bch_main();
 #endif
 
+#ifdef CONFIG_TC_DRIVERS_FTL_LOG
+	ftl_log_main();
+#endif
+
 #ifdef CONFIG_TC_DRIVERS_I2C
 	i2c_main();
 #endif
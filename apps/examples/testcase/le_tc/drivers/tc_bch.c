@@ -29,6 +29,16 @@
 
 #define SECT_SIZE	512
 
+/* A device of its own with a fresh cache, so that cache placement is known */
+#define CACHE_DEV	"/dev/tmpbchcache"
+#define CACHE_NSECTORS	4
+
+#if CONFIG_BCH_CACHE_READAHEAD > CACHE_NSECTORS - 2
+#define CACHE_READAHEAD	(CACHE_NSECTORS - 2)
+#else
+#define CACHE_READAHEAD	CONFIG_BCH_CACHE_READAHEAD
+#endif
+
 /* Closes all open file descriptors */
 static inline void close_fds(int *fds, int count)
 {
@@ -54,6 +64,49 @@ do {\
 	bchdev_unregister("/dev/tmpbchdevrw");\
 } while (0)
 
+/* Close the file descriptor and unregister the cache test device */
+#define cache_unreg(fd) \
+do {\
+	close(fd);\
+	bchdev_unregister(CACHE_DEV);\
+} while (0)
+
+/* Register the cache test device and open it */
+static int cache_open(void)
+{
+	int fd;
+
+	if (bchdev_register_cache("/dev/mtdblock1", CACHE_DEV, false, CACHE_NSECTORS) < 0) {
+		return ERROR;
+	}
+
+	fd = open(CACHE_DEV, O_RDWR);
+	if (fd < 0) {
+		bchdev_unregister(CACHE_DEV);
+	}
+
+	return fd;
+}
+
+/* Read or write 'len' bytes at the start of 'sector' */
+static int cache_read(int fd, int sector, char *buf, int len)
+{
+	if (lseek(fd, sector * SECT_SIZE, SEEK_SET) != sector * SECT_SIZE) {
+		return ERROR;
+	}
+
+	return read(fd, buf, len);
+}
+
+static int cache_write(int fd, int sector, const char *buf, int len)
+{
+	if (lseek(fd, sector * SECT_SIZE, SEEK_SET) != sector * SECT_SIZE) {
+		return ERROR;
+	}
+
+	return write(fd, buf, len);
+}
+
 /**
 * @fn                   :tc_driver_bch_register
 * @brief                :Test the bch driver register
@@ -279,6 +332,30 @@ static void tc_driver_bch_ioctl(void)
 	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, close(fd));
 #endif
 
+	ret = ioctl(fd, DIOC_FLUSH, 0);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, close(fd));
+
+#ifdef CONFIG_BCH_CACHE_STATS
+	/* A second partial read of the same sector is served by the cache */
+	struct bch_cachestat_s before;
+	struct bch_cachestat_s after;
+	char tmp[20];
+
+	ret = read(fd, tmp, sizeof(tmp));
+	TC_ASSERT_EQ_CLEANUP("bch_read", ret, sizeof(tmp), close(fd));
+	ret = ioctl(fd, DIOC_CACHESTAT, (unsigned long)&before);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, close(fd));
+	ret = read(fd, tmp, sizeof(tmp));
+	TC_ASSERT_EQ_CLEANUP("bch_read", ret, sizeof(tmp), close(fd));
+	ret = ioctl(fd, DIOC_CACHESTAT, (unsigned long)&after);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, close(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", after.hits, before.hits + 1, close(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", after.misses, before.misses, close(fd));
+
+	ret = ioctl(fd, DIOC_CACHESTAT, 0);
+	TC_ASSERT_LT_CLEANUP("bch_ioctl", ret, 0, close(fd));
+#endif
+
 	/* Negative test cases */
 	ret = ioctl(fd, DIOC_GETPRIV, 0);
 	TC_ASSERT_LT_CLEANUP("bch_ioctl", ret, 0, close(fd));
@@ -291,6 +368,184 @@ static void tc_driver_bch_ioctl(void)
 	TC_SUCCESS_RESULT();
 }
 
+#ifdef CONFIG_BCH_CACHE_STATS
+/**
+* @fn                   :tc_driver_bch_cache_lru
+* @brief                :Test the least recently used replacement of the bch cache
+* @scenario             :Fill the cache, keep two sectors in use and read a new one
+* API's covered         :read, ioctl
+* Preconditions         :none
+* Postconditions        :none
+* @return               :void
+*/
+static void tc_driver_bch_cache_lru(void)
+{
+	/* Sectors 2..8 fill the cache and 2, 6 are used in turn.  Sector 10
+	 * then replaces 4, the least recently used one: 2, 6, 8 still hit and
+	 * 4 misses.  The gaps keep the reads from looking sequential.
+	 */
+	static const int sectors[] = { 2, 4, 6, 8, 2, 6, 2, 6, 10, 2, 6, 8, 4 };
+	struct bch_cachestat_s stat;
+	char tmp[20];
+	int fd;
+	int ret;
+	int i;
+
+	fd = cache_open();
+	TC_ASSERT_GT("bch_open", fd, 0);
+
+	for (i = 0; i < sizeof(sectors) / sizeof(sectors[0]); i++) {
+		ret = cache_read(fd, sectors[i], tmp, sizeof(tmp));
+		TC_ASSERT_EQ_CLEANUP("bch_read", ret, sizeof(tmp), cache_unreg(fd));
+	}
+
+	ret = ioctl(fd, DIOC_CACHESTAT, (unsigned long)&stat);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.hits, 7, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.misses, 6, cache_unreg(fd));
+
+	cache_unreg(fd);
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @fn                   :tc_driver_bch_cache_readahead
+* @brief                :Test the read ahead of the bch cache
+* @scenario             :Read three consecutive sectors partially
+* API's covered         :read, ioctl
+* Preconditions         :none
+* Postconditions        :none
+* @return               :void
+*/
+static void tc_driver_bch_cache_readahead(void)
+{
+	struct bch_cachestat_s stat;
+	char tmp[20];
+	int fd;
+	int ret;
+	int i;
+
+	fd = cache_open();
+	TC_ASSERT_GT("bch_open", fd, 0);
+
+	/* Sector 20 lands in the first entry.  Sector 21 continues it and reads
+	 * ahead into the entries that follow, so sector 22 is then a hit.
+	 */
+	for (i = 20; i < 23; i++) {
+		ret = cache_read(fd, i, tmp, sizeof(tmp));
+		TC_ASSERT_EQ_CLEANUP("bch_read", ret, sizeof(tmp), cache_unreg(fd));
+	}
+
+	ret = ioctl(fd, DIOC_CACHESTAT, (unsigned long)&stat);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.readahead, CACHE_READAHEAD, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.hits, CACHE_READAHEAD > 0 ? 1 : 0, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.hits + stat.misses, 3, cache_unreg(fd));
+
+	cache_unreg(fd);
+
+	TC_SUCCESS_RESULT();
+}
+
+#ifdef CONFIG_BCH_CACHE_WRITEBACK
+/**
+* @fn                   :tc_driver_bch_cache_writeback
+* @brief                :Test that the bch cache writes consecutive sectors back at once
+* @scenario             :Modify three consecutive sectors partially and flush them
+* API's covered         :read, write, ioctl
+* Preconditions         :none
+* Postconditions        :none
+* @return               :void
+*/
+static void tc_driver_bch_cache_writeback(void)
+{
+	struct bch_cachestat_s stat;
+	char tmp[3][20];
+	int fd;
+	int ret;
+	int i;
+
+	fd = cache_open();
+	TC_ASSERT_GT("bch_open", fd, 0);
+
+	/* Sectors 30..32 take the first three entries.  Writing their heads back
+	 * leaves them dirty until the flush writes them with one transfer.
+	 */
+	for (i = 0; i < 3; i++) {
+		ret = cache_read(fd, 30 + i, tmp[i], sizeof(tmp[i]));
+		TC_ASSERT_EQ_CLEANUP("bch_read", ret, sizeof(tmp[i]), cache_unreg(fd));
+	}
+
+	for (i = 0; i < 3; i++) {
+		ret = cache_write(fd, 30 + i, tmp[i], sizeof(tmp[i]));
+		TC_ASSERT_EQ_CLEANUP("bch_write", ret, sizeof(tmp[i]), cache_unreg(fd));
+	}
+
+	ret = ioctl(fd, DIOC_CACHESTAT, (unsigned long)&stat);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.written, 0, cache_unreg(fd));
+
+	ret = ioctl(fd, DIOC_FLUSH, 0);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, cache_unreg(fd));
+
+	ret = ioctl(fd, DIOC_CACHESTAT, (unsigned long)&stat);
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", ret, OK, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.writebacks, 1, cache_unreg(fd));
+	TC_ASSERT_EQ_CLEANUP("bch_ioctl", stat.written, 3, cache_unreg(fd));
+
+	cache_unreg(fd);
+
+	TC_SUCCESS_RESULT();
+}
+#endif
+#endif
+
+/**
+* @fn                   :tc_driver_bch_cache_dirty
+* @brief                :Test that a full sector read returns the modified cached sector
+* @scenario             :Modify a sector partially, then read the whole sector
+* API's covered         :read, write
+* Preconditions         :none
+* Postconditions        :none
+* @return               :void
+*/
+static void tc_driver_bch_cache_dirty(void)
+{
+	const char pattern[] = "Test bch dirty";
+	char tmp[sizeof(pattern)];
+	char *buf;
+	int fd;
+	int ret;
+
+	buf = malloc(SECT_SIZE);
+	TC_ASSERT_GT("malloc", buf, 0);
+
+	fd = cache_open();
+	TC_ASSERT_GT_CLEANUP("bch_open", fd, 0, free(buf));
+
+	ret = cache_read(fd, 40, tmp, sizeof(tmp));
+	TC_ASSERT_EQ_CLEANUP("bch_read", ret, sizeof(tmp), cache_unreg(fd); free(buf));
+
+	/* The partial write stays in the cache with write back, the full sector
+	 * read comes from the media and must see it all the same.
+	 */
+	ret = cache_write(fd, 40, pattern, sizeof(pattern));
+	TC_ASSERT_EQ_CLEANUP("bch_write", ret, sizeof(pattern), cache_unreg(fd); free(buf));
+
+	ret = cache_read(fd, 40, buf, SECT_SIZE);
+	TC_ASSERT_EQ_CLEANUP("bch_read", ret, SECT_SIZE, cache_unreg(fd); free(buf));
+	TC_ASSERT_EQ_CLEANUP("bch_read", memcmp(buf, pattern, sizeof(pattern)), 0, cache_unreg(fd); free(buf));
+
+	ret = cache_write(fd, 40, tmp, sizeof(tmp));
+	TC_ASSERT_EQ_CLEANUP("bch_write", ret, sizeof(tmp), cache_unreg(fd); free(buf));
+
+	cache_unreg(fd);
+	free(buf);
+
+	TC_SUCCESS_RESULT();
+}
+
 /**
 * @fn                   :tc_driver_bch_unlink
 * @brief                :Test the bch driver unlink
@@ -337,6 +592,14 @@ void bch_main(void)
 	tc_driver_bch_open_close();
 	tc_driver_bch_read_write();
 	tc_driver_bch_ioctl();
+#ifdef CONFIG_BCH_CACHE_STATS
+	tc_driver_bch_cache_lru();
+	tc_driver_bch_cache_readahead();
+#ifdef CONFIG_BCH_CACHE_WRITEBACK
+	tc_driver_bch_cache_writeback();
+#endif
+#endif
+	tc_driver_bch_cache_dirty();
 	tc_driver_bch_unregister();
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
 	tc_driver_bch_unlink();
@@ -0,0 +1,311 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/// @file tc_ftl_log.c
+/// @brief Test Case Example for the log-structured FTL
+#include <tinyara/config.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/ioctl.h>
+#include <tinyara/fs/mtd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mount.h>
+#include "tc_internal.h"
+
+#define FTL_MINOR         250
+#define FTL_DEV           "/dev/mtdblock250"
+#define FTL_NERASEBLOCKS  (CONFIG_FTL_LOG_SPARE + 6)
+#define FTL_FLASHSIZE     (FTL_NERASEBLOCKS * CONFIG_RAMMTD_ERASESIZE)
+#define FTL_PROC_MOUNT    "/ftl_proc"
+#define FTL_PROC_MTD      FTL_PROC_MOUNT"/mtd"
+
+/* The RAM flash that the FTL is mounted on, again after every power cut */
+
+static FAR uint8_t *g_flash;
+static FAR struct mtd_dev_s *g_mtd;
+
+/* Mount the FTL on the RAM flash, as at boot, and open its block driver */
+
+static int ftl_mount(FAR struct inode **pnode)
+{
+	int ret;
+
+	ret = ftl_log_initialize(FTL_MINOR, g_mtd);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = open_blockdriver(FTL_DEV, 0, pnode);
+	if (ret < 0) {
+		unlink(FTL_DEV);
+	}
+
+	return ret;
+}
+
+/* Drop the FTL and all of its RAM state, the flash stays as it is */
+
+static void ftl_unmount(FAR struct inode *pnode)
+{
+	close_blockdriver(pnode);
+	unlink(FTL_DEV);
+}
+
+/* First R/W block of the data pages of an erase block, after its summary */
+
+static int ftl_hdrpages(FAR struct mtd_geometry_s *geo)
+{
+	int blkper = geo->erasesize / geo->blocksize;
+	int hdrpages;
+
+	for (hdrpages = 1; hdrpages < blkper; hdrpages++) {
+		if ((2 + blkper - hdrpages) * sizeof(uint32_t) <= hdrpages * geo->blocksize) {
+			break;
+		}
+	}
+
+	return hdrpages;
+}
+
+/* Check that 'nsectors' sectors from 'start' all hold the byte 'value' */
+
+static int ftl_check(FAR struct inode *pnode, FAR uint8_t *buf, size_t blocksize, size_t start, int nsectors, uint8_t value)
+{
+	size_t i;
+
+	if (pnode->u.i_bops->read(pnode, buf, start, nsectors) != nsectors) {
+		return ERROR;
+	}
+
+	for (i = 0; i < nsectors * blocksize; i++) {
+		if (buf[i] != value) {
+			return ERROR;
+		}
+	}
+
+	return OK;
+}
+
+/**
+* @fn                   :tc_driver_ftl_log_torn_write
+* @brief                :Test that the log keeps its data across a power cut
+* @scenario             :Program a page without its summary entry as a power
+*                        cut would, remount, write more and remount again
+* API's covered         :ftl_log_initialize, read, write, unlink
+* Preconditions         :none
+* Postconditions        :none
+* @return               :void
+*/
+static void tc_driver_ftl_log_torn_write(void)
+{
+	FAR struct inode *pnode;
+	struct mtd_geometry_s geo;
+	FAR uint8_t *buf;
+	int ret;
+
+	ret = MTD_IOCTL(g_mtd, MTDIOC_BULKERASE, 0);
+	TC_ASSERT_EQ("mtd_ioctl", ret, OK);
+	ret = MTD_IOCTL(g_mtd, MTDIOC_GEOMETRY, (unsigned long)((uintptr_t)&geo));
+	TC_ASSERT_EQ("mtd_ioctl", ret, OK);
+
+	buf = malloc(3 * geo.blocksize);
+	TC_ASSERT_NEQ("malloc", buf, NULL);
+
+	ret = ftl_mount(&pnode);
+	TC_ASSERT_EQ_CLEANUP("ftl_mount", ret, OK, free(buf));
+
+	/* Sectors 0..2 take the first data pages of the first erase block */
+
+	memset(buf, 'A', 3 * geo.blocksize);
+	ret = pnode->u.i_bops->write(pnode, buf, 0, 3);
+	TC_ASSERT_EQ_CLEANUP("ftl_write", ret, 3, ftl_unmount(pnode); free(buf));
+
+	/* A new copy of sector 0 reaches the next page, the power is cut before
+	 * its summary entry is written.
+	 */
+
+	ftl_unmount(pnode);
+	memset(buf, 'B', geo.blocksize);
+	ret = MTD_BWRITE(g_mtd, ftl_hdrpages(&geo) + 3, 1, buf);
+	TC_ASSERT_EQ_CLEANUP("mtd_bwrite", ret, 1, free(buf));
+
+	/* The sectors written after the power cut must survive the next one */
+
+	ret = ftl_mount(&pnode);
+	TC_ASSERT_EQ_CLEANUP("ftl_mount", ret, OK, free(buf));
+
+	memset(buf, 'C', 2 * geo.blocksize);
+	ret = pnode->u.i_bops->write(pnode, buf, 3, 2);
+	TC_ASSERT_EQ_CLEANUP("ftl_write", ret, 2, ftl_unmount(pnode); free(buf));
+
+	ftl_unmount(pnode);
+	ret = ftl_mount(&pnode);
+	TC_ASSERT_EQ_CLEANUP("ftl_mount", ret, OK, free(buf));
+
+	/* Sector 0 keeps its old copy */
+
+	ret = ftl_check(pnode, buf, geo.blocksize, 0, 3, 'A');
+	TC_ASSERT_EQ_CLEANUP("ftl_read", ret, OK, ftl_unmount(pnode); free(buf));
+	ret = ftl_check(pnode, buf, geo.blocksize, 3, 2, 'C');
+	TC_ASSERT_EQ_CLEANUP("ftl_read", ret, OK, ftl_unmount(pnode); free(buf));
+
+	ftl_unmount(pnode);
+	free(buf);
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @fn                   :tc_driver_ftl_log_gc
+* @brief                :Test garbage collection and its write amplification
+* @scenario             :Fill the device, rewrite one sector of every erase
+*                        block in turn until blocks are reclaimed, check the
+*                        data and the counters in /proc/mtd
+* API's covered         :read, write
+* Preconditions         :none
+* Postconditions        :none
+* @return               :void
+*/
+static void tc_driver_ftl_log_gc(void)
+{
+	FAR struct inode *pnode;
+	struct geometry geo;
+	FAR uint8_t *expect;
+	FAR uint8_t *buf;
+	size_t sector;
+	int rounds;
+	int ndata;
+	int ret;
+	int i;
+
+	ret = MTD_IOCTL(g_mtd, MTDIOC_BULKERASE, 0);
+	TC_ASSERT_EQ("mtd_ioctl", ret, OK);
+
+	ret = ftl_mount(&pnode);
+	TC_ASSERT_EQ("ftl_mount", ret, OK);
+
+	ret = pnode->u.i_bops->geometry(pnode, &geo);
+	TC_ASSERT_EQ_CLEANUP("ftl_geometry", ret, OK, ftl_unmount(pnode));
+
+	buf = malloc(geo.geo_sectorsize);
+	expect = malloc(geo.geo_nsectors);
+	TC_ASSERT_NEQ_CLEANUP("malloc", buf, NULL, ftl_unmount(pnode); free(expect));
+	TC_ASSERT_NEQ_CLEANUP("malloc", expect, NULL, ftl_unmount(pnode); free(buf));
+
+	for (sector = 0; sector < geo.geo_nsectors; sector++) {
+		expect[sector] = (uint8_t)sector;
+		memset(buf, expect[sector], geo.geo_sectorsize);
+		ret = pnode->u.i_bops->write(pnode, buf, sector, 1);
+		TC_ASSERT_EQ_CLEANUP("ftl_write", ret, 1, ftl_unmount(pnode); free(buf); free(expect));
+	}
+
+	/* Every erase block keeps some valid pages, so reclaiming one has to
+	 * move them.  Twice the flash is written, so blocks must be reclaimed.
+	 */
+
+	ndata = geo.geo_nsectors / (FTL_NERASEBLOCKS - CONFIG_FTL_LOG_SPARE);
+	rounds = 2 * FTL_NERASEBLOCKS * ndata;
+	for (i = 0; i < rounds; i++) {
+		sector = ((size_t)i * ndata + i / (FTL_NERASEBLOCKS - CONFIG_FTL_LOG_SPARE)) % geo.geo_nsectors;
+		expect[sector] = (uint8_t)(expect[sector] + 0x55);
+		memset(buf, expect[sector], geo.geo_sectorsize);
+		ret = pnode->u.i_bops->write(pnode, buf, sector, 1);
+		TC_ASSERT_EQ_CLEANUP("ftl_write", ret, 1, ftl_unmount(pnode); free(buf); free(expect));
+	}
+
+	for (sector = 0; sector < geo.geo_nsectors; sector++) {
+		ret = ftl_check(pnode, buf, geo.geo_sectorsize, sector, 1, expect[sector]);
+		TC_ASSERT_EQ_CLEANUP("ftl_read", ret, OK, ftl_unmount(pnode); free(buf); free(expect));
+	}
+
+#if defined(CONFIG_MTD_REGISTRATION) && defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MTD)
+	{
+		FAR char *line;
+		FILE *fp;
+		unsigned int host = 0;
+		unsigned int flash = 0;
+		unsigned int erase = 0;
+		bool found = false;
+
+		/* Only the FTL on the RAM flash reports write counters */
+
+		ret = mount(NULL, FTL_PROC_MOUNT, "procfs", 0, NULL);
+		TC_ASSERT_EQ_CLEANUP("mount", ret, OK, ftl_unmount(pnode); free(buf); free(expect));
+
+		fp = fopen(FTL_PROC_MTD, "r");
+		TC_ASSERT_NEQ_CLEANUP("fopen", fp, NULL, umount(FTL_PROC_MOUNT); ftl_unmount(pnode); free(buf); free(expect));
+
+		line = (FAR char *)buf;
+		while (fgets(line, geo.geo_sectorsize, fp) != NULL) {
+			if (sscanf(line, "%*d %*s host %u flash %u erase %u", &host, &flash, &erase) == 3) {
+				found = true;
+				break;
+			}
+		}
+
+		fclose(fp);
+		umount(FTL_PROC_MOUNT);
+
+		TC_ASSERT_EQ_CLEANUP("procfs", found, true, ftl_unmount(pnode); free(buf); free(expect));
+		TC_ASSERT_EQ_CLEANUP("procfs", host, geo.geo_nsectors + rounds, ftl_unmount(pnode); free(buf); free(expect));
+		TC_ASSERT_GT_CLEANUP("procfs", flash, host, ftl_unmount(pnode); free(buf); free(expect));
+		TC_ASSERT_GT_CLEANUP("procfs", erase, 0, ftl_unmount(pnode); free(buf); free(expect));
+	}
+#endif
+
+	ftl_unmount(pnode);
+	free(buf);
+	free(expect);
+
+	TC_SUCCESS_RESULT();
+}
+
+/****************************************************************************
+ * Name: ftl_log test
+ ****************************************************************************/
+void ftl_log_main(void)
+{
+	/* There is no way to release a RAM MTD, it is created once */
+
+	if (g_mtd == NULL) {
+		g_flash = malloc(FTL_FLASHSIZE);
+		if (g_flash == NULL) {
+			printf("ftl_log_main: no memory for the RAM flash\n");
+			total_fail++;
+			return;
+		}
+
+		g_mtd = rammtd_initialize(g_flash, FTL_FLASHSIZE);
+		if (g_mtd == NULL) {
+			printf("ftl_log_main: rammtd_initialize failed\n");
+			total_fail++;
+			free(g_flash);
+			return;
+		}
+	}
+
+	tc_driver_ftl_log_torn_write();
+	tc_driver_ftl_log_gc();
+
+	return;
+}
@@ -60,6 +60,10 @@ void adc_main(void);
 void bch_main(void);
 #endif
 
+#ifdef CONFIG_TC_DRIVERS_FTL_LOG
+void ftl_log_main(void);
+#endif
+
 #ifdef CONFIG_TC_DRIVERS_I2C
 void i2c_main(void);
 #endif
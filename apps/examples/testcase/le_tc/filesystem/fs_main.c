@@ -2453,6 +2453,140 @@ static void tc_fs_vfs_mkfifo_exist_path_n(void)
 
 	TC_SUCCESS_RESULT();
 }
+
+/**
+ * @testcase         tc_fs_vfs_pipe_splice_p
+ * @brief            Move the data of a pipe to and from another descriptor
+ * @scenario         Splice the data of one pipe out to a second one and back in
+ * @apicovered       pipe, ioctl(PIPEIOC_SPLICEOUT, PIPEIOC_SPLICEIN), write, read
+ * @precondition     CONFIG_PIPES should be enabled & CONFIG_DEV_PIPE_SIZE must greater than 11
+ * @postcondition    NA
+ */
+static void tc_fs_vfs_pipe_splice_p(void)
+{
+	struct pipe_splice_s splice;
+	int src[2];
+	int dst[2];
+	char buf[12];
+	int len = strlen(FIFO_DATA);
+	int ret;
+
+	ret = pipe(src);
+	TC_ASSERT_EQ("pipe", ret, OK);
+	ret = pipe(dst);
+	TC_ASSERT_EQ_CLEANUP("pipe", ret, OK, close(src[0]); close(src[1]));
+
+	/* Nothing is buffered, nothing is moved */
+
+	splice.fd = dst[1];
+	splice.len = sizeof(buf);
+	ret = ioctl(src[0], PIPEIOC_SPLICEOUT, (unsigned long)&splice);
+	TC_ASSERT_EQ_CLEANUP("ioctl", ret, 0, goto errout);
+
+	/* The pipe can not be spliced to itself */
+
+	splice.fd = src[1];
+	ret = ioctl(src[0], PIPEIOC_SPLICEOUT, (unsigned long)&splice);
+	TC_ASSERT_EQ_CLEANUP("ioctl", (ret < 0 && errno == EINVAL), true, goto errout);
+
+	/* Out of the first pipe into the second */
+
+	ret = write(src[1], FIFO_DATA, len);
+	TC_ASSERT_EQ_CLEANUP("write", ret, len, goto errout);
+
+	splice.fd = dst[1];
+	ret = ioctl(src[0], PIPEIOC_SPLICEOUT, (unsigned long)&splice);
+	TC_ASSERT_EQ_CLEANUP("ioctl", ret, len, goto errout);
+
+	memset(buf, 0, sizeof(buf));
+	ret = read(dst[0], buf, sizeof(buf));
+	TC_ASSERT_EQ_CLEANUP("read", ret, len, goto errout);
+	TC_ASSERT_EQ_CLEANUP("read", strncmp(buf, FIFO_DATA, len), 0, goto errout);
+
+	/* And back from the second pipe into the first */
+
+	ret = write(dst[1], FIFO_DATA, len);
+	TC_ASSERT_EQ_CLEANUP("write", ret, len, goto errout);
+
+	splice.fd = dst[0];
+	ret = ioctl(src[1], PIPEIOC_SPLICEIN, (unsigned long)&splice);
+	TC_ASSERT_EQ_CLEANUP("ioctl", ret, len, goto errout);
+
+	memset(buf, 0, sizeof(buf));
+	ret = read(src[0], buf, sizeof(buf));
+	TC_ASSERT_EQ_CLEANUP("read", ret, len, goto errout);
+	TC_ASSERT_EQ_CLEANUP("read", strncmp(buf, FIFO_DATA, len), 0, goto errout);
+
+	close(src[0]);
+	close(src[1]);
+	close(dst[0]);
+	close(dst[1]);
+
+	TC_SUCCESS_RESULT();
+	return;
+errout:
+	close(src[0]);
+	close(src[1]);
+	close(dst[0]);
+	close(dst[1]);
+}
+
+/**
+ * @testcase         tc_fs_vfs_pipe_setsize_p
+ * @brief            Set the ringbuffer size of a pipe
+ * @scenario         Resize an empty pipe and fill it, resizing a full one fails
+ * @apicovered       pipe, ioctl(PIPEIOC_SETSIZE), fcntl, write, read
+ * @precondition     CONFIG_PIPES should be enabled & CONFIG_DEV_PIPE_SIZE must greater than 11
+ * @postcondition    NA
+ */
+static void tc_fs_vfs_pipe_setsize_p(void)
+{
+	int fd[2];
+	char buf[12];
+	int ret;
+
+	ret = pipe(fd);
+	TC_ASSERT_EQ("pipe", ret, OK);
+
+	ret = ioctl(fd[1], PIPEIOC_SETSIZE, 1);
+	TC_ASSERT_EQ_CLEANUP("ioctl", (ret < 0 && errno == EINVAL), true, goto errout);
+
+	ret = ioctl(fd[1], PIPEIOC_SETSIZE, (unsigned long)CONFIG_DEV_PIPE_MAXSIZE + 1);
+	TC_ASSERT_EQ_CLEANUP("ioctl", (ret < 0 && errno == EINVAL), true, goto errout);
+
+	/* One byte of the ringbuffer is never used */
+
+	ret = ioctl(fd[1], PIPEIOC_SETSIZE, 8);
+	TC_ASSERT_EQ_CLEANUP("ioctl", ret, OK, goto errout);
+
+	ret = fcntl(fd[1], F_SETFL, O_NONBLOCK);
+	TC_ASSERT_EQ_CLEANUP("fcntl", ret, OK, goto errout);
+
+	memset(buf, 'P', sizeof(buf));
+	ret = write(fd[1], buf, sizeof(buf));
+	TC_ASSERT_EQ_CLEANUP("write", ret, 7, goto errout);
+
+	ret = ioctl(fd[1], PIPEIOC_SETSIZE, 4);
+	TC_ASSERT_EQ_CLEANUP("ioctl", (ret < 0 && errno == EBUSY), true, goto errout);
+
+	ret = read(fd[0], buf, sizeof(buf));
+	TC_ASSERT_EQ_CLEANUP("read", ret, 7, goto errout);
+
+	ret = ioctl(fd[1], PIPEIOC_SETSIZE, 4);
+	TC_ASSERT_EQ_CLEANUP("ioctl", ret, OK, goto errout);
+
+	ret = write(fd[1], buf, sizeof(buf));
+	TC_ASSERT_EQ_CLEANUP("write", ret, 3, goto errout);
+
+	close(fd[0]);
+	close(fd[1]);
+
+	TC_SUCCESS_RESULT();
+	return;
+errout:
+	close(fd[0]);
+	close(fd[1]);
+}
 #endif
 
 /**
@@ -6219,6 +6353,8 @@ int tc_filesystem_main(int argc, char *argv[])
 #if defined(CONFIG_PIPES) && (CONFIG_DEV_PIPE_SIZE > 11)
 	tc_fs_vfs_mkfifo_p();
 	tc_fs_vfs_mkfifo_exist_path_n();
+	tc_fs_vfs_pipe_splice_p();
+	tc_fs_vfs_pipe_setsize_p();
 #endif
 	tc_fs_vfs_sendfile_p();
 	tc_fs_vfs_sendfile_invalid_fd_n();
@@ -58,6 +58,7 @@
 **************************************************************************/
 #include <tinyara/config.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/types.h>
@@ -938,6 +939,89 @@ errout:
 	mq_unlink("mqsetattr");	
 }
 
+static void tc_mqueue_mq_open_invalid_attr(void)
+{
+	mqd_t mqdes;
+	struct mq_attr attr;
+
+	/* A message size whose allocation would wrap around */
+
+	attr.mq_maxmsg = 4;
+	attr.mq_msgsize = SIZE_MAX - 2;
+	attr.mq_flags = 0;
+
+	mqdes = mq_open("mqinval", O_RDWR | O_CREAT, 0666, &attr);
+	TC_ASSERT_EQ_CLEANUP("mq_open", mqdes, (mqd_t)ERROR, mq_close(mqdes); mq_unlink("mqinval"));
+
+	/* A queue that can hold no message */
+
+	attr.mq_maxmsg = 0;
+	attr.mq_msgsize = 4;
+
+	mqdes = mq_open("mqinval", O_RDWR | O_CREAT, 0666, &attr);
+	TC_ASSERT_EQ_CLEANUP("mq_open", mqdes, (mqd_t)ERROR, mq_close(mqdes); mq_unlink("mqinval"));
+
+	TC_SUCCESS_RESULT();
+}
+
+static void tc_mqueue_mq_send_priority_order(void)
+{
+	mqd_t mqdes;
+	struct mq_attr attr;
+	struct timespec start;
+	struct timespec end;
+	int prio;
+	int last_prio;
+	int last_seq;
+	char msg[4];
+	long elapsed;
+	int ret_chk;
+	int i;
+
+	attr.mq_maxmsg = 16;
+	attr.mq_msgsize = 4;
+	attr.mq_flags = 0;
+
+	mqdes = mq_open("mqprio", O_RDWR | O_CREAT | O_NONBLOCK, 0666, &attr);
+	TC_ASSERT_NEQ("mq_open", mqdes, (mqd_t)-1);
+
+	/* Eleven priorities from 0 to MQ_PRIO_MAX - 1 in a scattered order (5 is
+	 * coprime to 11, so every step is hit), several messages per priority.
+	 */
+
+	clock_gettime(CLOCK_REALTIME, &start);
+	for (i = 0; i < 16; i++) {
+		msg[0] = (char)i;
+		ret_chk = mq_send(mqdes, msg, sizeof(msg), (i * 5) % 11 * (MQ_PRIO_MAX - 1) / 10);
+		TC_ASSERT_EQ_CLEANUP("mq_send", ret_chk, OK, goto errout);
+	}
+	clock_gettime(CLOCK_REALTIME, &end);
+
+	elapsed = (end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec);
+	printf("tc_mqueue_mq_send_priority_order: %ld ns per mq_send\n", elapsed / 16);
+
+	last_prio = MQ_PRIO_MAX + 1;
+	last_seq = -1;
+	for (i = 0; i < 16; i++) {
+		ret_chk = mq_receive(mqdes, msg, sizeof(msg), &prio);
+		TC_ASSERT_EQ_CLEANUP("mq_receive", ret_chk, sizeof(msg), goto errout);
+		TC_ASSERT_LEQ_CLEANUP("mq_receive", prio, last_prio, goto errout);
+		if (prio == last_prio) {
+			TC_ASSERT_GT_CLEANUP("mq_receive", msg[0], last_seq, goto errout);
+		}
+		last_prio = prio;
+		last_seq = msg[0];
+	}
+
+	mq_close(mqdes);
+	mq_unlink("mqprio");
+	TC_SUCCESS_RESULT();
+	return;
+
+errout:
+	mq_close(mqdes);
+	mq_unlink("mqprio");
+}
 
 /****************************************************************************
  * Name: mqueue
@@ -952,6 +1036,8 @@ int mqueue_main(void)
 
 	tc_mqueue_mq_getattr();
 	tc_mqueue_mq_setattr();
+	tc_mqueue_mq_open_invalid_attr();
+	tc_mqueue_mq_send_priority_order();
 
 	return 0;
 }
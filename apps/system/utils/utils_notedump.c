@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <tinyara/fs/ioctl.h>
+#include <tinyara/sched_note.h>
+
+#define NOTEDUMP_BUFLEN 256
+
+static void notedump_usage(void)
+{
+	printf("\nUsage: notedump [-c | -e | -s | -o FILE]\n");
+	printf("Print the scheduler notes of %s as hex, one note per line\n", NOTE_DRVPATH);
+	printf("\nOptions:\n");
+	printf(" -c        Drop the buffered notes\n");
+	printf(" -e        Start recording notes\n");
+	printf(" -s        Stop recording notes\n");
+	printf(" -o FILE   Write the notes to FILE instead, as raw binary\n");
+	printf("\nConvert the output with tools/note/note2trace.py\n");
+}
+
+int utils_notedump(int argc, char **args)
+{
+	uint8_t buf[NOTEDUMP_BUFLEN];
+	uint32_t lost = 0;
+	ssize_t nread;
+	ssize_t pos;
+	int outfd = -1;
+	int fd;
+	int ret = OK;
+	int i;
+
+	if (argc > 1 && strcmp(args[1], "--help") == 0) {
+		notedump_usage();
+		return OK;
+	}
+
+	fd = open(NOTE_DRVPATH, O_RDONLY);
+	if (fd < 0) {
+		printf("Failed to open %s : %d\n", NOTE_DRVPATH, errno);
+		return ERROR;
+	}
+
+	if (argc > 1) {
+		if (strcmp(args[1], "-c") == 0) {
+			ret = ioctl(fd, NOTEIOC_CLEAR, 0);
+			goto done;
+		} else if (strcmp(args[1], "-e") == 0) {
+			ret = ioctl(fd, NOTEIOC_ENABLE, 1);
+			goto done;
+		} else if (strcmp(args[1], "-s") == 0) {
+			ret = ioctl(fd, NOTEIOC_ENABLE, 0);
+			goto done;
+		} else if (strcmp(args[1], "-o") == 0 && argc > 2) {
+			outfd = open(args[2], O_WRONLY | O_CREAT | O_TRUNC, 0666);
+			if (outfd < 0) {
+				printf("Failed to open %s : %d\n", args[2], errno);
+				ret = ERROR;
+				goto done;
+			}
+		} else {
+			notedump_usage();
+			ret = ERROR;
+			goto done;
+		}
+	}
+
+	while ((nread = read(fd, buf, sizeof(buf))) > 0) {
+		if (outfd >= 0) {
+			if (write(outfd, buf, nread) != nread) {
+				printf("Failed to write %s : %d\n", args[2], errno);
+				ret = ERROR;
+				break;
+			}
+			continue;
+		}
+
+		/* Each note starts with its length */
+
+		for (pos = 0; pos < nread && buf[pos] > 0; pos += buf[pos]) {
+			printf("NOTE:");
+			for (i = 0; i < buf[pos] && pos + i < nread; i++) {
+				printf(" %02x", buf[pos + i]);
+			}
+			printf("\n");
+		}
+	}
+
+	if (ioctl(fd, NOTEIOC_GETLOST, (unsigned long)&lost) == OK && lost > 0) {
+		printf("notedump: %u buffer overruns, notes were lost\n", (unsigned int)lost);
+	}
+
+	if (outfd >= 0) {
+		close(outfd);
+	}
+
+done:
+	if (ret != OK) {
+		printf("notedump failed : %d\n", errno);
+	}
+
+	close(fd);
+	return ret == OK ? OK : ERROR;
+}
@@ -28,6 +28,8 @@
 #ifndef __MESSAGING_H__
 #define __MESSAGING_H__
 
+#include <tinyara/config.h>
+
 /**
  * @brief These configs are used internally for getting receivers information before send.
  * @details MSG_READ_YET : There are more than CONFIG_MESSAGING_RECV_LIST_SIZE receivers, messaging f/w tries to read information again.\n
@@ -202,6 +204,28 @@ int messaging_recv_nonblock(const char *port_name, msg_recv_buf_t *recv_buf, msg
  * @since TizenRT v3.0
  */
 int messaging_cleanup(const char *port_name);
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+/**
+ * @brief Allocate a buffer which is sent by reference instead of by copy.
+ * @details @b #include <messaging/messaging.h>\n
+ * A message whose msg was allocated by this API is passed to the receivers\n
+ * as a reference, and they copy it straight into their receive buffer.\n
+ * The buffer must not be changed until every receiver received it.
+ * @param[in] size The size of the buffer
+ * @return On success, the buffer is returned. On failure, NULL is returned.
+ * @since TizenRT v4.0
+ */
+char *messaging_shmbuf_alloc(int size);
+/**
+ * @brief Release a buffer allocated by messaging_shmbuf_alloc.
+ * @details @b #include <messaging/messaging.h>\n
+ * The buffer is freed after every receiver of the messages sent from it received them.
+ * @param[in] buf The buffer to release
+ * @return None
+ * @since TizenRT v4.0
+ */
+void messaging_shmbuf_free(char *buf);
+#endif
 
 #ifdef __cplusplus
 }
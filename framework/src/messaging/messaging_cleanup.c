@@ -42,7 +42,7 @@ static int messaging_unlink_internalport(const char *port_name, int pid)
 		return ERROR;
 	}
 
-	ret = mq_unlink(internal_portname);
+	ret = messaging_port_unlink(internal_portname);
 	MSG_FREE(internal_portname);
 	if (ret != OK && errno != ENOENT) {
 		msgdbg("[Messaging] unregister fail : unlink error, errno %d.\n", errno);
@@ -95,7 +95,7 @@ int messaging_cleanup(const char *port_name)
 	do {
 		if ((strncmp(port_info->name, port_name, strlen(port_name) + 1) == 0) && (my_pid == port_info->pid)) {
 			cleanup_pid = port_info->pid;
-			mq_close(port_info->mqdes);
+			messaging_port_invalidate(port_info->mqdes);
 			sq_rem((FAR sq_entry_t *)port_info, port_info_list_ptr);
 			MSG_FREE(port_info->data);
 			MSG_FREE(port_info);
@@ -141,6 +141,18 @@ int messaging_parse_packet(char *packet, char *buf, int buflen, pid_t *sender_pi
 	case 1:
 		*sender_pid = ((messaging_packet_t *)packet)->sender_pid;
 		*msg_type = ((messaging_packet_t *)packet)->msg_type;
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+		if (*msg_type & MSG_TYPE_SHARED) {
+			/* Copy straight from the sender's buffer and drop the reference of this message. */
+			msg_shmref_t *ref = (msg_shmref_t *)(packet + offset);
+
+			*msg_type &= ~MSG_TYPE_SHARED;
+			memcpy(buf, ref->buf, ref->buflen < buflen ? ref->buflen : buflen);
+			messaging_shmbuf_release(ref->buf);
+			ret = OK;
+			break;
+		}
+#endif
 		memcpy(buf, packet + offset, buflen);
 		ret = OK;
 		break;
@@ -152,6 +164,30 @@ int messaging_parse_packet(char *packet, char *buf, int buflen, pid_t *sender_pi
 
 	return ret;
 }
+/****************************************************************************
+ * Name : messaging_packet_msglen
+ *
+ * Description:
+ *  Return the length of the message in a received packet of packetlen
+ *  bytes, at most buflen. Call it before messaging_parse_packet, which
+ *  drops the reference of a shared message.
+ ****************************************************************************/
+int messaging_packet_msglen(char *packet, int packetlen, int buflen)
+{
+	int msglen;
+
+	msglen = packetlen - (int)((messaging_packet_t *)packet)->offset;
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+	if (((messaging_packet_t *)packet)->msg_type & MSG_TYPE_SHARED) {
+		msglen = ((msg_shmref_t *)(packet + ((messaging_packet_t *)packet)->offset))->buflen;
+	}
+#endif
+	if (msglen < 0) {
+		msglen = 0;
+	}
+
+	return msglen < buflen ? msglen : buflen;
+}
 /****************************************************************************
  * Name : messaging_set_notification
  * 
@@ -210,7 +246,7 @@ void messaging_run_callback(int signo, siginfo_t *data)
 
 	while (1) {
 		/* recv_packet is used for receiving message including header. */
-		recv_packet = (char *)MSG_ALLOC(attr.mq_msgsize);
+		recv_packet = (char *)MSG_PACKET_ALLOC(attr.mq_msgsize);
 		if (recv_packet == NULL) {
 			msgdbg("[Messaging] recv fail : out of memory for including header.\n");
 			goto errout_with_recv_info;
@@ -231,14 +267,11 @@ void messaging_run_callback(int signo, siginfo_t *data)
 
 		/* Call user callback */
 		(*recv_info->user_cb)(msg_type, recv_info->msg, recv_info->cb_data);
-		MSG_FREE(recv_packet);
+		MSG_PACKET_FREE(recv_packet);
 		if (msg_type == MSG_SEND_REPLY) {
 			/* This is only for async-reply msg. In this case, callback registration is removed after one-time use. */
-			ret = mq_close(recv_info->mqdes);
-			if (ret != OK) {
-				msgdbg("[Messaging] Mq_close fail for async-reply.\n");
-			}
-			ret = mq_unlink(recv_info->port_name);
+			messaging_port_close(recv_info->mqdes);
+			ret = messaging_port_unlink(recv_info->port_name);
 			if (ret != OK) {
 				msgdbg("[Messaging] Unlink fail for async-reply, errno %d\n", errno);
 			}
@@ -259,9 +292,9 @@ void messaging_run_callback(int signo, siginfo_t *data)
 	return;
 
 errout_with_recv_packet:
-	MSG_FREE(recv_packet);
+	MSG_PACKET_FREE(recv_packet);
 errout_with_mq_close:
-	mq_close(recv_info->mqdes);
+	messaging_port_invalidate(recv_info->mqdes);
 errout_with_recv_info:
 	MSG_FREE(recv_info);
 }
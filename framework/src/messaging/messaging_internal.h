@@ -34,6 +34,14 @@
 #define MSG_ASPRINTF asprintf
 #endif
 
+#if defined(CONFIG_MESSAGING_PACKET_POOL) && CONFIG_MESSAGING_PACKET_POOL > 0
+#define MSG_PACKET_ALLOC(a) messaging_packet_alloc(a)
+#define MSG_PACKET_FREE(a) messaging_packet_free(a)
+#else
+#define MSG_PACKET_ALLOC(a) MSG_ALLOC(a)
+#define MSG_PACKET_FREE(a) MSG_FREE(a)
+#endif
+
 #define MSG_VERSION 1
 /* Messaging Version 1 */
 struct messaging_packet_s {
@@ -48,6 +56,16 @@ typedef struct messaging_packet_s messaging_packet_t;
 
 #define MAX_PORT_NAME_SIZE 64
 
+/* Set in msg_type when the message is a reference to a shared buffer. */
+#define MSG_TYPE_SHARED 0x100
+
+/* The message of a packet with MSG_TYPE_SHARED. */
+struct msg_shmref_s {
+	char *buf;
+	int buflen;
+};
+typedef struct msg_shmref_s msg_shmref_t;
+
 /**
  * @brief The type of handling message internally
  * @details MSG_INFO_SAVE    : For saving receiver information\n
@@ -138,10 +156,54 @@ void messaging_run_callback(int signo, siginfo_t *data);
  * @brief Internal function for parsing received packet
  */
 int messaging_parse_packet(char *packet, char *buf, int buflen, pid_t *sender_pid, int *msg_type);
+/**
+ * @brief Internal function for getting the message length of a received packet
+ */
+int messaging_packet_msglen(char *packet, int packetlen, int buflen);
 /**
  * @brief Internal function for getting g_port_info_list
  */
 sq_queue_t *messaging_get_port_info_list(void);
+/**
+ * @brief Internal function for opening the message queue of a port.
+ * The message size of the queue is returned through qsize.
+ */
+mqd_t messaging_port_open(const char *port_name, int oflag, int msgsize, int *qsize);
+/**
+ * @brief Internal function for closing a queue opened by messaging_port_open.
+ * A cached handle stays open.
+ */
+void messaging_port_close(mqd_t mqdes);
+/**
+ * @brief Internal function for closing a queue which had an error, even if it is cached.
+ */
+void messaging_port_invalidate(mqd_t mqdes);
+/**
+ * @brief Internal function for unlinking the message queue of a port.
+ * The queues of cached ports are never unlinked.
+ */
+int messaging_port_unlink(const char *port_name);
+#if defined(CONFIG_MESSAGING_PACKET_POOL) && CONFIG_MESSAGING_PACKET_POOL > 0
+/**
+ * @brief Internal function for allocating a packet buffer from the pool
+ */
+char *messaging_packet_alloc(int size);
+/**
+ * @brief Internal function for freeing a packet buffer
+ */
+void messaging_packet_free(char *packet);
+#endif
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+/**
+ * @brief Internal function for taking a reference on a shared buffer.
+ * It returns ERROR if buf is not a shared buffer of at least buflen bytes.
+ */
+int messaging_shmbuf_hold(char *buf, int buflen);
+/**
+ * @brief Internal function for dropping a reference on a shared buffer
+ */
+void messaging_shmbuf_release(char *buf);
+#endif
 /*
  *@endcond
  */
@@ -0,0 +1,527 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <debug.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <queue.h>
+#include <sys/types.h>
+#include <messaging/messaging.h>
+#include "messaging_internal.h"
+
+#ifdef CONFIG_MESSAGING_PORT_CACHE
+/* A message queue handle kept open by a task. The descriptor belongs to
+ * the task group of pid, so only that task uses or closes it. A handle
+ * opened O_RDONLY owns its queue, which is unlinked with the handle.
+ */
+struct msg_port_cache_s {
+	char name[MAX_PORT_NAME_SIZE];
+	mqd_t mqdes;
+	pid_t pid;
+	int oflag;
+	int msgsize;
+	bool stale;					/* The queue was unlinked, open it again */
+};
+typedef struct msg_port_cache_s msg_port_cache_t;
+
+static msg_port_cache_t g_port_cache[CONFIG_MESSAGING_PORT_CACHE_SIZE];
+
+/* The tasks which registered messaging_port_exit(), 0 if unused. */
+static pid_t g_port_exit_pid[CONFIG_MESSAGING_PORT_CACHE_SIZE];
+#endif
+
+#if defined(CONFIG_MESSAGING_PACKET_POOL) && CONFIG_MESSAGING_PACKET_POOL > 0
+#define MSG_POOL_WORDS ((CONFIG_MESSAGING_PACKET_POOL_BUFSIZE + 3) / 4)
+
+static uint32_t g_packet_pool[CONFIG_MESSAGING_PACKET_POOL][MSG_POOL_WORDS];
+static uint32_t g_packet_used;
+#endif
+
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+/* The header in front of the data of a shared buffer. */
+struct msg_shmbuf_s {
+	struct msg_shmbuf_s *flink;
+	int refs;
+	int size;
+	int reserved;
+};
+typedef struct msg_shmbuf_s msg_shmbuf_t;
+
+static sq_queue_t g_shmbuf_list;
+#endif
+
+/****************************************************************************
+ * private functions
+ ****************************************************************************/
+#ifdef CONFIG_MESSAGING_PORT_CACHE
+/* Drop a cached handle, called with the scheduler locked. The descriptor is
+ * closed only by its own task; the one of an exited task was closed with it.
+ * The queue owned by the handle is unlinked, and the handles of the other
+ * tasks on it are opened again on their next use, so that the next task
+ * getting the same pid starts with an empty queue.
+ */
+static void messaging_port_drop(msg_port_cache_t *entry, bool close)
+{
+	int idx;
+
+	if (close) {
+		mq_close(entry->mqdes);
+	}
+	entry->mqdes = NULL;
+
+	if ((entry->oflag & O_ACCMODE) == O_RDONLY) {
+		for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+			if (g_port_cache[idx].mqdes != NULL && strncmp(g_port_cache[idx].name, entry->name, MAX_PORT_NAME_SIZE) == 0) {
+				g_port_cache[idx].stale = true;
+			}
+		}
+		mq_unlink(entry->name);
+	}
+}
+
+/* Drop the handles of a task when it exits. */
+static void messaging_port_exit(int status, FAR void *arg)
+{
+	pid_t pid = (pid_t)(intptr_t)arg;
+	int idx;
+
+	sched_lock();
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		if (g_port_cache[idx].mqdes != NULL && g_port_cache[idx].pid == pid) {
+			messaging_port_drop(&g_port_cache[idx], true);
+		}
+		if (g_port_exit_pid[idx] == pid) {
+			g_port_exit_pid[idx] = 0;
+		}
+	}
+	sched_unlock();
+}
+
+/* Make sure the handles of this task are dropped when it exits, called
+ * with the scheduler locked. A task killed by another one does not run
+ * its exit functions, the pid check of messaging_port_find() drops those.
+ */
+static int messaging_port_hook(pid_t pid)
+{
+	int idx;
+	int slot = -1;
+
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		if (g_port_exit_pid[idx] == pid) {
+			return OK;
+		}
+		if (slot < 0 && (g_port_exit_pid[idx] == 0 || kill(g_port_exit_pid[idx], 0) != OK)) {
+			slot = idx;
+		}
+	}
+
+	if (slot < 0 || on_exit(messaging_port_exit, (FAR void *)(intptr_t)pid) != OK) {
+		return ERROR;
+	}
+	g_port_exit_pid[slot] = pid;
+	return OK;
+}
+
+/* Find the cached handle of this task, called with the scheduler locked.
+ * The handles of exited tasks are dropped on the way.
+ */
+static msg_port_cache_t *messaging_port_find(const char *port_name, int oflag, pid_t pid)
+{
+	msg_port_cache_t *entry;
+	int idx;
+
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		entry = &g_port_cache[idx];
+		if (entry->mqdes == NULL) {
+			continue;
+		}
+		if (entry->pid != pid && kill(entry->pid, 0) != OK) {
+			messaging_port_drop(entry, false);
+			continue;
+		}
+		if (entry->pid == pid && entry->oflag == oflag && strncmp(entry->name, port_name, MAX_PORT_NAME_SIZE) == 0) {
+			if (entry->stale) {
+				messaging_port_drop(entry, true);
+				return NULL;
+			}
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/* Pick a free entry for a new handle, called with the scheduler locked.
+ * Live handles are never evicted, because the nonblocking receive and the
+ * async reply keep using theirs after the call returns.
+ */
+static msg_port_cache_t *messaging_port_alloc(void)
+{
+	int idx;
+
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		if (g_port_cache[idx].mqdes == NULL) {
+			return &g_port_cache[idx];
+		}
+		if (kill(g_port_cache[idx].pid, 0) != OK) {
+			messaging_port_drop(&g_port_cache[idx], false);
+			return &g_port_cache[idx];
+		}
+	}
+	return NULL;
+}
+#endif
+
+/****************************************************************************
+ * functions
+ ****************************************************************************/
+/****************************************************************************
+ * Name : messaging_port_open
+ *
+ * Description:
+ *  Open the message queue of a port, creating it for O_RDONLY.
+ *  With CONFIG_MESSAGING_PORT_CACHE, the handle of the calling task is reused
+ *  if it is cached, and a new handle is added to the cache if there is room.
+ *
+ * Return Value:
+ *  On success, the queue descriptor is returned and the message size of the
+ *  queue is stored in qsize. On failure, (mqd_t)ERROR is returned.
+ ****************************************************************************/
+mqd_t messaging_port_open(const char *port_name, int oflag, int msgsize, int *qsize)
+{
+	struct mq_attr internal_attr;
+	mqd_t mqdes;
+#ifdef CONFIG_MESSAGING_PORT_CACHE
+	msg_port_cache_t *entry;
+	pid_t pid = getpid();
+	int reqsize = msgsize;
+
+	sched_lock();
+	entry = messaging_port_find(port_name, oflag, pid);
+	if (entry != NULL) {
+		mqdes = entry->mqdes;
+		*qsize = entry->msgsize;
+		sched_unlock();
+		if (msgsize > *qsize) {
+			msgdbg("[Messaging] port %s is smaller than %d, raise CONFIG_MESSAGING_PORT_MSGSIZE.\n", port_name, msgsize);
+			set_errno(EMSGSIZE);
+			return (mqd_t)ERROR;
+		}
+		return mqdes;
+	}
+	sched_unlock();
+
+	if (msgsize < CONFIG_MESSAGING_PORT_MSGSIZE) {
+		msgsize = CONFIG_MESSAGING_PORT_MSGSIZE;
+	}
+#endif
+
+	internal_attr.mq_maxmsg = CONFIG_MESSAGING_MAXMSG;
+	internal_attr.mq_msgsize = msgsize;
+	internal_attr.mq_flags = 0;
+
+	if ((oflag & O_ACCMODE) == O_RDONLY) {
+		oflag |= O_CREAT;
+	}
+
+	mqdes = mq_open(port_name, oflag, 0666, &internal_attr);
+	if (mqdes == (mqd_t)ERROR) {
+		return mqdes;
+	}
+	*qsize = msgsize;
+
+#ifdef CONFIG_MESSAGING_PORT_CACHE
+	oflag &= ~O_CREAT;
+
+	/* The queue may have been created earlier with another size. */
+	if (mq_getattr(mqdes, &internal_attr) == OK) {
+		*qsize = internal_attr.mq_msgsize;
+	}
+	if (reqsize > *qsize) {
+		msgdbg("[Messaging] port %s is smaller than %d, raise CONFIG_MESSAGING_PORT_MSGSIZE.\n", port_name, reqsize);
+		mq_close(mqdes);
+		set_errno(EMSGSIZE);
+		return (mqd_t)ERROR;
+	}
+
+	/* When the cache is full, the handle is closed again after use. */
+	sched_lock();
+	entry = messaging_port_alloc();
+	if (entry != NULL && messaging_port_hook(pid) == OK) {
+		strncpy(entry->name, port_name, MAX_PORT_NAME_SIZE - 1);
+		entry->name[MAX_PORT_NAME_SIZE - 1] = '\0';
+		entry->mqdes = mqdes;
+		entry->pid = pid;
+		entry->oflag = oflag;
+		entry->msgsize = *qsize;
+		entry->stale = false;
+	}
+	sched_unlock();
+#endif
+
+	return mqdes;
+}
+
+/****************************************************************************
+ * Name : messaging_port_close
+ *
+ * Description:
+ *  Close a queue opened by messaging_port_open unless its handle is cached.
+ ****************************************************************************/
+void messaging_port_close(mqd_t mqdes)
+{
+#ifdef CONFIG_MESSAGING_PORT_CACHE
+	int idx;
+
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		if (g_port_cache[idx].mqdes == mqdes) {
+			return;
+		}
+	}
+#endif
+	mq_close(mqdes);
+}
+
+/****************************************************************************
+ * Name : messaging_port_invalidate
+ *
+ * Description:
+ *  Close a queue and remove its handle from the cache. A queue the handle
+ *  was receiving on is unlinked too.
+ ****************************************************************************/
+void messaging_port_invalidate(mqd_t mqdes)
+{
+#ifdef CONFIG_MESSAGING_PORT_CACHE
+	pid_t pid = getpid();
+	int idx;
+
+	sched_lock();
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		if (g_port_cache[idx].mqdes == mqdes && g_port_cache[idx].pid == pid) {
+			messaging_port_drop(&g_port_cache[idx], true);
+			sched_unlock();
+			return;
+		}
+	}
+	sched_unlock();
+#endif
+	mq_close(mqdes);
+}
+
+/****************************************************************************
+ * Name : messaging_port_unlink
+ *
+ * Description:
+ *  Unlink the queue of a port. With CONFIG_MESSAGING_PORT_CACHE, a queue
+ *  whose receiving handle is cached stays until the handle is dropped by
+ *  messaging_port_invalidate(), messaging_cleanup() or the exit of its
+ *  task. Cached handles of other tasks on an unlinked queue are opened
+ *  again on their next use.
+ ****************************************************************************/
+int messaging_port_unlink(const char *port_name)
+{
+#ifdef CONFIG_MESSAGING_PORT_CACHE
+	int idx;
+
+	sched_lock();
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		if (g_port_cache[idx].mqdes != NULL && (g_port_cache[idx].oflag & O_ACCMODE) == O_RDONLY && strncmp(g_port_cache[idx].name, port_name, MAX_PORT_NAME_SIZE) == 0 && kill(g_port_cache[idx].pid, 0) == OK) {
+			sched_unlock();
+			return OK;
+		}
+	}
+	for (idx = 0; idx < CONFIG_MESSAGING_PORT_CACHE_SIZE; idx++) {
+		if (g_port_cache[idx].mqdes != NULL && strncmp(g_port_cache[idx].name, port_name, MAX_PORT_NAME_SIZE) == 0) {
+			g_port_cache[idx].stale = true;
+		}
+	}
+	sched_unlock();
+#endif
+	return mq_unlink(port_name);
+}
+
+#if defined(CONFIG_MESSAGING_PACKET_POOL) && CONFIG_MESSAGING_PACKET_POOL > 0
+/****************************************************************************
+ * Name : messaging_packet_lock
+ *
+ * Description:
+ *  Keep the pool bitmap from other tasks and from the signal callback of
+ *  the task, which runs on SIGMSG_MESSAGING and may interrupt an update of
+ *  it. Blocking the signal defers the callback until the bitmap is
+ *  consistent again.
+ ****************************************************************************/
+static void messaging_packet_lock(sigset_t *oldset)
+{
+	sigset_t set;
+
+	sigemptyset(&set);
+	sigaddset(&set, SIGMSG_MESSAGING);
+	(void)sigprocmask(SIG_BLOCK, &set, oldset);
+	sched_lock();
+}
+
+static void messaging_packet_unlock(sigset_t *oldset)
+{
+	sched_unlock();
+	(void)sigprocmask(SIG_SETMASK, oldset, NULL);
+}
+
+/****************************************************************************
+ * Name : messaging_packet_alloc
+ *
+ * Description:
+ *  Allocate a packet from the pool, or from the heap if it is too large or
+ *  the pool is empty.
+ ****************************************************************************/
+char *messaging_packet_alloc(int size)
+{
+	sigset_t oldset;
+	int idx;
+
+	if (size <= CONFIG_MESSAGING_PACKET_POOL_BUFSIZE) {
+		messaging_packet_lock(&oldset);
+		for (idx = 0; idx < CONFIG_MESSAGING_PACKET_POOL; idx++) {
+			if ((g_packet_used & (1 << idx)) == 0) {
+				g_packet_used |= (1 << idx);
+				messaging_packet_unlock(&oldset);
+				return (char *)g_packet_pool[idx];
+			}
+		}
+		messaging_packet_unlock(&oldset);
+	}
+
+	return (char *)MSG_ALLOC(size);
+}
+
+/****************************************************************************
+ * Name : messaging_packet_free
+ ****************************************************************************/
+void messaging_packet_free(char *packet)
+{
+	sigset_t oldset;
+	int idx;
+
+	if (packet >= (char *)g_packet_pool && packet < (char *)g_packet_pool + sizeof(g_packet_pool)) {
+		idx = (packet - (char *)g_packet_pool) / sizeof(g_packet_pool[0]);
+		messaging_packet_lock(&oldset);
+		g_packet_used &= ~(1 << idx);
+		messaging_packet_unlock(&oldset);
+		return;
+	}
+
+	MSG_FREE(packet);
+}
+#endif
+
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+/****************************************************************************
+ * Name : messaging_shmbuf_alloc
+ ****************************************************************************/
+char *messaging_shmbuf_alloc(int size)
+{
+	msg_shmbuf_t *shmbuf;
+
+	if (size <= 0) {
+		return NULL;
+	}
+
+	shmbuf = (msg_shmbuf_t *)MSG_ALLOC(sizeof(msg_shmbuf_t) + size);
+	if (shmbuf == NULL) {
+		msgdbg("[Messaging] shmbuf alloc fail : out of memory.\n");
+		return NULL;
+	}
+
+	/* The reference of the owner is dropped by messaging_shmbuf_free. */
+	shmbuf->refs = 1;
+	shmbuf->size = size;
+
+	sched_lock();
+	sq_addlast((FAR sq_entry_t *)shmbuf, &g_shmbuf_list);
+	sched_unlock();
+
+	return (char *)(shmbuf + 1);
+}
+
+/****************************************************************************
+ * Name : messaging_shmbuf_free
+ ****************************************************************************/
+void messaging_shmbuf_free(char *buf)
+{
+	if (buf != NULL) {
+		messaging_shmbuf_release(buf);
+	}
+}
+
+/****************************************************************************
+ * Name : messaging_shmbuf_hold
+ *
+ * Description:
+ *  Take a reference on a shared buffer for a packet being sent.
+ *
+ * Return Value:
+ *  OK if buf is a shared buffer holding buflen bytes, otherwise ERROR and
+ *  the message has to be copied.
+ ****************************************************************************/
+int messaging_shmbuf_hold(char *buf, int buflen)
+{
+	msg_shmbuf_t *shmbuf;
+	int ret = ERROR;
+
+	sched_lock();
+	for (shmbuf = (msg_shmbuf_t *)sq_peek(&g_shmbuf_list); shmbuf != NULL; shmbuf = (msg_shmbuf_t *)sq_next(shmbuf)) {
+		if ((char *)(shmbuf + 1) == buf) {
+			if (buflen <= shmbuf->size) {
+				shmbuf->refs++;
+				ret = OK;
+			}
+			break;
+		}
+	}
+	sched_unlock();
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name : messaging_shmbuf_release
+ ****************************************************************************/
+void messaging_shmbuf_release(char *buf)
+{
+	msg_shmbuf_t *shmbuf = (msg_shmbuf_t *)buf - 1;
+
+	sched_lock();
+	if (--shmbuf->refs > 0) {
+		sched_unlock();
+		return;
+	}
+	sq_rem((FAR sq_entry_t *)shmbuf, &g_shmbuf_list);
+	sched_unlock();
+
+	MSG_FREE(shmbuf);
+}
+#endif
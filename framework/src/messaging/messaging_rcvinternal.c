@@ -61,19 +61,18 @@ sq_queue_t *messaging_get_port_info_list(void)
  *  On success, 0 (OK) is returned.; On failure, -1 (ERROR) is returned.
  *  Sender pid is passed to callback function as 3rd argument.
  ****************************************************************************/
-static int messaging_rcv_nonblock(mqd_t mqdes, const char *port_name, msg_recv_buf_t *recv_buf, msg_callback_info_t *cb_info)
+static int messaging_rcv_nonblock(mqd_t mqdes, const char *port_name, int recv_size, msg_recv_buf_t *recv_buf, msg_callback_info_t *cb_info)
 {
 	int ret;
 	ssize_t recv_size_chk;
 	msg_recv_info_t *nonblock_data;
 	msg_port_info_t *port_info = NULL;
-	int recv_size;
 	char *recv_packet;
 	int msg_type;
-	char *internal_portname;
+	int buflen = recv_buf->buflen;
+	char internal_portname[MAX_PORT_NAME_SIZE];
 
-	recv_size = recv_buf->buflen + MSG_HEADER_SIZE;
-	recv_packet = (char *)MSG_ALLOC(recv_size);
+	recv_packet = (char *)MSG_PACKET_ALLOC(recv_size);
 	if (recv_packet == NULL) {
 		msgdbg("[Messaging] recv fail : out of memory for packet.\n");
 		goto errout_with_mq;
@@ -82,23 +81,26 @@ static int messaging_rcv_nonblock(mqd_t mqdes, const char *port_name, msg_recv_b
 	while (1) {
 		recv_size_chk = mq_receive(mqdes, (char *)recv_packet, recv_size, 0);
 		if (recv_size_chk > 0 && recv_size_chk <= recv_size) {
-			ret = messaging_parse_packet(recv_packet, recv_buf->buf, recv_buf->buflen, &recv_buf->sender_pid, &msg_type);
+			/* The callback gets the message length, the next message the whole buffer. */
+			recv_buf->buflen = messaging_packet_msglen(recv_packet, recv_size_chk, buflen);
+			ret = messaging_parse_packet(recv_packet, recv_buf->buf, buflen, &recv_buf->sender_pid, &msg_type);
 			if (ret != OK) {
-				MSG_FREE(recv_packet);
+				recv_buf->buflen = buflen;
+				MSG_PACKET_FREE(recv_packet);
 				goto errout_with_mq;
 			}
-			recv_buf->buflen = recv_size_chk;
 			(*cb_info->cb_func)(msg_type, recv_buf, cb_info->cb_data);
+			recv_buf->buflen = buflen;
 		} else if (recv_size_chk == ERROR && errno == EAGAIN) {
 			msgdbg("[Messaging] recv : empty queue, but NONBLOCK mode.\n");
 			break;
 		} else {
 			msgdbg("[Messaging] recv fail : errno %d, size %d.\n", errno, recv_size_chk);
-			MSG_FREE(recv_packet);
+			MSG_PACKET_FREE(recv_packet);
 			goto errout_with_mq;
 		}
 	}
-	MSG_FREE(recv_packet);
+	MSG_PACKET_FREE(recv_packet);
 
 	/* There was no msg, then set notification. */
 	ret = messaging_set_notify_signal(SIGMSG_MESSAGING, (_sa_sigaction_t)messaging_run_callback);
@@ -143,10 +145,9 @@ errout_with_msg:
 	sq_rem((FAR sq_entry_t *)port_info, &g_port_info_list);
 	MSG_FREE(port_info);
 errout_with_mq:
-	mq_close(mqdes);
-	MSG_ASPRINTF(&internal_portname, "%s%d", port_name, getpid());
-	mq_unlink(internal_portname);
-	MSG_FREE(internal_portname);
+	messaging_port_invalidate(mqdes);
+	snprintf(internal_portname, MAX_PORT_NAME_SIZE, "%s%d", port_name, getpid());
+	messaging_port_unlink(internal_portname);
 	return ERROR;
 }
 
@@ -165,16 +166,14 @@ errout_with_mq:
  * Return Value:
  *  On success, sender pid (>=0) is returned.; On failure, -1 (ERROR) is returned.
  ****************************************************************************/
-static int messaging_rcv_block(mqd_t mqdes, const char *port_name, msg_recv_buf_t *recv_buf)
+static int messaging_rcv_block(mqd_t mqdes, const char *port_name, int recv_size, msg_recv_buf_t *recv_buf)
 {
 	int ret = OK;
-	int recv_size;
 	char *recv_packet;
 	int msg_type = OK;
-	char *internal_portname;
+	char internal_portname[MAX_PORT_NAME_SIZE];
 
-	recv_size = MSG_HEADER_SIZE + recv_buf->buflen;
-	recv_packet = (char *)MSG_ALLOC(recv_size);
+	recv_packet = (char *)MSG_PACKET_ALLOC(recv_size);
 	if (recv_packet == NULL) {
 		msgdbg("[Messaging] recv fail : out of memory for packet.\n");
 		ret = ERROR;
@@ -195,11 +194,12 @@ static int messaging_rcv_block(mqd_t mqdes, const char *port_name, msg_recv_buf_
 	}
 
 cleanup_return:
-	MSG_FREE(recv_packet);
-	mq_close(mqdes);
-	MSG_ASPRINTF(&internal_portname, "%s%d", port_name, getpid());
-	mq_unlink(internal_portname);
-	MSG_FREE(internal_portname);
+	if (recv_packet != NULL) {
+		MSG_PACKET_FREE(recv_packet);
+	}
+	messaging_port_close(mqdes);
+	snprintf(internal_portname, MAX_PORT_NAME_SIZE, "%s%d", port_name, getpid());
+	messaging_port_unlink(internal_portname);
 	return msg_type;
 }
 /****************************************************************************
@@ -223,25 +223,25 @@ int messaging_recv_internal(const char *port_name, msg_recv_buf_t *recv_buf, msg
 {
 	int ret = OK;
 	mqd_t mqdes;
-	struct mq_attr internal_attr;
-	char *internal_portname;
-
-	MSG_ASPRINTF(&internal_portname, "%s%d", port_name, getpid());
+	int recv_size;
+	char internal_portname[MAX_PORT_NAME_SIZE];
 
-	internal_attr.mq_maxmsg = CONFIG_MESSAGING_MAXMSG;
-	internal_attr.mq_msgsize = recv_buf->buflen + MSG_HEADER_SIZE;
-	internal_attr.mq_flags = 0;
+	ret = snprintf(internal_portname, MAX_PORT_NAME_SIZE, "%s%d", port_name, getpid());
+	if (ret >= MAX_PORT_NAME_SIZE) {
+		msgdbg("[Messaging] recv fail : too long port name.\n");
+		return ERROR;
+	}
 
+	/* A cached port can be larger than this buffer, recv_size is the size of the port. */
 	if (cb_info == NULL) {
 		/* This is block receive case. */
-		mqdes = mq_open(internal_portname, O_RDONLY | O_CREAT, 0666, &internal_attr);
+		mqdes = messaging_port_open(internal_portname, O_RDONLY, recv_buf->buflen + MSG_HEADER_SIZE, &recv_size);
 	} else {
 		/* This is non-block receive case. */
-		mqdes = mq_open(internal_portname, O_RDONLY | O_CREAT | O_NONBLOCK, 0666, &internal_attr);
+		mqdes = messaging_port_open(internal_portname, O_RDONLY | O_NONBLOCK, recv_buf->buflen + MSG_HEADER_SIZE, &recv_size);
 	}
 
 	if (mqdes == (mqd_t)ERROR) {
-		MSG_FREE(internal_portname);
 		msgdbg("[Messaging] recv fail : open fail, errno %d.\n", errno);
 		return ERROR;
 	}
@@ -249,19 +249,16 @@ int messaging_recv_internal(const char *port_name, msg_recv_buf_t *recv_buf, msg
 	/* Save the receivers information. It will be used by sender to check the receivers. */
 	ret = SAVE_MSG_RECEIVER(port_name);
 	if (ret != OK) {
-		mq_close(mqdes);
-		mq_unlink(internal_portname);
-		MSG_FREE(internal_portname);
+		messaging_port_invalidate(mqdes);
+		messaging_port_unlink(internal_portname);
 		return ERROR;
 	}
 
 	if (cb_info == NULL) {
-		ret = messaging_rcv_block(mqdes, port_name, recv_buf);
+		ret = messaging_rcv_block(mqdes, port_name, recv_size, recv_buf);
 	} else {
-		ret = messaging_rcv_nonblock(mqdes, port_name, recv_buf, cb_info);
+		ret = messaging_rcv_nonblock(mqdes, port_name, recv_size, recv_buf, cb_info);
 	}
 
-	MSG_FREE(internal_portname);
 	return ret;
 }
-
@@ -23,6 +23,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <mqueue.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,9 +41,9 @@ static int messaging_set_async_callback(const char *port_name, msg_recv_buf_t *r
 {
 	int ret;
 	msg_recv_info_t *data;
-	struct mq_attr internal_attr;
 	int recv_size;
-	char *reply_portname;
+	int qsize;
+	char reply_portname[MAX_PORT_NAME_SIZE];
 	mqd_t mqdes;
 
 	ret = messaging_set_notify_signal(SIGMSG_MESSAGING, (_sa_sigaction_t)messaging_run_callback);
@@ -52,28 +53,23 @@ static int messaging_set_async_callback(const char *port_name, msg_recv_buf_t *r
 
 	recv_size = MSG_HEADER_SIZE + recv_data->buflen;
 
-	internal_attr.mq_maxmsg = CONFIG_MESSAGING_MAXMSG;
-	internal_attr.mq_msgsize = recv_size;
-	internal_attr.mq_flags = 0;
-
 	/* Sender waits the reply with "port_name + sender_pid + _r". */
-	MSG_ASPRINTF(&reply_portname, "%s%d%s", port_name, getpid(), "_r");
-	if (reply_portname == NULL) {
-		msgdbg("[Messaging] send fail : out of memory for async port.\n");
+	ret = snprintf(reply_portname, MAX_PORT_NAME_SIZE, "%s%d%s", port_name, getpid(), "_r");
+	if (ret >= MAX_PORT_NAME_SIZE) {
+		msgdbg("[Messaging] send fail : too long port name for async port.\n");
 		return ERROR;
 	}
 
-	mqdes = mq_open(reply_portname, O_RDONLY | O_CREAT, 0666, &internal_attr);
+	mqdes = messaging_port_open(reply_portname, O_RDONLY, recv_size, &qsize);
 	if (mqdes == (mqd_t)ERROR) {
 		msgdbg("[Messaging] send fail : open fail, errno %d.\n", errno);
-		MSG_FREE(reply_portname);
 		return ERROR;
 	}
 
 	data = (msg_recv_info_t *)MSG_ALLOC(sizeof(msg_recv_info_t));
 	if (data == NULL) {
 		msgdbg("[Messaging] send fail : out of memory for recv info.\n");
-		MSG_FREE(reply_portname);
+		messaging_port_close(mqdes);
 		return ERROR;
 	}
 	data->mqdes = mqdes;
@@ -81,7 +77,6 @@ static int messaging_set_async_callback(const char *port_name, msg_recv_buf_t *r
 	data->user_cb = param->cb_func;
 	data->cb_data = param->cb_data;
 	strncpy(data->port_name, reply_portname, strlen(reply_portname) + 1);
-	MSG_FREE(reply_portname);
 
 	ret = messaging_set_notification(SIGMSG_MESSAGING, data);
 	if (ret != OK) {
@@ -108,35 +103,39 @@ int messaging_send_packet(const char *port_name, msg_send_type_t msg_type, msg_s
 {
 	int ret = OK;
 	mqd_t mqdes;
-	struct mq_attr internal_attr;
 	char *send_packet;
 	int send_size;
+	int qsize;
 	uint32_t send_type;
 	uint32_t msg_offset;
 	uint32_t msg_version;
+	bool shared = false;
 
-	send_size = MSG_HEADER_SIZE + send_data->msglen;
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+	/* A shared buffer is passed as a reference instead of its contents. */
+	if (messaging_shmbuf_hold(send_data->msg, send_data->msglen) == OK) {
+		shared = true;
+	}
+#endif
 
-	internal_attr.mq_maxmsg = CONFIG_MESSAGING_MAXMSG;
-	internal_attr.mq_msgsize = send_size;
-	internal_attr.mq_flags = 0;
+	send_size = MSG_HEADER_SIZE + (shared ? sizeof(msg_shmref_t) : send_data->msglen);
 
-	mqdes = mq_open(port_name, O_WRONLY, 0666, &internal_attr);
+	mqdes = messaging_port_open(port_name, O_WRONLY, send_size, &qsize);
 	if (mqdes == (mqd_t)ERROR) {
 		if (errno == ENOENT) {
-			msgdbg("[Messagmemcpying] send fail : no receiver.\n");
+			msgdbg("[Messaging] send fail : no receiver.\n");
 		} else {
 			msgdbg("[Messaging] send fail : open fail, errno %d.\n", errno);
 		}
-		return ERROR;
+		goto errout_with_shmbuf;
 	}
 
-	send_packet = (char *)MSG_ALLOC(send_size);
+	send_packet = (char *)MSG_PACKET_ALLOC(send_size);
 	if (send_packet == NULL) {
 		msgdbg("[Messaging] send fail : out of memory for including header.\n");
-		mq_close(mqdes);
-		mq_unlink(port_name);
-		return ERROR;
+		messaging_port_invalidate(mqdes);
+		messaging_port_unlink(port_name);
+		goto errout_with_shmbuf;
 	}
 
 	/* Send packet(version 1) is like below.
@@ -162,23 +161,39 @@ int messaging_send_packet(const char *port_name, msg_send_type_t msg_type, msg_s
 	} else {
 		send_type = MSG_REPLY_REQUIRED;
 	}
-	((messaging_packet_t *)send_packet)->msg_type = send_type;
 
-	/* Copy the real send message. */
-	memcpy(send_packet + msg_offset, send_data->msg, send_data->msglen);
+	if (shared) {
+		/* The receiver copies from the shared buffer and drops the reference. */
+		((messaging_packet_t *)send_packet)->msg_type = send_type | MSG_TYPE_SHARED;
+		((msg_shmref_t *)(send_packet + msg_offset))->buf = send_data->msg;
+		((msg_shmref_t *)(send_packet + msg_offset))->buflen = send_data->msglen;
+	} else {
+		((messaging_packet_t *)send_packet)->msg_type = send_type;
+
+		/* Copy the real send message. */
+		memcpy(send_packet + msg_offset, send_data->msg, send_data->msglen);
+	}
 
 	ret = mq_send(mqdes, (char *)send_packet, send_size, send_data->priority);
 	if (ret != OK) {
 		msgdbg("[Messaging] send fail : errno %d.\n", errno);
-		MSG_FREE(send_packet);
-		mq_close(mqdes);
-		mq_unlink(port_name);
-		return ERROR;
+		MSG_PACKET_FREE(send_packet);
+		messaging_port_invalidate(mqdes);
+		messaging_port_unlink(port_name);
+		goto errout_with_shmbuf;
 	}
 
-	MSG_FREE(send_packet);
-	mq_close(mqdes);
+	MSG_PACKET_FREE(send_packet);
+	messaging_port_close(mqdes);
 	return ret;
+
+errout_with_shmbuf:
+#ifdef CONFIG_MESSAGING_SHARED_BUFFER
+	if (shared) {
+		messaging_shmbuf_release(send_data->msg);
+	}
+#endif
+	return ERROR;
 }
 
 static void messaging_init_recv_arr(int *arr)
@@ -210,7 +225,7 @@ int messaging_send_internal(const char *port_name, msg_send_type_t msg_type, msg
 	int ret = ERROR;
 	int read_status = MSG_READ_YET;
 	int recv_arr[CONFIG_MESSAGING_RECV_LIST_SIZE];
-	char *private_portname;
+	char private_portname[MAX_PORT_NAME_SIZE];
 	int recv_cnt;
 
 	/* Check that how many receivers are waiting. */
@@ -231,16 +246,15 @@ int messaging_send_internal(const char *port_name, msg_send_type_t msg_type, msg
 			if (recv_arr[recv_idx] == MSG_RECV_NOT_INIT) {
 				continue;
 			}
-			MSG_ASPRINTF(&private_portname, "%s%d", port_name, recv_arr[recv_idx]);
-			if (private_portname == NULL) {
-				msgdbg("[Messaging] send fail : out of memory for private portname.\n");
+			ret = snprintf(private_portname, MAX_PORT_NAME_SIZE, "%s%d", port_name, recv_arr[recv_idx]);
+			if (ret >= MAX_PORT_NAME_SIZE) {
+				msgdbg("[Messaging] send fail : too long port name.\n");
 				return ERROR;
 			}
 			if (msg_type == MSG_SEND_ASYNC) {
 				if (recv_cnt == 1) {
 					ret = messaging_set_async_callback(port_name, recv_data, cb_info);
 					if (ret != OK) {
-						MSG_FREE(private_portname);
 						return ERROR;
 					}
 				}
@@ -248,7 +262,6 @@ int messaging_send_internal(const char *port_name, msg_send_type_t msg_type, msg
 			} else {
 				ret = messaging_send_packet(private_portname, msg_type, send_data, NULL);
 			}
-			MSG_FREE(private_portname);
 		}
 	}
 	if (ret == OK) {
@@ -51,40 +51,36 @@ static int messaging_sync_recv(const char *port_name, msg_recv_buf_t *reply_buf)
 {
 	int ret = OK;
 	mqd_t sync_mqdes;
-	char *sync_portname;
-	struct mq_attr internal_attr;
+	char sync_portname[MAX_PORT_NAME_SIZE];
 	char *reply_data;
 	int reply_size;
+	int qsize;
 	int msg_type;
 
 	reply_size = reply_buf->buflen + MSG_HEADER_SIZE;
 
-	internal_attr.mq_maxmsg = CONFIG_MESSAGING_MAXMSG;
-	internal_attr.mq_msgsize = reply_size;
-	internal_attr.mq_flags = 0;
-
 	/* sender waits the reply with "port_name + sender_pid + _r". */
-	MSG_ASPRINTF(&sync_portname, "%s%d%s", port_name, getpid(), "_r");
-	if (sync_portname == NULL) {
-		msgdbg("message send fail : sync portname allocation fail.\n");
+	ret = snprintf(sync_portname, MAX_PORT_NAME_SIZE, "%s%d%s", port_name, getpid(), "_r");
+	if (ret >= MAX_PORT_NAME_SIZE) {
+		msgdbg("message send fail : too long sync portname.\n");
 		return ERROR;
 	}
-	sync_mqdes = mq_open(sync_portname, O_RDONLY | O_CREAT, 0666, &internal_attr);
+	sync_mqdes = messaging_port_open(sync_portname, O_RDONLY, reply_size, &qsize);
 	if (sync_mqdes == (mqd_t)ERROR) {
 		msgdbg("message send fail : sync open fail %d.\n", errno);
-		MSG_FREE(sync_portname);
 		return ERROR;
 	}
 
-	reply_data = (char *)MSG_ALLOC(reply_size);
+	/* A cached port can be larger than this reply. */
+	reply_data = (char *)MSG_PACKET_ALLOC(qsize);
 	if (reply_data == NULL) {
 		msgdbg("message send fail : out of memory for including header\n");
-		mq_close(sync_mqdes);
-		mq_unlink(sync_portname);
+		messaging_port_invalidate(sync_mqdes);
+		messaging_port_unlink(sync_portname);
 		return ERROR;
 	}
 
-	ret = mq_receive(sync_mqdes, reply_data, reply_size, 0);
+	ret = mq_receive(sync_mqdes, reply_data, qsize, 0);
 	if (ret < 0) {
 		msgdbg("message send fail : sync recv fail %d.\n", errno);
 		ret = ERROR;
@@ -95,10 +91,9 @@ static int messaging_sync_recv(const char *port_name, msg_recv_buf_t *reply_buf)
 		}
 	}
 
-	mq_close(sync_mqdes);
-	mq_unlink(sync_portname);
-	MSG_FREE(reply_data);
-	MSG_FREE(sync_portname);
+	messaging_port_close(sync_mqdes);
+	messaging_port_unlink(sync_portname);
+	MSG_PACKET_FREE(reply_data);
 
 	return ret;
 }
@@ -196,7 +191,7 @@ int messaging_send(const char *port_name, msg_send_data_t *send_data)
 int messaging_reply(const char *port_name, pid_t sender_pid, msg_send_data_t *reply_data)
 {
 	int ret = OK;
-	char *reply_portname;
+	char reply_portname[MAX_PORT_NAME_SIZE];
 	msg_send_data_t reply;
 
 	if (port_name == NULL || sender_pid < 0 || reply_data == NULL || reply_data->msg == NULL || reply_data->msglen <= 0) {
@@ -205,16 +200,14 @@ int messaging_reply(const char *port_name, pid_t sender_pid, msg_send_data_t *re
 	}
 
 	/* Sender waits the reply with "port_name + sender_pid + _r". */
-	MSG_ASPRINTF(&reply_portname, "%s%d%s", port_name, sender_pid, "_r");
-	if (reply_portname == NULL) {
-		msgdbg("[Messaging] unicast reply fail : out of memory.\n");
+	ret = snprintf(reply_portname, MAX_PORT_NAME_SIZE, "%s%d%s", port_name, sender_pid, "_r");
+	if (ret >= MAX_PORT_NAME_SIZE) {
+		msgdbg("[Messaging] unicast reply fail : too long port name.\n");
 		return ERROR;
 	}
 
 	reply.msg = reply_data->msg;
 	reply.msglen = reply_data->msglen;
 	reply.priority = MSG_REPLY_PRIO;
-	ret = messaging_send_packet(reply_portname, MSG_SEND_REPLY, &reply, NULL);
-	MSG_FREE(reply_portname);
-	return ret;
+	return messaging_send_packet(reply_portname, MSG_SEND_REPLY, &reply, NULL);
 }
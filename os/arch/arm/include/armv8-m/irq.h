@@ -129,6 +129,9 @@
 struct xcpt_syscall_s {
 	uint32_t excreturn;			/* The EXC_RETURN value */
 	uint32_t sysreturn;			/* The return PC */
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SYSCALL
+	uint32_t sysnr;				/* The system call number, for the leave note */
+#endif
 };
 #endif
 
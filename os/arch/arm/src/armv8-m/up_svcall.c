@@ -65,6 +65,9 @@
 #include <tinyara/arch.h>
 #include <tinyara/sched.h>
 #include <tinyara/userspace.h>
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SYSCALL
+#include <tinyara/sched_note.h>
+#endif
 
 #ifdef CONFIG_LIB_SYSCALL
 #include <syscall.h>
@@ -333,6 +336,9 @@ int up_svcall(int irq, FAR void *context, FAR void *arg)
 		 */
 
 		regs[REG_R0] = regs[REG_R2];
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SYSCALL
+		sched_note_syscall_leave(rtcb->xcp.syscall[index].sysnr, regs[REG_R0]);
+#endif
 	}
 	break;
 #endif
@@ -554,6 +560,13 @@ int up_svcall(int irq, FAR void *context, FAR void *arg)
 #endif
 		rtcb->xcp.nsyscalls = index + 1;
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SYSCALL
+		/* Record the call with the arguments passed in R1-R3 */
+
+		rtcb->xcp.syscall[index].sysnr = cmd - CONFIG_SYS_RESERVED;
+		sched_note_syscall_enter(cmd - CONFIG_SYS_RESERVED, 3, regs[REG_R1], regs[REG_R2], regs[REG_R3]);
+#endif
+
 		regs[REG_PC] = (uint32_t)dispatch_syscall;
 #if defined(CONFIG_BUILD_PROTECTED)
 		regs[REG_EXC_RETURN] = EXC_RETURN_PRIVTHR;
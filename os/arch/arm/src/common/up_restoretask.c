@@ -29,6 +29,9 @@
 #ifdef CONFIG_TASK_SCHED_HISTORY
 #include <tinyara/debug/sysdbg.h>
 #endif
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SWITCH
+#include <tinyara/sched_note.h>
+#endif
 #ifdef CONFIG_ARMV8M_TRUSTZONE
 #include <tinyara/tz_context.h>
 #endif
@@ -73,6 +76,11 @@ void up_restoretask(struct tcb_s *tcb)
 		save_task_scheduling_status(tcb);
 #endif
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SWITCH
+		/* Record the switch to the task which will be scheduled */
+		sched_note_resume(tcb);
+#endif
+
 		/* Restore the MPU registers in case we are switching to an application task */
 #ifdef CONFIG_APP_BINARY_SEPARATION
 
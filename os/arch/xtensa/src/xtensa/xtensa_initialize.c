@@ -197,10 +197,6 @@ void up_initialize(void)
 #endif
 #endif							/* CONFIG_NFILE_DESCRIPTORS */
 
-#if defined(CONFIG_SCHED_INSTRUMENTATION_BUFFER) && \
-	defined(CONFIG_DRIVER_NOTE)
-	note_register();			/* Non-standard /dev/note */
-#endif
 
 	/* Initialize the serial device driver */
 
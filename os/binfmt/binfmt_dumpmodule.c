@@ -60,6 +60,7 @@
 #include <debug.h>
 #include <errno.h>
 
+#include <tinyara/clock.h>
 #include <tinyara/binfmt/binfmt.h>
 
 #include "binfmt.h"
@@ -103,6 +104,13 @@ int dump_module(FAR const struct binary_s *bin)
 		berr("  dtors:     %p ndtors=%d\n", bin->dtors, bin->ndtors);
 #endif
 		berr("  stacksize: %d\n", bin->stacksize);
+#ifdef CONFIG_ELF
+		berr("  relocs:    %u in %u ms\n", bin->nrelocs, (unsigned int)TICK2MSEC(bin->reloc_ticks));
+#endif
+#ifdef CONFIG_ELF_CACHE_READ
+		berr("  cache:     hits=%u misses=%u\n", bin->cache_stats.hits, bin->cache_stats.misses);
+		berr("  readahead: prefetched=%u used=%u ghost hits=%u\n", bin->cache_stats.prefetched, bin->cache_stats.prefetch_hits, bin->cache_stats.ghost_hits);
+#endif
 		berr("  unload:    %p\n", bin->unload);
 	}
 
@@ -262,6 +262,9 @@ static int elf_loadbinary(FAR struct binary_s *binp)
 #endif
 
 	elf_dumpentrypt(binp, &loadinfo);
+#ifdef CONFIG_ELF_CACHE_READ
+	elf_cache_get_stats(&binp->cache_stats);
+#endif
 	elf_uninit(&loadinfo);
 	return OK;
 
@@ -60,6 +60,8 @@
 #include <tinyara/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 #include <tinyara/arch.h>
 #include <tinyara/binfmt/elf.h>
@@ -371,12 +373,13 @@ void elf_addrenv_free(FAR struct elf_loadinfo_s *loadinfo);
 
 /* Struct for output buffers to cache uncompressed blocks */
 struct block_cache_s {
-	unsigned char *out_buffer;              /* Buffer that is going to hold uncompressed data */
-	int block_number;                       /* Block number in compressed file for the cached block */
-	unsigned int no_requests_for_block;     /* Number of requests for current block that is cached */
-	unsigned int index_block_cache;         /* Index of block cache in the array */
+	unsigned char *out_buffer;              /* Buffer holding the block, NULL for a ghost or a free entry */
+	int block_number;                       /* Block number in the file of the cached block */
+	uint8_t list;                           /* 2Q list the entry is on */
+	bool prefetched;                        /* Read ahead and not requested yet */
 	struct block_cache_s *next;             /* Pointer to next element in doubly linked list */
 	struct block_cache_s *prev;             /* Pointer to previous element in doubly linked list */
+	struct block_cache_s *hnext;            /* Pointer to next element in the same hash bucket */
 };
 typedef struct block_cache_s block_cache_t;
 
@@ -416,6 +419,17 @@ int elf_cache_init(int filfd, uint16_t offset, off_t filelen);
  *   Negative value on failure
  ****************************************************************************/
 int elf_cache_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, size_t readsize, off_t offset);
+
+/****************************************************************************
+ * Name: elf_cache_get_stats
+ *
+ * Description:
+ *   Return the hit and miss counters of the cache since elf_cache_init
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+void elf_cache_get_stats(FAR struct binfmt_cache_stats_s *stats);
 #endif
 
 #ifdef CONFIG_APP_BINARY_SEPARATION
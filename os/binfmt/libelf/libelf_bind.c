@@ -62,6 +62,7 @@
 #include <assert.h>
 #include <debug.h>
 
+#include <tinyara/clock.h>
 #include <tinyara/elf.h>
 #include <tinyara/binfmt/elf.h>
 #include <tinyara/binfmt/symtab.h>
@@ -260,6 +261,8 @@ static int elf_relocate(FAR struct elf_loadinfo_s *loadinfo, int relidx, FAR con
 			berr("ERROR: Section %d reloc %d: Relocation failed: %d\n", relidx, i, ret);
 			goto ret_err;
 		}
+
+		loadinfo->binp->nrelocs++;
 	}
 
 ret_err:
@@ -367,9 +370,12 @@ ret_err:
 
 int elf_bind(FAR struct elf_loadinfo_s *loadinfo, FAR const struct symtab_s *exports, int nexports)
 {
+	clock_t start = clock_systimer();
 	int ret;
 	int i;
 
+	loadinfo->binp->nrelocs = 0;
+
 	/* Find the symbol and string tables */
 
 	ret = elf_findsymtab(loadinfo);
@@ -448,5 +454,8 @@ ret_err:
 		loadinfo->symtab = (uintptr_t)NULL;
 	}
 
+	loadinfo->binp->reloc_ticks = clock_systimer() - start;
+	binfo("%u relocations in %u ms\n", loadinfo->binp->nrelocs, (unsigned int)TICK2MSEC(loadinfo->binp->reloc_ticks));
+
 	return ret;
 }
@@ -23,21 +23,45 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include <string.h>
 #include <debug.h>
 #include <errno.h>
+#include <assert.h>
 
 #include <tinyara/fs/fs.h>
+#include <tinyara/kmalloc.h>
 #include "libelf.h"
 
 #ifdef CONFIG_COMPRESSED_BINARY
 #include <tinyara/binfmt/compression/compress_read.h>
 #endif
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Lists of the 2Q replacement.  A block read once sits in A1in.  When it
+ * leaves A1in, its buffer is reused and only its block number is kept in
+ * A1out.  A block found in A1out is used again and goes to Am, which is
+ * kept in LRU order.
+ */
+#define ELF_CACHE_FREE		0	/* Unused entries */
+#define ELF_CACHE_A1IN		1	/* Blocks read once, FIFO */
+#define ELF_CACHE_AM		2	/* Blocks used again, LRU */
+#define ELF_CACHE_A1OUT		3	/* Ghosts of blocks evicted from A1in */
+#define ELF_CACHE_NLISTS	4
+
 /****************************************************************************
  * Private Declarations
  ****************************************************************************/
 
+struct elf_cache_list_s {
+	block_cache_t *head;		/* Most recently inserted entry */
+	block_cache_t *tail;		/* Oldest entry, next to be evicted */
+	unsigned int count;
+};
+
 /* Number of blocks to be caching */
 static unsigned int number_blocks_caching;
 
@@ -50,16 +74,33 @@ static unsigned int file_len;
 /* Number of blocks for caching */
 static unsigned int number_of_blocks;
 
-/* Pointer to block_cache_t list to be used for holding ELF blocks */
+/* Entries for the cached blocks and the A1out ghosts */
 static block_cache_t *blockcache;
+static unsigned int number_entries;
+
+/* Hash of the entries by block number */
+static block_cache_t **blockhash;
+static unsigned int hash_mask;
 
-/* Pointers for maintaining doubly linked list of blockcache */
-static block_cache_t *head;		/* Pointer to least priority block for caching */
-static block_cache_t *tail;		/* Pointer to highest priority block for caching */
-static block_cache_t *most_accessed;	/* Pointer to most accessed block for quick access */
+/* Buffers not attached to any entry */
+static unsigned char **free_buffers;
+static unsigned int number_free_buffers;
 
-/* Number of requests for the most accessed block in blockcache list */
-static unsigned int max_accessed_count;
+/* 2Q lists and their target sizes */
+static struct elf_cache_list_s lists[ELF_CACHE_NLISTS];
+static unsigned int a1in_max;
+static unsigned int a1out_max;
+
+/* Readahead window: 'ra_size' blocks are read from 'ra_next' on, and the
+ * next window is read when the reader gets to 'ra_marker'.
+ */
+static unsigned int ra_size;
+static int ra_next;
+static int ra_marker;
+static bool ra_pending;
+
+/* Counters reported through binfmt_dumpmodule() */
+static struct binfmt_cache_stats_s cache_stats;
 
 /****************************************************************************
  * Private Functions
@@ -82,7 +123,7 @@ static void elf_cache_blocks_to_read(int *first_block, int *last_block, int *no_
 	blocksize = cache_blocks_size;
 
 	*first_block = offset / blocksize;
-	*last_block = (offset + readsize) / blocksize;
+	*last_block = (offset + readsize - 1) / blocksize;
 	*no_blocks = *last_block - *first_block + 1;
 }
 
@@ -150,7 +191,7 @@ static off_t elf_cache_read_block(int filfd, uint16_t binary_header_size, FAR ui
 	}
 
 	/* Last unaligned blocks to be read with its actual size and not with blocksize;*/
-	if (block_number == number_of_blocks - 1) {
+	if (block_number == number_of_blocks - 1 && file_len % cache_blocks_size) {
 		readsize = file_len % cache_blocks_size;
 	} else {
 		readsize = cache_blocks_size;
@@ -176,170 +217,327 @@ static off_t elf_cache_read_block(int filfd, uint16_t binary_header_size, FAR ui
 }
 
 /****************************************************************************
- * Name: elf_cache_update_blockcache_list
+ * Name: elf_cache_list_remove
  *
  * Description:
- *   Update blockcache list based on whether 'block_number' block in
- *   blockwise-elf binary is already cached or not. Also, maintain
- *   head, tail and most_accessed pointers.
- *   tail = most recently cached block (highest priority block for keeping
- *          cached)
- *   head = oldest cached block (lowest priority for keeping it cached).
- *          If a new block needs to be cached, cache to this blockcache element.
- *   most_accessed = pointer to most accessed block in blockcache list.
- *          Needed for easy access to most accessed block from comp. binary.
+ *   Detach 'entry' from the list it is on
  *
  * Returned Value:
- *   Index in blockcache list where 'block_number' from elf
- *   binary is cached state. Return Negative value on failure.
+ *   None
  ****************************************************************************/
-static unsigned int elf_cache_update_blockcache_list(int block_number, int filfd, uint16_t binary_header_size)
+static void elf_cache_list_remove(block_cache_t *entry)
 {
-	unsigned int blockcache_index;		/* Which blockcache element has needed ELF data for read */
-	block_cache_t *ptr;					/* Pointer to element in blockcache list which will be updated */
-	block_cache_t *temp;				/* Used when updating blockcache list */
-	bool flag_for_caching;				/* 1 = Block needs to be cached, 0 = Block already cached */
-	bool update_most_accessed;			/* 1 = Most accessed block is being removed from blockcache.
-										 *     Need to update most accessed pointer from scratch */
-	int size;
+	struct elf_cache_list_s *list = &lists[entry->list];
 
-	binfo("filfd: %d block_number: %d\n", filfd, block_number);
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	} else {
+		list->head = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	} else {
+		list->tail = entry->prev;
+	}
 
-	/* Initialize flags */
-	flag_for_caching = true;
-	update_most_accessed = false;
+	entry->next = NULL;
+	entry->prev = NULL;
+	list->count--;
+}
 
-	/* First check is with block_number at most_accessed pointer */
-	if (most_accessed->block_number == block_number) {
-		flag_for_caching = false;
-		blockcache_index = most_accessed->index_block_cache;
+/****************************************************************************
+ * Name: elf_cache_list_insert
+ *
+ * Description:
+ *   Attach 'entry' at the head of list 'which'
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+static void elf_cache_list_insert(block_cache_t *entry, uint8_t which)
+{
+	struct elf_cache_list_s *list = &lists[which];
+
+	entry->list = which;
+	entry->prev = NULL;
+	entry->next = list->head;
+	if (list->head) {
+		list->head->prev = entry;
+	} else {
+		list->tail = entry;
 	}
 
-	/* Start checking for if block is cached from the tail */
-	if (flag_for_caching == true) {
-		ptr = tail;
-		while (ptr != NULL) {
-			if (ptr->block_number == block_number) {
-				flag_for_caching = false;
-				blockcache_index = ptr->index_block_cache;
-				break;
-			} else {
-				ptr = ptr->prev;
-			}
+	list->head = entry;
+	list->count++;
+}
+
+/****************************************************************************
+ * Name: elf_cache_hash_lookup
+ *
+ * Description:
+ *   Find the entry, cached or ghost, of 'block_number'
+ *
+ * Returned Value:
+ *   Pointer to the entry, NULL if the block is not known
+ ****************************************************************************/
+static block_cache_t *elf_cache_hash_lookup(int block_number)
+{
+	block_cache_t *entry;
+
+	for (entry = blockhash[block_number & hash_mask]; entry; entry = entry->hnext) {
+		if (entry->block_number == block_number) {
+			return entry;
 		}
 	}
 
-	/* If block_number block from elf binary needs to be cached */
-	if (flag_for_caching == true) {
-
-		/* If most_accessed == head, need to update most_accessed */
-		if (head == most_accessed)
-			update_most_accessed = true;
+	return NULL;
+}
 
-		/* Detach head, Reassign head to head->next */
-		ptr = head;
-		head = ptr->next;
-		head->prev = ptr->prev;
+/****************************************************************************
+ * Name: elf_cache_hash_remove
+ *
+ * Description:
+ *   Remove 'entry' from the hash
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+static void elf_cache_hash_remove(block_cache_t *entry)
+{
+	block_cache_t **pp;
 
-		/* Read elf 'block_number' block into respective 'out_buffer' */
-		size = elf_cache_read_block(filfd, binary_header_size, ptr->out_buffer, block_number);
-		if (size < 0) {
-			berr("Read for block %d failed\n", block_number);
-			return ERROR;
+	for (pp = &blockhash[entry->block_number & hash_mask]; *pp; pp = &(*pp)->hnext) {
+		if (*pp == entry) {
+			*pp = entry->hnext;
+			break;
 		}
+	}
+
+	entry->hnext = NULL;
+}
+
+/****************************************************************************
+ * Name: elf_cache_release
+ *
+ * Description:
+ *   Forget the block of 'entry' and put the entry back on the free list.
+ *   Its buffer, if any, goes back to the free buffers.
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+static void elf_cache_release(block_cache_t *entry)
+{
+	elf_cache_list_remove(entry);
+	elf_cache_hash_remove(entry);
 
-		/* Update block_number, Number of requests */
-		ptr->block_number = block_number;
-		ptr->no_requests_for_block = 1;
+	if (entry->out_buffer) {
+		free_buffers[number_free_buffers++] = entry->out_buffer;
+		entry->out_buffer = NULL;
+	}
+
+	entry->block_number = -1;
+	entry->prefetched = false;
+	elf_cache_list_insert(entry, ELF_CACHE_FREE);
+}
+
+/****************************************************************************
+ * Name: elf_cache_reclaim
+ *
+ * Description:
+ *   Make sure a buffer is free, evicting a block if needed.  Following 2Q,
+ *   the oldest block of A1in is evicted while A1in is over its target size
+ *   and is remembered as a ghost in A1out; otherwise the least recently
+ *   used block of Am is evicted and forgotten.
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+static void elf_cache_reclaim(void)
+{
+	block_cache_t *victim;
+
+	if (number_free_buffers > 0) {
+		return;
+	}
+
+	if (lists[ELF_CACHE_A1IN].count > a1in_max || lists[ELF_CACHE_AM].count == 0) {
+		victim = lists[ELF_CACHE_A1IN].tail;
 
-		/* Updating most_accessed pointer */
-		if (ptr->no_requests_for_block >= max_accessed_count) {
-			max_accessed_count = ptr->no_requests_for_block;
-			most_accessed = ptr;
+		/* Keep its block number only, as a ghost */
+
+		elf_cache_list_remove(victim);
+		free_buffers[number_free_buffers++] = victim->out_buffer;
+		victim->out_buffer = NULL;
+		victim->prefetched = false;
+		elf_cache_list_insert(victim, ELF_CACHE_A1OUT);
+
+		if (lists[ELF_CACHE_A1OUT].count > a1out_max) {
+			elf_cache_release(lists[ELF_CACHE_A1OUT].tail);
 		}
+	} else {
+		elf_cache_release(lists[ELF_CACHE_AM].tail);
+	}
+}
 
-		/* Always attach ptr at tail */
-		temp = tail;
-		temp->next = ptr;
-		ptr->prev = temp;
-		ptr->next = NULL;
-		tail = ptr;
-
-		/* Update most_accessed from scratch, if needed */
-		if (update_most_accessed == true) {
-			max_accessed_count = 0;
-			temp = tail;
-			while (temp != NULL) {
-				if (temp->no_requests_for_block > max_accessed_count) {
-					max_accessed_count = temp->no_requests_for_block;
-					most_accessed = temp;
-				}
-				temp = temp->prev;
-			}
+/****************************************************************************
+ * Name: elf_cache_fill
+ *
+ * Description:
+ *   Read 'block_number' into a free buffer and insert it in the cache.  A
+ *   block remembered in A1out and read on demand has been used again after
+ *   its eviction and goes to Am; any other block, including a ghost read
+ *   ahead, goes to A1in.
+ *
+ * Returned Value:
+ *   Pointer to the entry on Success
+ *   NULL on Failure
+ ****************************************************************************/
+static block_cache_t *elf_cache_fill(int block_number, int filfd, uint16_t binary_header_size, bool prefetch)
+{
+	block_cache_t *entry;
+	uint8_t which = ELF_CACHE_A1IN;
+	int size;
+
+	elf_cache_reclaim();
+
+	entry = elf_cache_hash_lookup(block_number);
+	if (entry != NULL) {
+		/* Ghost hit, unless it is only the readahead asking */
+
+		DEBUGASSERT(entry->list == ELF_CACHE_A1OUT);
+		elf_cache_list_remove(entry);
+		if (!prefetch) {
+			which = ELF_CACHE_AM;
+			cache_stats.ghost_hits++;
+		}
+	} else {
+		entry = lists[ELF_CACHE_FREE].tail;
+		if (entry == NULL) {
+			entry = lists[ELF_CACHE_A1OUT].tail;
+			elf_cache_hash_remove(entry);
 		}
 
-		/* Update blockcache_index into which block is cached */
-		blockcache_index = ptr->index_block_cache;
+		elf_cache_list_remove(entry);
+		entry->block_number = block_number;
+		entry->hnext = blockhash[block_number & hash_mask];
+		blockhash[block_number & hash_mask] = entry;
+	}
 
-	} else { /* If block is already cached */
+	entry->out_buffer = free_buffers[--number_free_buffers];
+	entry->prefetched = prefetch;
+	elf_cache_list_insert(entry, which);
 
-		/* If block is cached at head location */
-		if (head == &blockcache[blockcache_index]) {
-			/* Detach head, Reassign head to head->next */
-			ptr = head;
-			head = ptr->next;
-			head->prev = ptr->prev;
+	/* Read elf 'block_number' block into its 'out_buffer' */
+	size = elf_cache_read_block(filfd, binary_header_size, entry->out_buffer, block_number);
+	if (size < 0) {
+		berr("Read for block %d failed\n", block_number);
+		elf_cache_release(entry);
+		return NULL;
+	}
 
-			ptr->no_requests_for_block += 1;
+	return entry;
+}
 
-			/* Update most_accessed pointer */
-			if (ptr->no_requests_for_block >= max_accessed_count) {
-				max_accessed_count = ptr->no_requests_for_block;
-				most_accessed = ptr;
-			}
+/****************************************************************************
+ * Name: elf_cache_readahead
+ *
+ * Description:
+ *   Read the blocks of the current readahead window which are not cached
+ *   yet, and arm the trigger for the next window on its first block.
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+static void elf_cache_readahead(int filfd, uint16_t binary_header_size)
+{
+	block_cache_t *entry;
+	int first = ra_next;
+	int block_number;
+
+	for (block_number = first; block_number < first + (int)ra_size && block_number < (int)number_of_blocks; block_number++) {
+		entry = elf_cache_hash_lookup(block_number);
+		if (entry != NULL && entry->out_buffer != NULL) {
+			continue;
+		}
 
-			/* Always attach ptr at tail */
-			temp = tail;
-			temp->next = ptr;
-			ptr->prev = temp;
-			ptr->next = NULL;
-			tail = ptr;
-
-		} else if (tail == &blockcache[blockcache_index]) { /* Block is cached at tail location */
-			blockcache[blockcache_index].no_requests_for_block += 1;
-
-			/* Update most_accessed pointer */
-			ptr = tail;
-			if (ptr->no_requests_for_block >= max_accessed_count) {
-				max_accessed_count = ptr->no_requests_for_block;
-				most_accessed = ptr;
-			}
-		} else { /* Block is cached at some other index in blockcache list */
+		if (elf_cache_fill(block_number, filfd, binary_header_size, true) == NULL) {
+			break;
+		}
+
+		cache_stats.prefetched++;
+	}
 
-			/* Detach blockcache element at blockcache_index */
-			ptr = &blockcache[blockcache_index];
-			ptr->prev->next = ptr->next;
-			ptr->next->prev = ptr->prev;
+	ra_marker = first;
+	ra_next = block_number;
+}
 
-			/* Update Number of requests for block */
-			ptr->no_requests_for_block += 1;
+/****************************************************************************
+ * Name: elf_cache_get_block
+ *
+ * Description:
+ *   Return the entry holding 'block_number', reading it from the file if it
+ *   is not cached.  Two misses on consecutive blocks start the readahead,
+ *   whose window doubles each time the reader reaches it, up to
+ *   CONFIG_ELF_CACHE_READAHEAD blocks and the size of A1in.  The window is
+ *   read by elf_cache_read() once it is done with the returned entry, which
+ *   the readahead might evict.
+ *
+ * Returned Value:
+ *   Pointer to the entry on Success
+ *   NULL on Failure
+ ****************************************************************************/
+static block_cache_t *elf_cache_get_block(int block_number, int filfd, uint16_t binary_header_size)
+{
+	block_cache_t *entry;
+	unsigned int ra_max;
 
-			/* Update most accessed pointer */
-			if (ptr->no_requests_for_block >= max_accessed_count) {
-				max_accessed_count = ptr->no_requests_for_block;
-				most_accessed = ptr;
-			}
+	binfo("filfd: %d block_number: %d\n", filfd, block_number);
 
-			/* Always attach ptr at tail */
-			temp = tail;
-			temp->next = ptr;
-			ptr->prev = temp;
-			ptr->next = NULL;
-			tail = ptr;
+	ra_max = CONFIG_ELF_CACHE_READAHEAD < a1in_max ? CONFIG_ELF_CACHE_READAHEAD : a1in_max;
+
+	entry = elf_cache_hash_lookup(block_number);
+	if (entry != NULL && entry->out_buffer != NULL) {
+		cache_stats.hits++;
+		if (entry->prefetched) {
+			entry->prefetched = false;
+			cache_stats.prefetch_hits++;
+		} else if (entry->list == ELF_CACHE_AM) {
+			elf_cache_list_remove(entry);
+			elf_cache_list_insert(entry, ELF_CACHE_AM);
 		}
+
+		/* The reader reached the window, read the next one ahead */
+
+		if (block_number == ra_marker && ra_size > 0) {
+			ra_size = ra_size * 2 < ra_max ? ra_size * 2 : ra_max;
+			ra_pending = true;
+		}
+
+		return entry;
+	}
+
+	cache_stats.misses++;
+
+	entry = elf_cache_fill(block_number, filfd, binary_header_size, false);
+	if (entry == NULL) {
+		return NULL;
+	}
+
+	if (block_number == ra_next && ra_max > 0) {
+		/* Sequential access, start or restart the readahead */
+
+		ra_size = ra_size > 0 ? ra_size : 1;
+		ra_next = block_number + 1;
+		ra_pending = true;
+	} else {
+		ra_size = 0;
+		ra_next = block_number + 1;
+		ra_marker = -1;
 	}
 
-	return blockcache_index;
+	return entry;
 }
 
 /****************************************************************************
@@ -361,68 +559,42 @@ int elf_cache_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer,
 	int last_block;
 	int no_blocks;
 	int block_number;		/* Block number in an ELF file */
-	int actual_offset;		/* Offset from start of ELF file */
-	int block_size_to_write;	/* Size to write into buffer from cached block */
+	int block_start;		/* Offset of the first byte to copy from the block */
+	int block_end;			/* Offset past the last byte to copy from the block */
 	int buffer_pos;			/* Position in buffer to start writing from */
 	int blocksize;			/* Blocksize used by the binary */
-	unsigned int blockcache_index;	/* Which blockcache element has needed ELF data for read */
+	block_cache_t *entry;
 
 	binfo("filfd: %d readsize: %d offset: %d\n", filfd, readsize, offset);
 
 	/* Setting first block, end block and number of blocks to read */
 	blocksize = cache_blocks_size;
 	elf_cache_blocks_to_read(&first_block, &last_block, &no_blocks, offset, readsize);
-	if (first_block < 0 || no_blocks < 0) {
+	if (first_block < 0 || no_blocks < 0 || last_block >= (int)number_of_blocks) {
 		berr("Incorrect first_block, no_blocks info\n");
-		buffer_pos = ERROR;
-		goto error_cache_read;
+		return ERROR;
 	}
 
-	block_number = first_block;
 	buffer_pos = 0;
-	/* Actual Offset in ELF file is same as Offset passed to this function */
-	actual_offset = offset;
-
-	/* Reading from first_block to last_block. Then writing to buffer. */
-	for (; block_number < first_block + no_blocks; block_number++) {
 
-		/* Update blockcache list and get data into one of the blockcache elements */
-		blockcache_index = elf_cache_update_blockcache_list(block_number, filfd, binary_header_size);
-		if (blockcache_index >= number_blocks_caching) {
-			buffer_pos = ERROR;
-			goto error_cache_read;
+	/* Copy the requested part of each block from first_block to last_block */
+	for (block_number = first_block; block_number <= last_block; block_number++) {
+		entry = elf_cache_get_block(block_number, filfd, binary_header_size);
+		if (entry == NULL) {
+			return ERROR;
 		}
 
-		if (block_number == first_block) {
-			/*
-			 * Read appropriate number of bytes to buffer from this block using readsize and offset info.
-			 * If start_offset + readsize < end_offset, write from start_offset to start_offset + readsize.
-			 * Otherwise, write from start_offset to end_offset into buffer.
-			 */
-			block_size_to_write = (((block_number + 1) * blocksize - 1) > (actual_offset + readsize - 1)) ? readsize : ((block_number + 1) * blocksize - actual_offset);
-			memcpy(&buffer[buffer_pos], &blockcache[blockcache_index].out_buffer[actual_offset - (block_number * blocksize)], block_size_to_write);
-			buffer_pos += block_size_to_write;
-		} else if (block_number == last_block) {
-			/*
-			 * Read appropriate number of bytes to buffer from this block using readsize and offset info.
-			 * Calculate end_offset (Offset of last byte to write from this block).
-			 * Write from start_offset to end_offset from this block into buffer.
-			 */
-			block_size_to_write = actual_offset + readsize - (block_number * blocksize);
-			memcpy(&buffer[buffer_pos], &blockcache[blockcache_index].out_buffer[0], block_size_to_write);
-			buffer_pos += block_size_to_write;
-		} else {
-			/*
-			 * This is not the first or last block. This is intermediary block.
-			 * So, write entire block into buffer.
-			 */
-			block_size_to_write = blocksize;
-			memcpy(&buffer[buffer_pos], &blockcache[blockcache_index].out_buffer[0], block_size_to_write);
-			buffer_pos += block_size_to_write;
+		block_start = (block_number == first_block) ? offset - block_number * blocksize : 0;
+		block_end = (block_number == last_block) ? offset + readsize - block_number * blocksize : blocksize;
+		memcpy(&buffer[buffer_pos], &entry->out_buffer[block_start], block_end - block_start);
+		buffer_pos += block_end - block_start;
+
+		if (ra_pending) {
+			ra_pending = false;
+			elf_cache_readahead(filfd, binary_header_size);
 		}
 	}
 
-error_cache_read:
 	return buffer_pos;
 }
 
@@ -438,7 +610,8 @@ error_cache_read:
  ****************************************************************************/
 int elf_cache_init(int filfd, uint16_t offset, off_t filelen)
 {
-	int ret = OK;
+	unsigned int nbuckets;
+	int i;
 
 	binfo("filfd: %d offset: %u filelen: %d\n", filfd, offset, filelen);
 
@@ -464,42 +637,63 @@ int elf_cache_init(int filfd, uint16_t offset, off_t filelen)
 		number_blocks_caching = 2;
 	}
 
-	/* Initialize max_accesed_count to 0 */
-	max_accessed_count = 0;
-
-	blockcache = (block_cache_t *)kmm_malloc(number_blocks_caching * sizeof(block_cache_t));
-	if (!blockcache) {
+	/* 2Q sizes: a quarter of the blocks for A1in, ghosts for half of them */
+	a1in_max = number_blocks_caching / 4 > 0 ? number_blocks_caching / 4 : 1;
+	a1out_max = number_blocks_caching / 2 > 0 ? number_blocks_caching / 2 : 1;
+	number_entries = number_blocks_caching + a1out_max + 1;
+
+	for (nbuckets = 1; nbuckets < number_entries; nbuckets <<= 1);
+	hash_mask = nbuckets - 1;
+
+	memset(lists, 0, sizeof(lists));
+	memset(&cache_stats, 0, sizeof(cache_stats));
+	number_free_buffers = 0;
+	ra_size = 0;
+	ra_next = -1;
+	ra_marker = -1;
+	ra_pending = false;
+
+	blockcache = (block_cache_t *)kmm_zalloc(number_entries * sizeof(block_cache_t));
+	blockhash = (block_cache_t **)kmm_zalloc(nbuckets * sizeof(block_cache_t *));
+	free_buffers = (unsigned char **)kmm_zalloc(number_blocks_caching * sizeof(unsigned char *));
+	if (!blockcache || !blockhash || !free_buffers) {
 		berr("Failed kmm_malloc for blockcache\n");
 		elf_cache_uninit();
 		return -ENOMEM;
 	}
 
-	/* Initialize blockcache list */
-	for (int i = 0; i < number_blocks_caching; i++) {
-		blockcache[i].out_buffer = (unsigned char *)kmm_malloc(cache_blocks_size);
+	/* All entries start on the free list, all buffers unattached */
+	for (i = 0; i < number_entries; i++) {
+		blockcache[i].block_number = -1;
+		elf_cache_list_insert(&blockcache[i], ELF_CACHE_FREE);
+	}
 
-		if (!blockcache[i].out_buffer) {
+	for (i = 0; i < number_blocks_caching; i++) {
+		free_buffers[i] = (unsigned char *)kmm_malloc(cache_blocks_size);
+		if (!free_buffers[i]) {
 			berr("Failed kmm_malloc for blockcache's out_buffer\n");
 			elf_cache_uninit();
 			return -ENOMEM;
 		}
 
-		blockcache[i].block_number = -1;
-		blockcache[i].no_requests_for_block = 0;
-		blockcache[i].index_block_cache = i;
-		blockcache[i].next = &blockcache[(i + 1) % number_blocks_caching];
-		blockcache[i].prev = &blockcache[(i - 1) % number_blocks_caching];
+		number_free_buffers++;
 	}
 
-	/* Assign head, tail and most_accessed pointers */
-	head = &blockcache[0];
-	tail = &blockcache[number_blocks_caching - 1];
-	most_accessed = tail;
-
-	head->prev = NULL;
-	tail->next = NULL;
+	return OK;
+}
 
-	return ret;
+/****************************************************************************
+ * Name: elf_cache_get_stats
+ *
+ * Description:
+ *   Return the hit and miss counters of the cache since elf_cache_init
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+void elf_cache_get_stats(FAR struct binfmt_cache_stats_s *stats)
+{
+	*stats = cache_stats;
 }
 
 /****************************************************************************
@@ -513,15 +707,32 @@ int elf_cache_init(int filfd, uint16_t offset, off_t filelen)
  ****************************************************************************/
 void elf_cache_uninit(void)
 {
-	for (int i = 0; i < number_blocks_caching; i++) {
-		if (blockcache[i].out_buffer) {
-			kmm_free(blockcache[i].out_buffer);
-			blockcache[i].out_buffer = NULL;
-		}
-	}
+	int i;
 
 	if (blockcache) {
+		for (i = 0; i < number_entries; i++) {
+			if (blockcache[i].out_buffer) {
+				kmm_free(blockcache[i].out_buffer);
+			}
+		}
+
 		kmm_free(blockcache);
 		blockcache = NULL;
 	}
+
+	if (free_buffers) {
+		for (i = 0; i < number_free_buffers; i++) {
+			kmm_free(free_buffers[i]);
+		}
+
+		kmm_free(free_buffers);
+		free_buffers = NULL;
+	}
+
+	number_free_buffers = 0;
+
+	if (blockhash) {
+		kmm_free(blockhash);
+		blockhash = NULL;
+	}
 }
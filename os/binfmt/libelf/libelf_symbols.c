@@ -60,9 +60,12 @@
 #include <string.h>
 #include <errno.h>
 #include <debug.h>
-#ifdef CONFIG_SUPPORT_COMMON_BINARY
+#if defined(CONFIG_SUPPORT_COMMON_BINARY) || defined(CONFIG_ELF_SYMBOL_HASH)
 #include <tinyara/hashmap.h>
 #endif
+#ifdef CONFIG_ELF_SYMBOL_HASH
+#include <semaphore.h>
+#endif
 
 #include <tinyara/binfmt/elf.h>
 #include <tinyara/binfmt/symtab.h>
@@ -78,10 +81,124 @@
  * Private Constant Data
  ****************************************************************************/
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_ELF_SYMBOL_HASH
+/* Hash index of the export table used by the last binary, kept for the next
+ * binaries bound against the same table.
+ */
+
+static struct hashmap_s *g_export_hash;
+static FAR const struct symtab_s *g_export_table;
+static int g_export_count;
+static sem_t g_export_sem = SEM_INITIALIZER(1);
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_ELF_SYMBOL_HASH
+/****************************************************************************
+ * Name: elf_hashexports
+ *
+ * Description:
+ *   Make g_export_hash the index of 'exports', by hash of the symbol names.
+ *   Nothing is done if it already is.  The caller holds g_export_sem.
+ *
+ * Returned Value:
+ *   0 (OK) is returned on success and a negated errno is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+static int elf_hashexports(FAR const struct symtab_s *exports, int nexports)
+{
+	int i;
+
+	if (g_export_hash && exports == g_export_table && nexports == g_export_count) {
+		return OK;
+	}
+
+	if (g_export_hash) {
+		hashmap_delete(g_export_hash);
+		g_export_hash = NULL;
+	}
+
+	g_export_hash = hashmap_create(2 * nexports + 1);
+	if (!g_export_hash || !g_export_hash->table) {
+		berr("Failed to allocate the export hash for %d symbols\n", nexports);
+		hashmap_delete(g_export_hash);
+		g_export_hash = NULL;
+		return -ENOMEM;
+	}
+
+	/* Insert backwards so that, as with a linear search, the first of
+	 * symbols of the same name is found.
+	 */
+
+	for (i = nexports - 1; i >= 0; i--) {
+		hashmap_insert(g_export_hash, &exports[i], hashmap_get_hashval((unsigned char *)exports[i].sym_name));
+	}
+
+	g_export_table = exports;
+	g_export_count = nexports;
+	return OK;
+}
+#endif
+
+#ifndef CONFIG_SUPPORT_COMMON_BINARY
+/****************************************************************************
+ * Name: elf_findexport
+ *
+ * Description:
+ *   Find the exported symbol 'name'.  With CONFIG_ELF_SYMBOL_HASH, the
+ *   symbol is looked up in a hash index of the export table, built on the
+ *   first lookup and reused until another table is used.  The table is
+ *   searched directly if the index can not be built or if the name of the
+ *   symbol found does not match, i.e. when two names have the same hash.
+ *
+ * Returned Value:
+ *   A reference to the symbol table entry if an entry with the matching
+ *   name is found; NULL is returned if the entry is not found.
+ *
+ ****************************************************************************/
+
+static FAR const struct symtab_s *elf_findexport(FAR const char *name, FAR const struct symtab_s *exports, int nexports)
+{
+#ifdef CONFIG_ELF_SYMBOL_HASH
+	FAR const struct symtab_s *symbol = NULL;
+	bool hashed = false;
+
+	if (!exports || nexports <= 0) {
+		return NULL;
+	}
+
+	while (sem_wait(&g_export_sem) < 0) {
+	}
+
+	if (elf_hashexports(exports, nexports) == OK) {
+		symbol = (FAR const struct symtab_s *)hashmap_get(g_export_hash, hashmap_get_hashval((unsigned char *)name));
+		hashed = true;
+	}
+
+	sem_post(&g_export_sem);
+
+	if (hashed && (!symbol || strcmp(symbol->sym_name, name) == 0)) {
+		return symbol;
+	}
+#endif
+
+#ifdef CONFIG_SYMTAB_ORDEREDBYNAME
+	return symtab_findorderedbyname(exports, name, nexports);
+#else
+	return symtab_findbyname(exports, name, nexports);
+#endif
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -342,11 +459,7 @@ int elf_symvalue(FAR struct elf_loadinfo_s *loadinfo, FAR Elf32_Sym *sym, FAR co
 
 #else
 
-#ifdef CONFIG_SYMTAB_ORDEREDBYNAME
-		symbol = symtab_findorderedbyname(exports, (FAR char *)loadinfo->iobuffer, nexports);
-#else
-		symbol = symtab_findbyname(exports, (FAR char *)loadinfo->iobuffer, nexports);
-#endif
+		symbol = elf_findexport((FAR const char *)loadinfo->iobuffer, exports, nexports);
 		if (!symbol) {
 			berr("SHN_UNDEF: Exported symbol \"%s\" not found\n", loadinfo->iobuffer);
 			return -ENOENT;
@@ -147,10 +147,20 @@ static int type_specific_initialize(int minor, FAR struct mtd_dev_s *mtd_part, c
 
 #ifdef CONFIG_MTD_FTL
 	bool do_ftlinit = false;
+#ifdef CONFIG_FTL_LOG
+	bool do_ftllog = false;
+#endif
 	if (!strncmp(types, "ftl,", 4)) {
 		tagno = MTD_FTL;
 		do_ftlinit = true;
 	}
+#ifdef CONFIG_FTL_LOG
+	else if (!strncmp(types, "ftllog,", 7)) {
+		tagno = MTD_FTL;
+		do_ftlinit = true;
+		do_ftllog = true;
+	}
+#endif
 #ifdef CONFIG_BINARY_MANAGER
 	else if (!strncmp(types, "kernel,", 7)
 	|| !strncmp(types, "bootparam,", 10)
@@ -213,6 +223,14 @@ static int type_specific_initialize(int minor, FAR struct mtd_dev_s *mtd_part, c
 
 #ifdef CONFIG_MTD_FTL
 	if (do_ftlinit) {
+#ifdef CONFIG_FTL_LOG
+		if (do_ftllog) {
+			if (ftl_log_initialize(g_partno, mtd_part)) {
+				printf("ERROR: failed to initialise mtd ftl errno :%d\n", errno);
+				return ERROR;
+			}
+		} else
+#endif
 			/* External flash can be NOR or NAND */
 #ifdef CONFIG_MTD_NAND
 		if (minor > 0) {
@@ -27,6 +27,18 @@
 #include <string.h>
 #include <debug.h>
 #include <errno.h>
+#ifdef CONFIG_COMPRESSION_PIPELINE
+#include <sched.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#endif
+
+#include <tinyara/clock.h>
+#ifdef CONFIG_COMPRESSION_PIPELINE
+#include <tinyara/irq.h>
+#include <tinyara/kthread.h>
+#include <tinyara/semaphore.h>
+#endif
 
 #include <tinyara/fs/fs.h>
 #include <tinyara/binfmt/compression/compress_read.h>
@@ -37,14 +49,80 @@
 #include <miniz/miniz.h>
 #endif
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* One slot for the block being read and one for each worker */
+
+#define COMPRESS_PIPELINE_NSLOTS (CONFIG_COMPRESSION_PIPELINE_WORKERS + 1)
+
 /****************************************************************************
  * Private Declarations
  ****************************************************************************/
 
+/* One decompressed block kept in the block cache */
+
+struct compress_cache_s {
+	int filfd;					/* File the block belongs to */
+	int block;					/* Block number, -1 if the entry is unused */
+	int size;					/* Number of decompressed bytes in data */
+	uint32_t stamp;				/* Last use, for LRU replacement */
+	FAR uint8_t *data;			/* Decompressed data, in buffers.out_buffer */
+};
+
 static struct s_header *compression_header;
 static struct s_buffer buffers;
 static int active_filefd = -1;
 
+/* Offset of each compressed block from the end of the binary header, and
+ * the size of the largest compressed block read_buffer can hold.
+ */
+
+static FAR off_t *block_offsets;
+static int read_buffer_size;
+
+static struct compress_cache_s block_cache[CONFIG_COMPRESSION_CACHE_BLOCKS];
+static uint32_t cache_stamp;
+
+/* Timing of the blocks read since compress_init() */
+
+static struct compress_stats_s compress_stats;
+
+#ifdef CONFIG_COMPRESSION_PIPELINE
+/* A compressed block on its way through the pipeline */
+
+struct compress_slot_s {
+	FAR uint8_t *src;			/* Compressed block, read_buffer_size bytes */
+	FAR uint8_t *dst;			/* Where to decompress the block */
+	int block;					/* Block number */
+	int size;					/* Size of the compressed block */
+};
+
+/* Pipeline state.  'free' is a stack of the slots the reader may fill,
+ * 'queue' a ring of the slots waiting for a worker.
+ */
+
+struct compress_pipeline_s {
+	bool started;
+	bool failed;				/* Start failed, read block by block until uninit */
+	int nworkers;
+	int result;					/* First error of the current read */
+	int nfree;
+	int qhead;
+	int qtail;
+	int free[COMPRESS_PIPELINE_NSLOTS];
+	int queue[COMPRESS_PIPELINE_NSLOTS];
+	struct compress_slot_s slot[COMPRESS_PIPELINE_NSLOTS];
+	sem_t slots;				/* Counts free slots */
+	sem_t ready;				/* Counts queued slots */
+	sem_t done;					/* Counts decompressed slots */
+	sem_t stopped;				/* Counts stopped workers */
+};
+
+static struct compress_pipeline_s pipeline;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -116,6 +194,8 @@ static int compress_parse_header(int filfd, uint16_t offset)
 	nbytes = read(filfd, ((uint8_t *)compression_header + sizeof(compression_header->size_header)), compheader_size - sizeof(compression_header->size_header));
 	if (nbytes != (compheader_size - sizeof(compression_header->size_header))) {
 		bcmpdbg("Read for compression header from offset %lu failed\n", offset);
+		kmm_free(compression_header);
+		compression_header = NULL;
 		return ERROR;
 	}
 
@@ -125,48 +205,81 @@ static int compress_parse_header(int filfd, uint16_t offset)
 }
 
 /****************************************************************************
- * Name: compress_offset_block
+ * Name: compress_init_offsets
  *
  * Description:
- *   Returns offset of 'block_number' block by reading it from compression header
+ *   Build the table of compressed block offsets from the section offsets of
+ *   the compression header, checking once that every block fits in
+ *   read_buffer, so that reading a block is a single seek and read.
  *
- * Returned Value:
- *   'block_offset' value (positive) on Success
+ * Returned value:
+ *   OK (0) on Success
  *   Negative value on Failure
  ****************************************************************************/
-static off_t compress_offset_block(int filfd, uint16_t binary_header_size, int block_number)
+static int compress_init_offsets(void)
 {
-	off_t position;
+	int nblocks;
+	int index;
+	int size;
+
+	/* The last section offset is the end of the last block */
+	nblocks = compression_header->sections - 1;
+	if (nblocks < 0 || compression_header->blocksize <= 0 ||
+		compression_header->size_header < (int)(sizeof(struct s_header) + compression_header->sections * sizeof(int))) {
+		bcmpdbg("Invalid compression header, %d sections\n", compression_header->sections);
+		return -EINVAL;
+	}
+
+	block_offsets = (FAR off_t *)kmm_malloc((nblocks + 1) * sizeof(off_t));
+	if (block_offsets == NULL) {
+		bcmpdbg("Failed kmm_malloc for block offsets\n");
+		return -ENOMEM;
+	}
 
-	/* Return position for 'block_number' block */
-	position = binary_header_size + compression_header->size_header + compression_header->secoff[block_number];
+	for (index = 0; index <= nblocks; index++) {
+		block_offsets[index] = compression_header->size_header + compression_header->secoff[index];
+		if (index == 0) {
+			continue;
+		}
+
+		size = block_offsets[index] - block_offsets[index - 1];
+		if (size < 0 || size > read_buffer_size) {
+			bcmpdbg("Incorrect size %d for block %d\n", size, index - 1);
+			kmm_free(block_offsets);
+			block_offsets = NULL;
+			return -EINVAL;
+		}
+	}
 
-	return position;
+	return OK;
 }
 
 /****************************************************************************
- * Name: compress_lseek_block
+ * Name: compress_read_block
  *
  * Description:
- *   Seek to start of "block_number" block in compressed blocks section
+ *   Read 'block_number' block from compressed blocks section into read_buffer
  *
  * Returned Value:
- *   Starting offset (positive) of 'block_number' block in binary on Success
+ *   Number of bytes read into read_buffer on Success
  *   Negative value on Failure
  ****************************************************************************/
-static off_t compress_lseek_block(int filfd, uint16_t binary_header_size, int block_number)
+static off_t compress_read_block(int filfd, uint16_t binary_header_size, FAR uint8_t *buf, int block_number)
 {
 	off_t rpos;
 	off_t block_offset;
+	off_t readsize;
+	ssize_t nbytes;
 
-	/* Calculate block offset from start of file for start of 'block_number' block */
-	block_offset = compress_offset_block(filfd, binary_header_size, block_number);
-	if (block_offset < 0) {
-		bcmpdbg("Incorrect offset for block number %d\n", block_number);
-		return block_offset;
+	if (block_number < 0 || block_number >= compression_header->sections - 1) {
+		bcmpdbg("Incorrect block number %d\n", block_number);
+		return -EINVAL;
 	}
 
-	/* Seek to location of this block in compressed file */
+	block_offset = binary_header_size + block_offsets[block_number];
+	readsize = block_offsets[block_number + 1] - block_offsets[block_number];
+
+	/* Seek to location of 'block_number' block in compressed file */
 	rpos = lseek(filfd, block_offset, SEEK_SET);
 	if (rpos != block_offset) {
 		int errval = get_errno();
@@ -174,62 +287,412 @@ static off_t compress_lseek_block(int filfd, uint16_t binary_header_size, int bl
 		return -errval;
 	}
 
-	return rpos;
+	/* Read 'block_number' block into buf */
+	nbytes = read(filfd, buf, readsize);
+	if (nbytes != readsize) {
+		bcmpdbg("Read for compressed block %d failed\n", block_number);
+		return ERROR;
+	}
+
+	return nbytes;
 }
 
 /****************************************************************************
- * Name: compress_read_block
+ * Name: compress_cache_reset
  *
  * Description:
- *   Read 'block_number' block from compressed blocks section into read_buffer
+ *   Drop every block from the block cache and give each entry its part of
+ *   'data', which holds CONFIG_COMPRESSION_CACHE_BLOCKS blocks.
  *
  * Returned Value:
- *   Number of bytes read into read_buffer on Success
+ *   None
+ ****************************************************************************/
+static void compress_cache_reset(FAR uint8_t *data, int blocksize)
+{
+	int index;
+
+	for (index = 0; index < CONFIG_COMPRESSION_CACHE_BLOCKS; index++) {
+		block_cache[index].filfd = -1;
+		block_cache[index].block = -1;
+		block_cache[index].size = 0;
+		block_cache[index].stamp = 0;
+		block_cache[index].data = data ? data + index * blocksize : NULL;
+	}
+
+	cache_stamp = 0;
+}
+
+/****************************************************************************
+ * Name: compress_get_block
+ *
+ * Description:
+ *   Return the cache entry holding decompressed block 'block_number' of the
+ *   file.  On a miss, the least recently used entry is replaced by the
+ *   block read and decompressed from the file.
+ *
+ * Returned Value:
+ *   Cache entry on Success
+ *   NULL on Failure, with the negative error value in '*errcode'
+ ****************************************************************************/
+static FAR struct compress_cache_s *compress_get_block(int filfd, uint16_t binary_header_size, int block_number, FAR int *errcode)
+{
+	FAR struct compress_cache_s *entry;
+	FAR struct compress_cache_s *victim = &block_cache[0];
+	off_t block_readsize;
+	clock_t start;
+	int index;
+	int ret;
+#if CONFIG_COMPRESSION_TYPE == LZMA
+	unsigned int writesize;
+	unsigned int size;
+#elif CONFIG_COMPRESSION_TYPE == MINIZ
+	long unsigned int writesize;
+	long unsigned int size;
+#endif
+
+	for (index = 0; index < CONFIG_COMPRESSION_CACHE_BLOCKS; index++) {
+		entry = &block_cache[index];
+		if (entry->block == block_number && entry->filfd == filfd) {
+			entry->stamp = ++cache_stamp;
+			compress_stats.nhits++;
+			return entry;
+		}
+
+		/* Prefer an unused entry, then the least recently used one */
+		if (victim->block >= 0 && (entry->block < 0 || entry->stamp < victim->stamp)) {
+			victim = entry;
+		}
+	}
+
+	/* Read compressed 'block_number' block into read_buffer */
+	start = clock_systimer();
+	block_readsize = compress_read_block(filfd, binary_header_size, buffers.read_buffer, block_number);
+	compress_stats.read_ticks += clock_systimer() - start;
+	if (block_readsize < 0) {
+		bcmpdbg("Read for compressed block %d failed\n", block_number);
+		*errcode = block_readsize;
+		return NULL;
+	}
+
+	/* Decompress block in read_buffer into the victim entry */
+	victim->block = -1;
+	size = block_readsize;
+	writesize = compression_header->blocksize;
+	start = clock_systimer();
+	ret = decompress_block(victim->data, &writesize, buffers.read_buffer, &size);
+	compress_stats.decompress_ticks += clock_systimer() - start;
+	compress_stats.nblocks++;
+	if (ret == ERROR) {
+		bcmpdbg("Failed to decompress %d block of this binary\n", block_number);
+		*errcode = ret;
+		return NULL;
+	}
+
+	victim->filfd = filfd;
+	victim->block = block_number;
+	victim->size = writesize;
+	victim->stamp = ++cache_stamp;
+
+	return victim;
+}
+
+#ifdef CONFIG_COMPRESSION_PIPELINE
+/****************************************************************************
+ * Name: compress_pipeline_wait
+ *
+ * Description:
+ *   Wait on a pipeline semaphore, ignoring signals, and return the number of
+ *   ticks spent waiting.
+ ****************************************************************************/
+static clock_t compress_pipeline_wait(FAR sem_t *sem)
+{
+	clock_t start = clock_systimer();
+
+	while (sem_wait(sem) < 0) {
+		DEBUGASSERT(get_errno() == EINTR);
+	}
+
+	return clock_systimer() - start;
+}
+
+/****************************************************************************
+ * Name: compress_pipeline_worker
+ *
+ * Description:
+ *   Decompress worker thread.  Takes the slots filled by the reader, in the
+ *   order they were queued, and decompresses each one straight into its
+ *   place in the destination buffer.  A negative slot number stops the
+ *   worker.
+ ****************************************************************************/
+static int compress_pipeline_worker(int argc, char *argv[])
+{
+	FAR struct compress_slot_s *slot;
+	irqstate_t flags;
+	clock_t start;
+	int index;
+	int ret;
+#if CONFIG_COMPRESSION_TYPE == LZMA
+	unsigned int writesize;
+	unsigned int size;
+#elif CONFIG_COMPRESSION_TYPE == MINIZ
+	long unsigned int writesize;
+	long unsigned int size;
+#endif
+
+	for (;;) {
+		compress_pipeline_wait(&pipeline.ready);
+
+		flags = enter_critical_section();
+		index = pipeline.queue[pipeline.qtail];
+		pipeline.qtail = (pipeline.qtail + 1) % COMPRESS_PIPELINE_NSLOTS;
+		leave_critical_section(flags);
+
+		if (index < 0) {
+			break;
+		}
+
+		slot = &pipeline.slot[index];
+		start = clock_systimer();
+		size = slot->size;
+		writesize = compression_header->blocksize;
+		ret = decompress_block(slot->dst, &writesize, slot->src, &size);
+		if (ret >= 0 && writesize != compression_header->blocksize) {
+			bcmpdbg("Block %d decompressed to %d bytes instead of %d\n", slot->block, (int)writesize, compression_header->blocksize);
+			ret = -EIO;
+		}
+
+		/* Give the slot back to the reader */
+
+		flags = enter_critical_section();
+		compress_stats.decompress_ticks += clock_systimer() - start;
+		compress_stats.nblocks++;
+		if (ret < 0 && pipeline.result == OK) {
+			bcmpdbg("Failed to decompress %d block of this binary\n", slot->block);
+			pipeline.result = ret;
+		}
+		pipeline.free[pipeline.nfree++] = index;
+		leave_critical_section(flags);
+
+		sem_post(&pipeline.slots);
+		sem_post(&pipeline.done);
+	}
+
+	sem_post(&pipeline.stopped);
+	return OK;
+}
+
+/****************************************************************************
+ * Name: compress_pipeline_start
+ *
+ * Description:
+ *   Allocate the slots and start the decompress workers, at the priority of
+ *   the calling loader.
+ *
+ * Returned value:
+ *   OK (0) on Success
  *   Negative value on Failure
  ****************************************************************************/
-static off_t compress_read_block(int filfd, uint16_t binary_header_size, FAR uint8_t *buf, int block_number)
+static int compress_pipeline_start(void)
 {
-	off_t rpos;
-	off_t readsize;
-	ssize_t nbytes;
-	off_t current_block_offset;
-	off_t next_block_offset;
+	struct sched_param param;
+	int index;
+	int pid;
 
-	/* Find out size of 'block_number' block in compressed file. Assign to readsize */
-	next_block_offset = compress_offset_block(filfd, binary_header_size, block_number + 1);
-	if (next_block_offset < 0) {
-		bcmpdbg("Incorrect offset for block number %d\n", block_number + 1);
-		return ERROR;
+	memset(&pipeline, 0, sizeof(pipeline));
+
+	for (index = 0; index < COMPRESS_PIPELINE_NSLOTS; index++) {
+		pipeline.slot[index].src = (FAR uint8_t *)kmm_malloc(read_buffer_size);
+		if (pipeline.slot[index].src == NULL) {
+			bcmpdbg("Failed kmm_malloc for pipeline slot %d\n", index);
+			goto errout_with_slots;
+		}
+
+		pipeline.free[pipeline.nfree++] = index;
 	}
 
-	current_block_offset = compress_offset_block(filfd, binary_header_size, block_number);
-	if (current_block_offset < 0) {
-		bcmpdbg("Incorrect offset for block number %d\n", block_number);
-		return ERROR;
+	sem_init(&pipeline.slots, 0, COMPRESS_PIPELINE_NSLOTS);
+	sem_init(&pipeline.ready, 0, 0);
+	sem_init(&pipeline.done, 0, 0);
+	sem_init(&pipeline.stopped, 0, 0);
+	sem_setprotocol(&pipeline.slots, SEM_PRIO_NONE);
+	sem_setprotocol(&pipeline.ready, SEM_PRIO_NONE);
+	sem_setprotocol(&pipeline.done, SEM_PRIO_NONE);
+	sem_setprotocol(&pipeline.stopped, SEM_PRIO_NONE);
+
+	sched_getparam(0, &param);
+
+	for (index = 0; index < CONFIG_COMPRESSION_PIPELINE_WORKERS; index++) {
+		pid = kernel_thread("decompress", param.sched_priority, CONFIG_COMPRESSION_PIPELINE_STACKSIZE, compress_pipeline_worker, (FAR char *const *)NULL);
+		if (pid < 0) {
+			bcmpdbg("Failed to start decompress worker %d: %d\n", index, get_errno());
+			break;
+		}
+
+		pipeline.nworkers++;
 	}
 
-	readsize = next_block_offset - current_block_offset;
-	if (readsize < 0) {
-		bcmpdbg("Incorrect readsize %d for block, has to be positive\n", readsize);
-		return readsize;
+	if (pipeline.nworkers == 0) {
+		sem_destroy(&pipeline.slots);
+		sem_destroy(&pipeline.ready);
+		sem_destroy(&pipeline.done);
+		sem_destroy(&pipeline.stopped);
+		goto errout_with_slots;
 	}
 
-	/* Seek to location of 'block_number' block in compressed file */
-	rpos = compress_lseek_block(filfd, binary_header_size, block_number);
-	if (rpos < 0) {
-		bcmpdbg("Failed to seek to offset of block number %d\n", block_number);
-		return rpos;
+	pipeline.started = true;
+	return OK;
+
+errout_with_slots:
+	for (index = 0; index < COMPRESS_PIPELINE_NSLOTS; index++) {
+		if (pipeline.slot[index].src) {
+			kmm_free(pipeline.slot[index].src);
+			pipeline.slot[index].src = NULL;
+		}
 	}
 
-	/* Read 'block_number' block into buf */
-	nbytes = read(filfd, buf, readsize);
-	if (nbytes != readsize) {
-		bcmpdbg("Read for compressed block %d failed\n", block_number);
-		return ERROR;
+	pipeline.failed = true;
+	return -ENOMEM;
+}
+
+/****************************************************************************
+ * Name: compress_pipeline_stop
+ *
+ * Description:
+ *   Stop the decompress workers and release the slots, and let the next
+ *   file try to start the pipeline again.
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+static void compress_pipeline_stop(void)
+{
+	irqstate_t flags;
+	int index;
+
+	pipeline.failed = false;
+	if (!pipeline.started) {
+		return;
 	}
 
-	return nbytes;
+	for (index = 0; index < pipeline.nworkers; index++) {
+		flags = enter_critical_section();
+		pipeline.queue[pipeline.qhead] = -1;
+		pipeline.qhead = (pipeline.qhead + 1) % COMPRESS_PIPELINE_NSLOTS;
+		leave_critical_section(flags);
+
+		sem_post(&pipeline.ready);
+		compress_pipeline_wait(&pipeline.stopped);
+	}
+
+	sem_destroy(&pipeline.slots);
+	sem_destroy(&pipeline.ready);
+	sem_destroy(&pipeline.done);
+	sem_destroy(&pipeline.stopped);
+
+	for (index = 0; index < COMPRESS_PIPELINE_NSLOTS; index++) {
+		kmm_free(pipeline.slot[index].src);
+		pipeline.slot[index].src = NULL;
+	}
+
+	pipeline.started = false;
+}
+
+/****************************************************************************
+ * Name: compress_pipeline_read
+ *
+ * Description:
+ *   Read 'no_blocks' whole blocks from 'first_block' on and decompress them
+ *   into 'buffer'.  The calling thread reads the compressed blocks into
+ *   free slots while the workers decompress the slots already read, so the
+ *   file reads overlap decompression and, with several workers, blocks are
+ *   decompressed concurrently.
+ *
+ * Returned Value:
+ *   Number of bytes decompressed into buffer on Success
+ *   Negative value on Failure
+ ****************************************************************************/
+static int compress_pipeline_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, int first_block, int no_blocks)
+{
+	FAR struct compress_slot_s *slot;
+	irqstate_t flags;
+	clock_t start;
+	off_t nbytes;
+	int ndispatched;
+	int index;
+	int ret;
+
+	if (pipeline.failed) {
+		return -ENOMEM;
+	}
+
+	if (!pipeline.started) {
+		ret = compress_pipeline_start();
+		if (ret != OK) {
+			return ret;
+		}
+	}
+
+	pipeline.result = OK;
+
+	for (ndispatched = 0; ndispatched < no_blocks; ndispatched++) {
+		/* Get a free slot and read the next compressed block into it */
+
+		compress_stats.wait_ticks += compress_pipeline_wait(&pipeline.slots);
+
+		flags = enter_critical_section();
+		index = pipeline.free[--pipeline.nfree];
+		ret = pipeline.result;
+		leave_critical_section(flags);
+
+		slot = &pipeline.slot[index];
+		if (ret == OK) {
+			start = clock_systimer();
+			nbytes = compress_read_block(filfd, binary_header_size, slot->src, first_block + ndispatched);
+			compress_stats.read_ticks += clock_systimer() - start;
+			ret = nbytes < 0 ? nbytes : OK;
+		}
+
+		if (ret != OK) {
+			/* A read or an earlier decompression failed, stop here */
+
+			flags = enter_critical_section();
+			pipeline.free[pipeline.nfree++] = index;
+			if (pipeline.result == OK) {
+				pipeline.result = ret;
+			}
+			leave_critical_section(flags);
+
+			sem_post(&pipeline.slots);
+			break;
+		}
+
+		slot->block = first_block + ndispatched;
+		slot->size = nbytes;
+		slot->dst = buffer + ndispatched * compression_header->blocksize;
+
+		/* Hand it over to the workers */
+
+		flags = enter_critical_section();
+		pipeline.queue[pipeline.qhead] = index;
+		pipeline.qhead = (pipeline.qhead + 1) % COMPRESS_PIPELINE_NSLOTS;
+		leave_critical_section(flags);
+
+		sem_post(&pipeline.ready);
+	}
+
+	/* Wait until the workers are done with every block handed over */
+
+	while (ndispatched-- > 0) {
+		compress_stats.wait_ticks += compress_pipeline_wait(&pipeline.done);
+	}
+
+	if (pipeline.result != OK) {
+		return pipeline.result;
+	}
+
+	return no_blocks * compression_header->blocksize;
 }
+#endif /* CONFIG_COMPRESSION_PIPELINE */
 
 /****************************************************************************
  * Name: compress_read
@@ -246,22 +709,19 @@ static off_t compress_read_block(int filfd, uint16_t binary_header_size, FAR uin
  ****************************************************************************/
 int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, size_t readsize, off_t offset)
 {
+	FAR struct compress_cache_s *entry;
 	int first_block;
 	int last_block;
 	int no_blocks;
 	int index;
 	int ret;
-	int actual_offset;			/* Offset from start of uncompressed file */
-	int block_size_to_write;	/* Size to write into buffer from decompressed block */
+	int block_start;			/* Offset of the first byte to copy from the block */
+	int block_end;				/* Offset past the last byte to copy from the block */
 	int buffer_index;
 	int blocksize;
-	int block_readsize;
-#if CONFIG_COMPRESSION_TYPE == LZMA
-	unsigned int writesize;
-	unsigned int size;
-#elif CONFIG_COMPRESSION_TYPE == MINIZ
-	long unsigned int writesize;
-	long unsigned int size;
+#ifdef CONFIG_COMPRESSION_PIPELINE
+	int pipe_first;				/* First block for the pipeline */
+	int pipe_last;				/* Last block for the pipeline */
 #endif
 
 	/* Setting first block, end block and number of blocks to read and decompressed */
@@ -269,69 +729,59 @@ int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, s
 	compress_blocks_to_read(&first_block, &last_block, &no_blocks, offset, readsize);
 	if (first_block < 0 || no_blocks < 0) {
 		bcmpdbg("Incorrect first_block, no_blocks info\n");
-		buffer_index = ERROR;
-		goto error_compress_read;
+		return ERROR;
 	}
 
-	index = first_block;
 	buffer_index = 0;
-	/* Actual Offset in uncompressed file is same as Offset passed to this function */
-	actual_offset = offset;
-
-	/* Reading and decompressing blocks from first_block to last_block. Then writing to buffer. */
-	for (; index < first_block + no_blocks; index++) {
-		/* Read compressed 'index' block into read_buffer */
-		block_readsize = compress_read_block(filfd, binary_header_size, buffers.read_buffer, index);
-		if (block_readsize < 0) {
-			bcmpdbg("Read for compressed block %d failed\n", index);
-			buffer_index = block_readsize;
-			goto error_compress_read;
-		}
 
-#if CONFIG_COMPRESSION_TYPE == LZMA
-		size = (unsigned int)block_readsize;
-#elif CONFIG_COMPRESSION_TYPE == MINIZ
-		size = (long unsigned int)block_readsize;
+#ifdef CONFIG_COMPRESSION_PIPELINE
+	/* Blocks wholly covered by the request are decompressed straight into
+	 * buffer by the pipeline, if there are enough of them to overlap.
+	 */
+	pipe_first = (offset + blocksize - 1) / blocksize;
+	pipe_last = (offset + readsize) / blocksize - 1;
+	if (pipe_last - pipe_first + 1 < CONFIG_COMPRESSION_PIPELINE_MINBLOCKS) {
+		pipe_first = -1;
+	}
 #endif
-		writesize = compression_header->blocksize; 
-		/* Decompress block in read_buffer to out_buffer */
-		ret = decompress_block(buffers.out_buffer, &writesize, buffers.read_buffer, &size);
-		if (ret == ERROR) {
-			bcmpdbg("Failed to decompress %d block of this binary\n", index);
-			buffer_index = ret;
-			goto error_compress_read;
+
+	/*
+	 * Get blocks from first_block to last_block, from the block cache or by
+	 * reading and decompressing them, and copy the requested bytes of each
+	 * one into buffer.  Only part of the first and last blocks may be used.
+	 */
+	for (index = first_block; index <= last_block; index++) {
+#ifdef CONFIG_COMPRESSION_PIPELINE
+		if (index == pipe_first) {
+			ret = compress_pipeline_read(filfd, binary_header_size, &buffer[buffer_index], pipe_first, pipe_last - pipe_first + 1);
+			if (ret >= 0) {
+				buffer_index += ret;
+				index = pipe_last;
+				continue;
+			} else if (ret != -ENOMEM) {
+				return ret;
+			}
+
+			/* Not enough memory for the pipeline, go block by block */
+		}
+#endif
+
+		entry = compress_get_block(filfd, binary_header_size, index, &ret);
+		if (entry == NULL) {
+			return ret;
 		}
 
-		if (index == first_block) {
-			/*
-			 * Read appropriate number of bytes to buffer from this block using readsize and offset info.
-			 * If start_offset + readsize < end_offset, write from start_offset to start_offset + readsize.
-			 * Otherwise, write from start_offset to end_offset into buffer.
-			 */
-			block_size_to_write = ((index + 1) * blocksize - 1 > actual_offset + readsize - 1 ? readsize : (index + 1) * blocksize - actual_offset);
-			memcpy(&buffer[buffer_index], &buffers.out_buffer[actual_offset - (index * blocksize)], block_size_to_write);
-			buffer_index += block_size_to_write;
-		} else if (index == last_block) {
-			/*
-			 * Read appropriate number of bytes to buffer from this block using readsize and offset info.
-			 * Calculate end_offset (Offset of last byte to write from this block).
-			 * Write from start_offset to end_offset from this block into buffer.
-			 */
-			block_size_to_write = actual_offset + readsize - (index * blocksize);
-			memcpy(&buffer[buffer_index], &buffers.out_buffer[0], block_size_to_write);
-			buffer_index += block_size_to_write;
-		} else {
-			/*
-			 * This is not the first or last block. This is intermediary block.
-			 * So, write entire block into buffer.
-			 */
-			block_size_to_write = blocksize;
-			memcpy(&buffer[buffer_index], &buffers.out_buffer[0], block_size_to_write);
-			buffer_index += block_size_to_write;
+		block_start = (index == first_block) ? offset - index * blocksize : 0;
+		block_end = (index == last_block) ? offset + readsize - index * blocksize : blocksize;
+		if (block_end > entry->size) {
+			bcmpdbg("Read beyond the %d bytes of block %d\n", entry->size, index);
+			return ERROR;
 		}
+
+		memcpy(&buffer[buffer_index], &entry->data[block_start], block_end - block_start);
+		buffer_index += block_end - block_start;
 	}
 
-error_compress_read:
 	return buffer_index;
 }
 
@@ -354,6 +804,10 @@ int compress_init(int filfd, uint16_t offset, off_t *filelen)
 		return -EBUSY;
 	}
 	active_filefd = filfd;
+
+	/* The timing is per file, even if the header turns out to be bad */
+	memset(&compress_stats, 0, sizeof(compress_stats));
+
 	/* Parsing compression header for compressed file */
 	ret = compress_parse_header(filfd, offset);
 	if (ret != OK) {
@@ -363,36 +817,65 @@ int compress_init(int filfd, uint16_t offset, off_t *filelen)
 
 	/* Assign file length as that of uncompressed file */
 	*filelen = compression_header->binary_size;
+	read_buffer_size = 0;
 
 #if CONFIG_COMPRESSION_TYPE == LZMA
 	/* Allocating memory for read and out buffer to be used for LZMA decompression */
 	if (compression_header->compression_format == COMPRESSION_TYPE_LZMA) {
-		buffers.read_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize + LZMA_PROPS_SIZE);
+		read_buffer_size = compression_header->blocksize + LZMA_PROPS_SIZE;
+		buffers.read_buffer = (unsigned char *)kmm_malloc(read_buffer_size);
 		if (buffers.read_buffer == NULL) {
-			return -ENOMEM;
+			ret = -ENOMEM;
+			goto error_compress_init;
 		}
-		buffers.out_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize);
+		buffers.out_buffer = (unsigned char *)kmm_malloc(CONFIG_COMPRESSION_CACHE_BLOCKS * compression_header->blocksize);
 		if (buffers.out_buffer == NULL) {
-			kmm_free(buffers.read_buffer);
-			return -ENOMEM;
+			ret = -ENOMEM;
+			goto error_compress_init;
 		}
 	}
 #elif CONFIG_COMPRESSION_TYPE == MINIZ
 	/* Allocating memory for read and out buffer to be used for Miniz decompression */
 	if (compression_header->compression_format == COMPRESSION_TYPE_MINIZ) {
-		buffers.read_buffer = (unsigned char *)kmm_malloc(compressBound(compression_header->blocksize));
+		read_buffer_size = compressBound(compression_header->blocksize);
+		buffers.read_buffer = (unsigned char *)kmm_malloc(read_buffer_size);
 		if (buffers.read_buffer == NULL) {
-			return -ENOMEM;
+			ret = -ENOMEM;
+			goto error_compress_init;
 		}
-		buffers.out_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize);
+		buffers.out_buffer = (unsigned char *)kmm_malloc(CONFIG_COMPRESSION_CACHE_BLOCKS * compression_header->blocksize);
 		if (buffers.out_buffer == NULL) {
-			kmm_free(buffers.read_buffer);
-			return -ENOMEM;
+			ret = -ENOMEM;
+			goto error_compress_init;
 		}
 	}
 #endif
 
+	/* Build the block offset table and start with an empty block cache */
+	ret = compress_init_offsets();
+	if (ret != OK) {
+		goto error_compress_init;
+	}
+
+	compress_cache_reset(buffers.out_buffer, compression_header->blocksize);
+	return OK;
+
 error_compress_init:
+	/* Release whatever was set up, so that another file can be loaded */
+	if (buffers.read_buffer) {
+		kmm_free(buffers.read_buffer);
+		buffers.read_buffer = NULL;
+	}
+	if (buffers.out_buffer) {
+		kmm_free(buffers.out_buffer);
+		buffers.out_buffer = NULL;
+	}
+	if (compression_header) {
+		kmm_free(compression_header);
+		compression_header = NULL;
+	}
+	read_buffer_size = 0;
+	active_filefd = -1;
 	return ret;
 }
 
@@ -407,9 +890,13 @@ error_compress_init:
  ****************************************************************************/
 void compress_uninit(void)
 {
+#ifdef CONFIG_COMPRESSION_PIPELINE
+	compress_pipeline_stop();
+#endif
+
 #if CONFIG_COMPRESSION_TYPE == LZMA || CONFIG_COMPRESSION_TYPE == MINIZ
 	/* Freeing memory allocated to read_buffer and out_buffer for file decompression */
-	if (compression_header->compression_format == COMPRESSION_TYPE_LZMA || compression_header->compression_format == COMPRESSION_TYPE_MINIZ) {
+	if (compression_header && (compression_header->compression_format == COMPRESSION_TYPE_LZMA || compression_header->compression_format == COMPRESSION_TYPE_MINIZ)) {
 		if (buffers.read_buffer) {
 			kmm_free(buffers.read_buffer);
 			buffers.read_buffer = NULL;
@@ -421,6 +908,13 @@ void compress_uninit(void)
 	}
 #endif
 
+	if (block_offsets) {
+		kmm_free(block_offsets);
+		block_offsets = NULL;
+	}
+
+	compress_cache_reset(NULL, 0);
+
 	kmm_free(compression_header);
 	compression_header = NULL;
 
@@ -431,3 +925,18 @@ struct s_header *get_compression_header(void)
 {
 	return compression_header;
 }
+
+/****************************************************************************
+ * Name: compress_get_stats
+ *
+ * Description:
+ *   Return the timing of the blocks read since the last compress_init().
+ *   It is kept after compress_uninit() so that the loader can report it,
+ *   and cleared here so that a load which reads nothing reports zeros
+ *   rather than the previous file.
+ ****************************************************************************/
+void compress_get_stats(FAR struct compress_stats_s *stats)
+{
+	*stats = compress_stats;
+	memset(&compress_stats, 0, sizeof(compress_stats));
+}
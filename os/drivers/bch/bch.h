@@ -69,21 +69,54 @@
 #define bchlib_semgive(d)	sem_post(&(d)->sem)	/* To match bchlib_semtake */
 #define MAX_OPENCNT			(255)				/* Limit of uint8_t */
 
+#ifndef CONFIG_BCH_CACHE_NSECTORS
+#define CONFIG_BCH_CACHE_NSECTORS	1
+#endif
+
+#ifndef CONFIG_BCH_CACHE_READAHEAD
+#define CONFIG_BCH_CACHE_READAHEAD	0
+#endif
+
+#define BCH_NOSECTOR		((size_t)-1)
+
+/* The data of cache entry 'i' */
+
+#define BCH_CACHEBUF(b, i)	(&(b)->buffer[(size_t)(i) * (b)->sectsize])
+
+#ifdef CONFIG_BCH_CACHE_STATS
+#define BCH_STAT(b, f, n)	((b)->stat.f += (n))
+#else
+#define BCH_STAT(b, f, n)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
+/* One entry of the sector cache */
+
+struct bch_cache_s {
+	size_t sector;				/* The sector held, BCH_NOSECTOR if none */
+	uint32_t used;				/* LRU clock at the last access, 0 if unused */
+	bool dirty;					/* true: Data has been written to the entry */
+};
+
 struct bchlib_s {
 	FAR struct inode *inode;	/* I-node of the block driver */
 	uint32_t sectsize;			/* The size of one sector on the device */
 	size_t nsectors;			/* Number of sectors supported by the device */
-	size_t sector;				/* The current sector in the buffer */
+	size_t nextsector;			/* Sector following the last one read */
 	sem_t sem;					/* For atomic accesses to this structure */
 	uint8_t refs;				/* Number of references */
-	bool dirty;					/* true: Data has been written to the buffer */
 	bool readonly;				/* true: Only read operations are supported */
 	bool unlinked;				/* true: The driver has been unlinked */
-	FAR uint8_t *buffer;		/* One sector buffer */
+	uint16_t ncached;			/* Number of entries in the sector cache */
+	uint32_t clock;				/* LRU clock, advanced on every access */
+	FAR struct bch_cache_s *cache;	/* The sector cache entries */
+	FAR uint8_t *buffer;		/* Their data, one sector per entry */
 
+#ifdef CONFIG_BCH_CACHE_STATS
+	struct bch_cachestat_s stat;	/* Cache statistics */
+#endif
 #if defined(CONFIG_BCH_ENCRYPTION)
 	uint8_t key[CONFIG_BCH_ENCRYPTION_KEY_SIZE];	/* Encryption key */
 #endif
@@ -106,8 +139,10 @@ EXTERN const struct file_operations bch_fops;
  * Public Function Prototypes
  ****************************************************************************/
 EXTERN void bchlib_semtake(FAR struct bchlib_s *bch);
-EXTERN int  bchlib_flushsector(FAR struct bchlib_s *bch);
+EXTERN int  bchlib_flushcache(FAR struct bchlib_s *bch);
 EXTERN int  bchlib_readsector(FAR struct bchlib_s *bch, size_t sector);
+EXTERN void bchlib_overlaycache(FAR struct bchlib_s *bch, FAR uint8_t *buffer, size_t sector, size_t nsectors);
+EXTERN void bchlib_updatecache(FAR struct bchlib_s *bch, FAR const uint8_t *buffer, size_t sector, size_t nsectors);
 
 #undef EXTERN
 #if defined(__cplusplus)
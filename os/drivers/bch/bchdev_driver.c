@@ -157,7 +157,7 @@ static int bch_close(FAR struct file *filep)
 
 	/* Flush any dirty pages remaining in the cache */
 	bchlib_semtake(bch);
-	(void)bchlib_flushsector(bch);
+	(void)bchlib_flushcache(bch);
 
 	/*
 	 * Decrement the reference count (I don't use bchlib_decref() because I
@@ -331,6 +331,27 @@ static int bch_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
 		bchlib_semgive(bch);
 	}
+	/* Is this a request to write the modified sectors to the media? */
+	else if (cmd == DIOC_FLUSH) {
+		bchlib_semtake(bch);
+		ret = bchlib_flushcache(bch);
+		bchlib_semgive(bch);
+	}
+#ifdef CONFIG_BCH_CACHE_STATS
+	/* Is this a request to get the cache statistics? */
+	else if (cmd == DIOC_CACHESTAT) {
+		FAR struct bch_cachestat_s *stat = (FAR struct bch_cachestat_s *)((uintptr_t)arg);
+
+		if (!stat) {
+			ret = -EINVAL;
+		} else {
+			bchlib_semtake(bch);
+			*stat = bch->stat;
+			bchlib_semgive(bch);
+			ret = OK;
+		}
+	}
+#endif
 #ifdef CONFIG_BCH_ENCRYPTION
 	/* Is this a request to set the encryption key? */
 	else if (cmd == DIOC_SETKEY) {
@@ -68,20 +68,20 @@
  * Public Functions
  ****************************************************************************/
 /****************************************************************************
- * Name: bchdev_register
+ * Name: bchdev_register_cache
  *
  * Description:
  *   Setup so that it exports the block driver referenced by 'blkdev' as a
- *   character device 'chardev'
+ *   character device 'chardev', with a cache of 'ncached' sectors
  *
  ****************************************************************************/
-int bchdev_register(FAR const char *blkdev, FAR const char *chardev, bool readonly)
+int bchdev_register_cache(FAR const char *blkdev, FAR const char *chardev, bool readonly, int ncached)
 {
 	FAR void *handle;
 	int ret;
 
 	/* Setup the BCH lib functions */
-	ret = bchlib_setup(blkdev, readonly, &handle);
+	ret = bchlib_setup_cache(blkdev, readonly, ncached, &handle);
 	if (ret < 0) {
 		fdbg("ERROR: bchlib_setup failed: %d\n", -ret);
 		return ret;
@@ -97,3 +97,16 @@ int bchdev_register(FAR const char *blkdev, FAR const char *chardev, bool readon
 
 	return ret;
 }
+
+/****************************************************************************
+ * Name: bchdev_register
+ *
+ * Description:
+ *   Setup so that it exports the block driver referenced by 'blkdev' as a
+ *   character device 'chardev'
+ *
+ ****************************************************************************/
+int bchdev_register(FAR const char *blkdev, FAR const char *chardev, bool readonly)
+{
+	return bchdev_register_cache(blkdev, chardev, readonly, CONFIG_BCH_CACHE_NSECTORS);
+}
@@ -57,6 +57,7 @@
 
 #include <sys/types.h>
 #include <stdbool.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -88,16 +89,16 @@ static void bch_xor(uint32_t *R, uint32_t *A, uint32_t *B)
  * Name: bch_cypher
  ****************************************************************************/
 #if defined(CONFIG_BCH_ENCRYPTION)
-static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
+static int bch_cypher(FAR struct bchlib_s *bch, FAR uint8_t *data, size_t sector, int encrypt)
 {
 	int blocks = bch->sectsize / 16;
-	FAR uint32_t *buffer = (FAR uint32_t *)bch->buffer;
+	FAR uint32_t *buffer = (FAR uint32_t *)data;
 	int i;
 
 	for (i = 0; i < blocks; i++, buffer += 16 / sizeof(uint32_t)) {
 		uint32_t T[4];
 		uint32_t X[4] = {
-			bch->sector, 0, 0, i
+			sector, 0, 0, i
 		};
 
 		aes_cypher(X, X, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
@@ -115,61 +116,151 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
 #endif
 
 /****************************************************************************
- * Public Functions
+ * Name: bch_findsector
+ *
+ * Description:
+ *   Return the cache entry holding 'sector', or -1 if it is not cached
+ *
  ****************************************************************************/
+static int bch_findsector(FAR struct bchlib_s *bch, size_t sector)
+{
+	int i;
+
+	for (i = 0; i < bch->ncached; i++) {
+		if (bch->cache[i].sector == sector) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
 /****************************************************************************
- * Name: bchlib_flushsector
+ * Name: bch_victim
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
- *
- * Assumptions:
- *   Caller must assume mutual exclusion
+ *   Choose the entry to receive 'sector'.  A sector following a cached one
+ *   goes to the next entry, so that a sequential stream stays contiguous in
+ *   the cache and can be read ahead and written back with one transfer.
+ *   Otherwise the least recently used entry is replaced.
  *
  ****************************************************************************/
-int bchlib_flushsector(FAR struct bchlib_s *bch)
+static int bch_victim(FAR struct bchlib_s *bch, size_t sector)
 {
-	FAR struct inode *inode;
-	ssize_t ret = OK;
+	int victim;
+	int i;
 
-	/*
-	 * Check if the sector has been modified and is out of sync with the
-	 * media.
-	 */
-	if (bch->dirty) {
-		inode = bch->inode;
+	if (sector > 0) {
+		victim = bch_findsector(bch, sector - 1) + 1;
+		if (victim > 0 && victim < bch->ncached) {
+			return victim;
+		}
+	}
+
+	victim = 0;
+	for (i = 1; i < bch->ncached; i++) {
+		if (bch->cache[i].used < bch->cache[victim].used) {
+			victim = i;
+		}
+	}
+
+	return victim;
+}
+
+/****************************************************************************
+ * Name: bch_writeback
+ *
+ * Description:
+ *   Write the 'count' entries starting at 'first', which hold consecutive
+ *   sectors, to the media with one transfer
+ *
+ ****************************************************************************/
+static int bch_writeback(FAR struct bchlib_s *bch, int first, int count)
+{
+	FAR struct inode *inode = bch->inode;
+	ssize_t ret;
+	int i;
 
 #if defined(CONFIG_BCH_ENCRYPTION)
-		/* Encrypt data as necessary */
-		bch_cypher(bch, CYPHER_ENCRYPT);
+	/* Encrypt data as necessary */
+	for (i = first; i < first + count; i++) {
+		bch_cypher(bch, BCH_CACHEBUF(bch, i), bch->cache[i].sector, CYPHER_ENCRYPT);
+	}
 #endif
 
-		/* Write the sector to the media */
-		ret = inode->u.i_bops->write(inode, bch->buffer, bch->sector, 1);
-		if (ret < 0) {
-			fdbg("Write failed: %d\n");
-		}
+	ret = inode->u.i_bops->write(inode, BCH_CACHEBUF(bch, first), bch->cache[first].sector, count);
+	if (ret < 0) {
+		fdbg("Write failed: %d\n", ret);
+	}
+
+	BCH_STAT(bch, writebacks, 1);
+	BCH_STAT(bch, written, count);
 
+	for (i = first; i < first + count; i++) {
 #if defined(CONFIG_BCH_ENCRYPTION)
 		/*
 		 * Computation overhead to save memory for extra sector buffer
 		 * TODO: Add configuration switch for extra sector buffer
 		 */
-		bch_cypher(bch, CYPHER_DECRYPT);
+		bch_cypher(bch, BCH_CACHEBUF(bch, i), bch->cache[i].sector, CYPHER_DECRYPT);
 #endif
 
 		/* The sector is now in sync with the media */
-		bch->dirty = false;
+		bch->cache[i].dirty = false;
 	}
 
 	return (int)ret;
 }
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+/****************************************************************************
+ * Name: bchlib_flushcache
+ *
+ * Description:
+ *   Write all dirty sectors of the cache to the media.  Dirty sectors in
+ *   consecutive entries that are also consecutive on the media are written
+ *   with one transfer.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+int bchlib_flushcache(FAR struct bchlib_s *bch)
+{
+	int ret = OK;
+	int first;
+	int last;
+	int err;
+
+	for (first = 0; first < bch->ncached; first = last) {
+		last = first + 1;
+		if (!bch->cache[first].dirty) {
+			continue;
+		}
+
+		while (last < bch->ncached && bch->cache[last].dirty &&
+				bch->cache[last].sector == bch->cache[last - 1].sector + 1) {
+			last++;
+		}
+
+		err = bch_writeback(bch, first, last - first);
+		if (err < 0) {
+			ret = err;
+		}
+	}
+
+	return ret;
+}
+
 /****************************************************************************
  * Name: bchlib_readsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Bring 'sector' into the cache and return its cache entry, or a negated
+ *   errno value if it could not be read.  A miss that continues the previous
+ *   one also reads up to CONFIG_BCH_CACHE_READAHEAD following sectors.
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -178,23 +269,110 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
 int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
 {
 	FAR struct inode *inode;
-	ssize_t ret = OK;
+	ssize_t ret;
+	int index;
+	int count;
+	int i;
+
+	index = bch_findsector(bch, sector);
+	if (index >= 0) {
+		BCH_STAT(bch, hits, 1);
+		bch->cache[index].used = ++bch->clock;
+		return index;
+	}
 
-	if (bch->sector != sector) {
-		inode = bch->inode;
+	BCH_STAT(bch, misses, 1);
+	index = bch_victim(bch, sector);
+	count = 1;
 
-		(void)bchlib_flushsector(bch);
-		bch->sector = (size_t)-1;
+#if CONFIG_BCH_CACHE_READAHEAD > 0
+	if (sector == bch->nextsector) {
+		while (count <= CONFIG_BCH_CACHE_READAHEAD && index + count < bch->ncached &&
+				sector + count < bch->nsectors && bch_findsector(bch, sector + count) < 0) {
+			count++;
+		}
+	}
+#endif
 
-		ret = inode->u.i_bops->read(inode, bch->buffer, sector, 1);
-		if (ret < 0) {
-			fdbg("Read failed: %d\n");
+	/* Write back the entries to be replaced */
+	for (i = index; i < index + count; i++) {
+		if (bch->cache[i].dirty) {
+			(void)bchlib_flushcache(bch);
+			break;
 		}
-		bch->sector = sector;
+	}
+
+	for (i = index; i < index + count; i++) {
+		bch->cache[i].sector = BCH_NOSECTOR;
+		bch->cache[i].used = 0;
+	}
+
+	inode = bch->inode;
+	ret = inode->u.i_bops->read(inode, BCH_CACHEBUF(bch, index), sector, count);
+	if (ret <= 0) {
+		fdbg("Read failed: %d\n", ret);
+		return ret < 0 ? (int)ret : -EIO;
+	}
+
+	/* The driver may return fewer sectors than requested */
+	count = ret < count ? (int)ret : count;
+	BCH_STAT(bch, readahead, count - 1);
+	bch->nextsector = sector + count;
+
+	for (i = index; i < index + count; i++) {
+		bch->cache[i].sector = sector + (i - index);
+		bch->cache[i].used = ++bch->clock;
 #if defined(CONFIG_BCH_ENCRYPTION)
-		bch_cypher(bch, CYPHER_DECRYPT);
+		bch_cypher(bch, BCH_CACHEBUF(bch, i), bch->cache[i].sector, CYPHER_DECRYPT);
 #endif
 	}
-	return (int)ret;
+
+	/* The requested sector is the most recently used one */
+	bch->cache[index].used = ++bch->clock;
+	return index;
 }
 
+/****************************************************************************
+ * Name: bchlib_overlaycache
+ *
+ * Description:
+ *   Sectors read from the media directly into 'buffer' bypass the cache.
+ *   Replace those that are modified in the cache by their cached contents.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+void bchlib_overlaycache(FAR struct bchlib_s *bch, FAR uint8_t *buffer, size_t sector, size_t nsectors)
+{
+	int i;
+
+	for (i = 0; i < bch->ncached; i++) {
+		if (bch->cache[i].dirty && bch->cache[i].sector >= sector && bch->cache[i].sector < sector + nsectors) {
+			memcpy(&buffer[(bch->cache[i].sector - sector) * bch->sectsize], BCH_CACHEBUF(bch, i), bch->sectsize);
+		}
+	}
+}
+
+/****************************************************************************
+ * Name: bchlib_updatecache
+ *
+ * Description:
+ *   Sectors written from 'buffer' directly to the media bypass the cache.
+ *   Update the cached copies of those sectors, which are now in sync.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+void bchlib_updatecache(FAR struct bchlib_s *bch, FAR const uint8_t *buffer, size_t sector, size_t nsectors)
+{
+	int i;
+
+	for (i = 0; i < bch->ncached; i++) {
+		if (bch->cache[i].sector >= sector && bch->cache[i].sector < sector + nsectors) {
+			memcpy(BCH_CACHEBUF(bch, i), &buffer[(bch->cache[i].sector - sector) * bch->sectsize], bch->sectsize);
+			bch->cache[i].dirty = false;
+		}
+	}
+}
@@ -100,6 +100,7 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 	uint16_t	sectoffset;
 	size_t		nbytes;
 	size_t		bytesread;
+	int			index;
 	int			ret;
 
 	/* Get rid of this special case right away */
@@ -125,8 +126,11 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 
 	bytesread = 0;
 	if (sectoffset > 0) {
-		/* Read the sector into the sector buffer */
-		bchlib_readsector(bch, sector);
+		/* Read the sector into the sector cache */
+		index = bchlib_readsector(bch, sector);
+		if (index < 0) {
+			return index;
+		}
 
 		/* Copy the tail end of the sector to the user buffer */
 		if (sectoffset + len > bch->sectsize) {
@@ -135,7 +139,7 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 			nbytes = len;
 		}
 
-		memcpy(buffer, &bch->buffer[sectoffset], nbytes);
+		memcpy(buffer, &BCH_CACHEBUF(bch, index)[sectoffset], nbytes);
 
 		/* Adjust pointers and counts */
 		sector++;
@@ -166,6 +170,10 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 			return ret;
 		}
 
+		/* The cache may hold newer data for some of these sectors */
+		bchlib_overlaycache(bch, (FAR uint8_t *)buffer, sector, nsectors);
+		bch->nextsector = sector + nsectors;
+
 		/* Adjust pointers and counts */
 		sector    += nsectors;
 		nbytes     = nsectors * bch->sectsize;
@@ -181,11 +189,14 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 
 	/* Then read any partial final sector */
 	if (len > 0) {
-		/* Read the sector into the sector buffer */
-		bchlib_readsector(bch, sector);
+		/* Read the sector into the sector cache */
+		index = bchlib_readsector(bch, sector);
+		if (index < 0) {
+			return index;
+		}
 
 		/* Copy the head end of the sector to the user buffer */
-		memcpy(buffer, bch->buffer, len);
+		memcpy(buffer, BCH_CACHEBUF(bch, index), len);
 
 		/* Adjust counts */
 		bytesread += len;
@@ -75,21 +75,26 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: bchlib_setup
+ * Name: bchlib_setup_cache
  *
  * Description:
  *   Setup so that the block driver referenced by 'blkdev' can be accessed
- *   similar to a character device.
+ *   similar to a character device, through a cache of 'ncached' sectors.
  *
  ****************************************************************************/
-int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
+int bchlib_setup_cache(const char *blkdev, bool readonly, int ncached, FAR void **handle)
 {
 	FAR struct bchlib_s *bch;
 	struct geometry geo;
 	int ret;
+	int i;
 
 	DEBUGASSERT(blkdev);
 
+	if (ncached < 1 || ncached > UINT16_MAX) {
+		return -EINVAL;
+	}
+
 	/* Allocate the BCH state structure */
 	bch = (FAR struct bchlib_s *)kmm_zalloc(sizeof(struct bchlib_s));
 	if (!bch) {
@@ -126,23 +131,53 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
 
 	/* Save the geometry info and complete initialization of the structure */
 	sem_init(&bch->sem, 0, 1);
-	bch->nsectors = geo.geo_nsectors;
-	bch->sectsize = geo.geo_sectorsize;
-	bch->sector   = (size_t)-1;
-	bch->readonly = readonly;
-
-	/* Allocate the sector I/O buffer */
-	bch->buffer = (FAR uint8_t *)kmm_malloc(bch->sectsize);
-	if (!bch->buffer) {
-		fdbg("ERROR: Failed to allocate sector buffer\n");
+	bch->nsectors   = geo.geo_nsectors;
+	bch->sectsize   = geo.geo_sectorsize;
+	bch->nextsector = BCH_NOSECTOR;
+	bch->ncached    = ncached;
+	bch->readonly   = readonly;
+
+	/* Allocate the sector cache */
+	bch->cache = (FAR struct bch_cache_s *)kmm_zalloc(ncached * sizeof(struct bch_cache_s));
+	bch->buffer = (FAR uint8_t *)kmm_malloc(ncached * bch->sectsize);
+	if (!bch->cache || !bch->buffer) {
+		fdbg("ERROR: Failed to allocate %d sector cache\n", ncached);
 		ret = -ENOMEM;
-		goto errout_with_bch;
+		goto errout_with_cache;
+	}
+
+	for (i = 0; i < ncached; i++) {
+		bch->cache[i].sector = BCH_NOSECTOR;
 	}
 
 	*handle = bch;
 	return OK;
 
+errout_with_cache:
+	if (bch->cache) {
+		kmm_free(bch->cache);
+	}
+
+	if (bch->buffer) {
+		kmm_free(bch->buffer);
+	}
+
+	sem_destroy(&bch->sem);
+
 errout_with_bch:
 	kmm_free(bch);
 	return ret;
 }
+
+/****************************************************************************
+ * Name: bchlib_setup
+ *
+ * Description:
+ *   Setup so that the block driver referenced by 'blkdev' can be accessed
+ *   similar to a character device.
+ *
+ ****************************************************************************/
+int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
+{
+	return bchlib_setup_cache(blkdev, readonly, CONFIG_BCH_CACHE_NSECTORS, handle);
+}
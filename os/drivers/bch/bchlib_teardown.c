@@ -88,7 +88,7 @@ int bchlib_teardown(FAR void *handle)
 	}
 
 	/* Flush any pending data to the block driver */
-	bchlib_flushsector(bch);
+	bchlib_flushcache(bch);
 
 	/* Close the block driver */
 	(void)close_blockdriver(bch->inode);
@@ -98,6 +98,10 @@ int bchlib_teardown(FAR void *handle)
 		kmm_free(bch->buffer);
 	}
 
+	if (bch->cache) {
+		kmm_free(bch->cache);
+	}
+
 	sem_destroy(&bch->sem);
 	kmm_free(bch);
 	return OK;
@@ -87,6 +87,7 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 	uint16_t sectoffset;
 	size_t   nbytes;
 	size_t   byteswritten;
+	int      index;
 	int      ret;
 
 	/* Get rid of this special case right away */
@@ -111,8 +112,11 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 
 	byteswritten = 0;
 	if (sectoffset > 0) {
-		/* Read the full sector into the sector buffer */
-		bchlib_readsector(bch, sector);
+		/* Read the full sector into the sector cache */
+		index = bchlib_readsector(bch, sector);
+		if (index < 0) {
+			return index;
+		}
 
 		/* Copy the tail end of the sector from the user buffer */
 		if (sectoffset + len > bch->sectsize) {
@@ -121,8 +125,8 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 			nbytes = len;
 		}
 
-		memcpy(&bch->buffer[sectoffset], buffer, nbytes);
-		bch->dirty = true;
+		memcpy(&BCH_CACHEBUF(bch, index)[sectoffset], buffer, nbytes);
+		bch->cache[index].dirty = true;
 
 		/* Adjust pointers and counts */
 		sector++;
@@ -154,6 +158,9 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 			return ret;
 		}
 
+		/* Keep the cached copies of these sectors in sync */
+		bchlib_updatecache(bch, (FAR const uint8_t *)buffer, sector, nsectors);
+
 		/* Adjust pointers and counts */
 		sector       += nsectors;
 		nbytes        = nsectors * bch->sectsize;
@@ -169,23 +176,28 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 
 	/* Then write any partial final sector */
 	if (len > 0) {
-		/* Read the sector into the sector buffer */
-		bchlib_readsector(bch, sector);
+		/* Read the sector into the sector cache */
+		index = bchlib_readsector(bch, sector);
+		if (index < 0) {
+			return index;
+		}
 
 		/* Copy the head end of the sector from the user buffer */
-		memcpy(bch->buffer, buffer, len);
-		bch->dirty = true;
+		memcpy(BCH_CACHEBUF(bch, index), buffer, len);
+		bch->cache[index].dirty = true;
 
 		/* Adjust counts */
 		byteswritten += len;
 	}
 
+#ifndef CONFIG_BCH_CACHE_WRITEBACK
 	/* Finally, flush any cached writes to the device as well */
-	ret = bchlib_flushsector(bch);
+	ret = bchlib_flushcache(bch);
 	if (ret < 0) {
 		fdbg("ERROR: Flush failed: %d\n", ret);
 		return ret;
 	}
+#endif
 
 	return byteswritten;
 }
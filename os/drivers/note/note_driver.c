@@ -0,0 +1,714 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <time.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/clock.h>
+#include <tinyara/sched.h>
+#include <tinyara/sched_note.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/ioctl.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_BUFFER
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Each CPU records its notes into a ring of fixed-size slots.  A note
+ * occupies one or more consecutive slots; each slot starts with a sequence
+ * word holding the (31-bit) index of the slot plus one, and the slots
+ * following the first one of a note have NOTE_SEQ_CONT set.  A sequence of
+ * zero means the slot is being written.
+ */
+
+#define NOTE_SLOT_SIZE       32
+#define NOTE_SLOT_DATA       (NOTE_SLOT_SIZE - sizeof(uint32_t))
+#define NOTE_NSLOTS          (CONFIG_SCHED_NOTE_BUFSIZE / NOTE_SLOT_SIZE)
+#define NOTE_SLOT_MASK       (NOTE_NSLOTS - 1)
+#define NOTE_SLOTS_FOR(len)  (((len) + NOTE_SLOT_DATA - 1) / NOTE_SLOT_DATA)
+
+#define NOTE_SEQ_CONT        0x80000000
+#define NOTE_SEQ_MASK        0x7fffffff
+#define NOTE_SEQ(idx)        (((idx) + 1) & NOTE_SEQ_MASK)
+
+/* True if the writers have lapped the reader of 'ring' */
+
+#define NOTE_LAPPED(ring) \
+	(__atomic_load_n(&(ring)->head, __ATOMIC_ACQUIRE) - (ring)->tail > NOTE_NSLOTS)
+
+/* The largest note recorded, longer strings and dumps are truncated */
+
+#define NOTE_MAX_LENGTH      128
+
+#if NOTE_NSLOTS < 8 || (NOTE_NSLOTS & NOTE_SLOT_MASK) != 0
+#error "CONFIG_SCHED_NOTE_BUFSIZE must be a power of two of at least 256"
+#endif
+
+#ifdef CONFIG_SMP
+#define NOTE_NCPUS           CONFIG_SMP_NCPUS
+#define note_cpu()           this_cpu()
+#else
+#define NOTE_NCPUS           1
+#define note_cpu()           0
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct note_slot_s {
+	uint32_t seq;				/* NOTE_SEQ() of the slot, 0 while written */
+	uint8_t data[NOTE_SLOT_DATA];	/* Part of a note */
+};
+
+struct note_ring_s {
+	uint32_t head;				/* Next slot index to reserve, only grows */
+	uint32_t tail;				/* Next slot index to read */
+	uint32_t lost;				/* Overruns since NOTEIOC_GETLOST */
+	struct note_slot_s slots[NOTE_NSLOTS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct note_ring_s g_note_ring[NOTE_NCPUS];
+static volatile bool g_note_enabled = true;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Store a value into the byte array of a note, least significant first */
+
+static void note_flatten(FAR uint8_t *dst, uintptr_t value, size_t size)
+{
+	while (size-- > 0) {
+		*dst++ = (uint8_t)value;
+		value >>= 8;
+	}
+}
+
+/****************************************************************************
+ * Name: note_systime
+ *
+ * Description:
+ *   Get the time stamp of a note without entering a critical section.
+ *   clock_systimespec() takes the global lock for 64-bit ticks, which
+ *   recurses when spinlocks are instrumented and serializes every note.
+ *   A 64-bit tick count is sampled until two reads agree instead.
+ *
+ ****************************************************************************/
+
+static void note_systime(FAR struct timespec *ts)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+	(void)up_timer_gettime(ts);
+#else
+	clock_t ticks;
+
+#ifdef CONFIG_SYSTEM_TIME64
+	clock_t check;
+
+	do {
+		ticks = g_system_timer;
+		check = g_system_timer;
+	} while (ticks != check);
+#else
+	ticks = g_system_timer;
+#endif
+
+	ts->tv_sec = (time_t)(ticks / TICK_PER_SEC);
+	ts->tv_nsec = (long)(ticks % TICK_PER_SEC) * NSEC_PER_TICK;
+#endif
+}
+
+/****************************************************************************
+ * Name: note_common
+ *
+ * Description:
+ *   Fill in the common header of a note for 'tcb', or the current task when
+ *   'tcb' is NULL.
+ *
+ ****************************************************************************/
+
+static void note_common(FAR struct tcb_s *tcb, FAR struct note_common_s *note, uint8_t length, uint8_t type)
+{
+	struct timespec ts;
+
+	if (tcb == NULL) {
+		tcb = this_task();
+	}
+
+	note_systime(&ts);
+
+	note->nc_length = length;
+	note->nc_type = type;
+	note->nc_priority = tcb != NULL ? tcb->sched_priority : 0;
+#ifdef CONFIG_SMP
+	note->nc_cpu = note_cpu();
+#endif
+	note_flatten(note->nc_pid, tcb != NULL ? (uintptr_t)tcb->pid : 0, sizeof(note->nc_pid));
+	note_flatten(note->nc_systime_sec, (uintptr_t)ts.tv_sec, sizeof(note->nc_systime_sec));
+	note_flatten(note->nc_systime_nsec, (uintptr_t)ts.tv_nsec, sizeof(note->nc_systime_nsec));
+}
+
+/****************************************************************************
+ * Name: note_add
+ *
+ * Description:
+ *   Copy a note into the ring of the current CPU.  The slots are reserved
+ *   with one atomic add so nested interrupt handlers get slots of their own,
+ *   and each slot is published by storing its sequence last.  A writer that
+ *   stalls for a full lap of the ring may leave a torn note behind; the
+ *   reader and the trace converter drop notes whose header is not valid.
+ *
+ ****************************************************************************/
+
+static void note_add(FAR const void *note, size_t notelen)
+{
+	FAR struct note_ring_s *ring;
+	FAR struct note_slot_s *slot;
+	FAR const uint8_t *src = (FAR const uint8_t *)note;
+	uint32_t idx;
+	uint32_t seq;
+	size_t nslots;
+	size_t i;
+	size_t n;
+
+	if (!g_note_enabled) {
+		return;
+	}
+
+	ring = &g_note_ring[note_cpu()];
+	nslots = NOTE_SLOTS_FOR(notelen);
+	idx = __atomic_fetch_add(&ring->head, (uint32_t)nslots, __ATOMIC_RELAXED);
+
+	for (i = 0; i < nslots; i++, idx++) {
+		slot = &ring->slots[idx & NOTE_SLOT_MASK];
+		seq = NOTE_SEQ(idx) | (i > 0 ? NOTE_SEQ_CONT : 0);
+
+		__atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+
+		n = notelen < NOTE_SLOT_DATA ? notelen : NOTE_SLOT_DATA;
+		memcpy(slot->data, src, n);
+		src += n;
+		notelen -= n;
+
+		__atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+	}
+}
+
+#ifdef CONFIG_DRIVER_NOTE
+
+/****************************************************************************
+ * Name: note_read_ring
+ *
+ * Description:
+ *   Copy the whole, published notes of one ring into 'buffer'.  Stops at
+ *   the first note that is still being written or that does not fit.
+ *
+ ****************************************************************************/
+
+static size_t note_read_ring(FAR struct note_ring_s *ring, FAR uint8_t *buffer, size_t buflen)
+{
+	FAR struct note_slot_s *slot;
+	size_t nread = 0;
+	size_t notelen;
+	size_t nslots;
+	size_t copied;
+	size_t n;
+	size_t i;
+	uint32_t head;
+	uint32_t seq;
+
+	for (;;) {
+		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		if (ring->tail == head) {
+			break;
+		}
+
+		/* Skip what the writers have lapped */
+
+		if (head - ring->tail > NOTE_NSLOTS) {
+			ring->lost++;
+			ring->tail = head - NOTE_NSLOTS;
+		}
+
+		slot = &ring->slots[ring->tail & NOTE_SLOT_MASK];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+		if (seq == (NOTE_SEQ(ring->tail) | NOTE_SEQ_CONT)) {
+			/* The rest of a note whose first slot was overwritten */
+
+			ring->tail++;
+			continue;
+		}
+
+		if (seq != NOTE_SEQ(ring->tail)) {
+			if (NOTE_LAPPED(ring)) {
+				continue;
+			}
+
+			/* Still being written, retry on the next read */
+
+			break;
+		}
+
+		notelen = slot->data[0];
+		if (notelen < sizeof(struct note_common_s) || notelen > NOTE_MAX_LENGTH) {
+			ring->lost++;
+			ring->tail++;
+			continue;
+		}
+
+		if (notelen > buflen - nread) {
+			break;
+		}
+
+		/* Copy slot by slot, checking that no slot changed under us */
+
+		nslots = NOTE_SLOTS_FOR(notelen);
+		for (i = 0, copied = 0; i < nslots; i++) {
+			slot = &ring->slots[(ring->tail + i) & NOTE_SLOT_MASK];
+			seq = NOTE_SEQ(ring->tail + i) | (i > 0 ? NOTE_SEQ_CONT : 0);
+			if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) {
+				break;
+			}
+
+			n = notelen - copied < NOTE_SLOT_DATA ? notelen - copied : NOTE_SLOT_DATA;
+			memcpy(&buffer[nread + copied], slot->data, n);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+				break;
+			}
+
+			copied += n;
+		}
+
+		if (i < nslots) {
+			if (!NOTE_LAPPED(ring)) {
+				/* A later part is still being written */
+
+				break;
+			}
+
+			ring->lost++;
+			continue;
+		}
+
+		ring->tail += nslots;
+		nread += notelen;
+	}
+
+	return nread;
+}
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+static ssize_t note_read(FAR struct file *filep, FAR char *buffer, size_t len);
+static ssize_t note_write(FAR struct file *filep, FAR const char *buffer, size_t len);
+static int note_ioctl(FAR struct file *filep, int cmd, unsigned long arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+static const struct file_operations note_fops = {
+	0,                          /* open */
+	0,                          /* close */
+	note_read,                  /* read */
+	note_write,                 /* write */
+	0,                          /* seek */
+	note_ioctl                  /* ioctl */
+#ifndef CONFIG_DISABLE_POLL
+	, 0                         /* poll */
+#endif
+};
+
+static sem_t g_note_exclsem = SEM_INITIALIZER(1);
+
+/****************************************************************************
+ * Name: note_read
+ *
+ * Description: Return whole notes, draining the ring of each CPU in turn.
+ *
+ ****************************************************************************/
+static ssize_t note_read(FAR struct file *filep, FAR char *buffer, size_t len)
+{
+	size_t nread = 0;
+	int cpu;
+
+	while (sem_wait(&g_note_exclsem) != OK) {
+		if (get_errno() != EINTR) {
+			return -get_errno();
+		}
+	}
+
+	for (cpu = 0; cpu < NOTE_NCPUS; cpu++) {
+		nread += note_read_ring(&g_note_ring[cpu], (FAR uint8_t *)buffer + nread, len - nread);
+	}
+
+	sem_post(&g_note_exclsem);
+	return (ssize_t)nread;
+}
+
+static ssize_t note_write(FAR struct file *filep, FAR const char *buffer, size_t len)
+{
+	return 0;
+}
+
+/****************************************************************************
+ * Name: note_ioctl
+ *
+ * Description: The ioctl method for the note buffer.
+ *
+ ****************************************************************************/
+static int note_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
+{
+	FAR uint32_t *lost;
+	int ret = OK;
+	int cpu;
+
+	while (sem_wait(&g_note_exclsem) != OK) {
+		if (get_errno() != EINTR) {
+			return -get_errno();
+		}
+	}
+
+	switch (cmd) {
+	case NOTEIOC_CLEAR:
+		for (cpu = 0; cpu < NOTE_NCPUS; cpu++) {
+			g_note_ring[cpu].tail = __atomic_load_n(&g_note_ring[cpu].head, __ATOMIC_ACQUIRE);
+			g_note_ring[cpu].lost = 0;
+		}
+		break;
+
+	case NOTEIOC_ENABLE:
+		g_note_enabled = (arg != 0);
+		break;
+
+	case NOTEIOC_GETLOST:
+		lost = (FAR uint32_t *)arg;
+		if (lost == NULL) {
+			ret = -EINVAL;
+			break;
+		}
+
+		*lost = 0;
+		for (cpu = 0; cpu < NOTE_NCPUS; cpu++) {
+			*lost += g_note_ring[cpu].lost;
+			g_note_ring[cpu].lost = 0;
+		}
+		break;
+
+	default:
+		ret = -ENOTTY;
+		break;
+	}
+
+	sem_post(&g_note_exclsem);
+	return ret;
+}
+
+#endif							/* CONFIG_DRIVER_NOTE */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+void sched_note_start(FAR struct tcb_s *tcb)
+{
+	uint8_t data[NOTE_MAX_LENGTH];
+	FAR struct note_start_s *note = (FAR struct note_start_s *)data;
+	size_t length = sizeof(struct note_common_s);
+#if CONFIG_TASK_NAME_SIZE > 0
+	size_t namelen = strnlen(tcb->name, NOTE_MAX_LENGTH - length - 1);
+
+	memcpy(note->nst_name, tcb->name, namelen);
+	note->nst_name[namelen] = '\0';
+	length += namelen + 1;
+#endif
+
+	note_common(tcb, &note->nst_cmn, (uint8_t)length, NOTE_START);
+	note_add(data, length);
+}
+
+void sched_note_stop(FAR struct tcb_s *tcb)
+{
+	struct note_stop_s note;
+
+	note_common(tcb, &note.nsp_cmn, sizeof(struct note_stop_s), NOTE_STOP);
+	note_add(&note, sizeof(struct note_stop_s));
+}
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SWITCH
+void sched_note_suspend(FAR struct tcb_s *tcb)
+{
+	struct note_suspend_s note;
+
+	note_common(tcb, &note.nsu_cmn, sizeof(struct note_suspend_s), NOTE_SUSPEND);
+	note.nsu_state = tcb->task_state;
+	note_add(&note, sizeof(struct note_suspend_s));
+}
+
+void sched_note_resume(FAR struct tcb_s *tcb)
+{
+	struct note_resume_s note;
+
+	note_common(tcb, &note.nre_cmn, sizeof(struct note_resume_s), NOTE_RESUME);
+	note_add(&note, sizeof(struct note_resume_s));
+}
+#endif
+
+#ifdef CONFIG_SMP
+void sched_note_cpu_start(FAR struct tcb_s *tcb, int cpu)
+{
+	struct note_cpu_start_s note;
+
+	note_common(tcb, &note.ncs_cmn, sizeof(struct note_cpu_start_s), NOTE_CPU_START);
+	note.ncs_target = (uint8_t)cpu;
+	note_add(&note, sizeof(struct note_cpu_start_s));
+}
+
+void sched_note_cpu_started(FAR struct tcb_s *tcb)
+{
+	struct note_cpu_started_s note;
+
+	note_common(tcb, &note.ncs_cmn, sizeof(struct note_cpu_started_s), NOTE_CPU_STARTED);
+	note_add(&note, sizeof(struct note_cpu_started_s));
+}
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SWITCH
+void sched_note_cpu_pause(FAR struct tcb_s *tcb, int cpu)
+{
+	struct note_cpu_pause_s note;
+
+	note_common(tcb, &note.ncp_cmn, sizeof(struct note_cpu_pause_s), NOTE_CPU_PAUSE);
+	note.ncp_target = (uint8_t)cpu;
+	note_add(&note, sizeof(struct note_cpu_pause_s));
+}
+
+void sched_note_cpu_paused(FAR struct tcb_s *tcb)
+{
+	struct note_cpu_paused_s note;
+
+	note_common(tcb, &note.ncp_cmn, sizeof(struct note_cpu_paused_s), NOTE_CPU_PAUSED);
+	note_add(&note, sizeof(struct note_cpu_paused_s));
+}
+
+void sched_note_cpu_resume(FAR struct tcb_s *tcb, int cpu)
+{
+	struct note_cpu_resume_s note;
+
+	note_common(tcb, &note.ncr_cmn, sizeof(struct note_cpu_resume_s), NOTE_CPU_RESUME);
+	note.ncr_target = (uint8_t)cpu;
+	note_add(&note, sizeof(struct note_cpu_resume_s));
+}
+
+void sched_note_cpu_resumed(FAR struct tcb_s *tcb)
+{
+	struct note_cpu_resumed_s note;
+
+	note_common(tcb, &note.ncr_cmn, sizeof(struct note_cpu_resumed_s), NOTE_CPU_RESUMED);
+	note_add(&note, sizeof(struct note_cpu_resumed_s));
+}
+#endif
+#endif							/* CONFIG_SMP */
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_CSECTION
+void sched_note_csection(FAR struct tcb_s *tcb, bool enter)
+{
+	struct note_csection_s note;
+
+	note_common(tcb, &note.ncs_cmn, sizeof(struct note_csection_s), enter ? NOTE_CSECTION_ENTER : NOTE_CSECTION_LEAVE);
+#ifdef CONFIG_SMP
+	note_flatten(note.ncs_count, tcb->irqcount, sizeof(note.ncs_count));
+#endif
+	note_add(&note, sizeof(struct note_csection_s));
+}
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SPINLOCKS
+void sched_note_spinlock(FAR struct tcb_s *tcb, FAR volatile spinlock_t *spinlock, int type)
+{
+	struct note_spinlock_s note;
+
+	note_common(tcb, &note.nsp_cmn, sizeof(struct note_spinlock_s), (uint8_t)type);
+	note_flatten(note.nsp_spinlock, (uintptr_t)spinlock, sizeof(note.nsp_spinlock));
+	note.nsp_value = (uint8_t)*spinlock;
+	note_add(&note, sizeof(struct note_spinlock_s));
+}
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SYSCALL
+void sched_note_syscall_enter(int nr, int argc, ...)
+{
+	struct note_syscall_enter_s note;
+	va_list ap;
+	int i;
+
+	if (argc > MAX_SYSCALL_ARGS) {
+		argc = MAX_SYSCALL_ARGS;
+	}
+
+	note_common(NULL, &note.nsc_cmn, SIZEOF_NOTE_SYSCALL_ENTER(argc), NOTE_SYSCALL_ENTER);
+	note.nsc_nr = (uint8_t)nr;
+	note.nsc_argc = (uint8_t)argc;
+
+	va_start(ap, argc);
+	for (i = 0; i < argc; i++) {
+		note_flatten(&note.nsc_args[i * sizeof(uintptr_t)], va_arg(ap, uintptr_t), sizeof(uintptr_t));
+	}
+	va_end(ap);
+
+	note_add(&note, SIZEOF_NOTE_SYSCALL_ENTER(argc));
+}
+
+void sched_note_syscall_leave(int nr, uintptr_t result)
+{
+	struct note_syscall_leave_s note;
+
+	note_common(NULL, &note.nsc_cmn, sizeof(struct note_syscall_leave_s), NOTE_SYSCALL_LEAVE);
+	note.nsc_nr = (uint8_t)nr;
+	note_flatten(note.nsc_result, result, sizeof(note.nsc_result));
+	note_add(&note, sizeof(struct note_syscall_leave_s));
+}
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+void sched_note_irqhandler(int irq, FAR void *handler, bool enter)
+{
+	struct note_irqhandler_s note;
+
+	note_common(NULL, &note.nih_cmn, sizeof(struct note_irqhandler_s), enter ? NOTE_IRQ_ENTER : NOTE_IRQ_LEAVE);
+	note.nih_irq = (uint8_t)irq;
+	note_add(&note, sizeof(struct note_irqhandler_s));
+}
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_DUMP
+void sched_note_string_ip(uint32_t tag, uintptr_t ip, FAR const char *buf)
+{
+	uint8_t data[NOTE_MAX_LENGTH];
+	FAR struct note_string_s *note = (FAR struct note_string_s *)data;
+	size_t maxlen = NOTE_MAX_LENGTH - sizeof(struct note_string_s);
+	size_t len = strlen(buf);
+
+	if (len > maxlen) {
+		len = maxlen;
+	}
+
+	note_common(NULL, &note->nst_cmn, (uint8_t)SIZEOF_NOTE_STRING(len), NOTE_DUMP_STRING);
+	note_flatten(note->nst_ip, ip, sizeof(note->nst_ip));
+	memcpy(note->nst_data, buf, len);
+	note->nst_data[len] = '\0';
+	note_add(data, SIZEOF_NOTE_STRING(len));
+	(void)tag;
+}
+
+void sched_note_dump_ip(uint32_t tag, uintptr_t ip, uint8_t event, FAR const void *buf, size_t len)
+{
+	uint8_t data[NOTE_MAX_LENGTH];
+	FAR struct note_binary_s *note = (FAR struct note_binary_s *)data;
+	size_t maxlen = NOTE_MAX_LENGTH - SIZEOF_NOTE_BINARY(0);
+
+	if (len > maxlen) {
+		len = maxlen;
+	}
+
+	note_common(NULL, &note->nbi_cmn, (uint8_t)SIZEOF_NOTE_BINARY(len), NOTE_DUMP_BINARY);
+	note_flatten(note->nbi_ip, ip, sizeof(note->nbi_ip));
+	note->nbi_event = event;
+	memcpy(note->nbi_data, buf, len);
+	note_add(data, SIZEOF_NOTE_BINARY(len));
+	(void)tag;
+}
+
+void sched_note_vprintf_ip(uint32_t tag, uintptr_t ip, FAR const char *fmt, va_list va)
+{
+	char buf[NOTE_MAX_LENGTH];
+
+	vsnprintf(buf, sizeof(buf), fmt, va);
+	sched_note_string_ip(tag, ip, buf);
+}
+
+void sched_note_vbprintf_ip(uint32_t tag, uintptr_t ip, uint8_t event, FAR const char *fmt, va_list va)
+{
+	char buf[NOTE_MAX_LENGTH];
+	int len;
+
+	len = vsnprintf(buf, sizeof(buf), fmt, va);
+	if (len < 0) {
+		return;
+	}
+
+	sched_note_dump_ip(tag, ip, event, buf, len < (int)sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+}
+
+void sched_note_printf_ip(uint32_t tag, uintptr_t ip, FAR const char *fmt, ...)
+{
+	va_list va;
+
+	va_start(va, fmt);
+	sched_note_vprintf_ip(tag, ip, fmt, va);
+	va_end(va);
+}
+
+void sched_note_bprintf_ip(uint32_t tag, uintptr_t ip, uint8_t event, FAR const char *fmt, ...)
+{
+	va_list va;
+
+	va_start(va, fmt);
+	sched_note_vbprintf_ip(tag, ip, event, fmt, va);
+	va_end(va);
+}
+#endif							/* CONFIG_SCHED_INSTRUMENTATION_DUMP */
+
+#ifdef CONFIG_DRIVER_NOTE
+/****************************************************************************
+ * Name: note_register
+ *
+ * Description:
+ *   Register the note buffer reader at NOTE_DRVPATH
+ *
+ ****************************************************************************/
+
+void note_register(void)
+{
+	(void)register_driver(NOTE_DRVPATH, &note_fops, 0444, NULL);
+}
+#endif
+
+#endif							/* CONFIG_SCHED_INSTRUMENTATION_BUFFER */
@@ -104,6 +104,50 @@ static const struct file_operations fifo_fops = {
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: mkfifo2
+ *
+ * Description:
+ *   mkfifo2() is mkfifo() with the size of the ringbuffer of the FIFO given
+ *   by the caller instead of CONFIG_DEV_PIPE_SIZE.  It is an internal OS
+ *   interface, not a system call.  Applications size a FIFO or a pipe with
+ *   the PIPEIOC_SETSIZE ioctl while it is empty.
+ *
+ * Inputs:
+ *   pathname - The full path to the FIFO instance to create
+ *   mode - Ignored for now
+ *   bufsize - Size of the ringbuffer in bytes.  One byte of it is never
+ *     used.  Must be between 2 and CONFIG_DEV_PIPE_MAXSIZE.
+ *
+ * Return:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int mkfifo2(FAR const char *pathname, mode_t mode, size_t bufsize)
+{
+	struct pipe_dev_s *dev;
+	int ret;
+
+	if (bufsize < 2 || bufsize > CONFIG_DEV_PIPE_MAXSIZE) {
+		return -EINVAL;
+	}
+
+	/* Allocate and initialize a new device structure instance */
+
+	dev = pipecommon_allocdev(bufsize);
+	if (!dev) {
+		return -ENOMEM;
+	}
+
+	ret = register_driver(pathname, &fifo_fops, mode, (void *)dev);
+	if (ret != 0) {
+		pipecommon_freedev(dev);
+	}
+
+	return ret;
+}
+
 /****************************************************************************
  * Name: mkfifo
  *
@@ -135,22 +179,7 @@ static const struct file_operations fifo_fops = {
 
 int mkfifo(FAR const char *pathname, mode_t mode)
 {
-	struct pipe_dev_s *dev;
-	int ret;
-
-	/* Allocate and initialize a new device structure instance */
-
-	dev = pipecommon_allocdev();
-	if (!dev) {
-		return -ENOMEM;
-	}
-
-	ret = register_driver(pathname, &fifo_fops, mode, (void *)dev);
-	if (ret != 0) {
-		pipecommon_freedev(dev);
-	}
-
-	return ret;
+	return mkfifo2(pathname, mode, CONFIG_DEV_PIPE_SIZE);
 }
 
 #endif							/* CONFIG_DEV_PIPE_SIZE > 0 */
@@ -231,7 +231,7 @@ int pipe(int fd[2])
 	if ((g_pipecreated & (1 << pipeno)) == 0) {
 		/* No.. Allocate and initialize a new device structure instance */
 
-		dev = pipecommon_allocdev();
+		dev = pipecommon_allocdev(CONFIG_DEV_PIPE_SIZE);
 		if (!dev) {
 			(void)sem_post(&g_pipesem);
 			err = ENOMEM;
@@ -66,6 +66,7 @@
 #include <sched.h>
 #include <semaphore.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -153,6 +154,243 @@ static void pipecommon_pollnotify(FAR struct pipe_dev_s *dev, pollevent_t events
 #define pipecommon_pollnotify(dev, event)
 #endif
 
+/****************************************************************************
+ * Name: pipecommon_rdsegment
+ *
+ * Description:
+ *   Return the number of bytes that can be read from d_rdndx onward
+ *   without wrapping around the end of the buffer.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_rdsegment(FAR struct pipe_dev_s *dev)
+{
+	if (dev->d_wrndx >= dev->d_rdndx) {
+		return dev->d_wrndx - dev->d_rdndx;
+	}
+
+	return dev->d_bufsize - dev->d_rdndx;
+}
+
+/****************************************************************************
+ * Name: pipecommon_wrsegment
+ *
+ * Description:
+ *   Return the number of bytes that can be written from d_wrndx onward
+ *   without wrapping around the end of the buffer.  One byte is always left
+ *   free so that a full buffer can be told from an empty one.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_wrsegment(FAR struct pipe_dev_s *dev)
+{
+	if (dev->d_rdndx > dev->d_wrndx) {
+		return dev->d_rdndx - dev->d_wrndx - 1;
+	}
+
+	if (dev->d_rdndx == 0) {
+		return dev->d_bufsize - dev->d_wrndx - 1;
+	}
+
+	return dev->d_bufsize - dev->d_wrndx;
+}
+
+/****************************************************************************
+ * Name: pipecommon_splice
+ *
+ * Description:
+ *   Move the data buffered in the pipe out to another descriptor
+ *   (PIPEIOC_SPLICEOUT), or data read from another descriptor into the free
+ *   space of the pipe (PIPEIOC_SPLICEIN).  The ringbuffer segments are
+ *   passed to write() or read() of the other descriptor as they are, at
+ *   most two per pass around the buffer, without a copy in between.
+ *
+ *   The other descriptor may block, so d_bfsem is not held across its I/O.
+ *   Instead PIPE_FLAG_SPLICEOUT keeps readers from consuming, and
+ *   PIPE_FLAG_SPLICEIN keeps writers from filling, the segment in flight.
+ *   They wait as on an empty or a full pipe.  Only what is buffered, or
+ *   what fits, at the time is moved; the pipe end is never waited for.
+ *
+ ****************************************************************************/
+
+static int pipecommon_splice(FAR struct file *filep, FAR struct pipe_dev_s *dev, int cmd, FAR struct pipe_splice_s *splice)
+{
+#if CONFIG_NFILE_DESCRIPTORS > 0
+	FAR struct file *other;
+#endif
+	FAR uint8_t *segment;
+	uint8_t flag;
+	size_t nmoved = 0;
+	size_t nbytes;
+	ssize_t ret = 0;
+	int sval;
+
+	if (splice == NULL) {
+		return -EINVAL;
+	}
+
+	if (cmd == PIPEIOC_SPLICEOUT ? (filep->f_oflags & O_RDOK) == 0 : (filep->f_oflags & O_WROK) == 0) {
+		return -EBADF;
+	}
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+	/* Splicing the pipe to itself would only move its data in a circle */
+
+	if ((unsigned int)splice->fd < CONFIG_NFILE_DESCRIPTORS && fs_getfilep(splice->fd, &other) == OK && other->f_inode == filep->f_inode) {
+		return -EINVAL;
+	}
+#endif
+
+	flag = cmd == PIPEIOC_SPLICEOUT ? PIPE_FLAG_SPLICEOUT : PIPE_FLAG_SPLICEIN;
+
+	while (nmoved < splice->len) {
+		pipecommon_semtake(&dev->d_bfsem);
+
+		if (dev->d_buffer == NULL) {
+			sem_post(&dev->d_bfsem);
+			ret = -EBADF;
+			break;
+		}
+
+		/* One splice at a time in each direction */
+
+		if (dev->d_flags & flag) {
+			sem_post(&dev->d_bfsem);
+			ret = -EBUSY;
+			break;
+		}
+
+		if (cmd == PIPEIOC_SPLICEIN) {
+			nbytes  = pipecommon_wrsegment(dev);
+			segment = &dev->d_buffer[dev->d_wrndx];
+		} else {
+			nbytes  = pipecommon_rdsegment(dev);
+			segment = &dev->d_buffer[dev->d_rdndx];
+		}
+
+		if (nbytes > splice->len - nmoved) {
+			nbytes = splice->len - nmoved;
+		}
+
+		if (nbytes == 0) {
+			sem_post(&dev->d_bfsem);
+			break;
+		}
+
+		dev->d_flags |= flag;
+		sem_post(&dev->d_bfsem);
+
+		if (cmd == PIPEIOC_SPLICEIN) {
+			ret = read(splice->fd, segment, nbytes);
+		} else {
+			ret = write(splice->fd, segment, nbytes);
+		}
+
+		if (ret < 0) {
+			ret = -get_errno();
+		}
+
+		pipecommon_semtake(&dev->d_bfsem);
+		dev->d_flags &= ~flag;
+
+		if (cmd == PIPEIOC_SPLICEIN) {
+			if (ret > 0) {
+				dev->d_wrndx += ret;
+				if (dev->d_wrndx >= dev->d_bufsize) {
+					dev->d_wrndx = 0;
+				}
+
+				pipecommon_pollnotify(dev, POLLIN);
+			}
+		} else {
+			if (ret > 0) {
+				dev->d_rdndx += ret;
+				if (dev->d_rdndx >= dev->d_bufsize) {
+					dev->d_rdndx = 0;
+				}
+
+				pipecommon_pollnotify(dev, POLLOUT);
+			}
+		}
+
+		/* Wake up the readers and the writers, for the data moved or because
+		 * they were held off
+		 */
+
+		while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0) {
+			sem_post(&dev->d_rdsem);
+		}
+
+		while (sem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0) {
+			sem_post(&dev->d_wrsem);
+		}
+
+		sem_post(&dev->d_bfsem);
+
+		if (ret <= 0) {
+			break;
+		}
+
+		nmoved += ret;
+		if ((size_t)ret < nbytes) {
+			break;
+		}
+	}
+
+	return nmoved > 0 ? (int)nmoved : (int)ret;
+}
+
+/****************************************************************************
+ * Name: pipecommon_setsize
+ *
+ * Description:
+ *   Give an empty pipe a ringbuffer of 'bufsize' bytes
+ *
+ ****************************************************************************/
+
+static int pipecommon_setsize(FAR struct pipe_dev_s *dev, unsigned long bufsize)
+{
+	FAR uint8_t *buffer = NULL;
+	int sval;
+
+	if (bufsize < 2 || bufsize > CONFIG_DEV_PIPE_MAXSIZE) {
+		return -EINVAL;
+	}
+
+	pipecommon_semtake(&dev->d_bfsem);
+
+	if (dev->d_wrndx != dev->d_rdndx || (dev->d_flags & (PIPE_FLAG_SPLICEOUT | PIPE_FLAG_SPLICEIN)) != 0) {
+		sem_post(&dev->d_bfsem);
+		return -EBUSY;
+	}
+
+	/* A buffer that is not allocated yet gets the size when it is */
+
+	if (dev->d_buffer) {
+		buffer = (FAR uint8_t *)kmm_malloc(bufsize);
+		if (buffer == NULL) {
+			sem_post(&dev->d_bfsem);
+			return -ENOMEM;
+		}
+
+		kmm_free(dev->d_buffer);
+		dev->d_buffer = buffer;
+	}
+
+	dev->d_bufsize = bufsize;
+	dev->d_wrndx   = 0;
+	dev->d_rdndx   = 0;
+
+	/* Writers waiting for room may fit now */
+
+	while (sem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0) {
+		sem_post(&dev->d_wrsem);
+	}
+
+	sem_post(&dev->d_bfsem);
+	return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -161,7 +399,7 @@ static void pipecommon_pollnotify(FAR struct pipe_dev_s *dev, pollevent_t events
  * Name: pipecommon_allocdev
  ****************************************************************************/
 
-FAR struct pipe_dev_s *pipecommon_allocdev(void)
+FAR struct pipe_dev_s *pipecommon_allocdev(size_t bufsize)
 {
 	struct pipe_dev_s *dev;
 
@@ -172,6 +410,7 @@ FAR struct pipe_dev_s *pipecommon_allocdev(void)
 		/* Initialize the private structure */
 
 		memset(dev, 0, sizeof(struct pipe_dev_s));
+		dev->d_bufsize = bufsize;
 		sem_init(&dev->d_bfsem, 0, 1);
 		sem_init(&dev->d_rdsem, 0, 0);
 		sem_init(&dev->d_wrsem, 0, 0);
@@ -229,7 +468,7 @@ int pipecommon_open(FAR struct file *filep)
 	 */
 
 	if (dev->d_refs == 0 && dev->d_buffer == NULL) {
-		dev->d_buffer = (uint8_t *)kmm_malloc(CONFIG_DEV_PIPE_SIZE);
+		dev->d_buffer = (uint8_t *)kmm_malloc(dev->d_bufsize);
 		if (!dev->d_buffer) {
 			(void)sem_post(&dev->d_bfsem);
 			return -ENOMEM;
@@ -401,6 +640,7 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 	FAR uint8_t *start = (uint8_t *)buffer;
 #endif
 	ssize_t nread = 0;
+	size_t nbytes;
 	int sval;
 	int ret;
 
@@ -416,9 +656,11 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 		return ERROR;
 	}
 
-	/* If the pipe is empty, then wait for something to be written to it */
+	/* If the pipe is empty, then wait for something to be written to it.
+	 * While its data is spliced out, it is not there to be read either.
+	 */
 
-	while (dev->d_wrndx == dev->d_rdndx) {
+	while (dev->d_wrndx == dev->d_rdndx || (dev->d_flags & PIPE_FLAG_SPLICEOUT) != 0) {
 		/* If O_NONBLOCK was set, then return EGAIN */
 
 		if (filep->f_oflags & O_NONBLOCK) {
@@ -428,7 +670,7 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 
 		/* If there are no writers on the pipe, then return end of file */
 
-		if (dev->d_nwriters <= 0) {
+		if (dev->d_nwriters <= 0 && dev->d_wrndx == dev->d_rdndx) {
 			sem_post(&dev->d_bfsem);
 			return 0;
 		}
@@ -445,15 +687,25 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 		}
 	}
 
-	/* Then return whatever is available in the pipe (which is at least one byte) */
+	/* Then return whatever is available in the pipe (which is at least one
+	 * byte), in at most two copies before and after the wrap.
+	 */
 
 	nread = 0;
 	while (nread < len && dev->d_wrndx != dev->d_rdndx) {
-		*buffer++ = dev->d_buffer[dev->d_rdndx];
-		if (++dev->d_rdndx >= CONFIG_DEV_PIPE_SIZE) {
+		nbytes = pipecommon_rdsegment(dev);
+		if (nbytes > len - nread) {
+			nbytes = len - nread;
+		}
+
+		memcpy(buffer, &dev->d_buffer[dev->d_rdndx], nbytes);
+		buffer += nbytes;
+		nread += nbytes;
+
+		dev->d_rdndx += nbytes;
+		if (dev->d_rdndx >= dev->d_bufsize) {
 			dev->d_rdndx = 0;
 		}
-		nread++;
 	}
 
 	/* Notify all waiting writers that bytes have been removed from the buffer */
@@ -481,7 +733,7 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer, size_t
 	struct pipe_dev_s *dev = inode->i_private;
 	ssize_t nwritten = 0;
 	ssize_t last;
-	int nxtwrndx;
+	size_t nbytes;
 	int sval;
 
 	DEBUGASSERT(dev);
@@ -514,24 +766,30 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer, size_t
 
 	last = 0;
 	for (;;) {
-		/* Calculate the write index AFTER the next byte is written */
+		/* How much fits before the buffer is full or the index wraps?  The
+		 * free space being spliced into counts as full.
+		 */
 
-		nxtwrndx = dev->d_wrndx + 1;
-		if (nxtwrndx >= CONFIG_DEV_PIPE_SIZE) {
-			nxtwrndx = 0;
-		}
+		nbytes = (dev->d_flags & PIPE_FLAG_SPLICEIN) != 0 ? 0 : pipecommon_wrsegment(dev);
+		if (nbytes > 0) {
+			/* Copy as much of the rest as fits */
 
-		/* Would the next write overflow the circular buffer? */
+			if (nbytes > len - nwritten) {
+				nbytes = len - nwritten;
+			}
 
-		if (nxtwrndx != dev->d_rdndx) {
-			/* No... copy the byte */
+			memcpy(&dev->d_buffer[dev->d_wrndx], buffer, nbytes);
+			buffer += nbytes;
+			nwritten += nbytes;
 
-			dev->d_buffer[dev->d_wrndx] = *buffer++;
-			dev->d_wrndx = nxtwrndx;
+			dev->d_wrndx += nbytes;
+			if (dev->d_wrndx >= dev->d_bufsize) {
+				dev->d_wrndx = 0;
+			}
 
 			/* Is the write complete? */
 
-			if (++nwritten >= len) {
+			if (nwritten >= len) {
 				/* Yes.. Notify all of the waiting readers that more data is available */
 
 				while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0) {
@@ -548,7 +806,7 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer, size_t
 				return len;
 			}
 		} else {
-			/* There is not enough room for the next byte. Was anything written in this pass? */
+			/* The buffer is full. Was anything written in this pass? */
 
 			if (last < nwritten) {
 				/* Yes.. Notify all of the waiting readers that more data is available */
@@ -631,13 +889,13 @@ int pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
 		if (dev->d_wrndx >= dev->d_rdndx) {
 			nbytes = dev->d_wrndx - dev->d_rdndx;
 		} else {
-			nbytes = (CONFIG_DEV_PIPE_SIZE - 1) + dev->d_wrndx - dev->d_rdndx;
+			nbytes = dev->d_bufsize + dev->d_wrndx - dev->d_rdndx;
 		}
 
 		/* Notify the POLLOUT event if the pipe is not full */
 
 		eventset = 0;
-		if (nbytes < (CONFIG_DEV_PIPE_SIZE - 1)) {
+		if (nbytes < (dev->d_bufsize - 1)) {
 			eventset |= POLLOUT;
 		}
 
@@ -684,9 +942,8 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 	FAR struct inode *inode = filep->f_inode;
 	FAR struct pipe_dev_s *dev = inode->i_private;
 
-	/* Only one command supported */
-
-	if (cmd == PIPEIOC_POLICY) {
+	switch (cmd) {
+	case PIPEIOC_POLICY:
 		if (arg != 0) {
 			PIPE_POLICY_1(dev->d_flags);
 		} else {
@@ -694,6 +951,16 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 		}
 
 		return OK;
+
+	case PIPEIOC_SPLICEOUT:
+	case PIPEIOC_SPLICEIN:
+		return pipecommon_splice(filep, dev, cmd, (FAR struct pipe_splice_s *)((uintptr_t)arg));
+
+	case PIPEIOC_SETSIZE:
+		return pipecommon_setsize(dev, arg);
+
+	default:
+		break;
 	}
 
 	return -ENOTTY;
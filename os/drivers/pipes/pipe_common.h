@@ -68,6 +68,14 @@
 #define CONFIG_DEV_PIPE_SIZE 1024
 #endif
 
+#ifndef CONFIG_DEV_PIPE_MAXSIZE
+#define CONFIG_DEV_PIPE_MAXSIZE CONFIG_DEV_PIPE_SIZE
+#endif
+
+#if CONFIG_DEV_PIPE_MAXSIZE < CONFIG_DEV_PIPE_SIZE
+#error "CONFIG_DEV_PIPE_MAXSIZE must not be smaller than CONFIG_DEV_PIPE_SIZE"
+#endif
+
 #if CONFIG_DEV_PIPE_SIZE > 0
 
 /****************************************************************************
@@ -88,6 +96,8 @@
 
 #define PIPE_FLAG_POLICY    (1 << 0)	/* Bit 0: Policy=Free buffer when empty */
 #define PIPE_FLAG_UNLINKED  (1 << 1)	/* Bit 1: The driver has been unlinked */
+#define PIPE_FLAG_SPLICEOUT (1 << 2)	/* Bit 2: Buffered data is being spliced out */
+#define PIPE_FLAG_SPLICEIN  (1 << 3)	/* Bit 3: Free space is being spliced into */
 
 #define PIPE_POLICY_0(f)    do { (f) &= ~PIPE_FLAG_POLICY; } while (0)
 #define PIPE_POLICY_1(f)    do { (f) |= PIPE_FLAG_POLICY; } while (0)
@@ -101,11 +111,11 @@
  * Public Types
  ****************************************************************************/
 
-/* Make the buffer index as small as possible for the configured pipe size */
+/* Make the buffer index as small as possible for the largest pipe size */
 
-#if CONFIG_DEV_PIPE_SIZE > 65535
+#if CONFIG_DEV_PIPE_MAXSIZE > 65535
 typedef uint32_t pipe_ndx_t;	/* 32-bit index */
-#elif CONFIG_DEV_PIPE_SIZE > 255
+#elif CONFIG_DEV_PIPE_MAXSIZE > 255
 typedef uint16_t pipe_ndx_t;	/* 16-bit index */
 #else
 typedef uint8_t pipe_ndx_t;		/*  8-bit index */
@@ -122,6 +132,7 @@ struct pipe_dev_s {
 	sem_t d_wrsem;				/* Full buffer - Writer waits for data read */
 	pipe_ndx_t d_wrndx;			/* Index in d_buffer to save next byte written */
 	pipe_ndx_t d_rdndx;			/* Index in d_buffer to return the next byte read */
+	pipe_ndx_t d_bufsize;		/* Size of d_buffer in bytes */
 	uint8_t d_refs;				/* References counts on pipe (limited to 255) */
 	uint8_t d_nwriters;			/* Number of reference counts for write access */
 	uint8_t d_pipeno;			/* Pipe minor number */
@@ -152,7 +163,7 @@ extern "C" {
 struct file;					/* Forward reference */
 struct inode;					/* Forward reference */
 
-FAR struct pipe_dev_s *pipecommon_allocdev(void);
+FAR struct pipe_dev_s *pipecommon_allocdev(size_t bufsize);
 void pipecommon_freedev(FAR struct pipe_dev_s *dev);
 int pipecommon_open(FAR struct file *filep);
 int pipecommon_close(FAR struct file *filep);
@@ -33,6 +33,7 @@
 #include <debug.h>
 #include <tinyara/lwnl/lwnl.h>
 #include <tinyara/kthread.h>
+#include <tinyara/kmalloc.h>
 #include <tinyara/netmgr/netdev_mgr.h>
 #include <tinyara/net/if/wifi.h>
 #include "vdev_handler.h"
@@ -55,6 +56,9 @@ static trwifi_result_e vdev_set_autoconnect(struct netdev *dev, uint8_t check);
 static trwifi_result_e vdev_drv_ioctl(struct netdev *dev, trwifi_msg_s *msg);
 
 static int vdev_linkoutput(struct netdev *dev, void *buf, uint16_t dlen);
+#ifdef CONFIG_NET_NETMGR_SG
+static int vdev_linkoutput_sg(struct netdev *dev, const struct iovec *iov, int iovcnt, uint16_t dlen);
+#endif
 static int vdev_set_multicast_list(struct netdev *dev, const struct in_addr *group, netdev_mac_filter_action action);
 
 /****************************************************************************
@@ -76,6 +80,10 @@ static struct trwifi_ops g_trwifi_drv_ops = {
 
 struct netdev *g_vwifi_dev = NULL;
 static uint8_t g_hwaddr[IFHWADDRLEN] = {0x0e, 0x04, 0x96, 0x1d, 0xb3, 0xb0};
+#ifdef CONFIG_NET_NETMGR_SG
+/* frame gathered from the segments, as a NIC would with its DMA descriptors */
+static uint8_t g_vdev_txframe[CONFIG_NET_ETH_MTU + 14];
+#endif
 
 extern void vwifi_handle_packet(uint8_t *buf, uint32_t len);
 extern void vwifi_initialize_scan(void);
@@ -223,6 +231,9 @@ int _vwifi_create_msgqueue(int *fd)
 static struct netdev* vdev_register_dev(void)
 {
 	struct nic_io_ops nops = {vdev_linkoutput, vdev_set_multicast_list};
+#ifdef CONFIG_NET_NETMGR_SG
+	nops.linkoutput_sg = vdev_linkoutput_sg;
+#endif
 	struct netdev_config nconfig;
 	nconfig.ops = &nops;
 	nconfig.flag = NM_FLAG_ETHARP | NM_FLAG_ETHERNET | NM_FLAG_BROADCAST | NM_FLAG_IGMP;
@@ -298,6 +309,13 @@ void vwifi_start(void)
 	return;
 }
 
+#ifdef CONFIG_NET_NETMGR_SG
+static void vdev_release_frame(struct netdev *dev, void *data)
+{
+	kmm_free(data);
+}
+#endif
+
 void vwifi_send_packet(uint8_t *buf, uint32_t len)
 {
 	VWIFI_LOG("send packet %d\n", len);
@@ -305,6 +323,20 @@ void vwifi_send_packet(uint8_t *buf, uint32_t len)
 		VWIFI_ERROR(0);
 		return;
 	}
+#ifdef CONFIG_NET_NETMGR_SG
+	/* packets are built in static buffers, move them to a receive buffer
+	 * which lwIP can hold until it releases it. This only exercises
+	 * netdev_input_ref(), the copy makes it no cheaper than netdev_input().
+	 */
+	uint8_t *frame = (uint8_t *)kmm_malloc(len);
+	if (frame) {
+		memcpy(frame, buf, len);
+		if (netdev_input_ref(g_vwifi_dev, frame, len, vdev_release_frame) == 0) {
+			return;
+		}
+		kmm_free(frame);
+	}
+#endif
 	netdev_input(g_vwifi_dev, buf, len);
 }
 
@@ -469,6 +501,27 @@ int vdev_linkoutput(struct netdev *dev, void *buf, uint16_t dlen)
 	return 0;
 }
 
+#ifdef CONFIG_NET_NETMGR_SG
+/* The virtual device gathers the iovec into its own frame buffer, a real
+ * driver would hand it to its DMA engine instead.
+ */
+int vdev_linkoutput_sg(struct netdev *dev, const struct iovec *iov, int iovcnt, uint16_t dlen)
+{
+	VWIFI_ENTRY;
+	uint32_t offset = 0;
+	if (dlen > sizeof(g_vdev_txframe)) {
+		VWIFI_ERROR(dlen);
+		return -1;
+	}
+	for (int i = 0; i < iovcnt; i++) {
+		memcpy(&g_vdev_txframe[offset], iov[i].iov_base, iov[i].iov_len);
+		offset += iov[i].iov_len;
+	}
+	vwifi_handle_packet(g_vdev_txframe, offset);
+	return 0;
+}
+#endif
+
 int vdev_set_multicast_list(struct netdev *dev, const struct in_addr *group,
 							netdev_mac_filter_action action)
 {
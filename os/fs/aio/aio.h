@@ -61,6 +61,8 @@
 
 #include <sys/types.h>
 #include <string.h>
+#include <signal.h>
+#include <semaphore.h>
 #include <aio.h>
 #include <queue.h>
 
@@ -90,6 +92,26 @@
 #error AIO needs file and/or socket descriptors
 #endif
 
+/* The worker priority is boosted and restored around each request only when
+ * the requests run on the low priority work queue.  The AIO worker pool
+ * boosts its own threads.
+ */
+
+#undef AIO_LPWORK_PI
+#if defined(CONFIG_PRIORITY_INHERITANCE) && !defined(CONFIG_FS_AIO_POOL)
+#define AIO_LPWORK_PI
+#endif
+
+/* Remove a request that has not been started from its worker queue.
+ * Returns a negated errno if it is no longer queued.
+ */
+
+#ifdef CONFIG_FS_AIO_POOL
+#define aio_unqueue(aioc) aio_pool_cancel(aioc)
+#else
+#define aio_unqueue(aioc) work_cancel(LPWORK, &(aioc)->aioc_work)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -115,6 +137,20 @@ struct aio_container_s {
 #endif
 };
 
+/* This structure is shared by the requests queued by one lio_listio() call
+ * and is referenced by the aio_priv field of their AIO control blocks.  The
+ * client is notified once, when the last request completes, instead of
+ * being sent SIGPOLL for each request.
+ */
+
+struct aio_batch_s {
+	sem_t ab_done;				/* Posted when the last request completes (LIO_WAIT) */
+	struct sigevent ab_sig;		/* Sent when the last request completes (LIO_NOWAIT) */
+	pid_t ab_pid;				/* ID of the client */
+	uint16_t ab_pending;		/* Requests not completed, +1 while queuing */
+	uint8_t ab_mode;			/* LIO_WAIT or LIO_NOWAIT */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -250,7 +286,8 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the low priority work queue, or on the
+ *   AIO worker pool if CONFIG_FS_AIO_POOL is selected.
  *
  * Input Parameters:
  *   arg - Worker argument.  In this case, a pointer to an instance of
@@ -283,5 +320,87 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker);
 
 int aio_signal(pid_t pid, FAR struct aiocb *aiocbp);
 
+/****************************************************************************
+ * Name: aio_read_worker/aio_write_worker
+ *
+ * Description:
+ *   Perform a queued aio_read() or aio_write() request on the worker
+ *   thread.
+ *
+ * Input Parameters:
+ *   arg - Worker argument.  In this case, a pointer to the AIO container
+ *     cast to void *.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aio_read_worker(FAR void *arg);
+void aio_write_worker(FAR void *arg);
+
+/****************************************************************************
+ * Name: aio_batch_done
+ *
+ * Description:
+ *   Account for the completion of one request of a lio_listio() batch and
+ *   notify the client if it was the last one.
+ *
+ * Input Parameters:
+ *   batch - The batch that the completed request belongs to
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aio_batch_done(FAR struct aio_batch_s *batch);
+
+#ifdef CONFIG_FS_AIO_POOL
+/****************************************************************************
+ * Name: aio_pool_initialize
+ *
+ * Description:
+ *   Initialize the AIO worker pool.  The worker threads are started when
+ *   the first request is queued.
+ *
+ ****************************************************************************/
+
+void aio_pool_initialize(void);
+
+/****************************************************************************
+ * Name: aio_pool_queue
+ *
+ * Description:
+ *   Queue a request on the AIO worker pool
+ *
+ * Input Parameters:
+ *   aioc   - The AIO container of the request
+ *   worker - The function that performs the request
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int aio_pool_queue(FAR struct aio_container_s *aioc, worker_t worker);
+
+/****************************************************************************
+ * Name: aio_pool_cancel
+ *
+ * Description:
+ *   Remove a request that no worker has started from the AIO worker pool
+ *
+ * Input Parameters:
+ *   aioc - The AIO container of the request
+ *
+ * Returned Value:
+ *   Zero (OK) if the request was removed; -ENOENT if it is not queued.
+ *
+ ****************************************************************************/
+
+int aio_pool_cancel(FAR struct aio_container_s *aioc);
+#endif
+
 #endif							/* CONFIG_FS_AIO */
 #endif							/* __FS_AIO_AIO_H */
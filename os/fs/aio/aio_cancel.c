@@ -170,10 +170,16 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 				 * first case.
 				 */
 
-				status = work_cancel(LPWORK, &aioc->aioc_work);
+				status = aio_unqueue(aioc);
 				if (status >= 0) {
 					aiocbp->aio_result = -ECANCELED;
 					ret = AIO_CANCELED;
+
+					/* A lio_listio() batch is still waiting for this request */
+
+					if (aiocbp->aio_priv) {
+						aio_batch_done((FAR struct aio_batch_s *)aiocbp->aio_priv);
+					}
 				} else {
 					ret = AIO_NOTCANCELED;
 				}
@@ -205,7 +211,7 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 				 * first case.
 				 */
 
-				status = work_cancel(LPWORK, &aioc->aioc_work);
+				status = aio_unqueue(aioc);
 
 				/* Remove the container from the list of pending transfers */
 
@@ -218,6 +224,10 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 					if (ret != AIO_NOTCANCELED) {
 						ret = AIO_CANCELED;
 					}
+
+					if (aiocbp->aio_priv) {
+						aio_batch_done((FAR struct aio_batch_s *)aiocbp->aio_priv);
+					}
 				} else {
 					ret = AIO_NOTCANCELED;
 				}
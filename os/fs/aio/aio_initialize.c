@@ -153,6 +153,10 @@ void aio_initialize(void)
 
 		dq_addlast(&g_aioc_alloc[i].aioc_link, &g_aioc_free);
 	}
+
+#ifdef CONFIG_FS_AIO_POOL
+	aio_pool_initialize();
+#endif
 }
 
 /****************************************************************************
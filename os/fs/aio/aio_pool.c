@@ -0,0 +1,510 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/aio/aio_pool.c
+ *
+ * The AIO worker pool runs the asynchronous I/O on threads of its own
+ * instead of the shared low priority work queue.  Queued requests wait in
+ * g_aio_ready, linked through the dq entry of their (otherwise unused)
+ * aioc_work.  A worker takes the oldest request whose file no other worker
+ * is transferring, then keeps taking the requests of that file until there
+ * are none left, so requests on one file are performed in queuing order
+ * while different files are transferred in parallel.
+ *
+ * Adjacent read or write requests on the same file, contiguous both in the
+ * file and in memory as lio_listio() callers typically queue them, are
+ * performed with a single transfer and the byte count is split between
+ * them afterwards.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <aio.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/fs/fs.h>
+#include <tinyara/kthread.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO_POOL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_FS_AIO_POOL_NTHREADS
+#define CONFIG_FS_AIO_POOL_NTHREADS 2
+#endif
+
+#ifndef CONFIG_FS_AIO_POOL_PRIORITY
+#define CONFIG_FS_AIO_POOL_PRIORITY 50
+#endif
+
+#ifndef CONFIG_FS_AIO_POOL_STACKSIZE
+#define CONFIG_FS_AIO_POOL_STACKSIZE 2048
+#endif
+
+#ifndef CONFIG_FS_AIO_POOL_MERGE
+#define CONFIG_FS_AIO_POOL_MERGE 8
+#endif
+
+#define AIOC_FROM_LINK(e) \
+	((FAR struct aio_container_s *)((FAR struct work_s *)(e))->arg)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct aio_worker_s {
+	pid_t aw_pid;				/* ID of the worker thread */
+	FAR struct file *aw_filep;	/* File being transferred, NULL if idle */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct aio_worker_s g_aio_workers[CONFIG_FS_AIO_POOL_NTHREADS];
+
+/* Requests not yet taken by a worker, in queuing order */
+
+static dq_queue_t g_aio_ready;
+
+/* Posted for each queued request.  A worker may take several requests per
+ * wakeup, so a wakeup can find nothing to do.
+ */
+
+static sem_t g_aio_readysem;
+
+static bool g_aio_started;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_pool_busy
+ *
+ * Description:
+ *   Check if a worker is transferring on 'filep'.
+ *
+ * Assumptions:
+ *   The caller holds aio_lock()
+ *
+ ****************************************************************************/
+
+static bool aio_pool_busy(FAR struct file *filep)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_FS_AIO_POOL_NTHREADS; i++) {
+		if (g_aio_workers[i].aw_filep == filep) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/****************************************************************************
+ * Name: aio_pool_next
+ *
+ * Description:
+ *   Return the oldest ready request on 'filep', or if 'filep' is NULL, the
+ *   oldest ready request on a file that no worker is transferring.
+ *
+ * Assumptions:
+ *   The caller holds aio_lock()
+ *
+ ****************************************************************************/
+
+static FAR struct aio_container_s *aio_pool_next(FAR struct file *filep)
+{
+	FAR struct aio_container_s *aioc;
+	FAR dq_entry_t *entry;
+
+	for (entry = dq_peek(&g_aio_ready); entry; entry = dq_next(entry)) {
+		aioc = AIOC_FROM_LINK(entry);
+		if (filep ? aioc->u.aioc_filep == filep : !aio_pool_busy(aioc->u.aioc_filep)) {
+			return aioc;
+		}
+	}
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: aio_pool_adjacent
+ *
+ * Description:
+ *   Check if 'next' continues the transfer of 'prev' both in the file and
+ *   in memory.
+ *
+ ****************************************************************************/
+
+static bool aio_pool_adjacent(FAR struct aio_container_s *prev, FAR struct aio_container_s *next)
+{
+	FAR struct aiocb *pcb = prev->aioc_aiocbp;
+	FAR struct aiocb *ncb = next->aioc_aiocbp;
+
+	return next->aioc_work.worker == prev->aioc_work.worker && pcb->aio_offset + (off_t)pcb->aio_nbytes == ncb->aio_offset && (FAR uint8_t *)pcb->aio_buf + pcb->aio_nbytes == (FAR uint8_t *)ncb->aio_buf;
+}
+
+/****************************************************************************
+ * Name: aio_pool_collect
+ *
+ * Description:
+ *   Take 'first' off the ready list, together with the requests on the same
+ *   file that directly follow it and are adjacent to it.
+ *
+ * Returned Value:
+ *   The number of requests in 'batch'
+ *
+ * Assumptions:
+ *   The caller holds aio_lock()
+ *
+ ****************************************************************************/
+
+static int aio_pool_collect(FAR struct aio_container_s *first, FAR struct aio_container_s **batch)
+{
+	FAR struct aio_container_s *aioc;
+	FAR dq_entry_t *entry;
+	FAR dq_entry_t *next;
+	int nbatch = 1;
+
+	batch[0] = first;
+	entry = dq_next(&first->aioc_work.dq);
+	dq_rem(&first->aioc_work.dq, &g_aio_ready);
+
+	if (first->aioc_work.worker != aio_read_worker && first->aioc_work.worker != aio_write_worker) {
+		return 1;
+	}
+
+	for (; entry && nbatch < CONFIG_FS_AIO_POOL_MERGE; entry = next) {
+		next = dq_next(entry);
+		aioc = AIOC_FROM_LINK(entry);
+		if (aioc->u.aioc_filep != first->u.aioc_filep) {
+			continue;
+		}
+
+		/* The next request on this file must not be passed over */
+
+		if (!aio_pool_adjacent(batch[nbatch - 1], aioc)) {
+			break;
+		}
+
+		dq_rem(entry, &g_aio_ready);
+		batch[nbatch++] = aioc;
+	}
+
+	return nbatch;
+}
+
+/****************************************************************************
+ * Name: aio_pool_merged
+ *
+ * Description:
+ *   Perform adjacent read or write requests with one transfer, then split
+ *   the byte count between them in order.
+ *
+ ****************************************************************************/
+
+static void aio_pool_merged(FAR struct aio_container_s **batch, int nbatch)
+{
+	FAR struct aiocb *aiocbp[CONFIG_FS_AIO_POOL_MERGE];
+	pid_t pid[CONFIG_FS_AIO_POOL_MERGE];
+	FAR struct file *filep = batch[0]->u.aioc_filep;
+	bool writing = (batch[0]->aioc_work.worker == aio_write_worker);
+	size_t total = 0;
+	ssize_t nbytes;
+	ssize_t result;
+	int i;
+
+	/* Decant all of the control blocks before starting the I/O, as the
+	 * single request workers do.
+	 */
+
+	for (i = 0; i < nbatch; i++) {
+		pid[i] = batch[i]->aioc_pid;
+		aiocbp[i] = aioc_decant(batch[i]);
+		total += aiocbp[i]->aio_nbytes;
+	}
+
+	if (!writing) {
+		nbytes = file_pread(filep, (FAR void *)aiocbp[0]->aio_buf, total, aiocbp[0]->aio_offset);
+	} else if ((filep->f_oflags & O_APPEND) != 0) {
+		nbytes = file_write(filep, (FAR const void *)aiocbp[0]->aio_buf, total);
+	} else {
+		nbytes = file_pwrite(filep, (FAR const void *)aiocbp[0]->aio_buf, total, aiocbp[0]->aio_offset);
+	}
+
+	if (nbytes < 0) {
+		int errcode = get_errno();
+		fdbg("ERROR: merged %s failed: %d\n", writing ? "pwrite" : "pread", errcode);
+		DEBUGASSERT(errcode > 0);
+		nbytes = -errcode;
+	}
+
+	for (i = 0; i < nbatch; i++) {
+		if (nbytes < 0) {
+			result = nbytes;
+		} else {
+			/* A short transfer ends in one of the requests, the ones after it
+			 * transferred nothing.
+			 */
+
+			result = (size_t)nbytes < aiocbp[i]->aio_nbytes ? nbytes : (ssize_t)aiocbp[i]->aio_nbytes;
+			nbytes -= result;
+		}
+
+		aiocbp[i]->aio_result = result;
+		(void)aio_signal(pid[i], aiocbp[i]);
+	}
+}
+
+/****************************************************************************
+ * Name: aio_pool_perform
+ *
+ * Description:
+ *   Perform a batch of requests taken by aio_pool_collect(), with the
+ *   priority of the highest priority client.
+ *
+ ****************************************************************************/
+
+static void aio_pool_perform(FAR struct aio_container_s **batch, int nbatch)
+{
+#ifdef CONFIG_PRIORITY_INHERITANCE
+	struct sched_param param;
+	int prio = CONFIG_FS_AIO_POOL_PRIORITY;
+	int i;
+
+	for (i = 0; i < nbatch; i++) {
+		if (batch[i]->aioc_prio > prio) {
+			prio = batch[i]->aioc_prio;
+		}
+	}
+
+	if (prio != CONFIG_FS_AIO_POOL_PRIORITY) {
+		param.sched_priority = prio;
+		(void)sched_setparam(0, &param);
+	}
+#endif
+
+	if (nbatch == 1) {
+		batch[0]->aioc_work.worker(batch[0]);
+	} else {
+		aio_pool_merged(batch, nbatch);
+	}
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+	if (prio != CONFIG_FS_AIO_POOL_PRIORITY) {
+		param.sched_priority = CONFIG_FS_AIO_POOL_PRIORITY;
+		(void)sched_setparam(0, &param);
+	}
+#endif
+}
+
+/****************************************************************************
+ * Name: aio_pool_thread
+ *
+ * Description:
+ *   The body of an AIO worker thread.  argv[1] is its index.
+ *
+ ****************************************************************************/
+
+static int aio_pool_thread(int argc, FAR char *argv[])
+{
+	FAR struct aio_worker_s *self = &g_aio_workers[atoi(argv[1])];
+	FAR struct aio_container_s *batch[CONFIG_FS_AIO_POOL_MERGE];
+	FAR struct aio_container_s *aioc;
+	int nbatch;
+
+	for (;;) {
+		while (sem_wait(&g_aio_readysem) < 0) {
+			DEBUGASSERT(get_errno() == EINTR);
+		}
+
+		aio_lock();
+		aioc = aio_pool_next(NULL);
+		if (aioc) {
+			/* Stay on this file until it has no ready request left */
+
+			self->aw_filep = aioc->u.aioc_filep;
+			do {
+				nbatch = aio_pool_collect(aioc, batch);
+				aio_unlock();
+
+				aio_pool_perform(batch, nbatch);
+
+				aio_lock();
+				aioc = aio_pool_next(self->aw_filep);
+			} while (aioc);
+
+			self->aw_filep = NULL;
+		}
+
+		aio_unlock();
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: aio_pool_start
+ *
+ * Description:
+ *   Start the worker threads.
+ *
+ * Assumptions:
+ *   The caller holds aio_lock()
+ *
+ ****************************************************************************/
+
+static int aio_pool_start(void)
+{
+	FAR char *argv[2];
+	char arg[4];
+	int i;
+
+	argv[0] = arg;
+	argv[1] = NULL;
+
+	for (i = 0; i < CONFIG_FS_AIO_POOL_NTHREADS; i++) {
+		if (g_aio_workers[i].aw_pid > 0) {
+			continue;
+		}
+
+		snprintf(arg, sizeof(arg), "%d", i);
+		g_aio_workers[i].aw_pid = kernel_thread("aio_worker", CONFIG_FS_AIO_POOL_PRIORITY, CONFIG_FS_AIO_POOL_STACKSIZE, aio_pool_thread, argv);
+		if (g_aio_workers[i].aw_pid < 0) {
+			int errcode = get_errno();
+			fdbg("ERROR: failed to start AIO worker %d: %d\n", i, errcode);
+			g_aio_workers[i].aw_pid = 0;
+
+			/* The workers already started can serve the requests */
+
+			return i > 0 ? OK : -errcode;
+		}
+	}
+
+	g_aio_started = true;
+	return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_pool_initialize
+ *
+ * Description:
+ *   Initialize the AIO worker pool.  The worker threads are started when
+ *   the first request is queued.
+ *
+ ****************************************************************************/
+
+void aio_pool_initialize(void)
+{
+	dq_init(&g_aio_ready);
+	sem_init(&g_aio_readysem, 0, 0);
+	sem_setprotocol(&g_aio_readysem, SEM_PRIO_NONE);
+}
+
+/****************************************************************************
+ * Name: aio_pool_queue
+ *
+ * Description:
+ *   Queue a request on the AIO worker pool
+ *
+ * Input Parameters:
+ *   aioc   - The AIO container of the request
+ *   worker - The function that performs the request
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int aio_pool_queue(FAR struct aio_container_s *aioc, worker_t worker)
+{
+	int ret = OK;
+
+	aio_lock();
+	if (!g_aio_started) {
+		ret = aio_pool_start();
+	}
+
+	if (ret == OK) {
+		aioc->aioc_work.worker = worker;
+		aioc->aioc_work.arg = aioc;
+		dq_addlast(&aioc->aioc_work.dq, &g_aio_ready);
+		sem_post(&g_aio_readysem);
+	}
+
+	aio_unlock();
+	return ret;
+}
+
+/****************************************************************************
+ * Name: aio_pool_cancel
+ *
+ * Description:
+ *   Remove a request that no worker has started from the AIO worker pool
+ *
+ * Input Parameters:
+ *   aioc - The AIO container of the request
+ *
+ * Returned Value:
+ *   Zero (OK) if the request was removed; -ENOENT if it is not queued.
+ *
+ ****************************************************************************/
+
+int aio_pool_cancel(FAR struct aio_container_s *aioc)
+{
+	FAR dq_entry_t *entry;
+	int ret = -ENOENT;
+
+	aio_lock();
+	for (entry = dq_peek(&g_aio_ready); entry; entry = dq_next(entry)) {
+		if (entry == &aioc->aioc_work.dq) {
+			dq_rem(entry, &g_aio_ready);
+			ret = OK;
+			break;
+		}
+	}
+
+	aio_unlock();
+	return ret;
+}
+
+#endif							/* CONFIG_FS_AIO_POOL */
@@ -91,7 +91,8 @@
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the low priority work queue, or on the
+ *   AIO worker pool if CONFIG_FS_AIO_POOL is selected.
  *
  * Input Parameters:
  *   arg - Worker argument.  In this case, a pointer to an instance of
@@ -107,7 +108,10 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
 {
 	int ret;
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef CONFIG_FS_AIO_POOL
+	ret = aio_pool_queue(aioc, worker);
+#else
+#ifdef AIO_LPWORK_PI
 	/* Prohibit context switches until we complete the queuing */
 
 	sched_lock();
@@ -122,6 +126,7 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
 	/* Schedule the work on the low priority worker thread */
 
 	ret = work_queue(LPWORK, &aioc->aioc_work, worker, aioc, 0);
+#endif
 	if (ret < 0) {
 		FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
 		DEBUGASSERT(aiocbp);
@@ -130,7 +135,7 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
 		set_errno(-ret);
 		ret = ERROR;
 	}
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_PI
 	/* Now the low-priority work queue might run at its new priority */
 
 	sched_unlock();
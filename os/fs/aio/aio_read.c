@@ -86,7 +86,7 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Private Functions
+ * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
@@ -105,12 +105,12 @@
  *
  ****************************************************************************/
 
-static void aio_read_worker(FAR void *arg)
+void aio_read_worker(FAR void *arg)
 {
 	FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
 	FAR struct aiocb *aiocbp;
 	pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_PI
 	uint8_t prio;
 #endif
 	ssize_t nread = 0;
@@ -122,7 +122,7 @@ static void aio_read_worker(FAR void *arg)
 
 	DEBUGASSERT(aioc && aioc->aioc_aiocbp);
 	pid = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_PI
 	prio = aioc->aioc_prio;
 #endif
 	aiocbp = aioc_decant(aioc);
@@ -156,17 +156,13 @@ static void aio_read_worker(FAR void *arg)
 
 	(void)aio_signal(pid, aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_PI
 	/* Restore the low priority worker thread default priority */
 
 	lpwork_restorepriority(prio);
 #endif
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: aio_read
  *
@@ -57,6 +57,7 @@
 #include <tinyara/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <sched.h>
 #include <signal.h>
 #include <aio.h>
@@ -139,6 +140,20 @@ int aio_signal(pid_t pid, FAR struct aiocb *aiocbp)
 		}
 	}
 
+	/* A request queued by lio_listio(LIO_WAIT) only counts down its batch,
+	 * the client is blocked in lio_listio() until the whole batch is done.
+	 */
+
+	if (aiocbp->aio_priv) {
+		FAR struct aio_batch_s *batch = (FAR struct aio_batch_s *)aiocbp->aio_priv;
+		bool lio_wait = (batch->ab_mode == LIO_WAIT);
+
+		aio_batch_done(batch);
+		if (lio_wait) {
+			goto out;
+		}
+	}
+
 	/* Send the poll signal in any event in case the caller is waiting
 	 * on sig_suspend();
 	 */
@@ -155,6 +170,7 @@ int aio_signal(pid_t pid, FAR struct aiocb *aiocbp)
 		ret = ERROR;
 	}
 
+out:
 	/* Make sure that errno is set correctly on return */
 
 	if (ret < 0) {
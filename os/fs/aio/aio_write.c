@@ -106,6 +106,10 @@ static inline int file_fcntl(FAR struct file *filep, int cmd, ...)
 }
 #endif
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
 /****************************************************************************
  * Name: aio_write_worker
  *
@@ -122,12 +126,12 @@ static inline int file_fcntl(FAR struct file *filep, int cmd, ...)
  *
  ****************************************************************************/
 
-static void aio_write_worker(FAR void *arg)
+void aio_write_worker(FAR void *arg)
 {
 	FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
 	FAR struct aiocb *aiocbp;
 	pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_PI
 	uint8_t prio;
 #endif
 	ssize_t nwritten = 0;
@@ -142,7 +146,7 @@ static void aio_write_worker(FAR void *arg)
 
 	DEBUGASSERT(aioc && aioc->aioc_aiocbp);
 	pid = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_PI
 	prio = aioc->aioc_prio;
 #endif
 	aiocbp = aioc_decant(aioc);
@@ -198,17 +202,13 @@ errout:
 
 	(void)aio_signal(pid, aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_PI
 	/* Restore the low priority worker thread default priority */
 
 	lpwork_restorepriority(prio);
 #endif
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: aio_write
  *
@@ -0,0 +1,421 @@
+/****************************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/aio/lio_listio.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <signal.h>
+#include <semaphore.h>
+#include <aio.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lio_submit
+ *
+ * Description:
+ *   Queue one LIO_READ or LIO_WRITE request of the batch.
+ *
+ * Returned Value:
+ *   Zero (OK) if the request was queued; otherwise ERROR with the result
+ *   of the request set.
+ *
+ ****************************************************************************/
+
+static int lio_submit(FAR struct aio_batch_s *batch, FAR struct aiocb *aiocbp)
+{
+	FAR struct aio_container_s *aioc;
+
+	aiocbp->aio_result = -EINPROGRESS;
+	aiocbp->aio_priv = batch;
+
+	aioc = aio_contain(aiocbp);
+	if (!aioc) {
+		aiocbp->aio_result = -get_errno();
+		aiocbp->aio_priv = NULL;
+		return ERROR;
+	}
+
+	aio_lock();
+	batch->ab_pending++;
+	aio_unlock();
+
+	if (aio_queue(aioc, aiocbp->aio_lio_opcode == LIO_READ ? aio_read_worker : aio_write_worker) < 0) {
+		/* aio_queue() has set the result */
+
+		fdbg("ERROR: aio_queue failed: %d\n", get_errno());
+		(void)aioc_decant(aioc);
+		aiocbp->aio_priv = NULL;
+
+		aio_lock();
+		batch->ab_pending--;
+		aio_unlock();
+		return ERROR;
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_batch_done
+ *
+ * Description:
+ *   Account for the completion of one request of a lio_listio() batch and
+ *   notify the client if it was the last one.
+ *
+ * Input Parameters:
+ *   batch - The batch that the completed request belongs to
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aio_batch_done(FAR struct aio_batch_s *batch)
+{
+	bool last;
+
+	aio_lock();
+	DEBUGASSERT(batch->ab_pending > 0);
+	last = (--batch->ab_pending == 0);
+	aio_unlock();
+
+	if (!last) {
+		return;
+	}
+
+	if (batch->ab_mode == LIO_WAIT) {
+		/* The batch lives on the stack of the waiting client */
+
+		sem_post(&batch->ab_done);
+		return;
+	}
+
+	if (batch->ab_sig.sigev_notify == SIGEV_SIGNAL) {
+#ifdef CONFIG_CAN_PASS_STRUCTS
+		(void)sigqueue(batch->ab_pid, batch->ab_sig.sigev_signo, batch->ab_sig.sigev_value);
+#else
+		(void)sigqueue(batch->ab_pid, batch->ab_sig.sigev_signo, batch->ab_sig.sigev_value.sival_ptr);
+#endif
+	}
+
+	kmm_free(batch);
+}
+
+/****************************************************************************
+ * Name: lio_listio
+ *
+ * Description:
+ *   The lio_listio() function initiates a list of I/O requests with a
+ *   single function call.
+ *
+ *   The 'mode' argument takes one of the values LIO_WAIT or LIO_NOWAIT
+ *   declared in <aio.h> and determines whether the function returns when
+ *   the I/O operations have been completed, or as soon as the operations
+ *   have been queued. If the 'mode' argument is LIO_WAIT, the function will
+ *   wait until all I/O is complete and the 'sig' argument will be ignored.
+ *
+ *   If the 'mode' argument is LIO_NOWAIT, the function will return
+ *   immediately, and asynchronous notification will occur, according to the
+ *   'sig' argument, when all the I/O operations complete. If 'sig' is NULL,
+ *   then no asynchronous notification will occur. If 'sig' is not NULL,
+ *   asynchronous notification occurs when all the requests in 'list' have
+ *   completed.
+ *
+ *   The I/O requests enumerated by 'list' are submitted in an unspecified
+ *   order.
+ *
+ *   The 'list' argument is an array of pointers to aiocb structures. The
+ *   array contains 'nent 'elements. The array may contain NULL elements,
+ *   which will be ignored.
+ *
+ *   If the buffer pointed to by 'list' or the aiocb structures pointed to
+ *   by the elements of the array 'list' become illegal addresses before all
+ *   asynchronous I/O completed and, if necessary, the notification is
+ *   sent, then the behavior is undefined. If the buffers pointed to by the
+ *   aio_buf member of the aiocb structure pointed to by the elements of
+ *   the array 'list' become illegal addresses prior to the asynchronous
+ *   I/O associated with that aiocb structure being completed, the behavior
+ *   is undefined.
+ *
+ *   The aio_lio_opcode field of each aiocb structure specifies the
+ *   operation to be performed. The supported operations are LIO_READ,
+ *   LIO_WRITE, and LIO_NOP; these symbols are defined in <aio.h>. The
+ *   LIO_NOP operation causes the list entry to be ignored. If the
+ *   aio_lio_opcode element is equal to LIO_READ, then an I/O operation is
+ *   submitted as if by a call to aio_read() with the aiocbp equal to the
+ *   address of the aiocb structure. If the aio_lio_opcode element is equal
+ *   to LIO_WRITE, then an I/O operation is submitted as if by a call to
+ *   aio_write() with the aiocbp equal to the address of the aiocb
+ *   structure.
+ *
+ *   The aio_fildes member specifies the file descriptor on which the
+ *   operation is to be performed.
+ *
+ *   The aio_buf member specifies the address of the buffer to or from which
+ *   the data is transferred.
+ *
+ *   The aio_nbytes member specifies the number of bytes of data to be
+ *   transferred.
+ *
+ *   The members of the aiocb structure further describe the I/O operation
+ *   to be performed, in a manner identical to that of the corresponding
+ *   aiocb structure when used by the aio_read() and aio_write() functions.
+ *
+ *   The 'nent' argument specifies how many elements are members of the list;
+ *   that is, the length of the array.
+ *
+ * Input Parameters:
+ *   mode - Either LIO_WAIT or LIO_NOWAIT
+ *   list - The list of I/O operations to be performed
+ *   nent - The number of elements in the list
+ *   sig  - Used to notify the caller when the I/O is performed
+ *          asynchronously.
+ *
+ * Returned Value:
+ *   If the mode argument has the value LIO_NOWAIT, the lio_listio()
+ *   function will return the value zero if the I/O operations are
+ *   successfully queued; otherwise, the function will return the value
+ *   -1 and set errno to indicate the error.
+ *
+ *   If the mode argument has the value LIO_WAIT, the lio_listio() function
+ *   will return the value zero when all the indicated I/O has completed
+ *   successfully. Otherwise, lio_listio() will return a value of -1 and
+ *   set errno to indicate the error.
+ *
+ *   In either case, the return value only indicates the success or failure
+ *   of the lio_listio() call itself, not the status of the individual I/O
+ *   requests. In some cases one or more of the I/O requests contained in
+ *   the list may fail. Failure of an individual request does not prevent
+ *   completion of any other individual request. To determine the outcome
+ *   of each I/O request, the application must examine the error status
+ *   associated with each aiocb control block. The error statuses so
+ *   returned are identical to those returned as the result of an aio_read()
+ *   or aio_write() function.
+ *
+ *   The lio_listio() function will fail if:
+ *
+ *     EAGAIN - The resources necessary to queue all the I/O requests were
+ *       not available. The application may check the error status for each
+ *       aiocb to determine the individual request(s) that failed.
+ *     EAGAIN - The number of entries indicated by 'nent' would cause the
+ *       system-wide limit {AIO_MAX} to be exceeded.
+ *     EINVAL - The mode argument is not a proper value, or the value of
+ *       'nent' was greater than {AIO_LISTIO_MAX}.
+ *     EIO - One or more of the individual I/O operations failed. The
+ *       application may check the error status for each aiocb structure to
+ *       determine the individual request(s) that failed.
+ *
+ *   In addition to the errors returned by the lio_listio() function, if the
+ *   lio_listio() function succeeds or fails with errors of EAGAIN or EIO,
+ *   then some of the I/O specified by the list may have been initiated.
+ *   If the lio_listio() function fails with an error code other than EAGAIN
+ *   or EIO, no operations from the list will have been initiated. The
+ *   I/O operation indicated by each list element can encounter errors specific
+ *   to the individual read or write function being performed. In this event,
+ *   the error status for each aiocb control block contains the associated
+ *   error code. The error codes that can be set are the same as would be
+ *   set by a read() or write() function, with the following additional
+ *   error codes possible:
+ *
+ *     EAGAIN - The requested I/O operation was not queued due to resource
+ *       limitations.
+ *     ECANCELED - The requested I/O was cancelled before the I/O completed
+ *       due to an explicit aio_cancel() request.
+ *     EFBIG - The aiocbp->aio_lio_opcode is LIO_WRITE, the file is a
+ *       regular file, aiocbp->aio_nbytes is greater than 0, and the
+ *       aiocbp->aio_offset is greater than or equal to the offset maximum
+ *       in the open file description associated with aiocbp->aio_fildes.
+ *     EINPROGRESS - The requested I/O is in progress.
+ *     EOVERFLOW - The aiocbp->aio_lio_opcode is LIO_READ, the file is a
+ *       regular file, aiocbp->aio_nbytes is greater than 0, and the
+ *       aiocbp->aio_offset is before the end-of-file and is greater than
+ *       or equal to the offset maximum in the open file description
+ *       associated with aiocbp->aio_fildes.
+ *
+ ****************************************************************************/
+
+int lio_listio(int mode, FAR struct aiocb *const list[], int nent, FAR struct sigevent *sig)
+{
+	FAR struct aio_batch_s *batch;
+	struct aio_batch_s waitbatch;
+	FAR struct aiocb *aiocbp;
+	int ret;
+	int i;
+
+	if ((mode != LIO_WAIT && mode != LIO_NOWAIT) || !list || nent < 0) {
+		set_errno(EINVAL);
+		return ERROR;
+	}
+
+	/* A LIO_WAIT caller waits for the batch, so it can live on the stack */
+
+	if (mode == LIO_WAIT) {
+		batch = &waitbatch;
+		memset(batch, 0, sizeof(struct aio_batch_s));
+		sem_init(&batch->ab_done, 0, 0);
+		sem_setprotocol(&batch->ab_done, SEM_PRIO_NONE);
+	} else {
+		batch = (FAR struct aio_batch_s *)kmm_zalloc(sizeof(struct aio_batch_s));
+		if (!batch) {
+			set_errno(EAGAIN);
+			return ERROR;
+		}
+
+		if (sig) {
+			batch->ab_sig = *sig;
+		} else {
+			batch->ab_sig.sigev_notify = SIGEV_NONE;
+		}
+	}
+
+	batch->ab_mode = mode;
+	batch->ab_pid = getpid();
+
+	/* Hold one count until the whole list is queued, so that the batch
+	 * cannot complete while it is being queued.
+	 */
+
+	batch->ab_pending = 1;
+	ret = OK;
+
+	/* Queue the whole list before any worker runs, so that the AIO worker
+	 * pool sees adjacent requests together and can merge them.
+	 */
+
+	sched_lock();
+	for (i = 0; i < nent; i++) {
+		/* Skip over NULL entries */
+
+		aiocbp = list[i];
+		if (!aiocbp) {
+			continue;
+		}
+
+		switch (aiocbp->aio_lio_opcode) {
+		case LIO_NOP:
+			aiocbp->aio_result = OK;
+			break;
+
+		case LIO_READ:
+		case LIO_WRITE:
+			if (lio_submit(batch, aiocbp) < 0) {
+				ret = ERROR;
+			}
+			break;
+
+		default:
+			fdbg("ERROR: Unrecognized opcode: %d\n", aiocbp->aio_lio_opcode);
+			aiocbp->aio_result = -EINVAL;
+			ret = ERROR;
+			break;
+		}
+	}
+
+	sched_unlock();
+
+	/* Drop the count held while queuing.  With LIO_NOWAIT, the batch may be
+	 * freed from here on.
+	 */
+
+	aio_batch_done(batch);
+
+	if (mode == LIO_WAIT) {
+		/* The batch is on this stack, so the wait cannot be interrupted */
+
+		while (sem_wait(&batch->ab_done) < 0) {
+			DEBUGASSERT(get_errno() == EINTR);
+		}
+
+		sem_destroy(&batch->ab_done);
+
+		for (i = 0; i < nent; i++) {
+			if (list[i]) {
+				list[i]->aio_priv = NULL;
+				if (list[i]->aio_result < 0) {
+					ret = ERROR;
+				}
+			}
+		}
+	}
+
+	if (ret < 0) {
+		set_errno(EIO);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+#endif							/* CONFIG_FS_AIO */
@@ -0,0 +1,1011 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/driver/mtd/ftl_log.c
+ *
+ * Log-structured FTL for NOR flash.  ftl.c rewrites a whole erase block for
+ * every partial erase block write.  Here sectors are never rewritten in
+ * place: each write programs the next free page of the active erase block
+ * and the logical to physical mapping is updated in RAM.  Erase blocks that
+ * only hold stale copies are reclaimed by garbage collection, which moves
+ * the still valid pages of the erase block with the fewest of them.
+ *
+ * The first page(s) of every erase block hold a summary:
+ *
+ *   uint32_t magic;               FTL_LOG_MAGIC once the block is in use
+ *   uint32_t seq;                 Order in which the blocks were opened
+ *   uint32_t lsector[ndata];      Logical sector of each data page
+ *
+ * An entry is programmed, by byte write into the erased summary, after its
+ * data page.  As in the dhara journal, the mapping is not stored but
+ * rebuilt at mount from the summaries, the copy in the block with the
+ * highest sequence number (and the latest page within it) winning.  A
+ * power loss leaves either the old or the new copy of a sector.  Pages
+ * that failed to program, or were found at mount without an entry, get
+ * FTL_LOG_DEAD entries.  Mount scans all entries of a block, so that the
+ * ones after a blank entry are found as well.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/ioctl.h>
+#include <tinyara/fs/mtd.h>
+
+#ifdef CONFIG_FTL_LOG
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FTL_LOG_MAGIC       0x474f4c46	/* "FLOG" */
+#define FTL_LOG_BLANK       0xffffffff	/* Erased summary entry */
+#define FTL_LOG_DEAD        0xfffffffe	/* Entry of a page that was skipped */
+#define FTL_LOG_UNMAPPED    0xffffffff	/* Logical sector never written */
+#define FTL_LOG_ERASEDVALUE 0xff
+#define FTL_LOG_HDRWORDS    2			/* magic and seq */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* RAM state of one erase block */
+
+struct ftl_logblock_s {
+	uint32_t seq;                  /* Sequence number, 0 if the block is free */
+	uint16_t valid;                /* Number of pages holding the current copy */
+	bool     erased;               /* true: Free and known to be erased */
+};
+
+struct ftl_log_s {
+	FAR struct mtd_dev_s *mtd;     /* Contained MTD interface */
+	struct mtd_geometry_s geo;     /* Device geometry */
+	sem_t                 exclsem; /* Serializes the accesses */
+	uint16_t              blkper;  /* R/W blocks per erase block */
+	uint16_t              hdrpages; /* Summary pages at the start of each erase block */
+	uint16_t              ndata;   /* Data pages per erase block */
+	uint16_t              pos;     /* Next data page of the active block */
+	int                   active;  /* Erase block being filled, -1 if none */
+	int                   lastblock; /* Last erase block opened */
+	size_t                nfree;   /* Number of free erase blocks */
+	size_t                nsectors; /* Number of logical sectors */
+	uint32_t              seq;     /* Sequence number of the next opened block */
+	FAR uint32_t         *map;     /* Logical sector -> R/W block */
+	FAR struct ftl_logblock_s *blocks; /* One per erase block */
+	FAR uint32_t         *summary; /* Summary pages of one erase block */
+	FAR uint32_t         *entries; /* Summary entries of the pages being written */
+	FAR uint8_t          *page;    /* One R/W block, for relocation */
+	struct ftl_logstat_s  stat;    /* Write amplification counters */
+	uint16_t              refs;    /* Number of references */
+	bool                  unlinked; /* The driver has been unlinked */
+	char                  name[16]; /* Block driver name */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     ftl_log_open(FAR struct inode *inode);
+static int     ftl_log_close(FAR struct inode *inode);
+static ssize_t ftl_log_read(FAR struct inode *inode, unsigned char *buffer, size_t start_sector, unsigned int nsectors);
+static ssize_t ftl_log_write(FAR struct inode *inode, const unsigned char *buffer, size_t start_sector, unsigned int nsectors);
+static int     ftl_log_geometry(FAR struct inode *inode, struct geometry *geometry);
+static int     ftl_log_ioctl(FAR struct inode *inode, int cmd, unsigned long arg);
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int     ftl_log_unlink(FAR struct inode *inode);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops = {
+	ftl_log_open,     /* open     */
+	ftl_log_close,    /* close    */
+	ftl_log_read,     /* read     */
+	ftl_log_write,    /* write    */
+	ftl_log_geometry, /* geometry */
+	ftl_log_ioctl     /* ioctl    */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+	, ftl_log_unlink  /* unlink   */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ftl_log_semtake
+ ****************************************************************************/
+
+static void ftl_log_semtake(FAR struct ftl_log_s *dev)
+{
+	while (sem_wait(&dev->exclsem) != OK) {
+		DEBUGASSERT(get_errno() == EINTR);
+	}
+}
+
+#define ftl_log_semgive(d) sem_post(&(d)->exclsem)
+
+/****************************************************************************
+ * Name: ftl_log_free
+ *
+ * Description: Free the device and its buffers
+ *
+ ****************************************************************************/
+
+static void ftl_log_free(FAR struct ftl_log_s *dev)
+{
+#ifdef CONFIG_MTD_REGISTRATION
+	/* /proc/mtd must not report the freed counters */
+
+	if (dev->mtd->ftlstat == &dev->stat) {
+		dev->mtd->ftlstat = NULL;
+	}
+#endif
+
+	if (dev->map) {
+		kmm_free(dev->map);
+	}
+
+	if (dev->blocks) {
+		kmm_free(dev->blocks);
+	}
+
+	if (dev->summary) {
+		kmm_free(dev->summary);
+	}
+
+	if (dev->entries) {
+		kmm_free(dev->entries);
+	}
+
+	if (dev->page) {
+		kmm_free(dev->page);
+	}
+
+	kmm_free(dev);
+}
+
+/****************************************************************************
+ * Name: ftl_log_ppn
+ *
+ * Description: R/W block of data page 'page' of erase block 'eb'
+ *
+ ****************************************************************************/
+
+static inline uint32_t ftl_log_ppn(FAR struct ftl_log_s *dev, int eb, int page)
+{
+	return (uint32_t)eb * dev->blkper + dev->hdrpages + page;
+}
+
+/****************************************************************************
+ * Name: ftl_log_erase
+ *
+ * Description: Erase a block and return it to the free blocks
+ *
+ ****************************************************************************/
+
+static int ftl_log_erase(FAR struct ftl_log_s *dev, int eb)
+{
+	int ret;
+
+	ret = MTD_ERASE(dev->mtd, eb, 1);
+	if (ret < 0) {
+		fdbg("ERROR: Erase block=%d failed: %d\n", eb, ret);
+		return ret;
+	}
+
+	dev->stat.erases++;
+	if (dev->blocks[eb].seq != 0) {
+		dev->nfree++;
+	}
+
+	dev->blocks[eb].seq    = 0;
+	dev->blocks[eb].valid  = 0;
+	dev->blocks[eb].erased = true;
+
+	if (eb == dev->active) {
+		dev->active = -1;
+		dev->pos    = dev->ndata;
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_newblock
+ *
+ * Description:
+ *   Open a free erase block as the active block.  The free blocks are taken
+ *   in turn, starting after the last one opened, to spread the erases.
+ *
+ ****************************************************************************/
+
+static int ftl_log_newblock(FAR struct ftl_log_s *dev)
+{
+	uint32_t hdr[FTL_LOG_HDRWORDS];
+	ssize_t nxfrd;
+	int eb;
+	int i;
+	int ret;
+
+	for (i = 1; i <= dev->geo.neraseblocks; i++) {
+		eb = (dev->lastblock + i) % dev->geo.neraseblocks;
+		if (dev->blocks[eb].seq == 0) {
+			break;
+		}
+	}
+
+	if (i > dev->geo.neraseblocks) {
+		return -ENOSPC;
+	}
+
+	if (!dev->blocks[eb].erased) {
+		ret = ftl_log_erase(dev, eb);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	hdr[0] = FTL_LOG_MAGIC;
+	hdr[1] = dev->seq;
+
+	nxfrd = MTD_WRITE(dev->mtd, (off_t)eb * dev->geo.erasesize, sizeof(hdr), (FAR const uint8_t *)hdr);
+	if (nxfrd != sizeof(hdr)) {
+		fdbg("ERROR: Write summary of block=%d failed: %d\n", eb, nxfrd);
+		return -EIO;
+	}
+
+	dev->blocks[eb].seq    = dev->seq++;
+	dev->blocks[eb].valid  = 0;
+	dev->blocks[eb].erased = false;
+	dev->nfree--;
+	dev->active    = eb;
+	dev->lastblock = eb;
+	dev->pos       = 0;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_skip
+ *
+ * Description:
+ *   Give up the next 'count' pages of the active block after a failed
+ *   program.  Their entries are marked dead so that mount goes on past
+ *   them.  If even that fails, the rest of the block is left unused.
+ *
+ ****************************************************************************/
+
+static void ftl_log_skip(FAR struct ftl_log_s *dev, int count)
+{
+	ssize_t nxfrd;
+	off_t offset;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		dev->entries[i] = FTL_LOG_DEAD;
+	}
+
+	offset = (off_t)dev->active * dev->geo.erasesize + (FTL_LOG_HDRWORDS + dev->pos) * sizeof(uint32_t);
+	nxfrd  = MTD_WRITE(dev->mtd, offset, count * sizeof(uint32_t), (FAR const uint8_t *)dev->entries);
+	if (nxfrd != count * sizeof(uint32_t)) {
+		fdbg("ERROR: Mark summary at %d dead failed: %d\n", offset, nxfrd);
+		dev->pos = dev->ndata;
+		return;
+	}
+
+	dev->pos += count;
+}
+
+/****************************************************************************
+ * Name: ftl_log_program
+ *
+ * Description:
+ *   Program 'count' pages from 'buffer' at the next free pages of the active
+ *   block, then their summary entries from dev->entries, and map them.  The
+ *   caller makes sure that the active block has room for them.
+ *
+ ****************************************************************************/
+
+static int ftl_log_program(FAR struct ftl_log_s *dev, FAR const uint8_t *buffer, int count)
+{
+	FAR uint32_t *lsector = dev->entries;
+	uint32_t ppn;
+	uint32_t old;
+	ssize_t nxfrd;
+	off_t offset;
+	int i;
+
+	DEBUGASSERT(dev->active >= 0 && dev->pos + count <= dev->ndata);
+
+	ppn   = ftl_log_ppn(dev, dev->active, dev->pos);
+	nxfrd = MTD_BWRITE(dev->mtd, ppn, count, buffer);
+	if (nxfrd != count) {
+		fdbg("ERROR: Write %d blocks at %d failed: %d\n", count, ppn, nxfrd);
+
+		/* The pages may be partially programmed, do not use them again */
+
+		ftl_log_skip(dev, count);
+		return -EIO;
+	}
+
+	offset = (off_t)dev->active * dev->geo.erasesize + (FTL_LOG_HDRWORDS + dev->pos) * sizeof(uint32_t);
+	nxfrd  = MTD_WRITE(dev->mtd, offset, count * sizeof(uint32_t), (FAR const uint8_t *)lsector);
+	if (nxfrd != count * sizeof(uint32_t)) {
+		fdbg("ERROR: Write summary at %d failed: %d\n", offset, nxfrd);
+		ftl_log_skip(dev, count);
+		return -EIO;
+	}
+
+	for (i = 0; i < count; i++, ppn++) {
+		old = dev->map[lsector[i]];
+		if (old != FTL_LOG_UNMAPPED) {
+			dev->blocks[old / dev->blkper].valid--;
+		}
+
+		dev->map[lsector[i]] = ppn;
+	}
+
+	dev->blocks[dev->active].valid += count;
+	dev->pos += count;
+	dev->stat.flashwrites += count;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_gc
+ *
+ * Description:
+ *   Reclaim the erase block with the fewest valid pages: move its valid
+ *   pages to the active block, opening a new one if they do not fit, and
+ *   erase it.
+ *
+ ****************************************************************************/
+
+static int ftl_log_gc(FAR struct ftl_log_s *dev)
+{
+	FAR uint32_t *lsector = &dev->summary[FTL_LOG_HDRWORDS];
+	uint32_t ppn;
+	ssize_t nxfrd;
+	int victim = -1;
+	int eb;
+	int i;
+	int ret;
+
+	/* The active block is a candidate only once it is full */
+
+	for (eb = 0; eb < dev->geo.neraseblocks; eb++) {
+		if (dev->blocks[eb].seq == 0 || (eb == dev->active && dev->pos < dev->ndata)) {
+			continue;
+		}
+
+		if (victim < 0 || dev->blocks[eb].valid < dev->blocks[victim].valid) {
+			victim = eb;
+		}
+	}
+
+	if (victim < 0) {
+		return -ENOSPC;
+	}
+
+	fvdbg("Reclaim block=%d valid=%d\n", victim, dev->blocks[victim].valid);
+
+	if (dev->blocks[victim].valid > dev->ndata - dev->pos) {
+		if (dev->nfree == 0) {
+			return -ENOSPC;
+		}
+
+		ret = ftl_log_newblock(dev);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	/* Read the summary of the victim to find its valid pages */
+
+	if (dev->blocks[victim].valid > 0) {
+		nxfrd = MTD_BREAD(dev->mtd, (off_t)victim * dev->blkper, dev->hdrpages, (FAR uint8_t *)dev->summary);
+		if (nxfrd != dev->hdrpages) {
+			fdbg("ERROR: Read summary of block=%d failed: %d\n", victim, nxfrd);
+			return -EIO;
+		}
+
+		for (i = 0; i < dev->ndata; i++) {
+			ppn = ftl_log_ppn(dev, victim, i);
+			if (lsector[i] >= dev->nsectors || dev->map[lsector[i]] != ppn) {
+				continue;
+			}
+
+			dev->entries[0] = lsector[i];
+			nxfrd = MTD_BREAD(dev->mtd, ppn, 1, dev->page);
+			if (nxfrd != 1) {
+				fdbg("ERROR: Read block %d failed: %d\n", ppn, nxfrd);
+				return -EIO;
+			}
+
+			ret = ftl_log_program(dev, dev->page, 1);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+
+	DEBUGASSERT(dev->blocks[victim].valid == 0);
+	return ftl_log_erase(dev, victim);
+}
+
+/****************************************************************************
+ * Name: ftl_log_reserve
+ *
+ * Description:
+ *   Make sure that the active block has at least one free page.  One free
+ *   erase block is kept for garbage collection.
+ *
+ ****************************************************************************/
+
+static int ftl_log_reserve(FAR struct ftl_log_s *dev)
+{
+	int ret = OK;
+
+	while (dev->pos >= dev->ndata && ret == OK) {
+		if (dev->nfree >= 2) {
+			ret = ftl_log_newblock(dev);
+		} else {
+			ret = ftl_log_gc(dev);
+		}
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: ftl_log_mount
+ *
+ * Description:
+ *   Rebuild the mapping and the block states from the summaries
+ *
+ ****************************************************************************/
+
+static int ftl_log_mount(FAR struct ftl_log_s *dev)
+{
+	FAR uint32_t *lsector = &dev->summary[FTL_LOG_HDRWORDS];
+	uint32_t seq;
+	uint32_t old;
+	size_t i;
+	ssize_t nxfrd;
+	int eb;
+	int last;
+	int j;
+
+	memset(dev->map, 0xff, dev->nsectors * sizeof(uint32_t));
+	dev->active    = -1;
+	dev->lastblock = -1;
+	dev->pos       = dev->ndata;
+	dev->nfree     = 0;
+	dev->seq       = 1;
+
+	for (eb = 0; eb < dev->geo.neraseblocks; eb++) {
+		dev->blocks[eb].seq    = 0;
+		dev->blocks[eb].valid  = 0;
+		dev->blocks[eb].erased = false;
+
+		nxfrd = MTD_BREAD(dev->mtd, (off_t)eb * dev->blkper, dev->hdrpages, (FAR uint8_t *)dev->summary);
+		if (nxfrd != dev->hdrpages) {
+			fdbg("ERROR: Read summary of block=%d failed: %d\n", eb, nxfrd);
+			return -EIO;
+		}
+
+		/* A block without a summary is free, it is erased before use */
+
+		if (dev->summary[0] != FTL_LOG_MAGIC || dev->summary[1] == 0) {
+			dev->nfree++;
+			continue;
+		}
+
+		seq = dev->summary[1];
+		dev->blocks[eb].seq = seq;
+		if (seq >= dev->seq) {
+			dev->seq       = seq + 1;
+			dev->active    = eb;
+			dev->lastblock = eb;
+		}
+
+		/* Blank entries may precede valid ones when a power loss hit
+		 * between a page and its entry, so all of them are scanned.
+		 */
+
+		for (j = 0, last = 0; j < dev->ndata; j++) {
+			if (lsector[j] == FTL_LOG_BLANK) {
+				continue;
+			}
+
+			/* Dead entries are out of range too */
+
+			last = j + 1;
+			if (lsector[j] >= dev->nsectors) {
+				continue;
+			}
+
+			old = dev->map[lsector[j]];
+			if (old == FTL_LOG_UNMAPPED || dev->blocks[old / dev->blkper].seq <= seq) {
+				dev->map[lsector[j]] = ftl_log_ppn(dev, eb, j);
+			}
+		}
+
+		if (eb == dev->active) {
+			dev->pos = last;
+		}
+	}
+
+	for (i = 0; i < dev->nsectors; i++) {
+		if (dev->map[i] != FTL_LOG_UNMAPPED) {
+			dev->blocks[dev->map[i] / dev->blkper].valid++;
+		}
+	}
+
+	/* A power loss may have left any number of pages after the last entry
+	 * programmed without their entries.  Mark them dead and continue after
+	 * the last page that is not erased.
+	 */
+
+	if (dev->active >= 0) {
+		last = dev->pos;
+		for (j = dev->ndata - 1; j >= dev->pos; j--) {
+			nxfrd = MTD_BREAD(dev->mtd, ftl_log_ppn(dev, dev->active, j), 1, dev->page);
+			if (nxfrd != 1) {
+				return -EIO;
+			}
+
+			for (i = 0; i < dev->geo.blocksize; i++) {
+				if (dev->page[i] != FTL_LOG_ERASEDVALUE) {
+					break;
+				}
+			}
+
+			if (i < dev->geo.blocksize) {
+				last = j + 1;
+				break;
+			}
+		}
+
+		if (last > dev->pos) {
+			ftl_log_skip(dev, last - dev->pos);
+		}
+	}
+
+	fvdbg("%u sectors, %u free blocks, active block=%d page=%d\n", dev->nsectors, dev->nfree, dev->active, dev->pos);
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_open
+ *
+ * Description: Open the block device
+ *
+ ****************************************************************************/
+
+static int ftl_log_open(FAR struct inode *inode)
+{
+	FAR struct ftl_log_s *dev;
+
+	fvdbg("Entry\n");
+	DEBUGASSERT(inode && inode->i_private);
+	dev = (FAR struct ftl_log_s *)inode->i_private;
+
+	ftl_log_semtake(dev);
+	dev->refs++;
+	ftl_log_semgive(dev);
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_close
+ *
+ * Description: close the block device
+ *
+ ****************************************************************************/
+
+static int ftl_log_close(FAR struct inode *inode)
+{
+	FAR struct ftl_log_s *dev;
+	bool release;
+
+	fvdbg("Entry\n");
+	DEBUGASSERT(inode && inode->i_private);
+	dev = (FAR struct ftl_log_s *)inode->i_private;
+
+	ftl_log_semtake(dev);
+	dev->refs--;
+	release = dev->refs == 0 && dev->unlinked;
+	ftl_log_semgive(dev);
+
+	if (release) {
+		sem_destroy(&dev->exclsem);
+		ftl_log_free(dev);
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_read
+ *
+ * Description:
+ *   Read the specified number of sectors.  Sectors that are consecutive on
+ *   the flash are read with one transfer, sectors never written read as
+ *   erased.
+ *
+ ****************************************************************************/
+
+static ssize_t ftl_log_read(FAR struct inode *inode, unsigned char *buffer, size_t start_sector, unsigned int nsectors)
+{
+	FAR struct ftl_log_s *dev;
+	FAR uint32_t *map;
+	ssize_t nxfrd;
+	size_t i;
+	size_t n;
+
+	fvdbg("sector: %d nsectors: %d\n", start_sector, nsectors);
+
+	DEBUGASSERT(inode && inode->i_private);
+	dev = (FAR struct ftl_log_s *)inode->i_private;
+
+	if (start_sector >= dev->nsectors) {
+		return -EINVAL;
+	}
+
+	if (nsectors > dev->nsectors - start_sector) {
+		nsectors = dev->nsectors - start_sector;
+	}
+
+	ftl_log_semtake(dev);
+	map = &dev->map[start_sector];
+	for (i = 0; i < nsectors; i += n) {
+		n = 1;
+		if (map[i] == FTL_LOG_UNMAPPED) {
+			while (i + n < nsectors && map[i + n] == FTL_LOG_UNMAPPED) {
+				n++;
+			}
+
+			memset(&buffer[i * dev->geo.blocksize], FTL_LOG_ERASEDVALUE, n * dev->geo.blocksize);
+			continue;
+		}
+
+		while (i + n < nsectors && map[i + n] == map[i] + n) {
+			n++;
+		}
+
+		nxfrd = MTD_BREAD(dev->mtd, map[i], n, &buffer[i * dev->geo.blocksize]);
+		if (nxfrd != n) {
+			fdbg("ERROR: Read %d blocks at %d failed: %d\n", n, map[i], nxfrd);
+			break;
+		}
+	}
+
+	ftl_log_semgive(dev);
+	return i > 0 ? (ssize_t)i : -EIO;
+}
+
+/****************************************************************************
+ * Name: ftl_log_write
+ *
+ * Description:
+ *   Write the specified number of sectors to the next free pages of the
+ *   log, as many as fit in the active block with each transfer
+ *
+ ****************************************************************************/
+
+static ssize_t ftl_log_write(FAR struct inode *inode, const unsigned char *buffer, size_t start_sector, unsigned int nsectors)
+{
+	FAR struct ftl_log_s *dev;
+	size_t done;
+	int count;
+	int ret = OK;
+	int i;
+
+	fvdbg("sector: %d nsectors: %d\n", start_sector, nsectors);
+
+	DEBUGASSERT(inode && inode->i_private);
+	dev = (FAR struct ftl_log_s *)inode->i_private;
+
+	if (start_sector >= dev->nsectors) {
+		return -EINVAL;
+	}
+
+	if (nsectors > dev->nsectors - start_sector) {
+		nsectors = dev->nsectors - start_sector;
+	}
+
+	ftl_log_semtake(dev);
+	for (done = 0; done < nsectors; done += count) {
+		ret = ftl_log_reserve(dev);
+		if (ret < 0) {
+			break;
+		}
+
+		count = dev->ndata - dev->pos;
+		if (count > nsectors - done) {
+			count = nsectors - done;
+		}
+
+		for (i = 0; i < count; i++) {
+			dev->entries[i] = start_sector + done + i;
+		}
+
+		ret = ftl_log_program(dev, &buffer[done * dev->geo.blocksize], count);
+		if (ret < 0) {
+			break;
+		}
+
+		dev->stat.hostwrites += count;
+	}
+
+	ftl_log_semgive(dev);
+	return done > 0 ? (ssize_t)done : ret;
+}
+
+/****************************************************************************
+ * Name: ftl_log_geometry
+ *
+ * Description: Return device geometry
+ *
+ ****************************************************************************/
+
+static int ftl_log_geometry(FAR struct inode *inode, struct geometry *geometry)
+{
+	FAR struct ftl_log_s *dev;
+
+	fvdbg("Entry\n");
+
+	DEBUGASSERT(inode);
+	if (geometry) {
+		dev = (FAR struct ftl_log_s *)inode->i_private;
+		geometry->geo_available     = true;
+		geometry->geo_mediachanged  = false;
+		geometry->geo_writeenabled  = true;
+		geometry->geo_nsectors      = dev->nsectors;
+		geometry->geo_sectorsize    = dev->geo.blocksize;
+
+		fvdbg("nsectors: %d sectorsize: %d\n",
+			  geometry->geo_nsectors, geometry->geo_sectorsize);
+
+		return OK;
+	}
+
+	return -EINVAL;
+}
+
+/****************************************************************************
+ * Name: ftl_log_ioctl
+ *
+ * Description: Pass the MTD ioctls to the contained MTD driver
+ *
+ ****************************************************************************/
+
+static int ftl_log_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+{
+	FAR struct ftl_log_s *dev;
+	int ret;
+
+	fvdbg("Entry\n");
+	DEBUGASSERT(inode && inode->i_private);
+	dev = (FAR struct ftl_log_s *)inode->i_private;
+
+	/* Sectors are not at a fixed place on the flash, they cannot be
+	 * executed in place.
+	 */
+
+	if (cmd == BIOC_XIPBASE || cmd == MTDIOC_XIPBASE) {
+		return -ENOTTY;
+	}
+
+	ftl_log_semtake(dev);
+	ret = MTD_IOCTL(dev->mtd, cmd, arg);
+	if (ret < 0) {
+		dbg("ERROR: MTD ioctl(%04x) failed: %d\n", cmd, ret);
+	} else if (cmd == MTDIOC_BULKERASE) {
+		/* Everything is erased, start from an empty log */
+
+		ret = ftl_log_mount(dev);
+	}
+
+	ftl_log_semgive(dev);
+	return ret;
+}
+
+/****************************************************************************
+ * Name: ftl_log_unlink
+ *
+ * Description:
+ *   Free the device once it is unlinked and closed.  The MTD is left as it
+ *   is, ftl_log_initialize() on it mounts the log again.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int ftl_log_unlink(FAR struct inode *inode)
+{
+	FAR struct ftl_log_s *dev;
+	bool release;
+
+	DEBUGASSERT(inode && inode->i_private);
+	dev = (FAR struct ftl_log_s *)inode->i_private;
+
+	ftl_log_semtake(dev);
+	dev->unlinked = true;
+	release = dev->refs == 0;
+	ftl_log_semgive(dev);
+
+	if (release) {
+		sem_destroy(&dev->exclsem);
+		ftl_log_free(dev);
+	}
+
+	return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ftl_log_initialize
+ *
+ * Description:
+ *   Initialize to provide a log-structured block driver wrapper around an
+ *   MTD interface.  The sectors are not stored at fixed places, so the MTD
+ *   cannot hold data written by other means (e.g. a ROMFS image).
+ *
+ * Input Parameters:
+ *   minor - The minor device number.  The MTD block device will be
+ *      registered as as /dev/mtdblockN where N is the minor number.
+ *   mtd - The MTD device that supports the FLASH interface.
+ *
+ ****************************************************************************/
+
+int ftl_log_initialize(int minor, FAR struct mtd_dev_s *mtd)
+{
+	FAR struct ftl_log_s *dev;
+	size_t sumsize;
+	int ret;
+
+	/* Sanity check */
+
+	if (minor < 0 || minor > 255 || !mtd) {
+		return -EINVAL;
+	}
+
+	/* Entries are programmed one at a time into the erased summary */
+
+	if (!mtd->write) {
+		dbg("ERROR: MTD does not support byte write\n");
+		return -ENOSYS;
+	}
+
+	/* Allocate a FTL device structure */
+
+	dev = (FAR struct ftl_log_s *)kmm_zalloc(sizeof(struct ftl_log_s));
+	if (!dev) {
+		return -ENOMEM;
+	}
+
+	dev->mtd = mtd;
+
+	ret = MTD_IOCTL(mtd, MTDIOC_GEOMETRY, (unsigned long)((uintptr_t)&dev->geo));
+	if (ret < 0) {
+		dbg("ERROR: MTD ioctl(MTDIOC_GEOMETRY) failed: %d\n", ret);
+		goto errout_with_dev;
+	}
+
+	/* Give the summary as many pages as it needs for the remaining ones */
+
+	dev->blkper = dev->geo.erasesize / dev->geo.blocksize;
+	DEBUGASSERT(dev->blkper * dev->geo.blocksize == dev->geo.erasesize);
+
+	for (dev->hdrpages = 1; dev->hdrpages < dev->blkper; dev->hdrpages++) {
+		sumsize = (FTL_LOG_HDRWORDS + dev->blkper - dev->hdrpages) * sizeof(uint32_t);
+		if (sumsize <= dev->hdrpages * dev->geo.blocksize) {
+			break;
+		}
+	}
+
+	dev->ndata = dev->blkper - dev->hdrpages;
+	if (dev->ndata == 0 || dev->geo.neraseblocks <= CONFIG_FTL_LOG_SPARE) {
+		dbg("ERROR: %d erase blocks of %d pages are too few\n", dev->geo.neraseblocks, dev->blkper);
+		ret = -EINVAL;
+		goto errout_with_dev;
+	}
+
+	/* Keep spare erase blocks so that garbage collection always finds an
+	 * erase block that is not entirely valid.
+	 */
+
+	dev->nsectors = (dev->geo.neraseblocks - CONFIG_FTL_LOG_SPARE) * dev->ndata;
+
+	dev->map     = (FAR uint32_t *)kmm_malloc(dev->nsectors * sizeof(uint32_t));
+	dev->blocks  = (FAR struct ftl_logblock_s *)kmm_zalloc(dev->geo.neraseblocks * sizeof(struct ftl_logblock_s));
+	dev->summary = (FAR uint32_t *)kmm_malloc(dev->hdrpages * dev->geo.blocksize);
+	dev->entries = (FAR uint32_t *)kmm_malloc(dev->ndata * sizeof(uint32_t));
+	dev->page    = (FAR uint8_t *)kmm_malloc(dev->geo.blocksize);
+	if (!dev->map || !dev->blocks || !dev->summary || !dev->entries || !dev->page) {
+		dbg("ERROR: Failed to allocate the mapping of %d sectors\n", dev->nsectors);
+		ret = -ENOMEM;
+		goto errout_with_dev;
+	}
+
+	sem_init(&dev->exclsem, 0, 1);
+
+	ret = ftl_log_mount(dev);
+	if (ret < 0) {
+		dbg("ERROR: Failed to scan the log: %d\n", ret);
+		goto errout_with_sem;
+	}
+
+	/* Create a MTD block device name */
+
+	snprintf(dev->name, sizeof(dev->name), "/dev/mtdblock%d", minor);
+
+	/* Inode private data is a reference to the FTL device structure */
+
+	ret = register_blockdriver(dev->name, &g_bops, 0, dev);
+	if (ret < 0) {
+		dbg("ERROR: register_blockdriver failed: %d\n", -ret);
+		goto errout_with_sem;
+	}
+
+#ifdef CONFIG_MTD_REGISTRATION
+	/* Report the write amplification in /proc/mtd */
+
+	mtd->ftlstat = &dev->stat;
+	if (!mtd->name) {
+		mtd_register(mtd, &dev->name[5]);
+	}
+#endif
+
+	return OK;
+
+errout_with_sem:
+	sem_destroy(&dev->exclsem);
+
+errout_with_dev:
+	ftl_log_free(dev);
+	return ret;
+}
+
+#endif /* CONFIG_FTL_LOG */
@@ -231,7 +231,20 @@ static ssize_t mtd_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
 		/* The provide the requested data */
 
 		do {
-			ret = snprintf(&buffer[total], buflen - total, "%-5d%s\n", priv->pnextmtd->mtdno, priv->pnextmtd->name);
+#ifdef CONFIG_FTL_LOG
+			FAR const struct ftl_logstat_s *stat = priv->pnextmtd->ftlstat;
+
+			/* Write amplification of a log-structured FTL, as a x.yy ratio */
+
+			if (stat && stat->hostwrites > 0) {
+				uint32_t wa = (uint32_t)((uint64_t)stat->flashwrites * 100 / stat->hostwrites);
+
+				ret = snprintf(&buffer[total], buflen - total, "%-5d%-12s host %u flash %u erase %u wa %u.%02u\n", priv->pnextmtd->mtdno, priv->pnextmtd->name, stat->hostwrites, stat->flashwrites, stat->erases, wa / 100, wa % 100);
+			} else
+#endif
+			{
+				ret = snprintf(&buffer[total], buflen - total, "%-5d%s\n", priv->pnextmtd->mtdno, priv->pnextmtd->name);
+			}
 
 			if (ret + total < buflen) {
 				total += ret;
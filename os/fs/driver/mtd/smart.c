@@ -68,6 +68,9 @@
 #include <string.h>
 #include <debug.h>
 #include <errno.h>
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+#include <semaphore.h>
+#endif
 
 #include <crc8.h>
 #include <crc16.h>
@@ -76,12 +79,16 @@
 #include <tinyara/irq.h>
 #endif
 #include <tinyara/math.h>
+#include <tinyara/clock.h>
 #include <tinyara/kmalloc.h>
 #include <tinyara/fs/fs.h>
 #include <tinyara/fs/ioctl.h>
 #include <tinyara/fs/mtd.h>
 #include <tinyara/fs/smart_procfs.h>
 #include <tinyara/fs/smart.h>
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+#include <tinyara/wqueue.h>
+#endif
 
 /****************************************************************************
  * Private Definitions
@@ -172,6 +179,23 @@
 #endif
 
 #define SMART_MAX_ALLOCS        6
+
+/* Packed map entry of an unmapped logical sector */
+
+#define SMART_PACKED_UNMAPPED   0x0FFF
+
+/* Maximum number of erase blocks relocated by the garbage collection of one
+ * write, unless the free sectors are down to the reserve.
+ */
+
+#ifndef CONFIG_MTD_SMART_GC_WRITE_BLOCKS
+#define CONFIG_MTD_SMART_GC_WRITE_BLOCKS 1
+#endif
+
+#ifndef CONFIG_MTD_SMART_GC_IDLE_MS
+#define CONFIG_MTD_SMART_GC_IDLE_MS 200
+#endif
+
 //#define CONFIG_MTD_SMART_PACK_COUNTS
 
 #ifndef CONFIG_MTD_SMART_ALLOC_DEBUG
@@ -179,6 +203,25 @@
 #define smart_free(d, p)        kmm_free(p)
 #endif
 
+#ifndef CONFIG_MTD_SMART_GC_BUCKETS
+#define smart_gc_update(d, b)
+#define smart_gc_rebuild(d)
+#endif
+
+#ifndef CONFIG_MTD_SMART_FREE_INDEX
+#define smart_free_take(d, s)
+#define smart_free_update(d, b)
+#define smart_free_reset(d, b, p)
+#define smart_free_rebuild(d)
+#endif
+
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+#define smart_semgive(d)        sem_post(&(d)->exclsem)
+#else
+#define smart_semtake(d)
+#define smart_semgive(d)
+#endif
+
 #define SMART_WEAR_FULL_RELOCATE_THRESHOLD  8
 #define SMART_WEAR_REORG_THRESHOLD          14
 #define SMART_WEAR_MIN_LEVEL                5
@@ -243,6 +286,7 @@ struct smart_cache_s {
 	uint16_t logical;			/* Logical sector number */
 	uint16_t physical;			/* Associated physical sector */
 	uint16_t birth;				/* The "birthday" of this entry */
+	uint16_t hnext;				/* Next entry with the same hash, 0xFFFF at the end */
 };
 #endif
 
@@ -268,6 +312,25 @@ struct smart_struct_s {
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 	uint32_t unusedsectors;		/* Count of unused sectors (i.e. free when erased) */
 	uint32_t blockerases;		/* Count of unused sectors (i.e. free when erased) */
+	uint32_t gcblocks;		/* Blocks collected while writing */
+	uint32_t gcidleblocks;		/* Blocks collected by the background worker */
+	uint32_t writehist[SMART_WRITE_HIST_NBUCKETS];	/* Log2 histogram of write latency in ms */
+#endif
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+	FAR uint16_t *gcnext;		/* Next block with the same release count */
+	FAR uint16_t *gcprev;		/* Previous block with the same release count */
+#endif
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	FAR uint8_t *freemap;		/* Bit set for each free physical sector */
+	FAR uint16_t *frnext;		/* Next block with the same free count */
+	FAR uint16_t *frprev;		/* Previous block with the same free count */
+	uint32_t allochits;		/* Sectors allocated through the index */
+	uint32_t allocscans;		/* Allocations which scanned the blocks */
+#endif
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+	sem_t exclsem;			/* Serializes the ioctls and the background worker */
+	struct work_s gcwork;		/* Background garbage collection work */
+	clock_t lastwrite;		/* Time of the last sector write or release */
 #endif
 	uint16_t neraseblocks;		/* Number of erase blocks or sub-sectors */
 	uint16_t lastallocblock;	/* Last  block we allocated a sector from */
@@ -303,15 +366,24 @@ struct smart_struct_s {
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
 	FAR struct smart_allocsector_s *allocsector;	/* Pointer to first alloc sector */
 #endif
+	uint32_t mapsize;		/* Bytes used by the sector map or cache */
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
 	FAR uint16_t *sMap;		/* Virtual to physical sector map */
+#ifdef CONFIG_MTD_SMART_MAP_PACKED
+	bool packedmap;			/* sMap holds 12-bit entries */
+#endif
 #else
 	FAR uint8_t *sBitMap;			/* Virtual sector used bit-map */
 	FAR struct smart_cache_s *sCache;	/* Sector cache */
+	FAR uint16_t *cache_hash;		/* First cache entry of each hash chain */
+	uint16_t cache_hashmask;		/* Number of hash chains - 1 */
 	uint16_t cache_entries;			/* Number of valid entries in the cache */
 	uint16_t cache_lastlog;			/* Keep track of the last sector accessed */
 	uint16_t cache_lastphys;		/* Keep the physical sector number also */
 	uint16_t cache_nextbirth;		/* Sector cache aging value */
+	uint32_t cache_hits;			/* Lookups found in the cache */
+	uint32_t cache_misses;			/* Lookups which scanned the device */
+	uint32_t cache_scanreads;		/* Sector headers read by the scans */
 #endif
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 	FAR uint8_t *erasecounts;	/* Number of erases for each erase block */
@@ -462,6 +534,9 @@ static int smart_geometry(FAR struct inode *inode, struct geometry *geometry);
 static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg);
 
 static uint16_t smart_findfreephyssector(FAR struct smart_struct_s *dev, uint8_t canrelocate);
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logical);
+#endif
 
 #ifdef CONFIG_FS_WRITABLE
 static int smart_writesector(FAR struct smart_struct_s *dev, unsigned long arg);
@@ -474,6 +549,9 @@ static int smart_allocsector(FAR struct smart_struct_s *dev, unsigned long reque
 static int smart_read_wearstatus(FAR struct smart_struct_s *dev);
 static int smart_relocate_static_data(FAR struct smart_struct_s *dev, uint16_t block);
 #endif
+#if defined(CONFIG_MTD_SMART_WEAR_LEVEL) && defined(CONFIG_MTD_SMART_BACKGROUND_GC)
+static int smart_write_wearstatus(struct smart_struct_s *dev);
+#endif
 static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t block, uint8_t forceerase);
 static int smart_relocate_sector(FAR struct smart_struct_s *dev, uint16_t oldsector, uint16_t newsector);
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
@@ -518,6 +596,82 @@ static const struct block_operations g_bops = {
  * Private variables
  ****************************************************************************/
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: smart_map_get
+ *
+ * Description: Return the physical sector of a logical sector, 0xFFFF if it
+ *              is not mapped.  The map has a 16-bit entry per logical
+ *              sector or, when packed, two 12-bit entries in three bytes.
+ *              With CONFIG_MTD_SMART_MINIMIZE_RAM, there is no map and the
+ *              mapping is looked up in the sector cache.
+ *
+ ****************************************************************************/
+
+static inline uint16_t smart_map_get(FAR struct smart_struct_s *dev, uint16_t logical)
+{
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+	return smart_cache_lookup(dev, logical);
+#else
+#ifdef CONFIG_MTD_SMART_MAP_PACKED
+	FAR const uint8_t *entry;
+	uint16_t physical;
+
+	if (dev->packedmap) {
+		entry = (FAR const uint8_t *)dev->sMap + (logical >> 1) * 3;
+		if (logical & 1) {
+			physical = (entry[1] >> 4) | ((uint16_t)entry[2] << 4);
+		} else {
+			physical = entry[0] | ((uint16_t)(entry[1] & 0x0F) << 8);
+		}
+
+		return physical == SMART_PACKED_UNMAPPED ? 0xFFFF : physical;
+	}
+#endif
+
+	return dev->sMap[logical];
+#endif
+}
+
+/****************************************************************************
+ * Name: smart_map_set
+ *
+ * Description: Map a logical sector to a physical sector, or unmap it if
+ *              the physical sector is 0xFFFF.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+static inline void smart_map_set(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical)
+{
+#ifdef CONFIG_MTD_SMART_MAP_PACKED
+	FAR uint8_t *entry;
+
+	if (dev->packedmap) {
+		if (physical == 0xFFFF) {
+			physical = SMART_PACKED_UNMAPPED;
+		}
+
+		entry = (FAR uint8_t *)dev->sMap + (logical >> 1) * 3;
+		if (logical & 1) {
+			entry[1] = (entry[1] & 0x0F) | (uint8_t)(physical << 4);
+			entry[2] = (uint8_t)(physical >> 4);
+		} else {
+			entry[0] = (uint8_t)physical;
+			entry[1] = (entry[1] & 0xF0) | (uint8_t)(physical >> 8);
+		}
+
+		return;
+	}
+#endif
+
+	dev->sMap[logical] = physical;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -539,12 +693,12 @@ static int smart_dumpsector(FAR struct smart_struct_s *dev, uint16_t sector, uin
 
 	if (command == SMART_DEBUG_CMD_DUMP_LSECTOR) {
 		lsector = sector;
-		psector = dev->sMap[sector];
+		psector = smart_map_get(dev, sector);
 	} else {
 		psector = sector;
 		lsector = (uint16_t)-1;
 		for (int i = 0; i < dev->totalsectors; i++) {
-			if (dev->sMap[i] == psector) {
+			if (smart_map_get(dev, i) == psector) {
 				lsector = i;
 				break;
 			}
@@ -574,6 +728,23 @@ static int smart_dumpsector(FAR struct smart_struct_s *dev, uint16_t sector, uin
 }
 #endif
 
+/****************************************************************************
+ * Name: smart_semtake
+ *
+ * Description:  Take the device semaphore, which keeps the background
+ *               garbage collection out of the ioctls.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+static void smart_semtake(FAR struct smart_struct_s *dev)
+{
+	while (sem_wait(&dev->exclsem) != OK) {
+		DEBUGASSERT(get_errno() == EINTR);
+	}
+}
+#endif
+
 /****************************************************************************
  * Name: smart_malloc
  *
@@ -756,6 +927,197 @@ static void smart_add_count(struct smart_struct_s *dev, uint8_t *pCount, uint16_
 }
 #endif
 
+/****************************************************************************
+ * Name: smart_gc_update
+ *
+ * Description: Move an erase block to the list of blocks with its current
+ *              release count.  Every block is on the list of its release
+ *              count, so that the garbage collection finds the block with
+ *              the most released sectors without scanning all the blocks.
+ *              The lists are circular and the head of the list of count
+ *              'n' is entry 'neraseblocks + n' of the link arrays.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+static void smart_gc_update(FAR struct smart_struct_s *dev, uint16_t block)
+{
+	uint16_t head;
+	uint16_t count;
+
+	if (dev->gcnext == NULL) {
+		return;
+	}
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	count = smart_get_count(dev, dev->releasecount, block);
+#else
+	count = dev->releasecount[block];
+#endif
+	if (count > dev->availSectPerBlk) {
+		count = dev->availSectPerBlk;
+	}
+
+	/* Unlink the block from its old list and add it to the new one. */
+
+	dev->gcnext[dev->gcprev[block]] = dev->gcnext[block];
+	dev->gcprev[dev->gcnext[block]] = dev->gcprev[block];
+
+	head = dev->neraseblocks + count;
+	dev->gcnext[block] = dev->gcnext[head];
+	dev->gcprev[block] = head;
+	dev->gcprev[dev->gcnext[head]] = block;
+	dev->gcnext[head] = block;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_gc_rebuild
+ *
+ * Description: Empty the release count lists and add every erase block to
+ *              the list of its release count.  Called once the release
+ *              counts have been set up by a scan or a format.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+static void smart_gc_rebuild(FAR struct smart_struct_s *dev)
+{
+	uint32_t x;
+
+	if (dev->gcnext == NULL) {
+		return;
+	}
+
+	for (x = 0; x <= (uint32_t)dev->neraseblocks + dev->availSectPerBlk; x++) {
+		dev->gcnext[x] = x;
+		dev->gcprev[x] = x;
+	}
+
+	for (x = 0; x < dev->neraseblocks; x++) {
+		smart_gc_update(dev, x);
+	}
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_free_update
+ *
+ * Description: Move an erase block to the list of blocks with its current
+ *              free count.  The lists are circular, like the release count
+ *              lists, and the head of the list of count 'n' is entry
+ *              'neraseblocks + n' of the link arrays.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+static void smart_free_update(FAR struct smart_struct_s *dev, uint16_t block)
+{
+	uint16_t head;
+	uint16_t count;
+
+	if (dev->freemap == NULL) {
+		return;
+	}
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	count = smart_get_count(dev, dev->freecount, block);
+#else
+	count = dev->freecount[block];
+#endif
+	if (count > dev->availSectPerBlk) {
+		count = dev->availSectPerBlk;
+	}
+
+	dev->frnext[dev->frprev[block]] = dev->frnext[block];
+	dev->frprev[dev->frnext[block]] = dev->frprev[block];
+
+	head = dev->neraseblocks + count;
+	dev->frnext[block] = dev->frnext[head];
+	dev->frprev[block] = head;
+	dev->frprev[dev->frnext[head]] = block;
+	dev->frnext[head] = block;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_free_take
+ *
+ * Description: Clear the free bit of a physical sector which has just been
+ *              allocated, and move its erase block to the list of its new
+ *              free count.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+static void smart_free_take(FAR struct smart_struct_s *dev, uint16_t sector)
+{
+	if (dev->freemap == NULL) {
+		return;
+	}
+
+	dev->freemap[sector >> 3] &= ~(1 << (sector & 0x07));
+	smart_free_update(dev, sector / dev->sectorsPerBlk);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_free_reset
+ *
+ * Description: Mark the sectors of an erase block which has just been
+ *              erased as free, except the 'prerelease' sectors at its end.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+static void smart_free_reset(FAR struct smart_struct_s *dev, uint16_t block, uint8_t prerelease)
+{
+	uint32_t sector;
+	uint32_t end;
+
+	if (dev->freemap == NULL) {
+		return;
+	}
+
+	sector = (uint32_t)block * dev->sectorsPerBlk;
+	end = sector + dev->availSectPerBlk - prerelease;
+	for (; sector < end; sector++) {
+		dev->freemap[sector >> 3] |= 1 << (sector & 0x07);
+	}
+
+	smart_free_update(dev, block);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_free_rebuild
+ *
+ * Description: Empty the free count lists and add every erase block to the
+ *              list of its free count.  Called once the free counts have
+ *              been set up by a scan.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+static void smart_free_rebuild(FAR struct smart_struct_s *dev)
+{
+	uint32_t x;
+
+	if (dev->freemap == NULL) {
+		return;
+	}
+
+	for (x = 0; x <= (uint32_t)dev->neraseblocks + dev->availSectPerBlk; x++) {
+		dev->frnext[x] = x;
+		dev->frprev[x] = x;
+	}
+
+	for (x = 0; x < dev->neraseblocks; x++) {
+		smart_free_update(dev, x);
+	}
+}
+#endif
+
 /****************************************************************************
  * Name: smart_checkfree
  *
@@ -1074,6 +1436,9 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	uint32_t erasesize;
 	uint32_t totalsectors;
 	uint32_t allocsize;
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+	uint32_t nhash;
+#endif
 
 	/* Validate the size isn't zero so we don't divide by zero below. */
 
@@ -1157,6 +1522,9 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 	dev->unusedsectors = 0;
 	dev->blockerases = 0;
+	dev->gcblocks = 0;
+	dev->gcidleblocks = 0;
+	memset(dev->writehist, 0, sizeof(dev->writehist));
 #endif
 
 	/* Release any existing rwbuffer and sMap. */
@@ -1191,6 +1559,21 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		dev->wearstatus = NULL;
 	}
 #endif
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+	if (dev->gcnext != NULL) {
+		smart_free(dev, dev->gcnext);
+		dev->gcnext = NULL;
+		dev->gcprev = NULL;
+	}
+#endif
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	if (dev->freemap != NULL) {
+		smart_free(dev, dev->frnext);
+		dev->freemap = NULL;
+		dev->frnext = NULL;
+		dev->frprev = NULL;
+	}
+#endif
 
 #ifdef CONFIG_MTD_SMART_JOURNALING
 	if (dev->block_map != NULL) {
@@ -1221,14 +1604,26 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	dev->totalsectors = (uint16_t)totalsectors;
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+	dev->mapsize = totalsectors * sizeof(uint16_t);
+#ifdef CONFIG_MTD_SMART_MAP_PACKED
+	/* 12-bit entries hold physical sectors up to 0xFFE */
+
+	dev->packedmap = (totalsectors <= SMART_PACKED_UNMAPPED);
+	if (dev->packedmap) {
+		dev->mapsize = ((totalsectors + 1) >> 1) * 3;
+	} else {
+		fdbg("%u sectors, too many for a packed sector map\n", (unsigned int)totalsectors);
+	}
+#endif
+
 	allocsize = dev->neraseblocks << 1;
-	dev->sMap = (FAR uint16_t *)smart_malloc(dev, totalsectors * sizeof(uint16_t) + allocsize, "Sector map");
+	dev->sMap = (FAR uint16_t *)smart_malloc(dev, dev->mapsize + allocsize, "Sector map");
 	if (!dev->sMap) {
 		fdbg("Error allocating SMART virtual map buffer\n");
 		goto errexit;
 	}
 
-	dev->releasecount = (FAR uint8_t *)dev->sMap + (totalsectors * sizeof(uint16_t));
+	dev->releasecount = (FAR uint8_t *)dev->sMap + dev->mapsize;
 	dev->freecount = dev->releasecount + dev->neraseblocks;
 #else
 	dev->sBitMap = (FAR uint8_t *)smart_malloc(dev, (totalsectors + 7) >> 3, "Sector Bitmap");
@@ -1252,10 +1647,13 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	allocsize = dev->neraseblocks << 1;
 #endif
 
-	/* Allocate the sector cache. */
+	/* Allocate the sector cache and its hash chains, at least one per entry. */
+
+	for (nhash = 1; nhash < CONFIG_MTD_SMART_SECTOR_CACHE_SIZE; nhash <<= 1);
 
+	dev->mapsize = CONFIG_MTD_SMART_SECTOR_CACHE_SIZE * sizeof(struct smart_cache_s) + nhash * sizeof(uint16_t);
 	if (dev->sCache == NULL) {
-		dev->sCache = (FAR struct smart_cache_s *)smart_malloc(dev, CONFIG_MTD_SMART_SECTOR_CACHE_SIZE * sizeof(struct smart_cache_s) + allocsize, "Sector Cache");
+		dev->sCache = (FAR struct smart_cache_s *)smart_malloc(dev, dev->mapsize + allocsize, "Sector Cache");
 	}
 
 	if (!dev->sCache) {
@@ -1263,7 +1661,14 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		goto errexit;
 	}
 
-	dev->releasecount = (FAR uint8_t *)dev->sCache + (CONFIG_MTD_SMART_SECTOR_CACHE_SIZE * sizeof(struct smart_cache_s));
+	dev->cache_hash = (FAR uint16_t *)&dev->sCache[CONFIG_MTD_SMART_SECTOR_CACHE_SIZE];
+	dev->cache_hashmask = nhash - 1;
+	memset(dev->cache_hash, 0xFF, nhash * sizeof(uint16_t));
+	dev->cache_hits = 0;
+	dev->cache_misses = 0;
+	dev->cache_scanreads = 0;
+
+	dev->releasecount = (FAR uint8_t *)dev->sCache + dev->mapsize;
 
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
 	if (dev->sectorsPerBlk > 16) {
@@ -1309,6 +1714,46 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	dev->uneven_wearcount = 0;
 #endif
 
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+	/* Allocate the links of the release count lists, one per erase block
+	 * plus the list heads.  Without them, the garbage collection scans the
+	 * erase blocks.
+	 */
+
+	allocsize = dev->neraseblocks + dev->availSectPerBlk + 1;
+	if (allocsize < 0xFFFF) {
+		dev->gcnext = (FAR uint16_t *)smart_malloc(dev, allocsize * 2 * sizeof(uint16_t), "GC lists");
+		if (!dev->gcnext) {
+			fdbg("Error allocating garbage collection lists\n");
+			goto errexit;
+		}
+
+		dev->gcprev = dev->gcnext + allocsize;
+		smart_gc_rebuild(dev);
+	}
+#endif
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	/* Allocate the free sector bitmap and the links of the free count
+	 * lists.  Without them, allocations scan the erase blocks and read the
+	 * sector headers.
+	 */
+
+	allocsize = dev->neraseblocks + dev->availSectPerBlk + 1;
+	if (allocsize < 0xFFFF) {
+		dev->frnext = (FAR uint16_t *)smart_malloc(dev, allocsize * 2 * sizeof(uint16_t) + ((dev->totalsectors + 7) >> 3), "Free index");
+		if (!dev->frnext) {
+			fdbg("Error allocating free sector index\n");
+			goto errexit;
+		}
+
+		dev->frprev = dev->frnext + allocsize;
+		dev->freemap = (FAR uint8_t *)(dev->frprev + allocsize);
+		memset(dev->freemap, 0, (dev->totalsectors + 7) >> 3);
+		smart_free_rebuild(dev);
+	}
+#endif
+
 	/* Allocate a read/write buffer. */
 
 	dev->rwbuffer = (FAR char *)smart_malloc(dev, size, "RW Buffer");
@@ -1351,6 +1796,18 @@ errexit:
 	}
 #endif
 
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+	if (dev->gcnext) {
+		smart_free(dev, dev->gcnext);
+	}
+#endif
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	if (dev->frnext) {
+		smart_free(dev, dev->frnext);
+	}
+#endif
+
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 	if (dev->erasecounts) {
 		smart_free(dev, dev->erasecounts);
@@ -1430,6 +1887,60 @@ static ssize_t smart_bytewrite(FAR struct smart_struct_s *dev, size_t offset, in
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smart_cache_find
+ *
+ * Description: Return the index of the cache entry of a logical sector, or
+ *              0xFFFF if the sector is not in the cache.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+static uint16_t smart_cache_find(FAR struct smart_struct_s *dev, uint16_t logical)
+{
+	uint16_t index;
+
+	index = dev->cache_hash[logical & dev->cache_hashmask];
+	while (index != 0xFFFF && dev->sCache[index].logical != logical) {
+		index = dev->sCache[index].hnext;
+	}
+
+	return index;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_cache_hash / smart_cache_unhash
+ *
+ * Description: Add / remove a cache entry to / from the hash chain of its
+ *              logical sector.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+static void smart_cache_hash(FAR struct smart_struct_s *dev, uint16_t index)
+{
+	FAR uint16_t *head = &dev->cache_hash[dev->sCache[index].logical & dev->cache_hashmask];
+
+	dev->sCache[index].hnext = *head;
+	*head = index;
+}
+
+static void smart_cache_unhash(FAR struct smart_struct_s *dev, uint16_t index)
+{
+	FAR uint16_t *link = &dev->cache_hash[dev->sCache[index].logical & dev->cache_hashmask];
+
+	while (*link != 0xFFFF) {
+		if (*link == index) {
+			*link = dev->sCache[index].hnext;
+			break;
+		}
+
+		link = &dev->sCache[*link].hnext;
+	}
+}
+#endif
+
 /****************************************************************************
  * Name: smart_add_sector_to_cache
  *
@@ -1439,7 +1950,7 @@ static ssize_t smart_bytewrite(FAR struct smart_struct_s *dev, size_t offset, in
  *              a fixed number of mappings per the
  *              CONFIG_MTD_SMART_SECTOR_CACHE_SIZE parameter.  Sectors are
  *              automatically managed and removed based on the time since
- *              they were accessed last.
+ *              they were added.
  *
  ****************************************************************************/
 
@@ -1449,36 +1960,46 @@ static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t lo
 	uint16_t index, x;
 	uint16_t oldest;
 
-	/* If we aren't full yet, just add the sector to the end of the list. */
+	/* If the sector is already cached, just update its mapping. */
 
-	index = 1;
-	if (dev->cache_entries < CONFIG_MTD_SMART_SECTOR_CACHE_SIZE) {
-		index = dev->cache_entries++;
+	oldest = 0;
+	index = smart_cache_find(dev, logical);
+	if (index != 0xFFFF) {
+		dev->sCache[index].physical = physical;
 	} else {
-		/* Cache is full.  We must find the least accessed entry and replace it. */
+		/* If we aren't full yet, just add the sector to the end of the list. */
 
-		oldest = 0xFFFF;
-		for (x = 0; x < CONFIG_MTD_SMART_SECTOR_CACHE_SIZE; x++) {
-			/* Never replace cache entries for system sectors. */
+		index = 1;
+		if (dev->cache_entries < CONFIG_MTD_SMART_SECTOR_CACHE_SIZE) {
+			index = dev->cache_entries++;
+		} else {
+			/* Cache is full.  We must find the oldest entry and replace it. */
 
-			if (dev->sCache[x].logical < SMART_FIRST_ALLOC_SECTOR) {
-				continue;
-			}
+			oldest = 0xFFFF;
+			for (x = 0; x < CONFIG_MTD_SMART_SECTOR_CACHE_SIZE; x++) {
+				/* Never replace cache entries for system sectors. */
 
-			/* If the hit count is zero, then choose this entry. */
+				if (dev->sCache[x].logical < SMART_FIRST_ALLOC_SECTOR) {
+					continue;
+				}
 
-			if (dev->sCache[x].birth < oldest) {
-				oldest = dev->sCache[x].birth;
-				index = x;
+				if (dev->sCache[x].birth < oldest) {
+					oldest = dev->sCache[x].birth;
+					index = x;
+				}
 			}
+
+			smart_cache_unhash(dev, index);
 		}
-	}
 
-	/* Now add the sector at index. */
+		/* Now add the sector at index. */
+
+		dev->sCache[index].logical = logical;
+		dev->sCache[index].physical = physical;
+		dev->sCache[index].birth = dev->cache_nextbirth++;
+		smart_cache_hash(dev, index);
+	}
 
-	dev->sCache[index].logical = logical;
-	dev->sCache[index].physical = physical;
-	dev->sCache[index].birth = dev->cache_nextbirth++;
 	dev->cache_lastlog = logical;
 	dev->cache_lastphys = physical;
 	if (dev->debuglevel > 1) {
@@ -1503,10 +2024,10 @@ static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t lo
  * Name: smart_cache_lookup
  *
  * Description: Perform a cache lookup for the requested logical sector.
- *              If the sector is in the cache, then update the hitcount and
- *              return the physical mapping.  If a cache miss occurs, then
- *              the routine will scan the volume to find the logical sector
- *              and add / replace a cache entry with the newly located sector.
+ *              If the sector is in the cache, then return the physical
+ *              mapping.  If a cache miss occurs, then the routine will scan
+ *              the volume to find the logical sector and add / replace a
+ *              cache entry with the newly located sector.
  *
  ****************************************************************************/
 
@@ -1515,7 +2036,7 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 {
 	int ret;
 	uint16_t block, sector;
-	uint16_t x, physical, logicalsector;
+	uint16_t index, physical, logicalsector;
 	struct smart_sect_header_s header;
 	size_t readaddress;
 
@@ -1524,18 +2045,18 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 	/* Test if searching for the last sector used. */
 
 	if (logical == dev->cache_lastlog) {
+		dev->cache_hits++;
 		return dev->cache_lastphys;
 	}
 
 	/* First search for the entry in the cache. */
 
-	for (x = 0; x < dev->cache_entries; x++) {
-		if (dev->sCache[x].logical == logical) {
-			/* Entry found in the cache.  Grab the physical mapping. */
+	index = smart_cache_find(dev, logical);
+	if (index != 0xFFFF) {
+		/* Entry found in the cache.  Grab the physical mapping. */
 
-			physical = dev->sCache[x].physical;
-			break;
-		}
+		dev->cache_hits++;
+		physical = dev->sCache[index].physical;
 	}
 
 	/* If the entry wasn't found in the cache, then we must search the volume
@@ -1543,6 +2064,8 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 	 */
 
 	if (physical == 0xFFFF) {
+		dev->cache_misses++;
+
 		/* Now scan the MTD device.  Instead of scanning start to end, we
 		 * span the erase blocks and read one sector from each at a time.
 		 * this helps speed up the search on volumes that aren't full
@@ -1556,10 +2079,11 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 			for (block = 0; block < dev->neraseblocks; block++) {
 				/* Calculate the read address for this sector. */
 
-				readaddress = block * dev->erasesize + sector * CONFIG_MTD_SMART_SECTOR_SIZE;
+				readaddress = block * dev->erasesize + sector * dev->sectorsize;
 
 				/* Read the header for this sector. */
 
+				dev->cache_scanreads++;
 				ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
 				if (ret != sizeof(struct smart_sect_header_s)) {
 					return physical;
@@ -1582,7 +2106,7 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 
 				/* Test if this sector has been release and skip it if it has. */
 
-				if (SECOR_IS_RELEASED(header)) {
+				if (SECTOR_IS_RELEASED(header)) {
 					continue;
 				}
 
@@ -1624,31 +2148,34 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 #ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
 static void smart_update_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical)
 {
-	uint16_t x;
+	uint16_t x, last;
 
-	/* Scan through all cache entries and find the logical sector entry */
+	/* Find the logical sector entry */
 
-	for (x = 0; x < dev->cache_entries; x++) {
-		if (dev->sCache[x].logical == logical) {
-			/* Entry found.  Update it's physical mapping. */
+	x = smart_cache_find(dev, logical);
+	if (x != 0xFFFF) {
+		/* Entry found.  Update it's physical mapping. */
 
-			dev->sCache[x].physical = physical;
+		dev->sCache[x].physical = physical;
 
-			/* If we are freeing a sector, then remove the logical entry from
-			   the cache.
-			 */
+		/* If we are freeing a sector, then remove the logical entry from
+		   the cache, moving the last entry in its place.
+		 */
 
-			if (physical == 0xFFFF) {
-				dev->sCache[x].logical = dev->sCache[dev->cache_entries - 1].logical;
-				dev->sCache[x].physical = dev->sCache[dev->cache_entries - 1].physical;
-				dev->cache_entries--;
+		if (physical == 0xFFFF) {
+			smart_cache_unhash(dev, x);
+			last = dev->cache_entries - 1;
+			if (x != last) {
+				smart_cache_unhash(dev, last);
+				dev->sCache[x] = dev->sCache[last];
+				smart_cache_hash(dev, x);
 			}
 
-			if (dev->debuglevel > 1) {
-				dbg("Update Cache:  Log=%d, Phys=%d at index %d\n", logical, physical, x);
-			}
+			dev->cache_entries--;
+		}
 
-			break;
+		if (dev->debuglevel > 1) {
+			dbg("Update Cache:  Log=%d, Phys=%d at index %d\n", logical, physical, x);
 		}
 	}
 
@@ -1905,7 +2432,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
 	for (sector = 0; sector < totalsectors; sector++) {
-		dev->sMap[sector] = -1;
+		smart_map_set(dev, sector, 0xFFFF);
 	}
 #else
 	/* Clear all logical sector used bits. */
@@ -1913,6 +2440,14 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	memset(dev->sBitMap, 0, (dev->totalsectors + 7) >> 3);
 #endif
 
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	/* The free sector bits are set below for the erased sector headers. */
+
+	if (dev->freemap != NULL) {
+		memset(dev->freemap, 0, (dev->totalsectors + 7) >> 3);
+	}
+#endif
+
 	/* Now scan the MTD device. */
 
 	for (sector = 0; sector < totalsectors; sector++) {
@@ -1942,6 +2477,24 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 
 		status_released = SECTOR_IS_RELEASED(header);
 		status_committed = SECTOR_IS_COMMITTED(header);
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+		/* Index the sector as free if smart_findfreephyssector would take it,
+		 * leaving out the pre-released sectors at the end of the device.
+		 */
+
+		if (dev->freemap != NULL && UINT8TOUINT16(header.logicalsector) == 0xFFFF &&
+#if SMART_STATUS_VERSION == 1
+			header.seq == 0xFF && header.crc8 == 0xFF &&
+#else
+			header.seq == CONFIG_SMARTFS_ERASEDSTATE &&
+#endif
+			!status_committed && sector % dev->sectorsPerBlk < dev->availSectPerBlk &&
+			(dev->totalsectors != 65534 || sector / dev->sectorsPerBlk != dev->neraseblocks - 1 ||
+			 sector % dev->sectorsPerBlk < dev->availSectPerBlk - 2)) {
+			dev->freemap[sector >> 3] |= 1 << (sector & 0x07);
+		}
+#endif
 #ifdef CONFIG_MTD_SMART_JOURNALING
 		fvdbg("released : %d committed : %d logical : %d physical : %d crc : %d sta :%d seq :%d\n", status_released, status_committed, logicalsector, sector, UINT8TOUINT16(header.crc16), header.status, header.seq);
 #endif
@@ -2073,7 +2626,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 		/* Test for duplicate logical sectors on the device. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		if (dev->sMap[logicalsector] != 0xFFFF)
+		if (smart_map_get(dev, logicalsector) != 0xFFFF)
 #else
 		if (dev->sBitMap[logicalsector >> 3] & (1 << (logicalsector & 0x07)))
 #endif
@@ -2082,7 +2635,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 			 * the same logical sector.  Use the sequence number information
 			 * to resolve who wins.
 			 */
-			fvdbg("Duplication occurs!!\n, Popular Physical Sector = %d\n", dev->sMap[logicalsector]);
+			fvdbg("Duplication occurs!!\n, Popular Physical Sector = %d\n", smart_map_get(dev, logicalsector));
 #if SMART_STATUS_VERSION == 1
 			if (header.status & SMART_STATUS_CRC) {
 				seq2 = header.seq;
@@ -2097,7 +2650,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 			/* We must re-read the 1st physical sector to get it's seq number. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-			readaddress = dev->sMap[logicalsector] * dev->mtdBlksPerSector * dev->geo.blocksize;
+			readaddress = smart_map_get(dev, logicalsector) * dev->mtdBlksPerSector * dev->geo.blocksize;
 #else
 			/* For minimize RAM, we have to rescan to find the 1st sector claiming to
 			 * be this logical sector.
@@ -2171,8 +2724,8 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 				/* Seq 2 is the winner ... bigger or it wrapped. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-				loser = dev->sMap[logicalsector];
-				dev->sMap[logicalsector] = sector;
+				loser = smart_map_get(dev, logicalsector);
+				smart_map_set(dev, logicalsector, sector);
 #else
 				loser = dupsector;
 #endif
@@ -2182,7 +2735,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 
 				loser = sector;
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-				winner = dev->sMap[logicalsector];
+				winner = smart_map_get(dev, logicalsector);
 #else
 				winner = smart_cache_lookup(dev, logicalsector);
 #endif
@@ -2246,7 +2799,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
 		/* Update the logical to physical sector map. */
 
-		dev->sMap[logicalsector] = winner;
+		smart_map_set(dev, logicalsector, winner);
 #else
 		/* Mark the logical sector as used in the bitmap */
 		dev->sBitMap[logicalsector >> 3] |= 1 << (logicalsector & 0x07);
@@ -2257,6 +2810,8 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 #endif
 	}
 
+	smart_free_rebuild(dev);
+
 #if defined(CONFIG_MTD_SMART_WEAR_LEVEL) && (SMART_STATUS_VERSION == 1)
 #ifdef CONFIG_MTD_SMART_CONVERT_WEAR_FORMAT
 
@@ -2267,7 +2822,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	 */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	sector = dev->sMap[0];
+	sector = smart_map_get(dev, 0);
 #else
 	sector = smart_cache_lookup(dev, 0);
 #endif
@@ -2307,7 +2862,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 			dev->releasesectors++;
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-			dev->sMap[0] = newsector;
+			smart_map_set(dev, 0, newsector);
 			dev->freecount[newsector / dev->sectorsPerBlk]--;
 			dev->releasecount[sector / dev->sectorsPerBlk]++;
 #else
@@ -2315,6 +2870,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 			smart_add_count(dev, dev->freecount, newsector / dev->sectorsPerBlk, -1);
 			smart_add_count(dev, dev->releasecount, sector / dev->sectorsPerBlk, 1);
 #endif
+			smart_free_take(dev, newsector);
 
 		}
 	}
@@ -2348,6 +2904,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 		}
 	}
 #endif
+	smart_gc_rebuild(dev);
 	ret = OK;
 
 err_out:
@@ -2454,6 +3011,7 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t
 		if (ret < 0) {
 			fdbg("MTD_ERASE failed!!\n");
 			dev->freecount[block] = 0;
+			smart_free_update(dev, block);
 			return;
 		}
 
@@ -2490,6 +3048,8 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t
 		dev->releasecount[block] = prerelease;
 		dev->freecount[block] = dev->availSectPerBlk - prerelease;
 #endif							/* CONFIG_MTD_SMART_PACK_COUNTS */
+		smart_gc_update(dev, block);
+		smart_free_reset(dev, block, prerelease);
 
 		/* Now that we have erased this block and updated the release / free counts,
 		 * if we are in WEAR LEVELING enabled mode, we must check if this erase block's
@@ -2684,7 +3244,7 @@ static int smart_relocate_static_data(FAR struct smart_struct_s *dev, uint16_t b
 			}
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-			dev->sMap[UINT8TOUINT16(header->logicalsector)] = newsector;
+			smart_map_set(dev, UINT8TOUINT16(header->logicalsector), newsector);
 #else
 			smart_update_cache(dev, *((FAR uint16_t *)header->logicalsector), newsector);
 #endif
@@ -2694,6 +3254,7 @@ static int smart_relocate_static_data(FAR struct smart_struct_s *dev, uint16_t b
 #else
 			dev->freecount[block]--;
 #endif							/* CONFIG_MTD_SMART_PACK_COUNTS */
+			smart_free_take(dev, newsector);
 			dev->freesectors--;
 		}
 
@@ -2966,6 +3527,7 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 		dev->releasecount[x] = prerelease;
 		dev->freecount[x] = dev->availSectPerBlk - prerelease;
 #endif
+		smart_free_reset(dev, x, prerelease);
 	}
 
 	/* Account for the format sector. */
@@ -2975,15 +3537,17 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 #else
 	dev->freecount[0]--;
 #endif
+	smart_free_take(dev, 0);
+	smart_gc_rebuild(dev);
 
 	/* Now initialize the logical to physical sector map. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	dev->sMap[0] = 0;			/* Logical sector zero = physical sector 0 */
+	smart_map_set(dev, 0, 0);			/* Logical sector zero = physical sector 0 */
 	for (x = 1; x < dev->totalsectors; x++) {
 		/* Mark all other logical sectors as non-existent. */
 
-		dev->sMap[x] = -1;
+		smart_map_set(dev, x, 0xFFFF);
 	}
 #endif
 
@@ -3202,6 +3766,7 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 
 	dev->freecount[block] = 0;
 #endif
+	smart_free_update(dev, block);
 
 	/* Next move all live data in the block to a new home. */
 
@@ -3280,7 +3845,7 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 		/* Update the variables. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		dev->sMap[UINT8TOUINT16(header->logicalsector)] = newsector;
+		smart_map_set(dev, UINT8TOUINT16(header->logicalsector), newsector);
 #else
 		smart_update_cache(dev, *((FAR uint16_t *)header->logicalsector), newsector);
 #endif
@@ -3290,6 +3855,7 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 #else
 		dev->freecount[newsector / dev->sectorsPerBlk]--;
 #endif
+		smart_free_take(dev, newsector);
 
 	}
 
@@ -3347,6 +3913,8 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 	dev->freecount[block] = dev->availSectPerBlk - prerelease;
 	dev->releasecount[block] = prerelease;
 #endif
+	smart_gc_update(dev, block);
+	smart_free_reset(dev, block, prerelease);
 
 #ifdef CONFIG_SMART_LOCAL_CHECKFREE
 	if (smart_checkfree(dev, __LINE__) != OK) {
@@ -3372,9 +3940,65 @@ errout:
 #else
 	dev->freecount[block] = freecount;
 #endif
+	smart_free_update(dev, block);
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smart_free_find
+ *
+ * Description: Return the first free sector of the erase block with the
+ *              most free sectors, or 0xFFFF if the index has none to offer.
+ *              The sector is taken out of the bitmap at once, so that it is
+ *              not handed out again if the write which follows fails.
+ *              Worn blocks are left to the scan of smart_findfreephyssector,
+ *              which decides when they are used.  A block whose free count
+ *              includes sectors with a header but no commit (an allocation
+ *              interrupted by a power loss) may have fewer free bits than
+ *              its count, so the walk moves on to the next block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+static uint16_t smart_free_find(FAR struct smart_struct_s *dev)
+{
+	uint16_t count;
+	uint16_t head;
+	uint16_t block;
+	uint32_t sector;
+	uint32_t end;
+
+	for (count = dev->availSectPerBlk; count > 0; count--) {
+		head = dev->neraseblocks + count;
+		for (block = dev->frnext[head]; block != head; block = dev->frnext[block]) {
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+			if (smart_get_wear_level(dev, block) >= SMART_WEAR_FULL_RELOCATE_THRESHOLD) {
+				continue;
+			}
+#endif
+			sector = (uint32_t)block * dev->sectorsPerBlk;
+			end = sector + dev->availSectPerBlk;
+			while (sector < end) {
+				if ((sector & 0x07) == 0 && end - sector >= 8 && dev->freemap[sector >> 3] == 0) {
+					sector += 8;
+					continue;
+				}
+
+				if (dev->freemap[sector >> 3] & (1 << (sector & 0x07))) {
+					dev->freemap[sector >> 3] &= ~(1 << (sector & 0x07));
+					dev->lastallocblock = block;
+					return (uint16_t)sector;
+				}
+
+				sector++;
+			}
+		}
+	}
+
+	return 0xFFFF;
+}
+#endif
+
 /****************************************************************************
  * Name: smart_findfreephyssector
  *
@@ -3396,6 +4020,21 @@ static uint16_t smart_findfreephyssector(FAR struct smart_struct_s *dev, uint8_t
 	uint32_t readaddr;
 	struct smart_sect_header_s header;
 	int ret;
+
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	/* Take the sector from the free sector index when it has one. */
+
+	if (dev->freemap != NULL) {
+		physicalsector = smart_free_find(dev);
+		if (physicalsector != 0xFFFF) {
+			dev->allochits++;
+			return physicalsector;
+		}
+
+		dev->allocscans++;
+	}
+#endif
+
 	/* Determine which erase block we should allocate the new
 	 * sector from. This is based on the number of free sectors
 	 * available in each erase block. */
@@ -3575,16 +4214,89 @@ retry:
 	if (physicalsector >= dev->totalsectors) {
 		fdbg("Program bug!  Selected sector too big!!!\n");
 	}
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	else if (dev->freemap != NULL) {
+		dev->freemap[physicalsector >> 3] &= ~(1 << (physicalsector & 0x07));
+	}
+#endif
 
 	return physicalsector;
 }
 
+/****************************************************************************
+ * Name: smart_gc_victim
+ *
+ * Description:  Return the erase block with the most released sectors,
+ *               skipping the blocks which have been worn completely, or
+ *               0xFFFF if no block has released sectors.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static uint16_t smart_gc_victim(FAR struct smart_struct_s *dev)
+{
+	uint16_t collectblock;
+	uint16_t releasemax;
+	uint16_t count;
+	uint16_t x;
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+	uint16_t head;
+
+	if (dev->gcnext != NULL) {
+		/* Take the first block on the list of the highest release count. */
+
+		for (count = dev->availSectPerBlk; count > 0; count--) {
+			head = dev->neraseblocks + count;
+			for (x = dev->gcnext[head]; x != head; x = dev->gcnext[x]) {
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+				if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD) {
+					continue;
+				}
+#endif
+				return x;
+			}
+		}
+
+		return 0xFFFF;
+	}
+#endif
+
+	collectblock = 0xFFFF;
+	releasemax = 0;
+	for (x = 0; x < dev->neraseblocks; x++) {
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+		/* Don't collect blocks that have been worn completely. */
+
+		if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD) {
+			continue;
+		}
+#endif
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+		count = smart_get_count(dev, dev->releasecount, x);
+#else
+		count = dev->releasecount[x];
+#endif
+		if (count > releasemax) {
+			releasemax = count;
+			collectblock = x;
+		}
+	}
+
+	return collectblock;
+}
+#endif							/* CONFIG_FS_WRITABLE */
+
 /****************************************************************************
  * Name: smart_garbagecollect
  *
  * Description:  Perform garbage collection if needed.  This is determined
  *               by the count of released sectors relative to free and
- *               total sectors.
+ *               total sectors.  Unless the free sectors are down to the
+ *               reserve, at most CONFIG_MTD_SMART_GC_WRITE_BLOCKS blocks are
+ *               collected per call, which bounds the time a write spends
+ *               collecting.  The rest is left to the following writes or to
+ *               the background garbage collection.
  *
  ****************************************************************************/
 
@@ -3592,13 +4304,9 @@ retry:
 static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 {
 	uint16_t collectblock;
-	uint16_t releasemax;
 	bool collect = TRUE;
-	int x;
+	int nblocks = 0;
 	int ret;
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-	uint8_t count;
-#endif
 
 	while (collect) {
 		collect = FALSE;
@@ -3607,7 +4315,7 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 		 * free sectors.  If it is, then we will do garbage collection.
 		 */
 
-		if (dev->releasesectors > dev->freesectors && dev->freesectors < (dev->totalsectors >> 5)) {
+		if (nblocks < CONFIG_MTD_SMART_GC_WRITE_BLOCKS && dev->releasesectors > dev->freesectors && dev->freesectors < (dev->totalsectors >> 5)) {
 			collect = TRUE;
 		}
 
@@ -3622,32 +4330,7 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 		if (collect) {
 			/* Find the block with the most released sectors. */
 
-			collectblock = 0xFFFF;
-			releasemax = 0;
-			for (x = 0; x < dev->neraseblocks; x++) {
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-				/* Don't collect blocks that have been worn completely. */
-
-				if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD) {
-					continue;
-				}
-#endif
-
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-				count = smart_get_count(dev, dev->releasecount, x);
-				if (count > releasemax) {
-					releasemax = count;
-					collectblock = x;
-				}
-#else
-				if (dev->releasecount[x] > releasemax) {
-					releasemax = dev->releasecount[x];
-					collectblock = x;
-				}
-#endif
-			}
-			//releasemax = smart_get_count(dev, dev->releasecount, collectblock);
-
+			collectblock = smart_gc_victim(dev);
 			if (collectblock == 0xFFFF) {
 				/* Need to collect, but no sectors with released blocks! */
 
@@ -3679,6 +4362,11 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 			if (ret != OK) {
 				return ret;
 			}
+
+			nblocks++;
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+			dev->gcblocks++;
+#endif
 		}
 	}
 
@@ -3686,6 +4374,112 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 }
 #endif							/* CONFIG_FS_WRITABLE */
 
+/****************************************************************************
+ * Name: smart_gc_idlevictim
+ *
+ * Description:  Return the erase block worth collecting while the device is
+ *               idle, or 0xFFFF if there is none.  A block is worth it when
+ *               at least half of it is released, or when there are more
+ *               released than free sectors, and the free sectors of the
+ *               other blocks can hold its live sectors.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+static uint16_t smart_gc_idlevictim(FAR struct smart_struct_s *dev)
+{
+	uint16_t block;
+	int releasecount;
+	int freecount;
+
+	block = smart_gc_victim(dev);
+	if (block == 0xFFFF) {
+		return block;
+	}
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	releasecount = smart_get_count(dev, dev->releasecount, block);
+	freecount = smart_get_count(dev, dev->freecount, block);
+#else
+	releasecount = dev->releasecount[block];
+	freecount = dev->freecount[block];
+#endif
+
+	if (releasecount < (dev->availSectPerBlk >> 1) && dev->releasesectors <= dev->freesectors) {
+		return 0xFFFF;
+	}
+
+	if (dev->freesectors - freecount < dev->availSectPerBlk - releasecount - freecount) {
+		return 0xFFFF;
+	}
+
+	return block;
+}
+
+/****************************************************************************
+ * Name: smart_gc_worker
+ *
+ * Description:  Background garbage collection.  Once no sector has been
+ *               written for CONFIG_MTD_SMART_GC_IDLE_MS, relocate the live
+ *               sectors of one block worth collecting and erase it, then
+ *               queue again for the next block.  A write arriving meanwhile
+ *               waits for one block relocation at most, and the following
+ *               writes find erased blocks instead of collecting themselves.
+ *
+ ****************************************************************************/
+
+static void smart_gc_worker(FAR void *arg)
+{
+	FAR struct smart_struct_s *dev = (FAR struct smart_struct_s *)arg;
+	clock_t idle = MSEC2TICK(CONFIG_MTD_SMART_GC_IDLE_MS);
+	clock_t elapsed;
+	uint16_t block;
+
+	smart_semtake(dev);
+
+	elapsed = clock_systimer() - dev->lastwrite;
+	if (elapsed < idle) {
+		/* Not idle yet, look again when it may be. */
+
+		work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, idle - elapsed);
+	} else {
+		block = smart_gc_idlevictim(dev);
+		if (block != 0xFFFF) {
+			fvdbg("Idle collecting block %d\n", block);
+			if (smart_relocate_block(dev, block) == OK) {
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+				dev->gcidleblocks++;
+#endif
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+				if (dev->wearflags & SMART_WEARFLAGS_WRITE_NEEDED) {
+					smart_write_wearstatus(dev);
+				}
+#endif
+				work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, 0);
+			}
+		}
+	}
+
+	smart_semgive(dev);
+}
+
+/****************************************************************************
+ * Name: smart_gc_schedule
+ *
+ * Description:  Note the time of a sector write or release and queue the
+ *               background garbage collection if it is not queued yet.
+ *
+ ****************************************************************************/
+
+static void smart_gc_schedule(FAR struct smart_struct_s *dev)
+{
+	dev->lastwrite = clock_systimer();
+	if (work_available(&dev->gcwork)) {
+		work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, MSEC2TICK(CONFIG_MTD_SMART_GC_IDLE_MS));
+	}
+}
+#endif							/* CONFIG_MTD_SMART_BACKGROUND_GC */
+
 /****************************************************************************
  * Name: smart_write_wearstatus
  *
@@ -3871,7 +4665,7 @@ static inline int smart_read_wearstatus(FAR struct smart_struct_s *dev)
 
 		/* Validate wear status sector has been allocated */
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		physsector = dev->sMap[req.logsector];
+		physsector = smart_map_get(dev, req.logsector);
 #else
 		physsector = smart_cache_lookup(dev, req.logsector);
 #endif
@@ -4099,7 +4893,7 @@ static int smart_writesector(FAR struct smart_struct_s *dev, unsigned long arg)
 #endif
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	physsector = dev->sMap[req->logsector];
+	physsector = smart_map_get(dev, req->logsector);
 #else
 	physsector = smart_cache_lookup(dev, req->logsector);
 #endif
@@ -4332,6 +5126,8 @@ static int smart_writesector(FAR struct smart_struct_s *dev, unsigned long arg)
 		dev->releasecount[block]++;
 		dev->freecount[physsector / dev->sectorsPerBlk]--;
 #endif
+		smart_gc_update(dev, block);
+		smart_free_take(dev, physsector);
 		dev->freesectors--;
 		dev->releasesectors++;
 
@@ -4344,7 +5140,7 @@ static int smart_writesector(FAR struct smart_struct_s *dev, unsigned long arg)
 		/* Update the sector map. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		dev->sMap[req->logsector] = physsector;
+		smart_map_set(dev, req->logsector, physsector);
 #else
 		smart_update_cache(dev, req->logsector, physsector);
 #endif
@@ -4436,7 +5232,7 @@ static int smart_readsector(FAR struct smart_struct_s *dev, unsigned long arg)
 		return -EINVAL;
 	}
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	physsector = dev->sMap[req->logsector];
+	physsector = smart_map_get(dev, req->logsector);
 #else
 	physsector = smart_cache_lookup(dev, req->logsector);
 #endif
@@ -4572,7 +5368,7 @@ static int smart_allocsector(FAR struct smart_struct_s *dev, unsigned long reque
 		/* Validate the sector is not already allocated. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		if (dev->sMap[requested] == (uint16_t)-1)
+		if (smart_map_get(dev, requested) == (uint16_t)-1)
 #else
 		if (!(dev->sBitMap[requested >> 3] & (1 << (requested & 0x07))))
 #endif
@@ -4603,7 +5399,7 @@ static int smart_allocsector(FAR struct smart_struct_s *dev, unsigned long reque
 		/* Loop through all sectors and find one to allocate. */
 		for (x = SMART_FIRST_ALLOC_SECTOR; x < dev->totalsectors; x++) {
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-			if (dev->sMap[x] == (uint16_t)-1)
+			if (smart_map_get(dev, x) == (uint16_t)-1)
 #else
 			if (!(dev->sBitMap[x >> 3] & (1 << (x & 0x07))))
 #endif
@@ -4707,7 +5503,7 @@ static int smart_allocsector(FAR struct smart_struct_s *dev, unsigned long reque
 	/* Map the sector and update the free sector counts. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	dev->sMap[logsector] = physicalsector;
+	smart_map_set(dev, logsector, physicalsector);
 #else
 	dev->sBitMap[logsector >> 3] |= (1 << (logsector & 0x07));
 	smart_add_sector_to_cache(dev, logsector, physicalsector, __LINE__);
@@ -4718,6 +5514,7 @@ static int smart_allocsector(FAR struct smart_struct_s *dev, unsigned long reque
 #else
 	dev->freecount[physicalsector / dev->sectorsPerBlk]--;
 #endif
+	smart_free_take(dev, physicalsector);
 	dev->freesectors--;
 
 	/* Return the logical sector number. */
@@ -4751,7 +5548,7 @@ static inline int smart_freesector(FAR struct smart_struct_s *dev, unsigned long
 		/* Validate the sector is actually allocated. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		if (dev->sMap[logicalsector] == (uint16_t)-1)
+		if (smart_map_get(dev, logicalsector) == (uint16_t)-1)
 #else
 		if (!(dev->sBitMap[logicalsector >> 3] & (1 << (logicalsector & 0x07))))
 #endif
@@ -4764,7 +5561,7 @@ static inline int smart_freesector(FAR struct smart_struct_s *dev, unsigned long
 	/* Okay to release the sector.  Read the sector header info. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	physsector = dev->sMap[logicalsector];
+	physsector = smart_map_get(dev, logicalsector);
 #else
 	physsector = smart_cache_lookup(dev, logicalsector);
 #endif
@@ -4809,11 +5606,12 @@ static inline int smart_freesector(FAR struct smart_struct_s *dev, unsigned long
 #else
 	dev->releasecount[block]++;
 #endif
+	smart_gc_update(dev, block);
 
 	/* Unmap this logical sector. */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	dev->sMap[logicalsector] = (uint16_t)-1;
+	smart_map_set(dev, logicalsector, 0xFFFF);
 #else
 	dev->sBitMap[logicalsector >> 3] &= ~(1 << (logicalsector & 0x07));
 	smart_update_cache(dev, logicalsector, 0xFFFF);
@@ -4827,6 +5625,29 @@ static inline int smart_freesector(FAR struct smart_struct_s *dev, unsigned long
 }
 #endif							/* CONFIG_FS_WRITABLE */
 
+/****************************************************************************
+ * Name: smart_account_write
+ *
+ * Description: Add the latency of a sector write to the histogram reported
+ *              through procfs.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+static void smart_account_write(FAR struct smart_struct_s *dev, clock_t ticks)
+{
+	uint32_t msec = TICK2MSEC(ticks);
+	int bucket = 0;
+
+	while (msec > 0 && bucket < SMART_WRITE_HIST_NBUCKETS - 1) {
+		msec >>= 1;
+		bucket++;
+	}
+
+	dev->writehist[bucket]++;
+}
+#endif
+
 /****************************************************************************
  * Name: smart_ioctl
  *
@@ -4845,6 +5666,9 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	uint16_t sector;
 	FAR struct smart_sect_header_s *header;
 	size_t offset;
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+	clock_t start;
+#endif
 
 	fvdbg("Entry cmd : %08x\n", cmd);
 	DEBUGASSERT(inode && inode->i_private);
@@ -4855,6 +5679,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
+	smart_semtake(dev);
+
 	/* Process the ioctl's we care about first, pass any we don't respond
 	 * to directly to the underlying MTD device.
 	 */
@@ -4869,7 +5695,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #ifdef CONFIG_DEBUG
 		if (arg == 0) {
 			fdbg("ERROR: BIOC_XIPBASE argument is NULL\n");
-			return -EINVAL;
+			ret = -EINVAL;
+			goto ok_out;
 		}
 #endif
 
@@ -4920,12 +5747,18 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 		/* Free the specified logical sector. */
 
 		ret = smart_freesector(dev, arg);
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+		smart_gc_schedule(dev);
+#endif
 		goto ok_out;
 
 	case BIOC_WRITESECT:
 
 		/* Write to the sector. */
 
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+		start = clock_systimer();
+#endif
 		ret = smart_writesector(dev, arg);
 
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
@@ -4935,6 +5768,12 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 			smart_write_wearstatus(dev);
 		}
 #endif
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+		smart_account_write(dev, clock_systimer() - start);
+#endif
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+		smart_gc_schedule(dev);
+#endif
 
 		goto ok_out;
 #endif							/* CONFIG_FS_WRITABLE */
@@ -4944,13 +5783,17 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #ifndef NXFUSE_HOST_BUILD
 		irqstate_t saved_state = enter_critical_section();
 #endif
-		uint16_t psector = dev->sMap[0];
+		uint16_t psector = smart_map_get(dev, 0);
 		fvdbg("psector : %d\n", psector);
 		header = (FAR struct smart_sect_header_s *)dev->rwbuffer;
 		ret = MTD_BREAD(dev->mtd, psector * dev->mtdBlksPerSector, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
 		if (ret != dev->mtdBlksPerSector) {
 			fdbg("Error reading phys sector %d\n", psector);
-			return -EIO;
+#ifndef NXFUSE_HOST_BUILD
+			leave_critical_section(saved_state);
+#endif
+			ret = -EIO;
+			goto ok_out;
 		}
 
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
@@ -4975,7 +5818,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #endif
 		goto ok_out;
 	case BIOC_CORRUPTION :
-		sector = dev->sMap[SMART_FIRST_DIR_SECTOR];
+		sector = smart_map_get(dev, SMART_FIRST_DIR_SECTOR);
 		header = (FAR struct smart_sect_header_s *)dev->rwbuffer;
 		ret = MTD_BREAD(dev->mtd, sector * dev->mtdBlksPerSector, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
 		if (ret != dev->mtdBlksPerSector) {
@@ -5001,16 +5844,18 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	case BIOC_FIBMAP:
 		sector = (uint16_t)arg;
 		if (sector >= dev->totalsectors) {
-			return -EINVAL;
+			ret = -EINVAL;
+			goto ok_out;
 		}
 
 		/* TODO Below should consider multi root mount point */
 		if (sector > SMART_FIRST_DIR_SECTOR && sector < SMART_FIRST_ALLOC_SECTOR) {
-			return 0xFFFF;
+			ret = 0xFFFF;
+			goto ok_out;
 		}
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		ret = (int)dev->sMap[sector];
+		ret = (int)smart_map_get(dev, sector);
 #else
 		ret = (int)smart_cache_lookup(dev, sector);
 #endif
@@ -5031,10 +5876,23 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 		procfs_data->unusedsectors = dev->unusedsectors;
 		procfs_data->blockerases = dev->blockerases;
 		procfs_data->sectorsperblk = dev->sectorsPerBlk;
+		procfs_data->mapsize = dev->mapsize;
+		procfs_data->gcblocks = dev->gcblocks;
+		procfs_data->gcidleblocks = dev->gcidleblocks;
+		memcpy(procfs_data->writehist, dev->writehist, sizeof(procfs_data->writehist));
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+		procfs_data->cachehits = dev->cache_hits;
+		procfs_data->cachemisses = dev->cache_misses;
+		procfs_data->scanreads = dev->cache_scanreads;
+#endif
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+		procfs_data->allochits = dev->allochits;
+		procfs_data->allocscans = dev->allocscans;
+#endif
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-		procfs_data->formatsector = dev->sMap[0];
-		procfs_data->dirsector = dev->sMap[3];
+		procfs_data->formatsector = smart_map_get(dev, 0);
+		procfs_data->dirsector = smart_map_get(dev, 3);
 #else
 		procfs_data->formatsector = smart_cache_lookup(dev, 0);
 		procfs_data->dirsector = smart_cache_lookup(dev, 3);
@@ -5091,6 +5949,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	}
 
 ok_out:
+	smart_semgive(dev);
 	return ret;
 }
 
@@ -6050,9 +6909,25 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 		dev->wearstatus = NULL;
 #endif
+#ifdef CONFIG_MTD_SMART_GC_BUCKETS
+		dev->gcnext = NULL;
+		dev->gcprev = NULL;
+#endif
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+		dev->freemap = NULL;
+		dev->frnext = NULL;
+		dev->frprev = NULL;
+		dev->allochits = 0;
+		dev->allocscans = 0;
+#endif
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
 		dev->allocsector = NULL;
 #endif
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+		sem_init(&dev->exclsem, 0, 1);
+		dev->gcwork.worker = NULL;
+		dev->lastwrite = clock_systimer();
+#endif
 #ifdef CONFIG_MTD_SMART_JOURNALING
 		dev->block_map = NULL;
 		dev->journal_seq = 0;
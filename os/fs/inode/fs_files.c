@@ -130,6 +130,12 @@ static int _files_close(FAR struct file *filep)
 	/* Check if the struct file is open (i.e., assigned an inode) */
 
 	if (inode) {
+#ifdef CONFIG_FS_EPOLL
+		/* The driver must not keep registrations into an epoll instance */
+
+		epoll_fileclose(filep);
+#endif
+
 		/* Close the file, driver, or mountpoint. */
 
 		if (inode->u.i_ops && inode->u.i_ops->close) {
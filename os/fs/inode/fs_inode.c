@@ -168,6 +168,47 @@ static int _inode_compare(FAR const char *fname, FAR struct inode *node)
 	}
 }
 
+/****************************************************************************
+ * Name: inode_search_hashed
+ *
+ * Description:
+ *   inode_search() for callers that do not need the left peer: each path
+ *   segment is found with a probe of the inode hash table.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_HASH
+static FAR struct inode *inode_search_hashed(FAR const char **path, FAR struct inode **parent, FAR const char **relpath)
+{
+	FAR const char *name = *path + 1;	/* Skip over leading '/' */
+	FAR struct inode *above = NULL;
+	FAR struct inode *node;
+
+	while ((node = inode_hash_lookup(above, name)) != NULL) {
+		/* Stop at the end of the path or at a mountpoint, which handles
+		 * the remaining part of the pathname.
+		 */
+
+		name = inode_nextname(name);
+		if (!*name || INODE_IS_MOUNTPT(node)) {
+			if (relpath) {
+				*relpath = name;
+			}
+			break;
+		}
+
+		above = node;
+	}
+
+	if (parent) {
+		*parent = above;
+	}
+
+	*path = name;
+	return node;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -289,6 +330,16 @@ FAR struct inode *inode_search(FAR const char **path, FAR struct inode **peer, F
 	FAR struct inode *left = NULL;
 	FAR struct inode *above = NULL;
 
+#ifdef CONFIG_FS_INODE_HASH
+	/* Only inode_reserve() and inode_unlink() need the left peer, to link
+	 * or unlink a node in the ordered peer list.
+	 */
+
+	if (!peer) {
+		return inode_search_hashed(path, parent, relpath);
+	}
+#endif
+
 	while (node) {
 		int result = _inode_compare(name, node);
 
@@ -384,6 +435,9 @@ void inode_free(FAR struct inode *node)
 	if (node) {
 		inode_free(node->i_peer);
 		inode_free(node->i_child);
+#ifdef CONFIG_FS_INODE_HASH
+		inode_hash_remove(node);
+#endif
 		kmm_free(node);
 	}
 }
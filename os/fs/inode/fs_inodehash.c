@@ -0,0 +1,203 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/inode/fs_inodehash.c
+ *
+ * Every inode of the pseudo file system is also linked in a hash table
+ * keyed by its parent inode and its name, so that inode_search() resolves
+ * a path segment with one probe instead of walking the ordered list of the
+ * peers.  The table is not a cache: an inode is added when it is linked in
+ * the tree and removed when it is unlinked or freed, so a miss means that
+ * there is no such inode.  Like the tree, it is protected by tree_sem.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include <tinyara/fs/fs.h>
+
+#include "inode/inode.h"
+
+#ifdef CONFIG_FS_INODE_HASH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if (CONFIG_FS_INODE_HASH_BUCKETS & (CONFIG_FS_INODE_HASH_BUCKETS - 1)) != 0
+#error "CONFIG_FS_INODE_HASH_BUCKETS must be a power of two"
+#endif
+
+#define INODE_HASH_MASK (CONFIG_FS_INODE_HASH_BUCKETS - 1)
+
+/* Peers share the parent, so the parent address is mixed in to spread the
+ * children of /dev and /var over the whole table.
+ */
+
+#define INODE_BUCKET(p, h) \
+	(((h) ^ ((uint32_t)((uintptr_t)(p) >> 3) * 0x9e3779b1)) & INODE_HASH_MASK)
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+static FAR struct inode *g_inode_hash[CONFIG_FS_INODE_HASH_BUCKETS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_hash_name
+ *
+ * Description:
+ *   FNV-1a hash of the first segment of 'name', its length is returned in
+ *   'len'.
+ *
+ ****************************************************************************/
+
+static uint32_t inode_hash_name(FAR const char *name, FAR size_t *len)
+{
+	FAR const char *ptr = name;
+	uint32_t hash = 2166136261u;
+
+	while (*ptr && *ptr != '/') {
+		hash = (hash ^ (uint8_t)*ptr++) * 16777619u;
+	}
+
+	*len = ptr - name;
+	return hash;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_hash_lookup
+ *
+ * Description:
+ *   Return the child of 'parent' (or the top level inode if 'parent' is
+ *   NULL) named by the first segment of 'name', or NULL if there is none.
+ *
+ * Assumptions:
+ *   The caller holds the tree_sem
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_hash_lookup(FAR struct inode *parent, FAR const char *name)
+{
+	FAR struct inode *node;
+	uint32_t hash;
+	size_t len;
+
+	hash = inode_hash_name(name, &len);
+	if (len == 0) {
+		return NULL;
+	}
+
+	for (node = g_inode_hash[INODE_BUCKET(parent, hash)]; node; node = node->i_hnext) {
+		if (node->i_hash == hash && node->i_parent == parent && strncmp(node->i_name, name, len) == 0 && node->i_name[len] == '\0') {
+			return node;
+		}
+	}
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: inode_hash_insert
+ *
+ * Description:
+ *   Add a newly linked inode to the hash table under 'parent'.
+ *
+ * Assumptions:
+ *   The caller holds the tree_sem
+ *
+ ****************************************************************************/
+
+void inode_hash_insert(FAR struct inode *node, FAR struct inode *parent)
+{
+	FAR struct inode **head;
+	size_t len;
+
+	node->i_hash = inode_hash_name(node->i_name, &len);
+	node->i_parent = parent;
+
+	head = &g_inode_hash[INODE_BUCKET(parent, node->i_hash)];
+	node->i_hnext = *head;
+	*head = node;
+}
+
+/****************************************************************************
+ * Name: inode_hash_remove
+ *
+ * Description:
+ *   Remove an inode from the hash table.  Nothing is done if the inode is
+ *   not in the table.
+ *
+ ****************************************************************************/
+
+void inode_hash_remove(FAR struct inode *node)
+{
+	FAR struct inode **prev;
+
+	/* inode_release() frees deleted subtrees without holding tree_sem */
+
+	inode_semtake();
+	for (prev = &g_inode_hash[INODE_BUCKET(node->i_parent, node->i_hash)]; *prev; prev = &(*prev)->i_hnext) {
+		if (*prev == node) {
+			*prev = node->i_hnext;
+			node->i_hnext = NULL;
+			break;
+		}
+	}
+
+	inode_semgive();
+}
+
+/****************************************************************************
+ * Name: inode_hash_reparent
+ *
+ * Description:
+ *   Re-key the children of 'node' after they were moved under it.
+ *
+ * Assumptions:
+ *   The caller holds the tree_sem
+ *
+ ****************************************************************************/
+
+void inode_hash_reparent(FAR struct inode *node)
+{
+	FAR struct inode *child;
+
+	for (child = node->i_child; child; child = child->i_peer) {
+		inode_hash_remove(child);
+		inode_hash_insert(child, node);
+	}
+}
+
+#endif /* CONFIG_FS_INODE_HASH */
@@ -136,6 +136,10 @@ FAR struct inode *inode_unlink(FAR const char *path)
 		}
 
 		node->i_peer = NULL;
+
+#ifdef CONFIG_FS_INODE_HASH
+		inode_hash_remove(node);
+#endif
 	}
 
 	return node;
@@ -151,6 +151,10 @@ static void inode_insert(FAR struct inode *node, FAR struct inode *peer, FAR str
 		node->i_peer = root_inode;
 		root_inode = node;
 	}
+
+#ifdef CONFIG_FS_INODE_HASH
+	inode_hash_insert(node, parent);
+#endif
 }
 
 /****************************************************************************
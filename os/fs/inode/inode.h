@@ -308,6 +308,60 @@ void inode_addref(FAR struct inode *inode);
 
 void inode_release(FAR struct inode *inode);
 
+#ifdef CONFIG_FS_INODE_HASH
+/* fs_inodehash.c ***********************************************************/
+/****************************************************************************
+ * Name: inode_hash_lookup
+ *
+ * Description:
+ *   Return the child of 'parent' (or the top level inode if 'parent' is
+ *   NULL) named by the first segment of 'name', or NULL if there is none.
+ *
+ * Assumptions:
+ *   The caller holds the tree_sem
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_hash_lookup(FAR struct inode *parent, FAR const char *name);
+
+/****************************************************************************
+ * Name: inode_hash_insert
+ *
+ * Description:
+ *   Add a newly linked inode to the hash table under 'parent'.
+ *
+ * Assumptions:
+ *   The caller holds the tree_sem
+ *
+ ****************************************************************************/
+
+void inode_hash_insert(FAR struct inode *node, FAR struct inode *parent);
+
+/****************************************************************************
+ * Name: inode_hash_remove
+ *
+ * Description:
+ *   Remove an inode from the hash table.  Nothing is done if the inode is
+ *   not in the table.
+ *
+ ****************************************************************************/
+
+void inode_hash_remove(FAR struct inode *node);
+
+/****************************************************************************
+ * Name: inode_hash_reparent
+ *
+ * Description:
+ *   Re-key the children of 'node' after they were moved under it.
+ *
+ * Assumptions:
+ *   The caller holds the tree_sem
+ *
+ ****************************************************************************/
+
+void inode_hash_reparent(FAR struct inode *node);
+#endif
+
 /* fs_foreachinode.c ********************************************************/
 /****************************************************************************
  * Name: foreach_inode
@@ -111,6 +111,7 @@ extern const struct procfs_operations power_procfsoperations;
 extern const struct procfs_operations cm_operations;
 extern const struct procfs_operations irqs_operations;
 extern const struct procfs_operations ereport_operations;
+extern const struct procfs_operations wqueue_operations;
 
 /* And even worse, this one is specific to the STM32.  The solution to
  * this nasty couple would be to replace this hard-coded, ROM-able
@@ -169,6 +170,11 @@ static const struct procfs_entry_s g_procfsentries[] = {
 	{"connectivity**", &cm_operations},
 #endif
 
+#if (defined(CONFIG_SCHED_WORKQUEUE_WHEEL) || defined(CONFIG_SCHED_WORKQUEUE_PERCPU)) && \
+	!defined(CONFIG_FS_PROCFS_EXCLUDE_WQUEUE)
+	{"wqueue", &wqueue_operations},
+#endif
+
 #if !defined(CONFIG_FS_PROCFS_EXCLUDE_EREPORT)
 	{"ereport**", &ereport_operations},
 	{"ereport/*", &ereport_operations},
@@ -66,6 +66,10 @@
 
 #include <tinyara/fs/mtd.h>
 #include <tinyara/fs/smart.h>
+#ifdef CONFIG_SMARTFS_WRITEBACK
+#include <tinyara/clock.h>
+#include <tinyara/wqueue.h>
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -239,7 +243,7 @@
 #define UINT8_TO_UINT16(UINT8_ARRAY)                    ((uint16_t)(((uint16_t)UINT8_ARRAY[1] << 8) & 0xFF00) | UINT8_ARRAY[0])
 #define SMARTFS_NEXTSECTOR(h)   (UINT8_TO_UINT16(h->nextsector))
 #define SMARTFS_USED(h)                 (UINT8_TO_UINT16(h->used))
-#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+#if defined(CONFIG_MTD_SMART_ENABLE_CRC) || defined(CONFIG_SMARTFS_WRITEBACK)
 #define CONFIG_SMARTFS_USE_SECTOR_BUFFER
 #endif
 
@@ -251,6 +255,19 @@
 
 #define SMARTFS_AVAIL_DATABYTES(f) f->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s)
 
+#ifndef CONFIG_SMARTFS_CHAIN_INDEX
+#define CONFIG_SMARTFS_CHAIN_INDEX 0
+#endif
+
+#ifdef CONFIG_SMARTFS_WRITEBACK
+#ifndef CONFIG_SMARTFS_WRITEBACK_FILES
+#define CONFIG_SMARTFS_WRITEBACK_FILES 4
+#endif
+#ifndef CONFIG_SMARTFS_WRITEBACK_MS
+#define CONFIG_SMARTFS_WRITEBACK_MS 0
+#endif
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -305,6 +322,15 @@ struct smartfs_chain_header_s {
 };
 #endif
 
+/* This structure remembers one sector of the chain of an open file. */
+
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+struct smartfs_chainidx_s {
+	uint32_t filepos;			/* File position of the first byte in the sector */
+	uint16_t sector;			/* Logical sector number */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -314,8 +340,12 @@ struct smartfs_ofile_s {
 #ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
 	uint8_t *buffer;			/* Sector buffer to reduce writes */
 	uint8_t bflags;				/* Buffer flags */
+#endif
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	clock_t dirtytime;			/* Time the buffer became dirty, 0 if clean */
 #endif
 	int16_t crefs;				/* Reference count */
+	bool unlinked;				/* Unlinked while open, firstsector may be reused */
 	mode_t oflags;				/* Open mode */
 	struct smartfs_entry_s entry;	/* Describes the SMARTFS inode entry */
 	size_t filepos;				/* Current file position */
@@ -327,6 +357,11 @@ struct smartfs_ofile_s {
 								 * used field until the file is closed,
 								 * a seek, or more data is written that
 								 * causes the sector to change. */
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+	uint16_t nchain;			/* Number of valid entries in chain[] */
+	uint8_t chainshift;			/* chain[n] is sector (n << chainshift) of the chain */
+	struct smartfs_chainidx_s chain[CONFIG_SMARTFS_CHAIN_INDEX];
+#endif
 };
 
 /* This structure represents the overall mountpoint state.  An instance of this
@@ -353,6 +388,12 @@ struct smartfs_mountpt_s {
 #ifdef CONFIG_SMARTFS_ENTRY_TIMESTAMP
 	uint32_t entry_seq;
 #endif
+#if defined(CONFIG_SMARTFS_WRITEBACK) && CONFIG_SMARTFS_WRITEBACK_MS > 0
+	struct work_s fs_wbwork;	/* Writes out buffers dirty for too long */
+	bool fs_wbqueued;			/* fs_wbwork is queued or running */
+	bool fs_wbstop;				/* Unbind waits for the running fs_wbwork */
+	sem_t fs_wbdone;			/* Posted when fs_wbwork stopped for unbind */
+#endif
 };
 
 
@@ -409,6 +450,18 @@ int smartfs_sync_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *
 
 off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf, off_t offset, int whence);
 
+FAR struct smartfs_ofile_s *smartfs_find_openfile(FAR struct smartfs_mountpt_s *fs, uint16_t firstsector);
+
+void smartfs_share_datalen(FAR struct smartfs_mountpt_s *fs, FAR struct smartfs_ofile_s *sf);
+
+void smartfs_mark_unlinked(FAR struct smartfs_mountpt_s *fs, uint16_t firstsector);
+
+#ifdef CONFIG_SMARTFS_WRITEBACK
+void smartfs_writeback_mark(FAR struct smartfs_mountpt_s *fs, FAR struct smartfs_ofile_s *sf);
+
+int smartfs_writeback_flush(FAR struct smartfs_mountpt_s *fs, uint16_t firstsector);
+#endif
+
 ssize_t smartfs_append_data(FAR struct smartfs_mountpt_s *fs, FAR struct smartfs_ofile_s *sf, const char *buffer, size_t byteswritten, size_t buflen);
 
 uint16_t smartfs_rdle16(FAR const void *val);
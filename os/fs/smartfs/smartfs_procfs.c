@@ -730,6 +730,56 @@ static ssize_t smartfs_debug_write(FAR struct file *filep, FAR const char *buffe
 	return buflen;
 }
 
+/****************************************************************************
+ * Name: smartfs_latency_read
+ *
+ * Description: Print the count of sector writes and the p50, p90, p99 and
+ *              maximum write latencies from the log2 histogram of the SMART
+ *              MTD layer.  Each latency is the upper bound of its bucket.
+ *
+ ****************************************************************************/
+
+static size_t smartfs_latency_read(FAR const uint32_t *hist, FAR char *buffer, size_t buflen)
+{
+	static const uint8_t percents[] = { 50, 90, 99, 100 };
+	static const char *const names[] = { "p50", "p90", "p99", "Max" };
+	uint32_t total;
+	uint32_t count;
+	size_t len;
+	int bucket;
+	int x;
+
+	total = 0;
+	for (bucket = 0; bucket < SMART_WRITE_HIST_NBUCKETS; bucket++) {
+		total += hist[bucket];
+	}
+
+	len = snprintf(buffer, buflen, "Sector Writes    %u\n", total);
+	if (total == 0) {
+		return len;
+	}
+
+	for (x = 0; x < (int)sizeof(percents) && len < buflen; x++) {
+		/* Find the bucket holding the requested percentile */
+
+		count = 0;
+		for (bucket = 0; bucket < SMART_WRITE_HIST_NBUCKETS - 1; bucket++) {
+			count += hist[bucket];
+			if ((uint64_t)count * 100 >= (uint64_t)total * percents[x]) {
+				break;
+			}
+		}
+
+		if (bucket == SMART_WRITE_HIST_NBUCKETS - 1) {
+			len += snprintf(&buffer[len], buflen - len, "Write %-10s >= %u ms\n", names[x], 1 << (bucket - 1));
+		} else {
+			len += snprintf(&buffer[len], buflen - len, "Write %-10s < %u ms\n", names[x], 1 << bucket);
+		}
+	}
+
+	return len;
+}
+
 /****************************************************************************
  * Name: smartfs_status_read
  *
@@ -761,6 +811,28 @@ static size_t smartfs_status_read(FAR struct file *filep, FAR char *buffer, size
 		if (ret == OK) {
 			/* Format and return data in the buffer */
 			len = snprintf(buffer, buflen, "Total Sectors    %d\nFree Sectors     %d\n" "Released Sectors %d\n", procfs_data.totalsectors, procfs_data.freesectors, procfs_data.releasesectors);
+			if (len < buflen) {
+				len += snprintf(&buffer[len], buflen - len, "Sector Map RAM   %u\n", procfs_data.mapsize);
+			}
+			if (len < buflen) {
+				len += smartfs_latency_read(procfs_data.writehist, &buffer[len], buflen - len);
+			}
+			if (len < buflen) {
+				len += snprintf(&buffer[len], buflen - len, "GC Blocks Write  %u\nGC Blocks Idle   %u\n", procfs_data.gcblocks, procfs_data.gcidleblocks);
+			}
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+			if (len < buflen) {
+				len += snprintf(&buffer[len], buflen - len, "Map Cache Hits   %u\nMap Cache Misses %u\nMap Scan Reads   %u\n", procfs_data.cachehits, procfs_data.cachemisses, procfs_data.scanreads);
+			}
+#endif
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+			if (len < buflen) {
+				len += snprintf(&buffer[len], buflen - len, "Alloc Index Hits %u\nAlloc Scans      %u\n", procfs_data.allochits, procfs_data.allocscans);
+			}
+#endif
+			if (len > buflen) {
+				len = buflen;
+			}
 #ifdef CONFIG_DEBUG_FS
 			/* Calculate the sector utilization percentage */
 			if (procfs_data.blockerases == 0) {
@@ -70,6 +70,7 @@
 #include <debug.h>
 
 #include <tinyara/kmalloc.h>
+#include <tinyara/semaphore.h>
 #include <tinyara/fs/fs.h>
 #include <tinyara/fs/dirent.h>
 #include <tinyara/fs/ioctl.h>
@@ -175,6 +176,7 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 	struct smartfs_mountpt_s *fs;
 	int ret;
 	struct smartfs_ofile_s *sf;
+	struct smartfs_ofile_s *other;
 #ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
 	struct smart_read_write_s readwrite;
 #endif
@@ -246,8 +248,30 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 			goto errout_with_buffer;
 		}
 
+		/* Another open instance of the file already knows its length and
+		 * part of its sector chain.  Data it has not written yet must
+		 * reach the media first.  See smartfs_find_openfile() for which
+		 * instance is trusted.
+		 */
+
+#ifdef CONFIG_SMARTFS_WRITEBACK
+		ret = smartfs_writeback_flush(fs, sf->entry.firstsector);
+		if (ret < 0) {
+			goto errout_with_buffer;
+		}
+#endif
+		other = smartfs_find_openfile(fs, sf->entry.firstsector);
+		if (other != NULL) {
+			sf->entry.datalen = other->entry.datalen;
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+			sf->nchain = other->nchain;
+			sf->chainshift = other->chainshift;
+			memcpy(sf->chain, other->chain, other->nchain * sizeof(struct smartfs_chainidx_s));
+#endif
+		}
+
 		/* If the file is being opened in a mode other than "READ ONLY", we will need the length of the file */
-		if ((oflags & O_ACCMODE) != O_RDONLY) {
+		if ((oflags & O_ACCMODE) != O_RDONLY && sf->entry.datalen == SMARTFS_DIRENT_LEN_UNKWN) {
 			ret = smartfs_get_datalen(fs, sf->entry.firstsector, &sf->entry.datalen);
 			if (ret < 0) {
 				fdbg("ERROR, Could not get the length of the file, ret : %d\n", ret);
@@ -373,6 +397,10 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 	sf->fnext = fs->fs_head;
 	fs->fs_head = sf;
 
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	smartfs_writeback_mark(fs, sf);
+#endif
+
 	ret = OK;
 	goto errout_with_semaphore;
 
@@ -431,6 +459,14 @@ static int smartfs_close(FAR struct file *filep)
 
 	smartfs_semtake(fs);
 
+	/* Readers of the file still open only know the length it had when
+	 * they opened it.
+	 */
+
+	if ((sf->oflags & O_WROK) != 0 && sf->byteswritten == 0) {
+		smartfs_share_datalen(fs, sf);
+	}
+
 	/* Check if we are the last one with a reference to the file and
 	 * only close if we are. */
 
@@ -522,6 +558,17 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 
 	smartfs_semtake(fs);
 
+#ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
+	/* The sector is read from the media, write out our changes to it first */
+
+	if (sf->bflags & SMARTFS_BFLAG_DIRTY) {
+		ret = smartfs_sync_internal(fs, sf);
+		if (ret < 0) {
+			goto errout_with_semaphore;
+		}
+	}
+#endif
+
 	/* Loop until all byte read or error */
 
 	bytesread = 0;
@@ -777,6 +824,10 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 	}
 	ret = byteswritten;
 
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	smartfs_writeback_mark(fs, sf);
+#endif
+
 errout_with_semaphore:
 	smartfs_semgive(fs);
 	return ret;
@@ -914,6 +965,7 @@ static int smartfs_fstat(FAR const struct file *filep, FAR struct stat *buf)
 	FAR struct inode *inode;
 	FAR struct smartfs_mountpt_s *fs;
 	FAR struct smartfs_ofile_s *sf;
+	int ret;
 
 	DEBUGASSERT(filep != NULL);
 	DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
@@ -928,6 +980,15 @@ static int smartfs_fstat(FAR const struct file *filep, FAR struct stat *buf)
 	/* Take the semaphore */
 	smartfs_semtake(fs);
 
+	/* A file opened read-only has not computed its length yet */
+	if (sf->entry.datalen == SMARTFS_DIRENT_LEN_UNKWN) {
+		ret = smartfs_get_datalen(fs, sf->entry.firstsector, &sf->entry.datalen);
+		if (ret < 0) {
+			smartfs_semgive(fs);
+			return ret;
+		}
+	}
+
 	/* Return information about the directory entry in the stat structure */
 	smartfs_stat_common(fs, &sf->entry, buf);
 	smartfs_semgive(fs);
@@ -1265,6 +1326,10 @@ static int smartfs_bind(FAR struct inode *blkdriver, const void *data, void **ha
 
 	fs->fs_blkdriver = blkdriver;	/* Save the block driver reference */
 	fs->fs_head = NULL;
+#if defined(CONFIG_SMARTFS_WRITEBACK) && CONFIG_SMARTFS_WRITEBACK_MS > 0
+	sem_init(&fs->fs_wbdone, 0, 0);
+	sem_setprotocol(&fs->fs_wbdone, SEM_PRIO_NONE);
+#endif
 
 	/* Now perform the mount.  */
 
@@ -1287,6 +1352,9 @@ static int smartfs_bind(FAR struct inode *blkdriver, const void *data, void **ha
 
 error_with_semaphore:
 	smartfs_semgive(fs);
+#if defined(CONFIG_SMARTFS_WRITEBACK) && CONFIG_SMARTFS_WRITEBACK_MS > 0
+	sem_destroy(&fs->fs_wbdone);
+#endif
 	kmm_free(fs);
 	return ret;
 }
@@ -1318,6 +1386,24 @@ static int smartfs_unbind(void *handle, FAR struct inode **blkdriver)
 		smartfs_semgive(fs);
 		return -EBUSY;
 	}
+#if defined(CONFIG_SMARTFS_WRITEBACK) && CONFIG_SMARTFS_WRITEBACK_MS > 0
+	/* All files were written out when closed, the timer has nothing to do.
+	 * If it could not be cancelled, the worker is already running and
+	 * waits for the semaphore, let it go before 'fs' is freed.
+	 */
+
+	if (fs->fs_wbqueued && work_cancel(LPWORK, &fs->fs_wbwork) != OK) {
+		fs->fs_wbstop = true;
+		smartfs_semgive(fs);
+		while (sem_wait(&fs->fs_wbdone) != OK) {
+			DEBUGASSERT(get_errno() == EINTR);
+		}
+		smartfs_semtake(fs);
+	}
+
+	fs->fs_wbqueued = false;
+	sem_destroy(&fs->fs_wbdone);
+#endif
 	/* Unmount ... close the block driver */
 	ret = smartfs_unmount(fs);
 	smartfs_semgive(fs);
@@ -1413,6 +1499,7 @@ static int smartfs_unlink(struct inode *mountpt, const char *relpath)
 		/* Okay, we are clear to delete the file.  Use the deleteentry routine. */
 
 		smartfs_deleteentry(fs, &entry);
+		smartfs_mark_unlinked(fs, entry.firstsector);
 
 	} else {
 		/* Just report the error */
@@ -1739,6 +1826,7 @@ static int smartfs_stat(struct inode *mountpt, const char *relpath, struct stat
 {
 	struct smartfs_mountpt_s *fs;
 	struct smartfs_entry_s entry;
+	struct smartfs_ofile_s *other;
 	int ret;
 
 	/* Sanity checks */
@@ -1760,8 +1848,22 @@ static int smartfs_stat(struct inode *mountpt, const char *relpath, struct stat
 		goto errout_with_semaphore;
 	}
 
-	/* We need to know the data length of the file too */
-	ret = smartfs_get_datalen(fs, entry.firstsector, &entry.datalen);
+	/* We need to know the data length of the file too.  An open instance
+	 * of the file may know it already.
+	 */
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	ret = smartfs_writeback_flush(fs, entry.firstsector);
+	if (ret < 0) {
+		goto errout_with_semaphore;
+	}
+#endif
+	other = smartfs_find_openfile(fs, entry.firstsector);
+	if (other != NULL) {
+		entry.datalen = other->entry.datalen;
+		ret = OK;
+	} else {
+		ret = smartfs_get_datalen(fs, entry.firstsector, &entry.datalen);
+	}
 	if (ret < 0) {
 		fdbg("ERROR, Could not get the length of the file, ret : %d\n", ret);
 		goto errout_with_semaphore;
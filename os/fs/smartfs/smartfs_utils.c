@@ -59,6 +59,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <fcntl.h>
 #include <string.h>
 #include <time.h>
 #include <semaphore.h>
@@ -522,6 +523,304 @@ out:
 }
 #endif
 
+/****************************************************************************
+ * Name: smartfs_chain_record
+ *
+ * Description: Remember a sector of the chain of an open file.  Only every
+ *              (1 << chainshift)th sector is kept, and only when the
+ *              entries before it are known.  When the index is full, every
+ *              other entry is dropped and the spacing doubles, so that the
+ *              index always covers the part of the file visited so far.
+ *
+ ****************************************************************************/
+
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+static void smartfs_chain_record(FAR struct smartfs_ofile_s *sf, uint32_t chainpos, uint16_t sector, uint32_t filepos)
+{
+	uint16_t x;
+
+	if (sf->nchain == CONFIG_SMARTFS_CHAIN_INDEX && (chainpos >> sf->chainshift) == sf->nchain) {
+		if (sf->chainshift >= 15) {
+			return;
+		}
+
+		for (x = 1; 2 * x < sf->nchain; x++) {
+			sf->chain[x] = sf->chain[2 * x];
+		}
+
+		sf->nchain = (sf->nchain + 1) >> 1;
+		sf->chainshift++;
+	}
+
+	if ((chainpos & ((1 << sf->chainshift) - 1)) != 0 || (chainpos >> sf->chainshift) != sf->nchain) {
+		return;
+	}
+
+	sf->chain[sf->nchain].sector = sector;
+	sf->chain[sf->nchain].filepos = filepos;
+	sf->nchain++;
+}
+#endif
+
+/****************************************************************************
+ * Name: smartfs_chain_truncate
+ *
+ * Description: Forget the sectors freed by shrinking a file to 'length'
+ *              in 'sf' and in every other open instance of the file.  The
+ *              sector holding position 'length' is kept, as is the first
+ *              sector.
+ *
+ ****************************************************************************/
+
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+static void smartfs_chain_truncate(FAR struct smartfs_mountpt_s *fs, FAR struct smartfs_ofile_s *sf, off_t length)
+{
+	FAR struct smartfs_ofile_s *next;
+
+	while (sf->nchain > 1 && sf->chain[sf->nchain - 1].filepos >= length) {
+		sf->nchain--;
+	}
+
+	for (next = fs->fs_head; next != NULL; next = next->fnext) {
+		if (next != sf && next->entry.firstsector == sf->entry.firstsector && !next->unlinked) {
+			while (next->nchain > 1 && next->chain[next->nchain - 1].filepos >= length) {
+				next->nchain--;
+			}
+		}
+	}
+}
+#endif
+
+/****************************************************************************
+ * Name: smartfs_find_openfile
+ *
+ * Description: Return an open instance of the file starting at
+ *              'firstsector' whose length is current and whose data has all
+ *              been written to the device, or NULL if there is none.
+ *              Only an instance opened for writing updates its length, so
+ *              it is preferred, and none is returned while it still holds
+ *              unwritten data.  Otherwise the largest known length wins.
+ *              Unlinked instances belong to a file that no longer exists.
+ *
+ ****************************************************************************/
+
+FAR struct smartfs_ofile_s *smartfs_find_openfile(FAR struct smartfs_mountpt_s *fs, uint16_t firstsector)
+{
+	FAR struct smartfs_ofile_s *sf;
+	FAR struct smartfs_ofile_s *best = NULL;
+	bool clean;
+
+	for (sf = fs->fs_head; sf != NULL; sf = sf->fnext) {
+		if (sf->entry.firstsector != firstsector || sf->unlinked) {
+			continue;
+		}
+
+		clean = sf->byteswritten == 0;
+#ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
+		clean = clean && sf->bflags == SMARTFS_BFLAG_UNMOD;
+#endif
+		if ((sf->oflags & O_WROK) != 0) {
+			if (!clean || sf->entry.datalen == SMARTFS_DIRENT_LEN_UNKWN) {
+				return NULL;
+			}
+
+			return sf;
+		}
+
+		if (clean && sf->entry.datalen != SMARTFS_DIRENT_LEN_UNKWN && (best == NULL || sf->entry.datalen > best->entry.datalen)) {
+			best = sf;
+		}
+	}
+
+	return best;
+}
+
+/****************************************************************************
+ * Name: smartfs_share_datalen
+ *
+ * Description: Give the length of 'sf', whose data is all on the device,
+ *              to every other open instance of the same file, which cannot
+ *              see the writes made through 'sf'.
+ *
+ ****************************************************************************/
+
+void smartfs_share_datalen(FAR struct smartfs_mountpt_s *fs, FAR struct smartfs_ofile_s *sf)
+{
+	FAR struct smartfs_ofile_s *next;
+
+	if (sf->unlinked || sf->entry.datalen == SMARTFS_DIRENT_LEN_UNKWN) {
+		return;
+	}
+
+	for (next = fs->fs_head; next != NULL; next = next->fnext) {
+		if (next != sf && next->entry.firstsector == sf->entry.firstsector && !next->unlinked) {
+			next->entry.datalen = sf->entry.datalen;
+		}
+	}
+}
+
+/****************************************************************************
+ * Name: smartfs_mark_unlinked
+ *
+ * Description: Mark the open instances of the file starting at
+ *              'firstsector' as unlinked, so that a new file reusing the
+ *              sector is not mistaken for them.
+ *
+ ****************************************************************************/
+
+void smartfs_mark_unlinked(FAR struct smartfs_mountpt_s *fs, uint16_t firstsector)
+{
+	FAR struct smartfs_ofile_s *sf;
+
+	for (sf = fs->fs_head; sf != NULL; sf = sf->fnext) {
+		if (sf->entry.firstsector == firstsector) {
+			sf->unlinked = true;
+		}
+	}
+}
+
+#ifdef CONFIG_SMARTFS_WRITEBACK
+#if CONFIG_SMARTFS_WRITEBACK_MS > 0
+/****************************************************************************
+ * Name: smartfs_writeback_worker
+ *
+ * Description: Write out the buffers of the open files which have been dirty
+ *              for CONFIG_SMARTFS_WRITEBACK_MS and queue again for the next
+ *              one which will be.  If unbind found the worker already
+ *              running, it waits for it on fs_wbdone before freeing 'fs'.
+ *
+ ****************************************************************************/
+
+static void smartfs_writeback_worker(FAR void *arg)
+{
+	FAR struct smartfs_mountpt_s *fs = (FAR struct smartfs_mountpt_s *)arg;
+	FAR struct smartfs_ofile_s *sf;
+	clock_t delay = MSEC2TICK(CONFIG_SMARTFS_WRITEBACK_MS);
+	clock_t next = delay;
+	clock_t elapsed;
+	bool dirty = false;
+
+	smartfs_semtake(fs);
+
+	if (fs->fs_wbstop) {
+		fs->fs_wbqueued = false;
+		sem_post(&fs->fs_wbdone);
+		smartfs_semgive(fs);
+		return;
+	}
+
+	for (sf = fs->fs_head; sf != NULL; sf = sf->fnext) {
+		if ((sf->bflags & SMARTFS_BFLAG_DIRTY) == 0) {
+			continue;
+		}
+
+		elapsed = clock_systimer() - sf->dirtytime;
+		if (elapsed >= delay) {
+			if (smartfs_sync_internal(fs, sf) == OK) {
+				continue;
+			}
+
+			/* Try again after another delay */
+
+			elapsed = 0;
+		}
+
+		if (delay - elapsed < next) {
+			next = delay - elapsed;
+		}
+
+		dirty = true;
+	}
+
+	fs->fs_wbqueued = dirty;
+	if (dirty) {
+		work_queue(LPWORK, &fs->fs_wbwork, smartfs_writeback_worker, fs, next);
+	}
+
+	smartfs_semgive(fs);
+}
+#endif
+
+/****************************************************************************
+ * Name: smartfs_writeback_mark
+ *
+ * Description: Note that the buffer of an open file holds unwritten data.
+ *              If more than CONFIG_SMARTFS_WRITEBACK_FILES files do now,
+ *              the buffers of the others dirty the longest are written out.
+ *              The caller holds the mountpoint semaphore.
+ *
+ ****************************************************************************/
+
+void smartfs_writeback_mark(FAR struct smartfs_mountpt_s *fs, FAR struct smartfs_ofile_s *sf)
+{
+	FAR struct smartfs_ofile_s *other;
+	FAR struct smartfs_ofile_s *oldest;
+	clock_t now;
+	int ndirty;
+
+	if ((sf->bflags & SMARTFS_BFLAG_DIRTY) == 0) {
+		return;
+	}
+
+	now = clock_systimer();
+	if (sf->dirtytime == 0) {
+		sf->dirtytime = now;
+	}
+
+	do {
+		ndirty = 1;
+		oldest = NULL;
+		for (other = fs->fs_head; other != NULL; other = other->fnext) {
+			if (other == sf || (other->bflags & SMARTFS_BFLAG_DIRTY) == 0) {
+				continue;
+			}
+
+			ndirty++;
+			if (oldest == NULL || now - other->dirtytime > now - oldest->dirtytime) {
+				oldest = other;
+			}
+		}
+
+		if (ndirty <= CONFIG_SMARTFS_WRITEBACK_FILES) {
+			break;
+		}
+	} while (smartfs_sync_internal(fs, oldest) == OK);
+
+#if CONFIG_SMARTFS_WRITEBACK_MS > 0
+	if (!fs->fs_wbqueued) {
+		fs->fs_wbqueued = true;
+		work_queue(LPWORK, &fs->fs_wbwork, smartfs_writeback_worker, fs, MSEC2TICK(CONFIG_SMARTFS_WRITEBACK_MS));
+	}
+#endif
+}
+
+/****************************************************************************
+ * Name: smartfs_writeback_flush
+ *
+ * Description: Write out the buffers of all open instances of the file
+ *              starting at firstsector, so that its data on the media is
+ *              current before it is opened again or its length is read.
+ *
+ ****************************************************************************/
+
+int smartfs_writeback_flush(FAR struct smartfs_mountpt_s *fs, uint16_t firstsector)
+{
+	FAR struct smartfs_ofile_s *sf;
+	int ret;
+
+	for (sf = fs->fs_head; sf != NULL; sf = sf->fnext) {
+		if (sf->entry.firstsector == firstsector && !sf->unlinked && (sf->bflags & SMARTFS_BFLAG_DIRTY) != 0) {
+			ret = smartfs_sync_internal(fs, sf);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+
+	return OK;
+}
+#endif							/* CONFIG_SMARTFS_WRITEBACK */
+
 /****************************************************************************
  * Name: smartfs_seek_internal
  *
@@ -541,6 +840,12 @@ off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s
 	off_t sectorstartpos;
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
 	int sector_used = 0;
+#endif
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+	uint32_t chainpos = UINT32_MAX;
+	uint16_t lo;
+	uint16_t mid;
+	uint16_t x;
 #endif
 	/* Test if this is a seek to get the current file pos */
 
@@ -560,7 +865,11 @@ off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s
 
 	/* Test if we need to sync the file */
 
+#ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
+	if (sf->byteswritten > 0 || (sf->bflags & SMARTFS_BFLAG_DIRTY)) {
+#else
 	if (sf->byteswritten > 0) {
+#endif
 		/* Perform a sync */
 		smartfs_sync_internal(fs, sf);
 	}
@@ -619,6 +928,36 @@ off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s
 		sf->filepos = 0;
 	}
 
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+	/* Start from the last remembered sector before newpos if it is
+	 * further than where we are.
+	 */
+
+	if (sf->nchain == 0) {
+		smartfs_chain_record(sf, 0, sf->entry.firstsector, 0);
+	}
+
+	lo = 0;
+	x = sf->nchain - 1;
+	while (lo < x) {
+		mid = (lo + x + 1) >> 1;
+		if (sf->chain[mid].filepos < newpos) {
+			lo = mid;
+		} else {
+			x = mid - 1;
+		}
+	}
+
+	if (sf->filepos == 0 || sf->chain[x].filepos > sf->filepos) {
+		sf->currsector = sf->chain[x].sector;
+		sf->filepos = sf->chain[x].filepos;
+		chainpos = (uint32_t)x << sf->chainshift;
+#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
+		sector_used = chainpos;
+#endif
+	}
+#endif
+
 	header = (struct smartfs_chain_header_s *)fs->fs_rwbuffer;
 	while ((sf->currsector != SMARTFS_ERASEDSTATE_16BIT) && (sf->filepos + SMARTFS_AVAIL_DATABYTES(fs) < newpos)) {
 		/* Read the sector's header */
@@ -640,6 +979,11 @@ off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s
 		sf->filepos += SMARTFS_USED(header);
 #endif
 		sf->currsector = SMARTFS_NEXTSECTOR(header);
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+		if (chainpos != UINT32_MAX && sf->currsector != SMARTFS_ERASEDSTATE_16BIT) {
+			smartfs_chain_record(sf, ++chainpos, sf->currsector, sf->filepos);
+		}
+#endif
 	}
 
 #ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
@@ -722,6 +1066,9 @@ int smartfs_sync_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *
 
 		sf->byteswritten = 0;
 		sf->bflags = SMARTFS_BFLAG_UNMOD;
+#ifdef CONFIG_SMARTFS_WRITEBACK
+		sf->dirtytime = 0;
+#endif
 	}
 #else							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
 
@@ -2062,6 +2409,9 @@ int smartfs_shrinkfile(FAR struct smartfs_mountpt_s *fs, FAR struct smartfs_ofil
 		}
 	}
 
+#if CONFIG_SMARTFS_CHAIN_INDEX > 0
+	smartfs_chain_truncate(fs, sf, length);
+#endif
 	return ret;
 }
 
@@ -114,6 +114,9 @@ int close(int fd)
 
 #if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
 		if ((unsigned int)fd < (CONFIG_NFILE_DESCRIPTORS + CONFIG_NSOCKET_DESCRIPTORS)) {
+#ifdef CONFIG_FS_EPOLL
+			epoll_sockclose(fd);
+#endif
 			ret = net_close(fd);
 			leave_cancellation_point();
 			return ret;
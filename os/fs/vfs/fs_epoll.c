@@ -0,0 +1,736 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/vfs/fs_epoll.c
+ *
+ * epoll keeps each descriptor registered with the poll() method of its
+ * driver from epoll_ctl(EPOLL_CTL_ADD) until EPOLL_CTL_DEL, with all of
+ * them posting one semaphore.  epoll_wait() then only collects the revents
+ * the drivers have set, instead of setting up and tearing down every
+ * descriptor on each call as poll() and select() do.  For level triggered
+ * descriptors, only the ones reported by the previous epoll_wait() are
+ * registered again, so that the driver looks at their state once more.
+ *
+ * An epoll handle is an index into a table of CONFIG_FS_EPOLL_NINSTANCES
+ * instances.  Every call holds a reference on the instance, so that
+ * epoll_close() only frees it once the last epoll_ctl() or epoll_wait()
+ * on it has returned.  Closing a registered descriptor removes it from
+ * every instance through epoll_fileclose() or epoll_sockclose().
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/epoll.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/clock.h>
+#include <tinyara/cancelpt.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/semaphore.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/net/net.h>
+#include <arch/irq.h>
+
+#ifdef CONFIG_FS_EPOLL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Flags of struct epoll_item_s */
+
+#define EPOLL_ITEM_SETUP  (1 << 0)	/* Registered with the driver */
+#define EPOLL_ITEM_REARM  (1 << 1)	/* Register again before the next wait */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct epoll_item_s {
+	struct pollfd pfd;			/* Registration with the driver, fd < 0 if unused */
+	FAR struct file *filep;		/* File of pfd.fd, NULL for a socket */
+	uint32_t events;			/* Events as given to epoll_ctl() */
+	epoll_data_t data;			/* Returned with the events */
+	uint8_t flags;				/* See EPOLL_ITEM_* */
+};
+
+struct epoll_head_s {
+	int crefs;					/* References, one for the table and one per call */
+	bool closed;				/* epoll_close() was called */
+	int size;					/* Number of items[] */
+	sem_t exclsem;				/* Serializes epoll_ctl() and epoll_wait() */
+	sem_t sem;					/* Posted by the drivers on events */
+	struct epoll_item_s items[1];	/* Actually 'size' items */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The live instances, indexed by handle.  Protected by a critical section */
+
+static FAR struct epoll_head_s *g_epoll[CONFIG_FS_EPOLL_NINSTANCES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_get
+ *
+ * Description:
+ *   Return the instance behind a handle returned by epoll_create() with a
+ *   reference taken on it, or NULL if the handle is not in use.
+ *
+ ****************************************************************************/
+
+static FAR struct epoll_head_s *epoll_get(int epfd)
+{
+	FAR struct epoll_head_s *eph;
+	irqstate_t flags;
+
+	if ((unsigned int)epfd >= CONFIG_FS_EPOLL_NINSTANCES) {
+		return NULL;
+	}
+
+	flags = enter_critical_section();
+	eph = g_epoll[epfd];
+	if (eph != NULL) {
+		eph->crefs++;
+	}
+
+	leave_critical_section(flags);
+	return eph;
+}
+
+/****************************************************************************
+ * Name: epoll_put
+ *
+ * Description:
+ *   Drop a reference on an instance and free it with the last one.
+ *
+ ****************************************************************************/
+
+static void epoll_put(FAR struct epoll_head_s *eph)
+{
+	irqstate_t flags;
+	int crefs;
+
+	flags = enter_critical_section();
+	crefs = --eph->crefs;
+	leave_critical_section(flags);
+
+	if (crefs == 0) {
+		sem_destroy(&eph->sem);
+		sem_destroy(&eph->exclsem);
+		kmm_free(eph);
+	}
+}
+
+/****************************************************************************
+ * Name: epoll_getfile
+ *
+ * Description:
+ *   Return the file behind 'fd', NULL for a socket.  Items are matched on
+ *   it too, since the same descriptor number means another file in another
+ *   task group.
+ *
+ ****************************************************************************/
+
+static int epoll_getfile(int fd, FAR struct file **filep)
+{
+	*filep = NULL;
+	if ((unsigned int)fd < CONFIG_NFILE_DESCRIPTORS) {
+		return fs_getfilep(fd, filep) == OK ? OK : -EBADF;
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_semtake
+ ****************************************************************************/
+
+static void epoll_semtake(FAR sem_t *sem)
+{
+	while (sem_wait(sem) != 0) {
+		/* The only case that an error should occur here is if the wait was
+		 * awakened by a signal.
+		 */
+
+		ASSERT(get_errno() == EINTR);
+	}
+}
+
+/****************************************************************************
+ * Name: epoll_fdsetup
+ *
+ * Description:
+ *   Register (or unregister) one item with the poll() method of the driver
+ *   of its file or socket descriptor.  Files are reached through the
+ *   struct file, which is the same whichever task calls.
+ *
+ ****************************************************************************/
+
+static int epoll_fdsetup(FAR struct epoll_head_s *eph, FAR struct epoll_item_s *item, bool setup)
+{
+	FAR struct pollfd *fds = &item->pfd;
+	int ret = -EBADF;
+
+	if (setup) {
+		fds->sem = &eph->sem;
+		fds->events = (pollevent_t)((item->events & (POLLIN | POLLOUT)) | POLLERR | POLLHUP);
+		fds->revents = 0;
+		fds->priv = NULL;
+		fds->filep = NULL;
+	} else if ((item->flags & EPOLL_ITEM_SETUP) == 0) {
+		return OK;
+	}
+
+	if (item->filep != NULL) {
+		ret = file_poll(item->filep, fds, setup);
+	} else
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+	if ((unsigned int)fds->fd < (CONFIG_NFILE_DESCRIPTORS + CONFIG_NSOCKET_DESCRIPTORS)) {
+		ret = net_poll(fds->fd, fds, setup);
+	} else
+#endif
+	{
+		ret = -EBADF;
+	}
+
+	if (setup && ret >= 0) {
+		item->flags |= EPOLL_ITEM_SETUP;
+	} else if (!setup) {
+		item->flags &= ~EPOLL_ITEM_SETUP;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: epoll_collect
+ *
+ * Description:
+ *   Copy the events the drivers have reported into evs[].  Returns the
+ *   number of entries filled.
+ *
+ ****************************************************************************/
+
+static int epoll_collect(FAR struct epoll_head_s *eph, FAR struct epoll_event *evs, int maxevents)
+{
+	FAR struct epoll_item_s *item;
+	irqstate_t flags;
+	pollevent_t revents;
+	int nevents = 0;
+	int i;
+
+	for (i = 0; i < eph->size && nevents < maxevents; i++) {
+		item = &eph->items[i];
+		if (item->pfd.fd < 0) {
+			continue;
+		}
+
+		/* Drivers may set revents from interrupt handlers */
+
+		flags = enter_critical_section();
+		revents = item->pfd.revents;
+		item->pfd.revents = 0;
+		leave_critical_section(flags);
+
+		revents &= item->pfd.events;
+		if (revents == 0) {
+			continue;
+		}
+
+		evs[nevents].events = revents;
+		evs[nevents].data = item->data;
+		nevents++;
+
+		if (item->events & EPOLLONESHOT) {
+			/* Nothing more until EPOLL_CTL_MOD enables it again */
+
+			(void)epoll_fdsetup(eph, item, false);
+			item->pfd.events = 0;
+		} else if ((item->events & EPOLLET) == 0) {
+			item->flags |= EPOLL_ITEM_REARM;
+		}
+	}
+
+	return nevents;
+}
+
+/****************************************************************************
+ * Name: epoll_rearm
+ *
+ * Description:
+ *   Register the level triggered items reported last time again, so that
+ *   the drivers report them at once if they are still ready.
+ *
+ ****************************************************************************/
+
+static void epoll_rearm(FAR struct epoll_head_s *eph)
+{
+	FAR struct epoll_item_s *item;
+	int i;
+
+	for (i = 0; i < eph->size; i++) {
+		item = &eph->items[i];
+		if (item->pfd.fd >= 0 && (item->flags & EPOLL_ITEM_REARM) != 0) {
+			item->flags &= ~EPOLL_ITEM_REARM;
+			(void)epoll_fdsetup(eph, item, false);
+			if (epoll_fdsetup(eph, item, true) < 0) {
+				/* The descriptor went away, tell the caller once */
+
+				item->pfd.revents = POLLERR;
+				item->pfd.events = POLLERR;
+			}
+		}
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_create
+ *
+ * Description:
+ *   Create an epoll instance for up to 'size' descriptors.
+ *
+ * Returned Value:
+ *   A handle to the instance, to be released with epoll_close().  -1 is
+ *   returned with errno set on failure, EMFILE if all
+ *   CONFIG_FS_EPOLL_NINSTANCES instances are in use.
+ *
+ ****************************************************************************/
+
+int epoll_create(int size)
+{
+	FAR struct epoll_head_s *eph;
+	irqstate_t flags;
+	int epfd;
+	int i;
+
+	if (size <= 0) {
+		set_errno(EINVAL);
+		return ERROR;
+	}
+
+	eph = (FAR struct epoll_head_s *)kmm_zalloc(sizeof(struct epoll_head_s) + (size - 1) * sizeof(struct epoll_item_s));
+	if (eph == NULL) {
+		set_errno(ENOMEM);
+		return ERROR;
+	}
+
+	eph->size = size;
+	for (i = 0; i < size; i++) {
+		eph->items[i].pfd.fd = -1;
+	}
+
+	sem_init(&eph->exclsem, 0, 1);
+	sem_init(&eph->sem, 0, 0);
+
+	/* The event semaphore is used for signaling and, hence, should not have
+	 * priority inheritance enabled.
+	 */
+
+	sem_setprotocol(&eph->sem, SEM_PRIO_NONE);
+	eph->crefs = 1;
+
+	flags = enter_critical_section();
+	for (epfd = 0; epfd < CONFIG_FS_EPOLL_NINSTANCES; epfd++) {
+		if (g_epoll[epfd] == NULL) {
+			g_epoll[epfd] = eph;
+			break;
+		}
+	}
+
+	leave_critical_section(flags);
+
+	if (epfd >= CONFIG_FS_EPOLL_NINSTANCES) {
+		epoll_put(eph);
+		set_errno(EMFILE);
+		return ERROR;
+	}
+
+	return epfd;
+}
+
+/****************************************************************************
+ * Name: epoll_ctl
+ *
+ * Description:
+ *   Register (EPOLL_CTL_ADD), change (EPOLL_CTL_MOD) or remove
+ *   (EPOLL_CTL_DEL) the descriptor 'fd' of an epoll instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 with errno set on failure.
+ *
+ ****************************************************************************/
+
+int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
+{
+	FAR struct epoll_head_s *eph;
+	FAR struct epoll_item_s *item = NULL;
+	FAR struct epoll_item_s *unused = NULL;
+	FAR struct file *filep;
+	int ret = OK;
+	int i;
+
+	if (fd < 0 || epoll_getfile(fd, &filep) < 0) {
+		set_errno(EBADF);
+		return ERROR;
+	}
+
+	if (op != EPOLL_CTL_DEL && ev == NULL) {
+		set_errno(EINVAL);
+		return ERROR;
+	}
+
+	eph = epoll_get(epfd);
+	if (eph == NULL) {
+		set_errno(EBADF);
+		return ERROR;
+	}
+
+	epoll_semtake(&eph->exclsem);
+
+	if (eph->closed) {
+		ret = -EBADF;
+		goto errout_with_sem;
+	}
+
+	for (i = 0; i < eph->size; i++) {
+		if (eph->items[i].pfd.fd == fd && eph->items[i].filep == filep) {
+			item = &eph->items[i];
+			break;
+		} else if (eph->items[i].pfd.fd < 0 && unused == NULL) {
+			unused = &eph->items[i];
+		}
+	}
+
+	switch (op) {
+	case EPOLL_CTL_ADD:
+		if (item != NULL) {
+			ret = -EEXIST;
+			break;
+		}
+
+		if (unused == NULL) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		unused->pfd.fd = fd;
+		unused->filep = filep;
+		unused->events = ev->events;
+		unused->data = ev->data;
+		unused->flags = 0;
+		ret = epoll_fdsetup(eph, unused, true);
+		if (ret < 0) {
+			unused->pfd.fd = -1;
+		}
+
+		break;
+
+	case EPOLL_CTL_MOD:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		(void)epoll_fdsetup(eph, item, false);
+
+		item->events = ev->events;
+		item->data = ev->data;
+		item->flags &= ~EPOLL_ITEM_REARM;
+		ret = epoll_fdsetup(eph, item, true);
+		if (ret < 0) {
+			item->pfd.fd = -1;
+		}
+
+		break;
+
+	case EPOLL_CTL_DEL:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		(void)epoll_fdsetup(eph, item, false);
+
+		item->pfd.fd = -1;
+		break;
+
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+errout_with_sem:
+	sem_post(&eph->exclsem);
+	epoll_put(eph);
+
+	if (ret < 0) {
+		set_errno(-ret);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_wait
+ *
+ * Description:
+ *   Wait for events on the descriptors of an epoll instance.  'timeout' is
+ *   in milliseconds, zero returns at once and a negative value waits
+ *   forever.
+ *
+ * Returned Value:
+ *   The number of entries filled in evs[], zero on timeout, or -1 with
+ *   errno set on failure.
+ *
+ ****************************************************************************/
+
+int epoll_wait(int epfd, FAR struct epoll_event *evs, int maxevents, int timeout)
+{
+	FAR struct epoll_head_s *eph;
+	struct timespec abstime;
+	irqstate_t flags;
+	int nevents = 0;
+	int ret = OK;
+
+	/* epoll_wait() is a cancellation point */
+
+	(void)enter_cancellation_point();
+
+	if (evs == NULL || maxevents <= 0) {
+		set_errno(EINVAL);
+		leave_cancellation_point();
+		return ERROR;
+	}
+
+	eph = epoll_get(epfd);
+	if (eph == NULL) {
+		set_errno(EBADF);
+		leave_cancellation_point();
+		return ERROR;
+	}
+
+	if (timeout > 0) {
+		(void)clock_gettime(CLOCK_REALTIME, &abstime);
+		abstime.tv_sec += timeout / MSEC_PER_SEC;
+		abstime.tv_nsec += (timeout % MSEC_PER_SEC) * NSEC_PER_MSEC;
+		if (abstime.tv_nsec >= NSEC_PER_SEC) {
+			abstime.tv_sec++;
+			abstime.tv_nsec -= NSEC_PER_SEC;
+		}
+	}
+
+	epoll_semtake(&eph->exclsem);
+	epoll_rearm(eph);
+
+	for (;;) {
+		if (eph->closed) {
+			/* epoll_close() woke us up */
+
+			ret = EBADF;
+			break;
+		}
+
+		nevents = epoll_collect(eph, evs, maxevents);
+		if (nevents > 0 || timeout == 0) {
+			break;
+		}
+
+		/* Nothing yet.  The semaphore may also count posts for events
+		 * already collected, then we just look again.
+		 */
+
+		sem_post(&eph->exclsem);
+
+		if (timeout < 0) {
+			ret = sem_wait(&eph->sem);
+		} else {
+			flags = enter_critical_section();
+			ret = sem_timedwait(&eph->sem, &abstime);
+			leave_critical_section(flags);
+		}
+
+		if (ret < 0) {
+			ret = get_errno();
+			epoll_put(eph);
+			if (ret == ETIMEDOUT) {
+				leave_cancellation_point();
+				return 0;
+			}
+
+			set_errno(ret);
+			leave_cancellation_point();
+			return ERROR;
+		}
+
+		epoll_semtake(&eph->exclsem);
+	}
+
+	sem_post(&eph->exclsem);
+	epoll_put(eph);
+	leave_cancellation_point();
+
+	if (ret == EBADF) {
+		set_errno(EBADF);
+		return ERROR;
+	}
+
+	return nevents;
+}
+
+/****************************************************************************
+ * Name: epoll_close
+ *
+ * Description:
+ *   Unregister all descriptors and release an epoll instance.  The handle
+ *   is invalid at once; an epoll_wait() on it returns with EBADF, and the
+ *   memory is freed when the last call using it has returned.
+ *
+ ****************************************************************************/
+
+void epoll_close(int epfd)
+{
+	FAR struct epoll_head_s *eph;
+	irqstate_t flags;
+	int sval;
+	int i;
+
+	if ((unsigned int)epfd >= CONFIG_FS_EPOLL_NINSTANCES) {
+		return;
+	}
+
+	flags = enter_critical_section();
+	eph = g_epoll[epfd];
+	g_epoll[epfd] = NULL;
+	leave_critical_section(flags);
+
+	if (eph == NULL) {
+		return;
+	}
+
+	epoll_semtake(&eph->exclsem);
+
+	for (i = 0; i < eph->size; i++) {
+		if (eph->items[i].pfd.fd >= 0) {
+			(void)epoll_fdsetup(eph, &eph->items[i], false);
+			eph->items[i].pfd.fd = -1;
+		}
+	}
+
+	eph->closed = true;
+	sem_post(&eph->exclsem);
+
+	/* Wake up the waiters, which see 'closed' */
+
+	while (sem_getvalue(&eph->sem, &sval) == 0 && sval < 0) {
+		sem_post(&eph->sem);
+	}
+
+	/* Drop the reference of the table */
+
+	epoll_put(eph);
+}
+
+/****************************************************************************
+ * Name: epoll_remove
+ *
+ * Description:
+ *   Remove the file 'filep', or the socket 'fd' if filep is NULL, from
+ *   every epoll instance, so that no driver keeps a registration pointing
+ *   into an instance after the descriptor is closed.
+ *
+ ****************************************************************************/
+
+static void epoll_remove(FAR struct file *filep, int fd)
+{
+	FAR struct epoll_head_s *eph;
+	FAR struct epoll_item_s *item;
+	int epfd;
+	int i;
+
+	for (epfd = 0; epfd < CONFIG_FS_EPOLL_NINSTANCES; epfd++) {
+		eph = epoll_get(epfd);
+		if (eph == NULL) {
+			continue;
+		}
+
+		epoll_semtake(&eph->exclsem);
+
+		for (i = 0; i < eph->size && !eph->closed; i++) {
+			item = &eph->items[i];
+			if (item->pfd.fd >= 0 && item->filep == filep && (filep != NULL || item->pfd.fd == fd)) {
+				(void)epoll_fdsetup(eph, item, false);
+				item->pfd.fd = -1;
+			}
+		}
+
+		sem_post(&eph->exclsem);
+		epoll_put(eph);
+	}
+}
+
+/****************************************************************************
+ * Name: epoll_fileclose
+ *
+ * Description:
+ *   Remove a file that is being closed from every epoll instance.
+ *
+ ****************************************************************************/
+
+void epoll_fileclose(FAR struct file *filep)
+{
+	epoll_remove(filep, -1);
+}
+
+/****************************************************************************
+ * Name: epoll_sockclose
+ *
+ * Description:
+ *   Remove a socket descriptor that is being closed from every epoll
+ *   instance.
+ *
+ ****************************************************************************/
+
+void epoll_sockclose(int sockfd)
+{
+	epoll_remove(NULL, sockfd);
+}
+
+#endif							/* CONFIG_FS_EPOLL */
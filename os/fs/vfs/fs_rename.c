@@ -199,6 +199,9 @@ int rename(FAR const char *oldpath, FAR const char *newpath)
 		/* Copy the inode state from the old inode to the newly allocated inode */
 
 		newinode->i_child = oldinode->i_child;	/* Link to lower level inode */
+#ifdef CONFIG_FS_INODE_HASH
+		inode_hash_reparent(newinode);
+#endif
 		newinode->i_flags = oldinode->i_flags;	/* Flags for inode */
 		newinode->u.i_ops = oldinode->u.i_ops;	/* Inode operations */
 #ifdef CONFIG_FILE_MODE
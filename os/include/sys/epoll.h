@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/**
+ * @defgroup EPOLL_KERNEL EPOLL
+ * @brief Provides APIs for scalable I/O event notification
+ * @ingroup KERNEL
+ *
+ * @{
+ */
+
+/// @file sys/epoll.h
+/// @brief epoll APIs
+
+#ifndef __INCLUDE_SYS_EPOLL_H
+#define __INCLUDE_SYS_EPOLL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <poll.h>
+
+#ifdef CONFIG_FS_EPOLL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* epoll_ctl() operations */
+
+#define EPOLL_CTL_ADD  1		/* Register a descriptor */
+#define EPOLL_CTL_DEL  2		/* Remove a registered descriptor */
+#define EPOLL_CTL_MOD  3		/* Change the events of a registered descriptor */
+
+/* Events.  The low bits are the poll() events, EPOLLERR and EPOLLHUP are
+ * always reported.
+ */
+
+#define EPOLLIN        POLLIN
+#define EPOLLPRI       POLLPRI
+#define EPOLLOUT       POLLOUT
+#define EPOLLRDNORM    POLLRDNORM
+#define EPOLLRDBAND    POLLRDBAND
+#define EPOLLWRNORM    POLLWRNORM
+#define EPOLLWRBAND    POLLWRBAND
+#define EPOLLERR       POLLERR
+#define EPOLLHUP       POLLHUP
+
+#define EPOLLONESHOT   (1u << 30)	/* Disable the descriptor once reported */
+#define EPOLLET        (1u << 31)	/* Report only the driver notifications */
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+typedef union epoll_data {
+	FAR void *ptr;
+	int fd;
+	uint32_t u32;
+} epoll_data_t;
+
+struct epoll_event {
+	uint32_t events;			/* EPOLL* events */
+	epoll_data_t data;			/* Returned as given to epoll_ctl() */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief Create an epoll instance for up to 'size' descriptors
+ * @details @b #include <sys/epoll.h> \n
+ * SYSTEM CALL API \n
+ * The returned handle is a small non-negative index, not a file
+ * descriptor, release it with epoll_close() instead of close().
+ * @since TizenRT v4.0
+ */
+int epoll_create(int size);
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief Register, change or remove a descriptor of an epoll instance
+ * @details @b #include <sys/epoll.h> \n
+ * SYSTEM CALL API \n
+ * A descriptor stays registered with its driver until EPOLL_CTL_DEL or
+ * until it is closed.
+ * @since TizenRT v4.0
+ */
+int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev);
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief Wait up to 'timeout' ms for events on an epoll instance
+ * @details @b #include <sys/epoll.h> \n
+ * SYSTEM CALL API
+ * @since TizenRT v4.0
+ */
+int epoll_wait(int epfd, FAR struct epoll_event *evs, int maxevents, int timeout);
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief Remove all descriptors and release an epoll instance
+ * @details @b #include <sys/epoll.h> \n
+ * SYSTEM CALL API
+ * @since TizenRT v4.0
+ */
+void epoll_close(int epfd);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif							/* CONFIG_FS_EPOLL */
+#endif							/* __INCLUDE_SYS_EPOLL_H */
+/**
+ * @}
+ */
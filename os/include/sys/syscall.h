@@ -288,14 +288,23 @@
 #define SYS_aio_write                  (__SYS_descriptors + 7)
 #define SYS_aio_fsync                  (__SYS_descriptors + 8)
 #define SYS_aio_cancel                 (__SYS_descriptors + 9)
-#define __SYS_poll                     (__SYS_descriptors + 10)
+#define SYS_lio_listio                 (__SYS_descriptors + 10)
+#define __SYS_poll                     (__SYS_descriptors + 11)
 #else
 #define __SYS_poll                     (__SYS_descriptors + 6)
 #endif
 #ifndef CONFIG_DISABLE_POLL
 #define SYS_poll                       __SYS_poll
 #define SYS_select                     (__SYS_poll + 1)
+#ifdef CONFIG_FS_EPOLL
+#define SYS_epoll_create               (__SYS_poll + 2)
+#define SYS_epoll_ctl                  (__SYS_poll + 3)
+#define SYS_epoll_wait                 (__SYS_poll + 4)
+#define SYS_epoll_close                (__SYS_poll + 5)
+#define __SYS_boardctl                 (__SYS_poll + 6)
+#else
 #define __SYS_boardctl                 (__SYS_poll + 2)
+#endif
 #else
 #define __SYS_boardctl                 __SYS_poll
 #endif
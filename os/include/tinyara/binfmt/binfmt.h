@@ -102,6 +102,18 @@ typedef FAR void (*binfmt_dtor_t)(void);
  * will attempt to load each file that is found at those absolute paths.
  */
 
+#ifdef CONFIG_ELF_CACHE_READ
+/* Counters of the ELF block cache for the load of a binary */
+
+struct binfmt_cache_stats_s {
+	uint32_t hits;				/* Reads served from the cache */
+	uint32_t misses;			/* Reads of blocks not cached */
+	uint32_t prefetched;			/* Blocks read ahead */
+	uint32_t prefetch_hits;			/* Blocks read ahead and used later */
+	uint32_t ghost_hits;			/* Demand misses on blocks recently evicted */
+};
+#endif
+
 struct symtab_s;
 struct binary_s {
 	/* Information provided to the loader to load and bind a module */
@@ -167,6 +179,13 @@ struct binary_s {
 	size_t stacksize;			/* Size of the stack in bytes (unallocated) */
 	size_t filelen;                 /* Size of binary size, used only when underlying is MTD */
 	size_t offset;                  /* Offset of binary from partition start*/
+#ifdef CONFIG_ELF_CACHE_READ
+	struct binfmt_cache_stats_s cache_stats;	/* Block cache counters of the load */
+#endif
+#ifdef CONFIG_ELF
+	uint32_t nrelocs;			/* Number of relocations done by elf_bind() */
+	clock_t reloc_ticks;			/* Time spent in elf_bind(), in ticks */
+#endif
 #ifdef CONFIG_BINARY_MANAGER
 	uint8_t binary_idx;             /* Index of binary in binary table */
 	uint32_t bin_ver;               /* version of binary */
@@ -22,6 +22,8 @@
 /****************************************************************************
  * Included Files
  ****************************************************************************/
+#include <sys/types.h>
+#include <stdint.h>
 #include <tinyara/compression.h>
 
 /****************************************************************************
@@ -38,6 +40,18 @@ struct s_buffer {
 	unsigned char *out_buffer;
 };
 
+/* Timing of the blocks read from a compressed file, in clock ticks.  With
+ * the decompress pipeline, reads and decompression overlap and the sum of
+ * the stages may exceed the elapsed time.
+ */
+struct compress_stats_s {
+	uint32_t nblocks;			/* Blocks read and decompressed */
+	uint32_t nhits;				/* Blocks found in the block cache */
+	clock_t read_ticks;			/* Reading compressed blocks */
+	clock_t decompress_ticks;	/* Decompressing blocks */
+	clock_t wait_ticks;			/* Reader waiting for the decompress workers */
+};
+
 /****************************************************************************
  * Function Prototypes
  ****************************************************************************/
@@ -88,4 +102,16 @@ int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, s
  ****************************************************************************/
 struct s_header *get_compression_header(void);
 
+/****************************************************************************
+ * Name: compress_get_stats
+ *
+ * Description:
+ *   Return the timing of the blocks read since the last compress_init()
+ *   and clear it
+ *
+ * Returned Value:
+ *   None
+ ****************************************************************************/
+void compress_get_stats(FAR struct compress_stats_s *stats);
+
 #endif							/* __INCLUDE_COMPRESS_READ_H */
@@ -173,6 +173,16 @@ struct block_operations {
 	int (*unlink)(FAR struct inode *inode);
 };
 
+/* Sector cache statistics of a BCH device, returned by DIOC_CACHESTAT */
+
+struct bch_cachestat_s {
+	uint32_t hits;				/* Sector accesses served from the cache */
+	uint32_t misses;			/* Sector accesses that had to read the media */
+	uint32_t readahead;			/* Sectors read ahead of a sequential reader */
+	uint32_t writebacks;		/* Block driver writes of modified sectors */
+	uint32_t written;			/* Modified sectors written by them */
+};
+
 /* This structure is provided by a filesystem to describe a mount point.
  * Note that this structure differs from file_operations ONLY in the form of
  * the open method.  Once the file is opened, it can be accessed either as a
@@ -284,6 +294,11 @@ struct inode {
 	mode_t i_mode;				/* Access mode flags */
 #endif
 	FAR void *i_private;		/* Per inode driver private data */
+#ifdef CONFIG_FS_INODE_HASH
+	FAR struct inode *i_parent;	/* Link to upper level inode */
+	FAR struct inode *i_hnext;	/* Link to next inode in the hash bucket */
+	uint32_t i_hash;			/* Hash of i_name */
+#endif
 	char i_name[1];				/* Name of inode (variable) */
 };
 #define FSNODE_SIZE(n) (sizeof(struct inode) + (n))
@@ -1027,6 +1042,25 @@ int file_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup);
 
 int fdesc_poll(int fd, FAR struct pollfd *fds, bool setup);
 
+/* fs/vfs/fs_epoll.c ********************************************************/
+/****************************************************************************
+ * Name: epoll_fileclose and epoll_sockclose
+ *
+ * Description:
+ *   Remove a file, or a socket descriptor, that is being closed from every
+ *   epoll instance it is registered with.
+ *
+ * Input Parameters:
+ *   filep  - The file being closed
+ *   sockfd - The socket descriptor being closed
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_EPOLL
+void epoll_fileclose(FAR struct file *filep);
+void epoll_sockclose(int sockfd);
+#endif
+
 /* fs/driver/block/fs_blockproxy.c ******************************************/
 /****************************************************************************
  * Name: unique_chardev_initialize
@@ -1062,6 +1096,21 @@ void devnull_register(void);
 
 void devzero_register(void);
 
+/* drivers/pipes/fifo.c *****************************************************/
+/****************************************************************************
+ * Name: mkfifo2
+ *
+ * Description:
+ *   Like mkfifo(), but with a ringbuffer of 'bufsize' bytes instead of
+ *   CONFIG_DEV_PIPE_SIZE.  For use inside the OS only; applications use the
+ *   PIPEIOC_SETSIZE ioctl instead.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PIPES
+int mkfifo2(FAR const char *pathname, mode_t mode, size_t bufsize);
+#endif
+
 /* drivers/loop.c ***********************************************************/
 /****************************************************************************
  * Name: losetup
@@ -1096,6 +1145,17 @@ int loteardown(FAR const char *devname);
 
 int bchdev_register(FAR const char *blkdev, FAR const char *chardev, bool readonly);
 
+/****************************************************************************
+ * Name: bchdev_register_cache
+ *
+ * Description:
+ *   Same as bchdev_register(), with a cache of 'ncached' sectors instead of
+ *   CONFIG_BCH_CACHE_NSECTORS
+ *
+ ****************************************************************************/
+
+int bchdev_register_cache(FAR const char *blkdev, FAR const char *chardev, bool readonly, int ncached);
+
 /* drivers/bch/bchdev_unregister.c ******************************************/
 /****************************************************************************
  * Name: bchdev_unregister
@@ -1124,6 +1184,17 @@ int bchdev_unregister(FAR const char *chardev);
 
 int bchlib_setup(FAR const char *blkdev, bool readonly, FAR void **handle);
 
+/****************************************************************************
+ * Name: bchlib_setup_cache
+ *
+ * Description:
+ *   Same as bchlib_setup(), with a cache of 'ncached' sectors instead of
+ *   CONFIG_BCH_CACHE_NSECTORS
+ *
+ ****************************************************************************/
+
+int bchlib_setup_cache(FAR const char *blkdev, bool readonly, int ncached, FAR void **handle);
+
 /* drivers/bch/bchlib_teardown.c ********************************************/
 /****************************************************************************
  * Name: bchlib_teardown
@@ -57,6 +57,7 @@
  ****************************************************************************/
 
 #include <tinyara/config.h>
+#include <sys/types.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -104,6 +105,7 @@
 #define _THERMALBASE	(0x2900)	/* thermal camera control ioctl commands */
 #define _COMPBASE       (0x2a00)	/* compress ioctl commands */
 #define _PMBASE         (0x2b00)    	/* pm ioctl commands */
+#define _NOTEBASE       (0x2c00)	/* Scheduler note driver ioctl commands */
 #define _TESTIOCBASE    (0xfe00)	/* KERNEL TEST DRV module ioctl commands */
 #define _MIPIDSIBASE    (0x3900) 	/* Mipidsi device ioctl commands */
 #define _CSIIOCBASE     (0x3a00) 	/* Wifi CSI ioctl commands */
@@ -188,6 +190,13 @@
 #define DIOC_SETKEY     _DIOC(0X0004)	/* IN:  Encryption key
 										 * OUT: None
 										 */
+#define DIOC_FLUSH      _DIOC(0x0005)	/* IN:  None
+										 * OUT: None (ioctl return value provides
+										 *      success/failure indication).
+										 */
+#define DIOC_CACHESTAT  _DIOC(0x0006)	/* IN:  Pointer to a struct bch_cachestat_s
+										 * OUT: Cache statistics of the device
+										 */
 
 /* TinyAra block driver ioctl definitions *************************************/
 
@@ -393,6 +402,21 @@
 											 *       (default)
 											 *     1=fre when empty
 											 * OUT: None */
+#define PIPEIOC_SPLICEOUT  _PIPEIOC(0x0002)	/* Move buffered data to another
+											 * descriptor
+											 * IN: Pointer to struct
+											 *     pipe_splice_s
+											 * OUT: Bytes moved (returned) */
+#define PIPEIOC_SPLICEIN   _PIPEIOC(0x0003)	/* Move data from another
+											 * descriptor into the pipe
+											 * IN: Pointer to struct
+											 *     pipe_splice_s
+											 * OUT: Bytes moved (returned) */
+#define PIPEIOC_SETSIZE    _PIPEIOC(0x0004)	/* Set the ringbuffer size of
+											 * an empty pipe
+											 * IN: unsigned long integer,
+											 *     2..CONFIG_DEV_PIPE_MAXSIZE
+											 * OUT: None */
 /* RTC driver ioctl definitions *********************************************/
 /* (see include/tinyara/rtc.h */
 
@@ -508,6 +532,21 @@
 #define CPULOADIOC_STOP               _CPULOADIOC(0x0002)
 #define CPULOADIOC_GETVALUE           _CPULOADIOC(0x0003)
 
+/* Scheduler note driver ioctl definitions ************************/
+/* NOTEIOC_CLEAR:   Drop all buffered notes.  Argument: Ignored
+ * NOTEIOC_ENABLE:  Start (arg != 0) or stop (arg == 0) recording notes
+ * NOTEIOC_GETLOST: Number of overruns, where notes were overwritten before
+ *                  being read.  Argument: A reference to uint32_t, the
+ *                  count is cleared
+ */
+
+#define _NOTEIOCVALID(c)      (_IOC_TYPE(c) == _NOTEBASE)
+#define _NOTEIOC(nr)          _IOC(_NOTEBASE, nr)
+
+#define NOTEIOC_CLEAR                 _NOTEIOC(0x0001)
+#define NOTEIOC_ENABLE                _NOTEIOC(0x0002)
+#define NOTEIOC_GETLOST               _NOTEIOC(0x0003)
+
 /* Audio driver ioctl definitions *************************************/
 /* (see tinyara/audio/audio.h) */
 
@@ -518,6 +557,13 @@
  * Public Type Definitions
  ****************************************************************************/
 
+/* Argument of PIPEIOC_SPLICEOUT and PIPEIOC_SPLICEIN */
+
+struct pipe_splice_s {
+	int fd;						/* File or socket descriptor at the other end */
+	size_t len;					/* Maximum number of bytes to move */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
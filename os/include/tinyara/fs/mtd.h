@@ -117,6 +117,16 @@ struct mtd_byte_write_s {
 	const uint8_t *buffer;		/* Pointer to the data to write */
 };
 
+#ifdef CONFIG_FTL_LOG
+/* Write amplification counters of the log-structured FTL, in R/W blocks */
+
+struct ftl_logstat_s {
+	uint32_t hostwrites;		/* Blocks written through the block driver */
+	uint32_t flashwrites;		/* Blocks programmed, including relocations */
+	uint32_t erases;			/* Erase blocks erased */
+};
+#endif
+
 /* This structure defines the interface to a simple memory technology device.
  * It will likely need to be extended in the future to support more complex
  * devices.
@@ -176,6 +186,12 @@ struct mtd_dev_s {
 	/* Name of this MTD device */
 
 	FAR const char *name;
+
+#ifdef CONFIG_FTL_LOG
+	/* Counters of the log-structured FTL on this device, if any */
+
+	FAR const struct ftl_logstat_s *ftlstat;
+#endif
 #endif
 };
 
@@ -305,6 +321,25 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd);
 int ftl_nand_initialize(int minor, FAR struct mtd_dev_s *mtd);
 #endif
 
+/****************************************************************************
+ * Name: ftl_log_initialize
+ *
+ * Description:
+ *   Initialize to provide a log-structured block driver wrapper around an
+ *   MTD interface.  Sectors are written out of place, so partial erase
+ *   block writes need no erase block read-modify-write.
+ *
+ * Input Parameters:
+ *   minor - The minor device number.  The MTD block device will be
+ *      registered as as /dev/mtdblockN where N is the minor number.
+ *   mtd - The MTD device that supports the FLASH interface.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_FTL_LOG)
+int ftl_log_initialize(int minor, FAR struct mtd_dev_s *mtd);
+#endif
+
 /****************************************************************************
  * Name: dhara_initialize
  *
@@ -71,6 +71,12 @@
 #define SMART_DEBUG_CMD_DUMP_PSECTOR      3
 #define SMART_DEBUG_CMD_DUMP_LSECTOR      4
 #define SMART_DEBUG_DUMP_ALL              0xFFFF
+
+/* Number of buckets of the write latency histogram.  Bucket 0 counts the
+ * writes under a millisecond, bucket n those from 2^(n-1) to 2^n ms.
+ */
+
+#define SMART_WRITE_HIST_NBUCKETS         16
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -101,6 +107,19 @@ struct mtd_smart_procfs_data_s {
 	uint8_t formatversion;		/* Version of the volume format */
 	uint32_t unusedsectors;	/* Number of unused sectors (free when erased) */
 	uint32_t blockerases;		/* Number block erase operations */
+	uint32_t mapsize;		/* Bytes of RAM used by the sector map or cache */
+	uint32_t gcblocks;		/* Blocks collected while writing */
+	uint32_t gcidleblocks;		/* Blocks collected by the background worker */
+	uint32_t writehist[SMART_WRITE_HIST_NBUCKETS];	/* Sector write latency histogram */
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+	uint32_t cachehits;		/* Sector lookups found in the cache */
+	uint32_t cachemisses;		/* Sector lookups which scanned the device */
+	uint32_t scanreads;		/* Sector headers read by those scans */
+#endif
+#ifdef CONFIG_MTD_SMART_FREE_INDEX
+	uint32_t allochits;		/* Sectors allocated through the free index */
+	uint32_t allocscans;		/* Allocations which scanned the erase blocks */
+#endif
 
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 	FAR const uint8_t *erasecounts;	/* Array of erase counts per erase block */
@@ -69,6 +69,9 @@
 #endif
 
 #include <tinyara/sched.h>
+#ifdef CONFIG_MM_PERCPU_CACHE
+#include <tinyara/spinlock.h>
+#endif
 /****************************************************************************
  * Pre-Processor Definitions
  ****************************************************************************/
@@ -170,6 +173,15 @@
 #define MM_MAX_CHUNK     (1 << MM_MAX_SHIFT)
 #define MM_NNODES        (MM_MAX_SHIFT - MM_MIN_SHIFT + 1)
 
+#ifdef CONFIG_MM_FREELIST_BITMAP
+/* Each mm_nodelist[] bin is split into MM_SL_COUNT second level classes of
+ * equal width.  See mm_size2sl().
+ */
+
+#define MM_SL_SHIFT      3
+#define MM_SL_COUNT      (1 << MM_SL_SHIFT)
+#endif
+
 #define MM_GRAN_MASK     (MM_MIN_CHUNK-1)
 #define MM_ALIGN_UP(a)   (((a) + MM_GRAN_MASK) & ~MM_GRAN_MASK)
 #define MM_ALIGN_DOWN(a) ((a) & ~MM_GRAN_MASK)
@@ -204,6 +216,10 @@
 
 #define HEAPINFO_INVALID_GROUPID -1
 
+/* Owner pid recorded in chunks parked in the per-CPU small object cache */
+
+#define HEAPINFO_CACHED (INT16_MAX - 2)
+
 #define HEAPINFO_HEAP_TYPE_KERNEL 1
 #ifdef CONFIG_APP_BINARY_SEPARATION
 #define HEAPINFO_HEAP_TYPE_BINARY    2
@@ -340,6 +356,31 @@ struct mm_delaynode_s
 	FAR struct mm_delaynode_s *flink;
 };
 
+#ifdef CONFIG_MM_PERCPU_CACHE
+/* Per-CPU small object cache.
+ *
+ * Freed chunks whose size is not larger than MM_CACHE_MAXCHUNK are parked
+ * in a per-CPU bin indexed by their chunk size instead of being returned to
+ * mm_nodelist.  The chunks stay marked as allocated in the heap, so only the
+ * owning CPU touches a bin and it does so with local interrupts disabled,
+ * without taking the heap semaphore.
+ */
+
+#define MM_CACHE_MAXCHUNK  MM_ALIGN_UP(CONFIG_MM_PERCPU_CACHE_MAXSIZE + SIZEOF_MM_ALLOCNODE)
+#define MM_CACHE_NCLASSES  (MM_CACHE_MAXCHUNK >> MM_MIN_SHIFT)
+#define MM_CACHE_NDX(s)    (((s) >> MM_MIN_SHIFT) - 1)
+
+struct mm_cachenode_s {
+	FAR struct mm_cachenode_s *flink;
+};
+
+struct mm_percpu_cache_s {
+	FAR struct mm_cachenode_s *bin[MM_CACHE_NCLASSES];
+	uint8_t count[MM_CACHE_NCLASSES];
+	spinlock_t lock;			/* Only contended by mm_cache_flush() */
+};
+#endif
+
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 struct heapinfo_tcb_info_s {
 	int pid;
@@ -418,13 +459,31 @@ struct mm_heap_s {
 	 */
 
 	struct mm_freenode_s mm_nodelist[MM_NNODES + 1];
+
+#ifdef CONFIG_MM_FREELIST_BITMAP
+	/* Two level index over mm_nodelist.  Free nodes of one second level
+	 * class are kept contiguous in their (descending) bin list and
+	 * mm_sl_head points at the largest of them.  A bit is set in the
+	 * bitmaps for every non-empty bin and class.
+	 */
+
+	uint32_t mm_fl_bitmap;
+	uint8_t mm_sl_bitmap[MM_NNODES];
+	FAR struct mm_freenode_s *mm_sl_head[MM_NNODES][MM_SL_COUNT];
+#endif
 	
 	/* Free delay list, for some situations where we can't do free
-	* immdiately.
+	* immdiately.  Nodes are pushed lock-free to the list of the current
+	* cpu and all lists are drained by mm_free_delaylist().
 	*/
 
 	FAR struct mm_delaynode_s *mm_delaylist[CONFIG_SMP_NCPUS];
 
+#ifdef CONFIG_MM_PERCPU_CACHE
+	/* Small object cache, one per cpu */
+
+	struct mm_percpu_cache_s mm_cache[CONFIG_SMP_NCPUS];
+#endif
 };
 
 /****************************************************************************
@@ -558,6 +617,23 @@ FAR void *kmm_malloc(size_t size);
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_free_delaylist(FAR struct mm_heap_s *heap);
+#ifdef CONFIG_MM_PERCPU_CACHE
+void mm_free_nocache(FAR struct mm_heap_s *heap, FAR void *mem);
+#endif
+
+/* Functions contained in mm_percpu_cache.c *********************************/
+
+#ifdef CONFIG_MM_PERCPU_CACHE
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+FAR void *mm_cache_alloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr);
+#else
+FAR void *mm_cache_alloc(FAR struct mm_heap_s *heap, size_t size);
+#endif
+bool mm_cache_free(FAR struct mm_heap_s *heap, FAR void *mem);
+bool mm_cache_push(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node);
+void mm_cache_flush(FAR struct mm_heap_s *heap);
+#endif
 
 /* Functions contained in kmm_free.c ****************************************/
 
@@ -714,10 +790,17 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node,
 /* Functions contained in mm_addfreechunk.c *********************************/
 
 void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+#ifdef CONFIG_MM_FREELIST_BITMAP
+void mm_removefreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap, size_t size);
+#endif
 
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
 int mm_size2ndx(size_t size);
+#ifdef CONFIG_MM_FREELIST_BITMAP
+int mm_size2sl(size_t size, int ndx);
+#endif
 
 void mm_dump_node(struct mm_allocnode_s *node, char *node_type);
 void mm_dump_heap_region(uint32_t start, uint32_t end);
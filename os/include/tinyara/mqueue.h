@@ -74,6 +74,13 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+/* Message priorities are grouped by 8 into 32 buckets */
+
+#define MQ_PRIO_BUCKET_SHIFT 3
+#define MQ_PRIO_NBUCKETS     32
+#endif
+
 /****************************************************************************
  * Global Type Declarations
  ****************************************************************************/
@@ -81,10 +88,18 @@
 /* This structure defines a message queue */
 
 struct mq_des;					/* forward reference */
+struct mqueue_msg_s;			/* forward reference */
 
 struct mqueue_inode_s {
 	FAR struct inode *inode;	/* Containing inode */
 	sq_queue_t msglist;			/* Prioritized message list */
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+	uint32_t prio_map;			/* Buckets that have messages in msglist */
+	FAR struct mqueue_msg_s *prio_tail[MQ_PRIO_NBUCKETS];	/* Last message of each bucket */
+#endif
+#ifdef CONFIG_MQ_PERQUEUE_POOL
+	sq_queue_t msgfree;			/* Free messages of the per-queue pool */
+#endif
 	uint16_t maxmsgs;			/* Maximum number of messages in the queue */
 	uint16_t nmsgs;				/* Number of message in the queue */
 	int16_t nwaitnotfull;		/* Number tasks waiting for not full */
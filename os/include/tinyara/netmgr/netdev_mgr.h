@@ -19,6 +19,8 @@
 #ifndef __TIZENRT_NETMGR_H__
 #define __TIZENRT_NETMGR_H__
 
+#include <sys/uio.h>
+
 #define NM_MAX_HWADDR_LEN 6
 
 #ifndef IFNAMSIZ
@@ -81,8 +83,33 @@ struct nic_io_ops {
 	 */
 	int (*linkoutput)(struct netdev *dev, void *data, uint16_t len);
 	int (*igmp_mac_filter)(struct netdev *netif, const struct in_addr *group, netdev_mac_filter_action action);
+#ifdef CONFIG_NET_NETMGR_SG
+	/* DESC:
+	 * optional, called instead of linkoutput to send a frame without copying it
+	 * into dev->tx_buf first. the frame is the concatenation of iov[0..iovcnt-1],
+	 * the driver gathers it (e.g. with DMA descriptors) before returning because
+	 * the memory belongs to the network stack.
+	 * PARAMETER
+	 * dev: network device which sends data.
+	 * iov: segments of the frame.
+	 * iovcnt: number of segments, at most CONFIG_NET_NETMGR_SG_IOVMAX.
+	 * len: total length of the frame.
+	 * RETURN
+	 * On success: return 0;
+	 * On error: return -1;
+	 */
+	int (*linkoutput_sg)(struct netdev *dev, const struct iovec *iov, int iovcnt, uint16_t len);
+#endif
 };
 
+#ifdef CONFIG_NET_NETMGR_SG
+/*
+ * Called by the network stack when it does not use a buffer passed to
+ * netdev_input_ref() anymore. it can be called from any task.
+ */
+typedef void (*netdev_release_t)(struct netdev *dev, void *data);
+#endif
+
 struct netdev_config {
 	struct nic_io_ops *ops;
 	int flag;
@@ -126,6 +153,25 @@ struct netdev *netdev_register(struct netdev_config *config);
  * On error: return -1;
  */
 int netdev_input(struct netdev *dev, void *data, uint16_t len);
+#ifdef CONFIG_NET_NETMGR_SG
+/*
+ * DESC:
+ * pass a received frame to network stack without copying it.
+ * the network stack refers to data in place until it calls release, so the
+ * buffer must not be reused by the driver before then. a frame may be held
+ * for a while (e.g. TCP out-of-order queue). when CONFIG_NET_NETMGR_SG_NRXREF
+ * buffers are already held the frame is copied and released at once.
+ * PARAMETER
+ * dev: network device which send data to network stack
+ * data: buffer holding the frame, owned by the driver.
+ * len: length of the frame.
+ * release: function which gives data back to the driver.
+ * RETURN
+ * On success: return 0, release is called once data is not used anymore
+ * On error: return -1, data still belongs to the caller
+ */
+int netdev_input_ref(struct netdev *dev, void *data, uint16_t len, netdev_release_t release);
+#endif
 /**
  * Configuration
  */
@@ -61,6 +61,14 @@
 #  define CONFIG_SCHED_INSTRUMENTATION_CPUSET 0xffff
 #endif
 
+#ifndef printf_like
+#  define printf_like(a, b) __attribute__((format(printf, a, b)))
+#endif
+
+/* Path of the note buffer reader, see note_register() */
+
+#define NOTE_DRVPATH "/dev/note"
+
 /* Note filter mode flag definitions */
 
 #define NOTE_FILTER_MODE_FLAG_ENABLE       (1 << 0) /* Enable instrumentation */
@@ -132,7 +140,7 @@
           sched_note_dump_ip(tag, SCHED_NOTE_IP, event, buf, len)
 #  define sched_note_vprintf(tag, fmt, va) \
           sched_note_vprintf_ip(tag, SCHED_NOTE_IP, fmt, va)
-#  define sched_note_vbprintf(event, fmt, va) \
+#  define sched_note_vbprintf(tag, event, fmt, va) \
           sched_note_vbprintf_ip(tag, SCHED_NOTE_IP, event, fmt, va)
 #  define sched_note_printf(tag, fmt, ...) \
           sched_note_printf_ip(tag, SCHED_NOTE_IP, fmt, ##__VA_ARGS__)
@@ -143,9 +151,9 @@
           sched_note_printf_ip(tag, SCHED_NOTE_IP, "B|%d|%s", gettid(), str)
 #  define sched_note_endex(tag, str) \
           sched_note_printf_ip(tag, SCHED_NOTE_IP, "E|%d|%s", gettid(), str)
-#  define sched_note_begin(tag, ip) \
+#  define sched_note_begin(tag) \
           sched_note_string_ip(tag, SCHED_NOTE_IP, "B")
-#  define sched_note_end(tag, ip) \
+#  define sched_note_end(tag) \
           sched_note_string_ip(tag, SCHED_NOTE_IP, "E")
 #else
 #  define sched_note_string(tag, buf)
@@ -691,6 +699,26 @@ void sched_note_filter_tag(FAR struct note_filter_tag_s *oldf,
                            FAR struct note_filter_tag_s *newf);
 #endif
 
+/****************************************************************************
+ * Name: note_register
+ *
+ * Description:
+ *   Register the reader of the in-memory note buffer at NOTE_DRVPATH.
+ *   read() returns whole notes in the note_*_s formats above, oldest
+ *   first for each CPU; see the NOTEIOC_* commands for its control.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRIVER_NOTE
+void note_register(void);
+#endif
+
 #endif /* defined(__KERNEL__) || defined(CONFIG_BUILD_FLAT) */
 
 #undef EXTERN
@@ -287,6 +287,9 @@ struct work_s {
 	FAR void *arg;				/* Callback argument */
 	clock_t qtime;			/* Time work queued */
 	clock_t delay;			/* Delay until work performed */
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	uint8_t cpu;				/* Index of the per-cpu queue holding the work */
+#endif
 };
 
 /****************************************************************************
@@ -392,6 +395,29 @@ int work_lpstart(void);
 
 int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay);
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+/****************************************************************************
+ * Name: work_queue_cpu
+ *
+ * Description:
+ *   Same as work_queue() but queue the work on the queue of the given cpu.
+ *   The work is performed by a worker of that cpu unless it is busy, in
+ *   which case an idle worker of another cpu may take it.  work_queue()
+ *   uses the queue of the calling cpu.
+ *
+ * Input parameters:
+ *   qid    - The work queue ID
+ *   cpu    - The preferred cpu, or a negative value for the calling cpu
+ *   work, worker, arg, delay - See work_queue()
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+int work_queue_cpu(int qid, int cpu, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay);
+#endif
+
 /****************************************************************************
  * Name: work_cancel
  *
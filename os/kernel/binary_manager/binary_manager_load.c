@@ -50,6 +50,10 @@
 #ifdef CONFIG_BINARY_SIGNING
 #include <tinyara/signature.h>
 #endif
+#ifdef CONFIG_COMPRESSED_BINARY
+#include <tinyara/clock.h>
+#include <tinyara/binfmt/compression/compress_read.h>
+#endif
 
 #include "sched/sched.h"
 #include "task/task.h"
@@ -115,6 +119,9 @@ static int binary_manager_load_binary(int bin_idx, char *path, load_attr_t *load
 {
 	int ret;
 	int retry_count;
+#ifdef CONFIG_COMPRESSED_BINARY
+	struct compress_stats_s stats;
+#endif
 
 	retry_count = 0;
 	while (retry_count < BINMGR_LOADING_TRYCNT) {
@@ -125,6 +132,11 @@ static int binary_manager_load_binary(int bin_idx, char *path, load_attr_t *load
 			strncpy(BIN_NAME(bin_idx), load_attr->bin_name, BIN_NAME_MAX);
 			bmdbg("Load success! [Name: %s] [Version: %d] [Partition: %s] [Text start : 0x%08x] %s\n", BIN_NAME(bin_idx), 
 					BIN_LOADVER(bin_idx), GET_PARTNAME(BIN_USEIDX(bin_idx)), elf_find_text_section_addr(bin_idx), BINARY_COMP_TYPE);
+#ifdef CONFIG_COMPRESSED_BINARY
+			compress_get_stats(&stats);
+			bmdbg("Decompression of %s: %u blocks (%u cached), read %u ms, decompress %u ms, wait %u ms\n", BIN_NAME(bin_idx),
+					stats.nblocks, stats.nhits, (unsigned int)TICK2MSEC(stats.read_ticks), (unsigned int)TICK2MSEC(stats.decompress_ticks), (unsigned int)TICK2MSEC(stats.wait_ticks));
+#endif
 			return OK;
 		} else if (errno == ENOMEM) {
 			/* Sleep for a moment to get available memory */
@@ -78,6 +78,9 @@
 #ifdef CONFIG_SCHED_CPULOAD
 #include <tinyara/cpuload.h>
 #endif
+#ifdef CONFIG_DRIVER_NOTE
+#include <tinyara/sched_note.h>
+#endif
 #ifdef CONFIG_PRODCONFIG
 #include <tinyara/prodconfig.h>
 #endif
@@ -307,6 +310,10 @@ static inline void os_do_appstart(void)
 	cpuload_initialize();
 #endif
 
+#ifdef CONFIG_DRIVER_NOTE
+	note_register();
+#endif
+
 #ifdef CONFIG_TASK_MANAGER
 	task_manager_drv_register();
 #endif
@@ -142,7 +142,17 @@ void mq_msgfree(FAR struct mqueue_msg_s *mqmsg)
 
 	else if (mqmsg->type == MQ_ALLOC_DYN) {
 		sched_kfree(mqmsg);
-	} else {
+	}
+#ifdef CONFIG_MQ_PERQUEUE_POOL
+	/* A message of a per-queue pool goes back to the pool of its queue. */
+
+	else if (mqmsg->type == MQ_ALLOC_QUEUE) {
+		saved_state = enter_critical_section();
+		sq_addlast((FAR sq_entry_t *)mqmsg, &mqmsg->owner->msgfree);
+		leave_critical_section(saved_state);
+	}
+#endif
+	else {
 		PANIC();
 	}
 }
@@ -56,6 +56,7 @@
 
 #include <tinyara/config.h>
 
+#include <stdint.h>
 #include <mqueue.h>
 #include <assert.h>
 
@@ -86,6 +87,64 @@
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_MQ_PERQUEUE_POOL
+/****************************************************************************
+ * Name: mq_msgqpoolalloc
+ *
+ * Description:
+ *   Allocate a message queue followed by a pool of mq_maxmsg messages of
+ *   mq_msgsize bytes.  The pool is freed together with the queue.  If that
+ *   much memory is not available, the queue is allocated without a pool
+ *   and takes its messages from the shared lists.
+ *
+ ****************************************************************************/
+
+static FAR struct mqueue_inode_s *mq_msgqpoolalloc(FAR struct mq_attr *attr)
+{
+	FAR struct mqueue_inode_s *msgq;
+	FAR struct mqueue_msg_s *mqmsg;
+	size_t qsize = (sizeof(struct mqueue_inode_s) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+	size_t msgsize;
+	int nmsgs;
+	int i;
+
+	if (attr) {
+		nmsgs = attr->mq_maxmsg;
+		msgsize = MQ_MSG_SIZE(attr->mq_msgsize);
+	} else {
+		nmsgs = MQ_MAX_MSGS;
+		msgsize = MQ_MSG_SIZE(MQ_MAX_BYTES);
+	}
+
+	/* mq_msgqalloc() bounded both, but the pool must not wrap around */
+
+	msgq = NULL;
+	if (nmsgs <= (SIZE_MAX - qsize) / msgsize) {
+		msgq = (FAR struct mqueue_inode_s *)kmm_zalloc(qsize + msgsize * nmsgs);
+	}
+
+	if (msgq) {
+		sq_init(&msgq->msgfree);
+		mqmsg = (FAR struct mqueue_msg_s *)((FAR char *)msgq + qsize);
+		for (i = 0; i < nmsgs; i++) {
+			mqmsg->type = MQ_ALLOC_QUEUE;
+			mqmsg->owner = msgq;
+			sq_addlast((FAR sq_entry_t *)mqmsg, &msgq->msgfree);
+			mqmsg = (FAR struct mqueue_msg_s *)((FAR char *)mqmsg + msgsize);
+		}
+		return msgq;
+	}
+
+	/* Without a pool, a message larger than MQ_MAX_BYTES still comes from the heap */
+
+	msgq = (FAR struct mqueue_inode_s *)kmm_zalloc(sizeof(struct mqueue_inode_s));
+	if (msgq) {
+		sq_init(&msgq->msgfree);
+	}
+	return msgq;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -114,17 +173,20 @@ FAR struct mqueue_inode_s *mq_msgqalloc(mode_t mode, FAR struct mq_attr *attr)
 	FAR struct mqueue_inode_s *msgq;
 
 	/* Check if the caller is attempting to allocate a message for messages
-	 * larger than the configured maximum message size.
+	 * larger than the configured maximum message size, or no messages at all.
 	 */
 
-	DEBUGASSERT(!attr || attr->mq_msgsize <= MQ_MAX_BYTES);
-	if (attr && attr->mq_msgsize > MQ_MAX_BYTES) {
+	if (attr && (attr->mq_maxmsg == 0 || attr->mq_msgsize > MQ_QUEUE_MAX_BYTES)) {
 		return NULL;
 	}
 
+#ifndef CONFIG_MQ_PERQUEUE_POOL
 	/* Allocate memory for the new message queue. */
 
 	msgq = (FAR struct mqueue_inode_s *)kmm_zalloc(sizeof(struct mqueue_inode_s));
+#else
+	msgq = mq_msgqpoolalloc(attr);
+#endif
 
 	if (msgq) {
 		/* Initialize the new named message queue */
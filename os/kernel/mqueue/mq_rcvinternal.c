@@ -143,6 +143,40 @@ int mq_verifyreceive(mqd_t mqdes, FAR char *msg, size_t msglen)
 	return OK;
 }
 
+/****************************************************************************
+ * Name: mq_msgremfirst
+ *
+ * Description:
+ *   Remove the highest priority message from the head of the queue.
+ *
+ * Parameters:
+ *   msgq - The message queue
+ *
+ * Return Value:
+ *   The message, or NULL if the queue is empty.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+FAR struct mqueue_msg_s *mq_msgremfirst(FAR struct mqueue_inode_s *msgq)
+{
+	FAR struct mqueue_msg_s *mqmsg;
+
+	mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msglist);
+
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+	/* The bucket is empty once its tail is removed */
+
+	if (mqmsg && msgq->prio_tail[mqmsg->priority >> MQ_PRIO_BUCKET_SHIFT] == mqmsg) {
+		msgq->prio_map &= ~(1u << (mqmsg->priority >> MQ_PRIO_BUCKET_SHIFT));
+	}
+#endif
+
+	return mqmsg;
+}
+
 /****************************************************************************
  * Name: mq_waitreceive
  *
@@ -194,7 +228,7 @@ FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes)
 
 	/* Get the message from the head of the queue */
 
-	while ((rcvmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msglist)) == NULL) {
+	while ((rcvmsg = mq_msgremfirst(msgq)) == NULL) {
 		/* The queue is empty!  Should we block until there the above condition
 		 * has been satisfied?
 		 */
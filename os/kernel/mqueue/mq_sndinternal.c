@@ -91,10 +91,65 @@
  * Private Variables
  ****************************************************************************/
 
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+/* Bit index of a power of two by its De Bruijn product */
+
+static const uint8_t g_debruijn32[32] = {
+	0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+	31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+/****************************************************************************
+ * Name: mq_msgfindprev
+ *
+ * Description:
+ *   Find the message after which a message of priority 'prio' is inserted,
+ *   that is the last message with a priority of at least 'prio'.  The list
+ *   holds the buckets in descending order, so that is the tail of the
+ *   bucket of 'prio' or of the nearest non-empty higher bucket.  Only when
+ *   the bucket of 'prio' ends with a lower priority are its messages
+ *   walked.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+static FAR struct mqueue_msg_s *mq_msgfindprev(FAR struct mqueue_inode_s *msgq, int prio)
+{
+	FAR struct mqueue_msg_s *prev;
+	FAR struct mqueue_msg_s *next;
+	int bucket = prio >> MQ_PRIO_BUCKET_SHIFT;
+	uint32_t higher;
+
+	if ((msgq->prio_map & (1u << bucket)) != 0 && msgq->prio_tail[bucket]->priority >= prio) {
+		return msgq->prio_tail[bucket];
+	}
+
+	/* Start after the tail of the nearest non-empty higher bucket */
+
+	prev = NULL;
+	higher = bucket + 1 < MQ_PRIO_NBUCKETS ? msgq->prio_map & ~((2u << bucket) - 1) : 0;
+	if (higher != 0) {
+		/* Index of the lowest set bit */
+
+		higher &= -higher;
+		prev = msgq->prio_tail[g_debruijn32[(uint32_t)(higher * 0x077cb531u) >> 27]];
+	}
+
+	next = prev ? prev->next : (FAR struct mqueue_msg_s *)msgq->msglist.head;
+	for (; next && prio <= next->priority; prev = next, next = next->next) ;
+
+	return prev;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -166,8 +221,13 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
  *   the g_msgfreeirq list.  If this is unsuccessful, the calling interrupt
  *   handler will be notified.
  *
+ *   With CONFIG_MQ_PERQUEUE_POOL, the pool of the queue is tried first.
+ *   A message larger than MQ_MAX_BYTES can only come from that pool or
+ *   the heap.
+ *
  * Inputs:
- *   None
+ *   msgq - The queue the message is sent to
+ *   msglen - The length of the message in bytes
  *
  * Return Value:
  *   A reference to the allocated msg structure.
@@ -177,24 +237,38 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
  *
  ****************************************************************************/
 
-FAR struct mqueue_msg_s *mq_msgalloc(void)
+FAR struct mqueue_msg_s *mq_msgalloc(FAR struct mqueue_inode_s *msgq, size_t msglen)
 {
 	FAR struct mqueue_msg_s *mqmsg;
 	irqstate_t saved_state;
 
+#ifdef CONFIG_MQ_PERQUEUE_POOL
+	/* The pool messages hold maxmsgsize bytes, which msglen was checked against */
+
+	saved_state = enter_critical_section();
+	mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msgfree);
+	leave_critical_section(saved_state);
+	if (mqmsg) {
+		return mqmsg;
+	}
+#endif
+
 	/* If we were called from an interrupt handler, then try to get the message
 	 * from generally available list of messages. If this fails, then try the
 	 * list of messages reserved for interrupt handlers
 	 */
 
 	if (up_interrupt_context()) {
-		/* Try the general free list */
+		mqmsg = NULL;
+		if (msglen <= MQ_MAX_BYTES) {
+			/* Try the general free list */
 
-		mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfree);
-		if (!mqmsg) {
-			/* Try the free list reserved for interrupt handlers */
+			mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfree);
+			if (!mqmsg) {
+				/* Try the free list reserved for interrupt handlers */
 
-			mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfreeirq);
+				mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfreeirq);
+			}
 		}
 		if (!mqmsg) {
 			set_errno(EBUSY);
@@ -208,14 +282,24 @@ FAR struct mqueue_msg_s *mq_msgalloc(void)
 		 * Disable interrupts -- we might be called from an interrupt handler.
 		 */
 
-		saved_state = enter_critical_section();
-		mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfree);
-		leave_critical_section(saved_state);
+		mqmsg = NULL;
+		if (msglen <= MQ_MAX_BYTES) {
+			saved_state = enter_critical_section();
+			mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfree);
+			leave_critical_section(saved_state);
+		}
 
 		/* If we cannot a message from the free list, then we will have to allocate one. */
 
 		if (!mqmsg) {
-			mqmsg = (FAR struct mqueue_msg_s *)kmm_malloc((sizeof(struct mqueue_msg_s)));
+			if (msglen <= MQ_MAX_BYTES) {
+				mqmsg = (FAR struct mqueue_msg_s *)kmm_malloc((sizeof(struct mqueue_msg_s)));
+			} else {
+				/* Bounded by the maxmsgsize of the queue, so this does not wrap */
+
+				DEBUGASSERT(msglen <= MQ_QUEUE_MAX_BYTES);
+				mqmsg = (FAR struct mqueue_msg_s *)kmm_malloc(MQ_MSG_SIZE(msglen));
+			}
 
 			/* Check if we got an allocated message */
 			if (mqmsg) {
@@ -356,7 +440,11 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
 {
 	FAR struct tcb_s *btcb;
 	FAR struct mqueue_inode_s *msgq;
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+	int bucket;
+#else
 	FAR struct mqueue_msg_s *next;
+#endif
 	FAR struct mqueue_msg_s *prev;
 	irqstate_t saved_state;
 
@@ -378,11 +466,15 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
 
 	saved_state = enter_critical_section();
 
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+	prev = mq_msgfindprev(msgq, prio);
+#else
 	/* Search the message list to find the location to insert the new
 	 * message. Each is list is maintained in ascending priority order.
 	 */
 
 	for (prev = NULL, next = (FAR struct mqueue_msg_s *)msgq->msglist.head; next && prio <= next->priority; prev = next, next = next->next) ;
+#endif
 
 	/* Add the message at the right place */
 
@@ -392,6 +484,16 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
 		sq_addfirst((FAR sq_entry_t *)mqmsg, &msgq->msglist);
 	}
 
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+	/* The message ends its bucket if the bucket was empty or it follows the old tail */
+
+	bucket = prio >> MQ_PRIO_BUCKET_SHIFT;
+	if ((msgq->prio_map & (1u << bucket)) == 0 || msgq->prio_tail[bucket] == prev) {
+		msgq->prio_tail[bucket] = mqmsg;
+		msgq->prio_map |= (1u << bucket);
+	}
+#endif
+
 	/* Increment the count of messages in the queue */
 
 	msgq->nmsgs++;
@@ -63,6 +63,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <limits.h>
 #include <mqueue.h>
 #include <sched.h>
@@ -78,6 +79,14 @@
 
 #define MQ_MAX_BYTES   CONFIG_MQ_MAXMSGSIZE
 #define MQ_MAX_MSGS    16
+
+/* The largest mq_msgsize that a queue may be created with */
+
+#if defined(CONFIG_MQ_PERQUEUE_POOL) && CONFIG_MQ_PERQUEUE_MAXMSGSIZE > CONFIG_MQ_MAXMSGSIZE
+#define MQ_QUEUE_MAX_BYTES CONFIG_MQ_PERQUEUE_MAXMSGSIZE
+#else
+#define MQ_QUEUE_MAX_BYTES MQ_MAX_BYTES
+#endif
 #define MQ_PRIO_MAX    _POSIX_MQ_PRIO_MAX
 
 /* This defines the number of messages descriptors to allocate at each
@@ -99,19 +108,31 @@
 enum mqalloc_e {
 	MQ_ALLOC_FIXED = 0,			/* pre-allocated; never freed */
 	MQ_ALLOC_DYN,				/* dynamically allocated; free when unused */
-	MQ_ALLOC_IRQ				/* Preallocated, reserved for interrupt handling */
+	MQ_ALLOC_IRQ,				/* Preallocated, reserved for interrupt handling */
+	MQ_ALLOC_QUEUE				/* From the pool of the owning queue */
 };
 
-/* This structure describes one buffered POSIX message. */
+/* This structure describes one buffered POSIX message.  Messages of a
+ * per-queue pool or with more than MQ_MAX_BYTES of data are allocated with
+ * MQ_MSG_SIZE(), so only their first msglen bytes of mail exist.
+ */
 
 struct mqueue_msg_s {
 	FAR struct mqueue_msg_s *next;	/* Forward link to next message */
 	uint8_t type;					/* (Used to manage allocations) */
 	uint8_t priority;				/* priority of message */
 	size_t msglen;					/* Message data length */
+#ifdef CONFIG_MQ_PERQUEUE_POOL
+	FAR struct mqueue_inode_s *owner;	/* Queue of an MQ_ALLOC_QUEUE message */
+#endif
 	char mail[MQ_MAX_BYTES];		/* Message data */
 };
 
+/* The allocation size of a message with n bytes of data */
+
+#define MQ_MSG_SIZE(n) \
+	((offsetof(struct mqueue_msg_s, mail) + (n) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1))
+
 /****************************************************************************
  * Public Variables
  ****************************************************************************/
@@ -166,11 +187,12 @@ void mq_waitirq(FAR struct tcb_s *wtcb, int errcode);
 int mq_verifyreceive(mqd_t mqdes, FAR char *msg, size_t msglen);
 FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes);
 ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR char *ubuffer, FAR int *prio);
+FAR struct mqueue_msg_s *mq_msgremfirst(FAR struct mqueue_inode_s *msgq);
 
 /* mq_sndinternal.c ********************************************************/
 
 int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio);
-FAR struct mqueue_msg_s *mq_msgalloc(void);
+FAR struct mqueue_msg_s *mq_msgalloc(FAR struct mqueue_inode_s *msgq, size_t msglen);
 int mq_waitsend(mqd_t mqdes);
 int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg, size_t msglen, int prio);
 
@@ -71,7 +71,9 @@ void sched_resume_scheduler(FAR struct tcb_s *tcb)
 #ifdef CONFIG_SCHED_CRITMONITOR
   sched_resume_critmon(tcb);
 #endif
-#ifdef CONFIG_SCHED_INSTRUMENTATION
+#if defined(CONFIG_SCHED_INSTRUMENTATION) && !defined(CONFIG_ARCH_ARM)
+  /* ARM records the switch in up_restoretask() */
+
   sched_note_resume(tcb);
 #endif
 }
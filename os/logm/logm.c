@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <unistd.h>
+#include <semaphore.h>
 #ifdef CONFIG_ARCH_LOWPUTC
 #include <sched.h>
 #endif
@@ -36,6 +37,13 @@ int g_logm_head;
 int g_logm_tail;
 int g_logm_dropmsg_count;
 int g_logm_overflow_offset = -1;
+sem_t g_logm_wakeup_sem;
+
+/* Set while a wakeup is posted and not yet consumed by the logm task, so
+ * that at most one sem_post() is issued per flush.
+ */
+
+static uint8_t g_logm_wakeup_pending;
 
 static void logm_putc(FAR struct lib_outstream_s *this, int ch)
 {
@@ -74,16 +82,48 @@ static void logm_flush(struct lib_outstream_s *stream)
 }
 #endif
 
+/* Wake up the logm task before its flushing interval expires */
+void logm_wakeup(void)
+{
+	if (LOGM_STATUS(LOGM_READY) && !__atomic_exchange_n(&g_logm_wakeup_pending, 1, __ATOMIC_RELAXED)) {
+		sem_post(&g_logm_wakeup_sem);
+	}
+}
+
+/* Called by the logm task before it starts flushing */
+void logm_wakeup_clear(void)
+{
+	__atomic_store_n(&g_logm_wakeup_pending, 0, __ATOMIC_RELAXED);
+}
+
 /* logm_internal hook for syslog & printfs */
 int logm_internal(int flag, int indx, int priority, const char *fmt, va_list ap)
 {
 	irqstate_t flags;
 	int ret = 0;
+	int used;
 	struct lib_outstream_s strm;
 #ifdef CONFIG_LOGM_TIMESTAMP
 	struct timespec ts;
 #endif
 
+#ifdef CONFIG_LOGM_BINARY
+	/* Binary mode does not format anything here, it only counts the length
+	 * of the message for the return value, and only disables local
+	 * interrupts, so it is usable from interrupt handlers as well.  Formats
+	 * which cannot be deferred are formatted now but go to the same ring,
+	 * so that the messages are printed in order.
+	 */
+
+	if (LOGM_STATUS(LOGM_READY) && flag == LOGM_NORMAL) {
+		ret = logm_binary_put(priority, fmt, ap);
+		if (ret < 0) {
+			ret = logm_binary_puttext(priority, fmt, ap);
+		}
+		return ret;
+	}
+#endif
+
 	if (LOGM_STATUS(LOGM_READY) && !LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ) \
 		&& flag == LOGM_NORMAL && !up_interrupt_context()) {
 
@@ -113,7 +153,12 @@ int logm_internal(int flag, int indx, int priority, const char *fmt, va_list ap)
 			g_logm_dropmsg_count = 1;
 			g_logm_overflow_offset = g_logm_tail;
 		}
+		used = (g_logm_tail - g_logm_head + logm_bufsize) % logm_bufsize;
 		leave_critical_section(flags);
+
+		if (LOGM_WAKEUP_WATERMARK > 0 && used * 100 >= logm_bufsize * LOGM_WAKEUP_WATERMARK) {
+			logm_wakeup();
+		}
 	} else {
 		/* Low Output: Sytem is not yet completely ready or this is called from interrupt handler */
 #ifdef CONFIG_ARCH_LOWPUTC
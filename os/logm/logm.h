@@ -20,6 +20,8 @@
 
 #include <tinyara/config.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <semaphore.h>
 
 /****************************************************************************
  * Preprocessor Definitions
@@ -39,6 +41,16 @@
 #define LOGM_PRINT_INTERVAL        (1000)
 #endif
 
+/* Percentage of a log buffer which wakes up the logm task before the
+ * flushing interval expires.  Zero means pure polling.
+ */
+
+#ifdef CONFIG_LOGM_WAKEUP_WATERMARK
+#define LOGM_WAKEUP_WATERMARK      CONFIG_LOGM_WAKEUP_WATERMARK
+#else
+#define LOGM_WAKEUP_WATERMARK      (0)
+#endif
+
 #ifndef BIT
 #define BIT(x) (1 << (x))
 #endif
@@ -74,12 +86,20 @@ EXTERN int logm_bufsize;
 EXTERN uint8_t logm_status;
 EXTERN volatile int new_logm_bufsize;
 EXTERN volatile int logm_print_interval;
+EXTERN sem_t g_logm_wakeup_sem;
 
 /************************************************************************************
  * Private Function Prototypes
  ************************************************************************************/
 int logm_task(int argc, char *argv[]);
 void logm_register_tashcmds(void);
+void logm_wakeup(void);
+void logm_wakeup_clear(void);
+#ifdef CONFIG_LOGM_BINARY
+int logm_binary_put(int priority, FAR const char *fmt, va_list ap);
+int logm_binary_puttext(int priority, FAR const char *fmt, va_list ap);
+void logm_binary_flush(void);
+#endif
 
 #undef EXTERN
 #if defined(__cplusplus)
@@ -0,0 +1,727 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * logm/logm_binary.c
+ *
+ * Binary logging mode.  Instead of formatting a message in the caller,
+ * logm_binary_put() records a copy of the format string, a timestamp and
+ * the raw arguments into a ring owned by the current cpu.  Messages which
+ * cannot be deferred are formatted by logm_binary_puttext() into the same
+ * ring, so that all messages keep their order.  Formatting is deferred to
+ * the logm task, which merges the rings of all cpus in timestamp order.
+ *
+ * Each ring has a single producer (the cpu that owns it, serialized with
+ * local interrupts disabled) and a single consumer (the logm task), so no
+ * lock shared between cpus is needed.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+
+#include <tinyara/irq.h>
+#include <tinyara/arch.h>
+#include <tinyara/clock.h>
+#include <tinyara/streams.h>
+#include <tinyara/logm.h>
+
+#include "logm.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define LOGM_BINARY_BUFSIZE    CONFIG_LOGM_BINARY_BUFSIZE
+#define LOGM_BINARY_MAXRECORD  CONFIG_LOGM_BINARY_MAXRECORD
+
+#if (LOGM_BINARY_BUFSIZE & (LOGM_BINARY_BUFSIZE - 1)) != 0
+#error "CONFIG_LOGM_BINARY_BUFSIZE must be a power of two"
+#endif
+
+#if LOGM_BINARY_MAXRECORD > LOGM_BINARY_BUFSIZE
+#error "CONFIG_LOGM_BINARY_MAXRECORD must not exceed CONFIG_LOGM_BINARY_BUFSIZE"
+#endif
+
+#define LOGM_BINARY_MASK       (LOGM_BINARY_BUFSIZE - 1)
+
+/* Longest conversion specification accepted, e.g. "%-08.3lld" */
+
+#define LOGM_SPEC_MAX          16
+
+/* Size of the buffer used to batch formatted output to stdout */
+
+#define LOGM_OUTBUF_SIZE       128
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Types of the arguments recorded for a conversion specification */
+
+enum logm_argtype_e {
+	LOGM_ARG_END,				/* End of the format string */
+	LOGM_ARG_NONE,				/* "%%", no argument */
+	LOGM_ARG_INT,
+	LOGM_ARG_LONG,
+#ifdef CONFIG_HAVE_LONG_LONG
+	LOGM_ARG_LLONG,
+#endif
+	LOGM_ARG_PTR,
+	LOGM_ARG_DOUBLE,
+	LOGM_ARG_STR,				/* Copied into the record, NUL terminated */
+	LOGM_ARG_INVALID			/* Cannot be deferred ("%n", "%*d", ...) */
+};
+
+/* Header of each record.  It is followed by the format string, NUL
+ * terminated, and the packed arguments in the order of its conversion
+ * specifications.  A record with fmtlen 0 holds preformatted text instead.
+ */
+
+struct logm_binhdr_s {
+	uint16_t len;				/* Length of the whole record */
+	uint16_t priority;
+	uint16_t fmtlen;			/* Length of the format string with its NUL */
+	clock_t ts;					/* clock_systimer() at the time of the call */
+};
+
+struct logm_ring_s {
+	uint32_t head;				/* Updated by the logm task only */
+	uint32_t tail;				/* Updated by the owning cpu only */
+	uint32_t dropped;			/* Records dropped since the last flush */
+	uint8_t buf[LOGM_BINARY_BUFSIZE];
+};
+
+/* Output stream which batches formatted characters for fwrite() */
+
+struct logm_binstream_s {
+	struct lib_outstream_s public;
+	int len;
+	char buf[LOGM_OUTBUF_SIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct logm_ring_s g_logm_ring[CONFIG_SMP_NCPUS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: logm_parsespec
+ *
+ * Description:
+ *   Advance '*fmt' past the literal text and the next conversion
+ *   specification.  On return, '*spec' points to the '%' which starts the
+ *   specification and '*speclen' holds its length.  Returns the type of
+ *   the argument consumed by the specification.
+ *
+ ****************************************************************************/
+
+static enum logm_argtype_e logm_parsespec(FAR const char **fmt, FAR const char **spec, FAR int *speclen)
+{
+	FAR const char *ptr = *fmt;
+	enum logm_argtype_e type;
+	int lcount = 0;
+	bool zflag = false;
+
+	while (*ptr != '\0' && *ptr != '%') {
+		ptr++;
+	}
+
+	*spec = ptr;
+	if (*ptr == '\0') {
+		*fmt = ptr;
+		*speclen = 0;
+		return LOGM_ARG_END;
+	}
+
+	ptr++;
+	if (*ptr == '%') {
+		*fmt = ptr + 1;
+		*speclen = 2;
+		return LOGM_ARG_NONE;
+	}
+
+	/* Flags, field width and precision.  A '*' takes its value from the
+	 * argument list which is not supported in binary mode.
+	 */
+
+	while (*ptr != '\0' && strchr("-+ #0123456789.", *ptr) != NULL) {
+		ptr++;
+	}
+
+	/* Length modifiers */
+
+	for (;; ptr++) {
+		if (*ptr == 'l') {
+			lcount++;
+		} else if (*ptr == 'z' || *ptr == 't') {
+			zflag = true;
+		} else if (*ptr == 'j') {
+			lcount = 2;
+		} else if (*ptr != 'h' && *ptr != 'L') {
+			break;
+		}
+	}
+
+	switch (*ptr) {
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+	case 'c':
+		if (lcount >= 2) {
+#ifdef CONFIG_HAVE_LONG_LONG
+			type = LOGM_ARG_LLONG;
+#else
+			type = LOGM_ARG_INVALID;
+#endif
+		} else if (lcount == 1 || (zflag && sizeof(size_t) == sizeof(long))) {
+			type = LOGM_ARG_LONG;
+		} else {
+			type = LOGM_ARG_INT;
+		}
+		break;
+
+	case 'p':
+		type = LOGM_ARG_PTR;
+		break;
+
+	case 's':
+		type = LOGM_ARG_STR;
+		break;
+
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+		type = LOGM_ARG_DOUBLE;
+		break;
+
+	default:
+		/* '*', '%n', positional arguments or a truncated specification */
+
+		type = LOGM_ARG_INVALID;
+		break;
+	}
+
+	if (*ptr != '\0') {
+		ptr++;
+	}
+
+	*fmt = ptr;
+	*speclen = ptr - *spec;
+	if (*speclen >= LOGM_SPEC_MAX) {
+		type = LOGM_ARG_INVALID;
+	}
+
+	return type;
+}
+
+/****************************************************************************
+ * Name: logm_argsize
+ ****************************************************************************/
+
+static int logm_argsize(enum logm_argtype_e type)
+{
+	switch (type) {
+	case LOGM_ARG_INT:
+		return sizeof(int);
+	case LOGM_ARG_LONG:
+		return sizeof(long);
+#ifdef CONFIG_HAVE_LONG_LONG
+	case LOGM_ARG_LLONG:
+		return sizeof(long long);
+#endif
+	case LOGM_ARG_PTR:
+		return sizeof(FAR void *);
+	case LOGM_ARG_DOUBLE:
+		return sizeof(double);
+	case LOGM_ARG_STR:
+		return 1;				/* At least the terminating NUL */
+	default:
+		return 0;
+	}
+}
+
+/****************************************************************************
+ * Name: logm_ring_copyin / logm_ring_copyout
+ *
+ * Description:
+ *   Copy to and from the ring at a free running offset, handling the wrap.
+ *
+ ****************************************************************************/
+
+static void logm_ring_copyin(FAR struct logm_ring_s *ring, uint32_t offset, FAR const void *src, size_t len)
+{
+	size_t pos = offset & LOGM_BINARY_MASK;
+	size_t first = LOGM_BINARY_BUFSIZE - pos;
+
+	if (first > len) {
+		first = len;
+	}
+
+	memcpy(&ring->buf[pos], src, first);
+	memcpy(&ring->buf[0], (FAR const uint8_t *)src + first, len - first);
+}
+
+static void logm_ring_copyout(FAR struct logm_ring_s *ring, uint32_t offset, FAR void *dest, size_t len)
+{
+	size_t pos = offset & LOGM_BINARY_MASK;
+	size_t first = LOGM_BINARY_BUFSIZE - pos;
+
+	if (first > len) {
+		first = len;
+	}
+
+	memcpy(dest, &ring->buf[pos], first);
+	memcpy((FAR uint8_t *)dest + first, &ring->buf[0], len - first);
+}
+
+/****************************************************************************
+ * Name: logm_binstream_putc / logm_binstream_flush
+ ****************************************************************************/
+
+static void logm_binstream_flush(FAR struct logm_binstream_s *stream)
+{
+	if (stream->len > 0) {
+		fwrite(stream->buf, 1, stream->len, stdout);
+		stream->len = 0;
+	}
+}
+
+static void logm_binstream_putc(FAR struct lib_outstream_s *this, int ch)
+{
+	FAR struct logm_binstream_s *stream = (FAR struct logm_binstream_s *)this;
+
+	if (stream->len >= LOGM_OUTBUF_SIZE) {
+		logm_binstream_flush(stream);
+	}
+
+	stream->buf[stream->len++] = ch;
+	this->nput++;
+}
+
+/****************************************************************************
+ * Name: logm_binary_format
+ *
+ * Description:
+ *   Format one record, whose payload follows the header, into the output
+ *   stream.
+ *
+ ****************************************************************************/
+
+static void logm_binary_format(FAR struct lib_outstream_s *strm, FAR const struct logm_binhdr_s *hdr, FAR const uint8_t *payload, int paylen)
+{
+	FAR const char *fmt = (FAR const char *)payload;
+	FAR const uint8_t *args = payload + hdr->fmtlen;
+	int argslen = paylen - hdr->fmtlen;
+	FAR const char *spec;
+	enum logm_argtype_e type;
+	char specbuf[LOGM_SPEC_MAX];
+	int speclen;
+	int pos = 0;
+
+#ifdef CONFIG_LOGM_TIMESTAMP
+	lib_sprintf(strm, "[%4d.%4d] ", (int)(hdr->ts / TICK_PER_SEC), (int)((hdr->ts % TICK_PER_SEC) * USEC_PER_TICK / 100));
+#endif
+
+	if (hdr->fmtlen == 0) {
+		while (paylen-- > 0 && *fmt != '\0') {
+			strm->put(strm, *fmt++);
+		}
+
+		return;
+	}
+
+	for (;;) {
+		FAR const char *literal = fmt;
+
+		type = logm_parsespec(&fmt, &spec, &speclen);
+		while (literal < spec) {
+			strm->put(strm, *literal++);
+		}
+
+		if (type == LOGM_ARG_END) {
+			break;
+		} else if (type == LOGM_ARG_NONE) {
+			strm->put(strm, '%');
+			continue;
+		}
+
+		memcpy(specbuf, spec, speclen);
+		specbuf[speclen] = '\0';
+
+		if (type == LOGM_ARG_STR) {
+			lib_sprintf(strm, specbuf, (FAR const char *)&args[pos]);
+			pos += strlen((FAR const char *)&args[pos]) + 1;
+			continue;
+		}
+
+		if (pos + logm_argsize(type) > argslen) {
+			/* Corrupted record, never expected */
+
+			break;
+		}
+
+		switch (type) {
+		case LOGM_ARG_INT: {
+			int val;
+			memcpy(&val, &args[pos], sizeof(val));
+			lib_sprintf(strm, specbuf, val);
+			break;
+		}
+		case LOGM_ARG_LONG: {
+			long val;
+			memcpy(&val, &args[pos], sizeof(val));
+			lib_sprintf(strm, specbuf, val);
+			break;
+		}
+#ifdef CONFIG_HAVE_LONG_LONG
+		case LOGM_ARG_LLONG: {
+			long long val;
+			memcpy(&val, &args[pos], sizeof(val));
+			lib_sprintf(strm, specbuf, val);
+			break;
+		}
+#endif
+		case LOGM_ARG_PTR: {
+			FAR void *val;
+			memcpy(&val, &args[pos], sizeof(val));
+			lib_sprintf(strm, specbuf, val);
+			break;
+		}
+		case LOGM_ARG_DOUBLE: {
+			double val;
+			memcpy(&val, &args[pos], sizeof(val));
+			lib_sprintf(strm, specbuf, val);
+			break;
+		}
+		default:
+			break;
+		}
+
+		pos += logm_argsize(type);
+	}
+}
+
+/****************************************************************************
+ * Name: logm_binary_commit
+ *
+ * Description:
+ *   Complete the header of a record and publish it in the ring of the
+ *   current cpu.  Returns 'len', or 0 if the ring is full.
+ *
+ ****************************************************************************/
+
+static int logm_binary_commit(FAR uint8_t *rec, int len, int priority, int fmtlen)
+{
+	FAR struct logm_ring_s *ring;
+	struct logm_binhdr_s hdr;
+	irqstate_t flags;
+	uint32_t head;
+	uint32_t tail;
+
+	hdr.len = len;
+	hdr.priority = priority;
+	hdr.fmtlen = fmtlen;
+	hdr.ts = clock_systimer();
+	memcpy(rec, &hdr, sizeof(hdr));
+
+	/* Only local interrupts are disabled: the ring belongs to this cpu and
+	 * the logm task only moves 'head'.
+	 */
+
+	flags = irqsave();
+	ring = &g_logm_ring[up_cpu_index()];
+	tail = ring->tail;
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	if (LOGM_BINARY_BUFSIZE - (tail - head) < len) {
+		__atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+		irqrestore(flags);
+		logm_wakeup();
+		return 0;
+	}
+
+	logm_ring_copyin(ring, tail, rec, len);
+	__atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+	irqrestore(flags);
+
+	if (LOGM_WAKEUP_WATERMARK > 0 && (tail + len - head) * 100 >= LOGM_BINARY_BUFSIZE * LOGM_WAKEUP_WATERMARK) {
+		logm_wakeup();
+	}
+
+	return len;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: logm_binary_put
+ *
+ * Description:
+ *   Record a message in the ring of the current cpu without formatting it.
+ *   The format string and string arguments are copied (string arguments
+ *   are truncated to fit the record), every other argument is stored by
+ *   value, so nothing needs to stay valid after the call.
+ *
+ * Returned Value:
+ *   The length of the formatted message, as printf() would return it, on
+ *   success, 0 if the ring is full and the message was dropped, or a
+ *   negated errno value if the message cannot be deferred.  In the latter
+ *   case 'ap' is untouched and the caller should format the message itself.
+ *
+ ****************************************************************************/
+
+int logm_binary_put(int priority, FAR const char *fmt, va_list ap)
+{
+	uint8_t rec[LOGM_BINARY_MAXRECORD];
+	FAR const char *ptr;
+	FAR const char *spec;
+	enum logm_argtype_e type;
+	struct lib_outstream_s nullstream;
+	va_list apcopy;
+	int speclen;
+	int fmtlen = strlen(fmt) + 1;
+	int fixedlen = sizeof(struct logm_binhdr_s) + fmtlen;
+	int strspace;
+	int textlen;
+	int len;
+
+	/* First pass: make sure every conversion can be deferred and find out
+	 * how much of the record is left for string arguments.
+	 */
+
+	ptr = fmt;
+	while ((type = logm_parsespec(&ptr, &spec, &speclen)) != LOGM_ARG_END) {
+		if (type == LOGM_ARG_INVALID) {
+			return -EINVAL;
+		}
+
+		fixedlen += logm_argsize(type);
+	}
+
+	if (fixedlen > LOGM_BINARY_MAXRECORD) {
+		return -E2BIG;
+	}
+
+	/* The caller returns what printf() would, count it without storing the
+	 * text.  String arguments are counted in full, even if they are
+	 * truncated in the record.
+	 */
+
+	lib_nulloutstream(&nullstream);
+	va_copy(apcopy, ap);
+	textlen = lib_vsprintf(&nullstream, fmt, apcopy);
+	va_end(apcopy);
+
+	/* Second pass: pack the arguments */
+
+	strspace = LOGM_BINARY_MAXRECORD - fixedlen;
+	len = sizeof(struct logm_binhdr_s);
+	memcpy(&rec[len], fmt, fmtlen);
+	len += fmtlen;
+	ptr = fmt;
+	while ((type = logm_parsespec(&ptr, &spec, &speclen)) != LOGM_ARG_END) {
+		switch (type) {
+		case LOGM_ARG_INT: {
+			int val = va_arg(ap, int);
+			memcpy(&rec[len], &val, sizeof(val));
+			break;
+		}
+		case LOGM_ARG_LONG: {
+			long val = va_arg(ap, long);
+			memcpy(&rec[len], &val, sizeof(val));
+			break;
+		}
+#ifdef CONFIG_HAVE_LONG_LONG
+		case LOGM_ARG_LLONG: {
+			long long val = va_arg(ap, long long);
+			memcpy(&rec[len], &val, sizeof(val));
+			break;
+		}
+#endif
+		case LOGM_ARG_PTR: {
+			FAR void *val = va_arg(ap, FAR void *);
+			memcpy(&rec[len], &val, sizeof(val));
+			break;
+		}
+		case LOGM_ARG_DOUBLE: {
+			double val = va_arg(ap, double);
+			memcpy(&rec[len], &val, sizeof(val));
+			break;
+		}
+		case LOGM_ARG_STR: {
+			FAR const char *str = va_arg(ap, FAR const char *);
+			size_t slen;
+
+			if (str == NULL) {
+				str = "(null)";
+			}
+
+			slen = strlen(str);
+			if (slen > (size_t)strspace) {
+				slen = strspace;
+			}
+
+			memcpy(&rec[len], str, slen);
+			rec[len + slen] = '\0';
+			strspace -= slen;
+			len += slen;
+			break;
+		}
+		default:
+			break;
+		}
+
+		len += logm_argsize(type);
+	}
+
+	if (logm_binary_commit(rec, len, priority, fmtlen) == 0) {
+		return 0;
+	}
+
+	return textlen;
+}
+
+/****************************************************************************
+ * Name: logm_binary_puttext
+ *
+ * Description:
+ *   Format a message which cannot be deferred and record the text in the
+ *   ring of the current cpu, truncated to fit the record, so that it keeps
+ *   its order with the binary records.
+ *
+ * Returned Value:
+ *   The length of the formatted message, before truncation, on success, 0
+ *   if the ring is full and the message was dropped.
+ *
+ ****************************************************************************/
+
+int logm_binary_puttext(int priority, FAR const char *fmt, va_list ap)
+{
+	uint8_t rec[LOGM_BINARY_MAXRECORD];
+	int hdrlen = sizeof(struct logm_binhdr_s);
+	int textlen;
+	int len;
+
+	textlen = vsnprintf((FAR char *)&rec[hdrlen], LOGM_BINARY_MAXRECORD - hdrlen, fmt, ap);
+	if (textlen < 0) {
+		textlen = 0;
+	}
+
+	len = textlen;
+	if (len >= LOGM_BINARY_MAXRECORD - hdrlen) {
+		len = LOGM_BINARY_MAXRECORD - hdrlen - 1;
+	}
+
+	if (logm_binary_commit(rec, hdrlen + len + 1, priority, 0) == 0) {
+		return 0;
+	}
+
+	return textlen;
+}
+
+/****************************************************************************
+ * Name: logm_binary_flush
+ *
+ * Description:
+ *   Called by the logm task.  Format every record queued in the rings of
+ *   all cpus, oldest first, and write them to stdout in batches.
+ *
+ ****************************************************************************/
+
+void logm_binary_flush(void)
+{
+	FAR struct logm_ring_s *ring;
+	struct logm_binstream_s stream;
+	struct logm_binhdr_s hdr = { 0 };
+	struct logm_binhdr_s next;
+	uint8_t args[LOGM_BINARY_MAXRECORD];
+	uint32_t dropped;
+	uint32_t head;
+	int cpu;
+	int sel;
+
+	stream.public.put = logm_binstream_putc;
+#ifdef CONFIG_STDIO_LINEBUFFER
+	stream.public.flush = lib_noflush;
+#endif
+	stream.public.nput = 0;
+	stream.len = 0;
+
+	for (;;) {
+		/* Pick the oldest record among the heads of all rings */
+
+		sel = -1;
+		for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+			ring = &g_logm_ring[cpu];
+			head = ring->head;
+			if (head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) {
+				continue;
+			}
+
+			logm_ring_copyout(ring, head, &next, sizeof(next));
+			if (sel < 0 || (int32_t)(next.ts - hdr.ts) < 0) {
+				hdr = next;
+				sel = cpu;
+			}
+		}
+
+		if (sel < 0) {
+			break;
+		}
+
+		ring = &g_logm_ring[sel];
+		head = ring->head;
+		logm_ring_copyout(ring, head + sizeof(hdr), args, hdr.len - sizeof(hdr));
+		__atomic_store_n(&ring->head, head + hdr.len, __ATOMIC_RELEASE);
+
+		logm_binary_format(&stream.public, &hdr, args, hdr.len - sizeof(hdr));
+	}
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		dropped = __atomic_exchange_n(&g_logm_ring[cpu].dropped, 0, __ATOMIC_RELAXED);
+		if (dropped > 0) {
+			lib_sprintf(&stream.public, "\n[LOGM BUFFER OVERFLOW] %d messages are dropped on cpu%d\n", (int)dropped, cpu);
+		}
+	}
+
+	logm_binstream_flush(&stream);
+	fflush(stdout);
+}
@@ -24,6 +24,8 @@
 #include <tinyara/logm.h>
 #include <tinyara/config.h>
 #include <tinyara/kmalloc.h>
+#include <tinyara/clock.h>
+#include <tinyara/semaphore.h>
 #include "logm.h"
 #ifdef CONFIG_LOGM_TEST
 #include "logm_test.h"
@@ -63,6 +65,35 @@ static int logm_change_bufsize(int buflen)
 	return OK;
 }
 
+/* Write out the text buffer in contiguous chunks rather than byte by byte */
+static void logm_flush_text(void)
+{
+	int head = g_logm_head;
+	int tail = g_logm_tail;
+	int end;
+
+	while (head != tail) {
+		end = (tail > head) ? tail : logm_bufsize;
+		if (g_logm_overflow_offset > head && g_logm_overflow_offset < end) {
+			end = g_logm_overflow_offset;
+		}
+
+		fwrite(&g_logm_rsvbuf[head], 1, end - head, stdout);
+		head = end % logm_bufsize;
+		g_logm_head = head;
+
+		if (LOGM_STATUS(LOGM_BUFFER_OVERFLOW)) {
+			LOGM_STATUS_CLEAR(LOGM_BUFFER_OVERFLOW);
+		}
+		if (g_logm_overflow_offset >= 0 && g_logm_overflow_offset == head) {
+			fprintf(stdout, "\n[LOGM BUFFER OVERFLOW] %d messages are dropped\n", g_logm_dropmsg_count);
+			g_logm_overflow_offset = -1;
+		}
+	}
+
+	fflush(stdout);
+}
+
 int logm_task(int argc, char *argv[])
 {
 	irqstate_t flags;
@@ -70,6 +101,11 @@ int logm_task(int argc, char *argv[])
 	g_logm_rsvbuf = (char *)kmm_malloc(logm_bufsize);
 	memset(g_logm_rsvbuf, 0, logm_bufsize);
 
+	/* The wakeup semaphore is used for signaling, not for locking */
+
+	sem_init(&g_logm_wakeup_sem, 0, 0);
+	sem_setprotocol(&g_logm_wakeup_sem, SEM_PRIO_NONE);
+
 	/* Now logm is ready */
 	LOGM_STATUS_SET(LOGM_READY);
 
@@ -78,17 +114,12 @@ int logm_task(int argc, char *argv[])
 #endif
 
 	while (1) {
-		while (g_logm_head != g_logm_tail) {
-			fputc(g_logm_rsvbuf[g_logm_head], stdout);
-			g_logm_head = (g_logm_head + 1) % logm_bufsize;
-			if (LOGM_STATUS(LOGM_BUFFER_OVERFLOW)) {
-				LOGM_STATUS_CLEAR(LOGM_BUFFER_OVERFLOW);
-			}
-			if (g_logm_overflow_offset >= 0 && g_logm_overflow_offset == g_logm_head) {
-				fprintf(stdout, "\n[LOGM BUFFER OVERFLOW] %d messages are dropped\n", g_logm_dropmsg_count);
-				g_logm_overflow_offset = -1;
-			}
-		}
+		logm_wakeup_clear();
+
+#ifdef CONFIG_LOGM_BINARY
+		logm_binary_flush();
+#endif
+		logm_flush_text();
 
 		if (LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ)) {
 			flags = enter_critical_section();
@@ -97,7 +128,12 @@ int logm_task(int argc, char *argv[])
 			}
 			leave_critical_section(flags);
 		}
-		usleep(logm_print_interval);
+
+		/* Sleep until the interval expires or a buffer reaches its
+		 * watermark.
+		 */
+
+		sem_tickwait(&g_logm_wakeup_sem, clock_systimer(), USEC2TICK(logm_print_interval));
 	}
 
 	kmm_free(g_logm_rsvbuf);
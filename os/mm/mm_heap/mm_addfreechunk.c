@@ -58,6 +58,8 @@
 
 #include <tinyara/mm/mm.h>
 
+#include "mm_node.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -88,9 +90,34 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 
 	int ndx = mm_size2ndx(node->size);
 
+#ifdef CONFIG_MM_FREELIST_BITMAP
+	int sl = mm_size2sl(node->size, ndx);
+	uint32_t bits;
+
+	/* Start the search at the first node of our class.  If the class is
+	 * empty, the node goes right before the next smaller class or, if
+	 * there is none, after the last node of the next larger class.
+	 */
+
+	if (heap->mm_sl_head[ndx][sl]) {
+		next = heap->mm_sl_head[ndx][sl];
+		prev = next->blink;
+	} else if ((bits = heap->mm_sl_bitmap[ndx] & ((1 << sl) - 1)) != 0) {
+		next = heap->mm_sl_head[ndx][31 - __builtin_clz(bits)];
+		prev = next->blink;
+	} else {
+		bits = heap->mm_sl_bitmap[ndx] & ~((2 << sl) - 1);
+		prev = bits ? heap->mm_sl_head[ndx][__builtin_ctz(bits)] : &heap->mm_nodelist[ndx];
+		next = prev->flink;
+	}
+#else
+	prev = &heap->mm_nodelist[ndx];
+	next = prev->flink;
+#endif
+
 	/* Now put the new free node in a descending order */
 
-	for (prev = &heap->mm_nodelist[ndx], next = prev->flink; next && next->size > node->size; prev = next, next = next->flink) ;
+	for (; next && next->size > node->size; prev = next, next = next->flink) ;
 
 	/* Does it go in mid next or at the end? */
 
@@ -103,4 +130,92 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 
 		next->blink = node;
 	}
+
+#ifdef CONFIG_MM_FREELIST_BITMAP
+	/* The node is the first of its class if it went in front of the old one */
+
+	if (!heap->mm_sl_head[ndx][sl] || heap->mm_sl_head[ndx][sl] == next) {
+		heap->mm_sl_head[ndx][sl] = node;
+	}
+
+	heap->mm_sl_bitmap[ndx] |= (1 << sl);
+	heap->mm_fl_bitmap |= (1 << ndx);
+#endif
+}
+
+#ifdef CONFIG_MM_FREELIST_BITMAP
+/****************************************************************************
+ * Name: mm_removefreechunk
+ *
+ * Description:
+ *   Remove a free chunk from the nodelist and update the two level index.
+ *   It is assumed that the caller holds the mm semaphore and has not yet
+ *   changed the size of the node.
+ *
+ ****************************************************************************/
+
+void mm_removefreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+	int ndx = mm_size2ndx(node->size);
+	int sl = mm_size2sl(node->size, ndx);
+	FAR struct mm_freenode_s *next = node->flink;
+
+	if (heap->mm_sl_head[ndx][sl] == node) {
+		/* The class keeps going if the next node belongs to it */
+
+		if (next && mm_size2sl(next->size, ndx) == sl) {
+			heap->mm_sl_head[ndx][sl] = next;
+		} else {
+			heap->mm_sl_head[ndx][sl] = NULL;
+			heap->mm_sl_bitmap[ndx] &= ~(1 << sl);
+			if (heap->mm_sl_bitmap[ndx] == 0) {
+				heap->mm_fl_bitmap &= ~(1 << ndx);
+			}
+		}
+	}
+
+	UNLINK_FREE_NODE(node);
+}
+
+/****************************************************************************
+ * Name: mm_findfreechunk
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes in constant time.  The first
+ *   node of the class of 'size' is used if it is large enough; otherwise
+ *   the first node of the next non-empty class or bin.  Every node there is
+ *   larger than 'size'.  Returns NULL if there is no such chunk.  It is
+ *   assumed that the caller holds the mm semaphore.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap, size_t size)
+{
+	FAR struct mm_freenode_s *node;
+	int ndx = mm_size2ndx(size);
+	int sl = mm_size2sl(size, ndx);
+	uint32_t bits;
+
+	node = heap->mm_sl_head[ndx][sl];
+	if (node && node->size >= size) {
+		return node;
+	}
+
+	/* Next larger class in the same bin */
+
+	bits = heap->mm_sl_bitmap[ndx] & ~((2 << sl) - 1);
+	if (bits) {
+		return heap->mm_sl_head[ndx][__builtin_ctz(bits)];
+	}
+
+	/* Smallest class of the next larger non-empty bin */
+
+	bits = heap->mm_fl_bitmap & ~((2 << ndx) - 1);
+	if (bits) {
+		ndx = __builtin_ctz(bits);
+		return heap->mm_sl_head[ndx][__builtin_ctz(heap->mm_sl_bitmap[ndx])];
+	}
+
+	return NULL;
 }
+#endif
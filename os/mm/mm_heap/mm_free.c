@@ -79,32 +79,34 @@ static void mm_add_delaylist(FAR struct mm_heap_s *heap, FAR void *mem)
 {
 #if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
 	FAR struct mm_delaynode_s *tmp = mem;
-	irqstate_t flags;
-
-	/* Delay the deallocation until a more appropriate time. */
-
-	flags = enter_critical_section();
-
-	tmp->flink = heap->mm_delaylist[up_cpu_index()];
-	heap->mm_delaylist[up_cpu_index()] = tmp;
+	FAR struct mm_delaynode_s **list;
+	FAR struct mm_delaynode_s *head;
+
+	/* Delay the deallocation until a more appropriate time.
+	 *
+	 * The node is pushed with a compare-and-swap, so this is safe against
+	 * interrupt handlers and other cpus without a critical section.  The
+	 * list of this cpu is only used to spread the contention; any cpu may
+	 * take it over in mm_free_delaylist().
+	 */
 
-	leave_critical_section(flags);
+	list = &heap->mm_delaylist[up_cpu_index()];
+	head = __atomic_load_n(list, __ATOMIC_RELAXED);
+	do {
+		tmp->flink = head;
+	} while (!__atomic_compare_exchange_n(list, &head, tmp, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
 #endif
 }
 
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: mm_free
+ * Name: mm_free_internal
  *
  * Description:
  *   Returns a chunk of memory to the list of free nodes,  merging with
  *   adjacent free chunks if possible.
  *
  ****************************************************************************/
-void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
+static void mm_free_internal(FAR struct mm_heap_s *heap, FAR void *mem)
 {
 	FAR struct mm_freenode_s *node;
 	FAR struct mm_freenode_s *prev;
@@ -181,7 +183,7 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 		 * but there may not be a successor node.
 		 */
 		DEBUGASSERT_MM_FREE_NODE(heap, next);
-		REMOVE_NODE_FROM_LIST(next);
+		REMOVE_NODE_FROM_LIST(heap, next);
 
 		/* Then merge the two chunks */
 
@@ -200,7 +202,7 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 		 * not be a successor node.
 		 */
 		DEBUGASSERT_MM_FREE_NODE(heap, prev);
-		REMOVE_NODE_FROM_LIST(prev);
+		REMOVE_NODE_FROM_LIST(heap, prev);
 
 		/* Then merge the two chunks */
 
@@ -214,3 +216,99 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 	mm_addfreechunk(heap, node);
 	mm_givesemaphore(heap);
 }
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_free_delaylist
+ *
+ * Description:
+ *   Release the deallocations that were delayed by mm_free() because the
+ *   MM semaphore could not be taken.  The lists of all cpus are taken over
+ *   with an atomic exchange and freed in one batch, so that the semaphore
+ *   is acquired only once for all of them.
+ *
+ ****************************************************************************/
+void mm_free_delaylist(FAR struct mm_heap_s *heap)
+{
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+	FAR struct mm_delaynode_s *tmp;
+	FAR struct mm_delaynode_s *address;
+	bool locked = false;
+	int cpu;
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		/* Test if the delayed list is empty without an atomic operation */
+
+		if (__atomic_load_n(&heap->mm_delaylist[cpu], __ATOMIC_RELAXED) == NULL) {
+			continue;
+		}
+
+		if (!locked) {
+			if (!mm_takesemaphore(heap)) {
+				/* Leave the lists to the next caller */
+
+				return;
+			}
+
+			locked = true;
+		}
+
+		/* Move the delay list to local */
+
+		tmp = __atomic_exchange_n(&heap->mm_delaylist[cpu], NULL, __ATOMIC_ACQUIRE);
+		while (tmp) {
+			/* Get the first delayed deallocation */
+
+			address = tmp;
+			tmp = tmp->flink;
+
+			/* Nested takes of the semaphore held above are only counted */
+
+			mm_free_internal(heap, (FAR void *)address);
+		}
+	}
+
+	if (locked) {
+		mm_givesemaphore(heap);
+	}
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_free
+ *
+ * Description:
+ *   Returns a chunk of memory to the list of free nodes,  merging with
+ *   adjacent free chunks if possible.
+ *
+ *   If CONFIG_MM_PERCPU_CACHE is enabled, small chunks are parked in the
+ *   per-CPU cache instead and mm_free_nocache() does the work above.
+ *
+ ****************************************************************************/
+void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+#ifdef CONFIG_MM_PERCPU_CACHE
+	if (mem && mm_cache_free(heap, mem)) {
+		return;
+	}
+#endif
+
+	mm_free_internal(heap, mem);
+}
+
+#ifdef CONFIG_MM_PERCPU_CACHE
+/****************************************************************************
+ * Name: mm_free_nocache
+ *
+ * Description:
+ *   Same as mm_free() but always returns the chunk to the free nodes.
+ *
+ ****************************************************************************/
+void mm_free_nocache(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+	mm_free_internal(heap, mem);
+}
+#endif
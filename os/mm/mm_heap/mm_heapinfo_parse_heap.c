@@ -114,6 +114,9 @@ void heapinfo_parse_heap(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 	size_t heap_resource;
 	size_t stack_resource;
 	size_t nonsched_resource;
+#ifdef CONFIG_MM_PERCPU_CACHE
+	size_t cached_resource = 0;
+#endif
 	int nonsched_idx;
 	struct sched_param sched_data;
 	size_t heap_size;
@@ -191,6 +194,16 @@ void heapinfo_parse_heap(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 			ASSERT(node->size);
 
 			/* Check if the node corresponds to an allocated memory chunk */
+#ifdef CONFIG_MM_PERCPU_CACHE
+			if (node->pid == HEAPINFO_CACHED && (node->preceding & MM_ALLOC_BIT) != 0) {
+				/* Parked in a per-CPU cache, not owned by anyone */
+
+				cached_resource += node->size;
+				if (mode == HEAPINFO_DETAIL_ALL || mode == HEAPINFO_DETAIL_FREE || mode == HEAPINFO_DETAIL_SPECIFIC_HEAP) {
+					heap_dbg("0x%x | %8u |   %c    |            |       |\n", node, node->size, 'C');
+				}
+			} else
+#endif
 			if ((pid == HEAPINFO_PID_ALL || node->pid == pid) && (node->preceding & MM_ALLOC_BIT) != 0) {
 				if (mode == HEAPINFO_DETAIL_ALL || mode == HEAPINFO_DETAIL_PID || mode == HEAPINFO_DETAIL_SPECIFIC_HEAP) {
 					if (node->pid >= 0) {
@@ -272,6 +285,9 @@ void heapinfo_parse_heap(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 	heap_dbg("< Free >\n");
 	heap_dbg("  - Number of Free Node               : %d\n", ordblks);
 	heap_dbg("  - Largest Free Node Size            : %u\n", mxordblk);
+#ifdef CONFIG_MM_PERCPU_CACHE
+	heap_dbg("  - Size Cached per CPU (C)           : %u\n", cached_resource);
+#endif
 	heap_dbg("\n< Allocation >\n");
 	heap_dbg("  - Current Size (Alive Allocation) = (1) + (2) + (3)\n");
 	heap_dbg("     . by Dead Threads (*) (1)        : %u\n", nonsched_resource);
@@ -252,6 +252,11 @@ int mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heapsi
 	/* Initialize the node array */
 
 	memset(heap->mm_nodelist, 0, sizeof(struct mm_freenode_s) * (MM_NNODES + 1));
+#ifdef CONFIG_MM_FREELIST_BITMAP
+	heap->mm_fl_bitmap = 0;
+	memset(heap->mm_sl_bitmap, 0, sizeof(heap->mm_sl_bitmap));
+	memset(heap->mm_sl_head, 0, sizeof(heap->mm_sl_head));
+#endif
 
 	/* Initialize delay list to NULL for all cpus */
 
@@ -259,6 +264,12 @@ int mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heapsi
 		heap->mm_delaylist[i] = NULL;
 	}
 
+#ifdef CONFIG_MM_PERCPU_CACHE
+	/* Start with empty small object caches, SP_UNLOCKED is 0 */
+
+	memset(heap->mm_cache, 0, sizeof(heap->mm_cache));
+#endif
+
 	/* Initialize the malloc semaphore to one (to support one-at-
 	 * a-time access to private data sets).
 	 */
@@ -90,88 +90,25 @@
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
-static void mm_free_delaylist(FAR struct mm_heap_s *heap)
-{
-#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
-	FAR struct mm_delaynode_s *tmp;
-	irqstate_t flags;
-
-	/* Move the delay list to local */
-
-	flags = enter_critical_section();
-
-	tmp = heap->mm_delaylist[up_cpu_index()];
-	heap->mm_delaylist[up_cpu_index()] = NULL;
-
-	leave_critical_section(flags);
-
-	/* Test if the delayed is empty */
-
-	while (tmp)
-	{
-		FAR void *address;
-
-		/* Get the first delayed deallocation */
-
-		address = tmp;
-		tmp = tmp->flink;
-
-		/* The address should always be non-NULL since that was checked in the
-		 * 'while' condition above.
-		 */
-
-		mm_free(heap, address);
-	}
-#endif
-}
-
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
- * Name: mm_malloc
+ * Name: mm_allocnode
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
- *
- *  8-byte alignment of the allocated data is assured.
+ *  Take a chunk of exactly 'size' bytes out of the free node lists.  The
+ *  caller must hold the MM semaphore and 'size' must already be aligned and
+ *  include the allocation node.
  *
  ****************************************************************************/
-#ifdef CONFIG_DEBUG_MM_HEAPINFO
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr)
-#else
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
-#endif
+static FAR struct mm_allocnode_s *mm_allocnode(FAR struct mm_heap_s *heap, size_t size)
 {
 	FAR struct mm_freenode_s *node;
-	void *ret = NULL;
-	int ndx;
-	bool gc_done = false;
-
-	/* Free the delay list first */
-	mm_free_delaylist(heap);
-
-	/* Handle bad sizes */
-
-	if (size > MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) {
-		mdbg("Because of mm_allocnode, %u cannot be allocated. The maximum \
-			 allocable size is (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) \
-			 : %u\n.", size, (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE));
-		return NULL;
-	}
-
-	/* Adjust the size to account for (1) the size of the allocated node and
-	 * (2) to make sure that it is an even multiple of our granule size.
-	 */
-
-	size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
 
-retry_after_gc:
-	/* We need to hold the MM semaphore while we muck with the nodelist. */
+#ifdef CONFIG_MM_FREELIST_BITMAP
+	/* Let the two level index pick the chunk */
 
-	mm_takesemaphore(heap);
+	node = mm_findfreechunk(heap, size);
+#else
+	int ndx;
 
 	/* Get the location in the node list to start the search
 	 * by converting the request size into a nodelist index.
@@ -195,13 +132,14 @@ retry_after_gc:
 	if (!(node && node->size == size)) {
 		node = prev;
 	}
+#endif
 
 	/* If we found a node with non-zero size, then this is one to use. Since
 	 * the list is ordered, we know that is must be best fitting chunk
 	 * available.
 	 */
 
-	if (node->size) {
+	if (node && node->size) {
 		FAR struct mm_freenode_s *remainder;
 		FAR struct mm_freenode_s *next;
 		size_t remaining;
@@ -210,7 +148,7 @@ retry_after_gc:
 		 * a successor node.
 		 */
 		DEBUGASSERT_MM_FREE_NODE(heap, node);
-		REMOVE_NODE_FROM_LIST(node);
+		REMOVE_NODE_FROM_LIST(heap, node);
 
 		/* Check if we have to split the free node into one of the allocated
 		 * size and another smaller freenode.  In some cases, the remaining
@@ -249,18 +187,130 @@ retry_after_gc:
 		/* Handle the case of an exact size match */
 
 		node->preceding |= MM_ALLOC_BIT;
+		return (FAR struct mm_allocnode_s *)node;
+	}
+
+	return NULL;
+}
 
+#ifdef CONFIG_MM_PERCPU_CACHE
+/****************************************************************************
+ * Name: mm_refill_cache
+ *
+ * Description:
+ *  Carve additional chunks of 'size' bytes for the per-CPU cache while the
+ *  MM semaphore is already held, so that the following small allocations
+ *  of the same size do not need to take it.
+ *
+ ****************************************************************************/
+static void mm_refill_cache(FAR struct mm_heap_s *heap, size_t size)
+{
+	FAR struct mm_allocnode_s *node;
+	int i;
+
+	if (size > MM_CACHE_MAXCHUNK) {
+		return;
+	}
+
+	for (i = 1; i < CONFIG_MM_PERCPU_CACHE_BATCH; i++) {
+		node = mm_allocnode(heap, size);
+		if (!node) {
+			break;
+		}
+
+		if (!mm_cache_push(heap, node)) {
+			mm_free_nocache(heap, (FAR char *)node + SIZEOF_MM_ALLOCNODE);
+			break;
+		}
+	}
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
-		heapinfo_update_node((struct mm_allocnode_s *)node, caller_retaddr);
-		heapinfo_add_size(heap, ((struct mm_allocnode_s *)node)->pid, node->size);
-		heapinfo_update_total_size(heap, node->size, ((struct mm_allocnode_s *)node)->pid);
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr)
+#else
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+#endif
+{
+	FAR struct mm_allocnode_s *node;
+	void *ret = NULL;
+	bool gc_done = false;
+
+	/* Free the delay list first */
+	mm_free_delaylist(heap);
+
+	/* Handle bad sizes */
+
+	if (size > MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) {
+		mdbg("Because of mm_allocnode, %u cannot be allocated. The maximum \
+			 allocable size is (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) \
+			 : %u\n.", size, (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE));
+		return NULL;
+	}
+
+	/* Adjust the size to account for (1) the size of the allocated node and
+	 * (2) to make sure that it is an even multiple of our granule size.
+	 */
+
+	size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+
+#ifdef CONFIG_MM_PERCPU_CACHE
+	/* Small chunks are served from the cache of this cpu without taking
+	 * the MM semaphore.
+	 */
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	ret = mm_cache_alloc(heap, size, caller_retaddr);
+#else
+	ret = mm_cache_alloc(heap, size);
+#endif
+	if (ret) {
+		mvdbg("Allocated %p, size %u from cache\n", ret, size);
+		return ret;
+	}
+#endif
+
+retry_after_gc:
+	/* We need to hold the MM semaphore while we muck with the nodelist. */
+
+	mm_takesemaphore(heap);
+
+	node = mm_allocnode(heap, size);
+	if (node) {
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+		heapinfo_update_node(node, caller_retaddr);
+		heapinfo_add_size(heap, node->pid, node->size);
+		heapinfo_update_total_size(heap, node->size, node->pid);
 #endif
 		ret = (void *)((char *)node + SIZEOF_MM_ALLOCNODE);
+
+#ifdef CONFIG_MM_PERCPU_CACHE
+		mm_refill_cache(heap, size);
+#endif
 	}
 
 	mm_givesemaphore(heap);
 
 	if (!ret && gc_done == false) {
+#ifdef CONFIG_MM_PERCPU_CACHE
+		/* Give the cached chunks back so they can be merged */
+
+		mm_cache_flush(heap);
+#endif
 		mdbg("Allocation failed!!! We dont have enough memory. Try to free dead task stack areas\n");
 		sched_garbagecollection();
 		gc_done = true;
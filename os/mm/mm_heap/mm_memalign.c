@@ -221,7 +221,7 @@ retry_after_gc:
 		 * a successor node.
 		 */
 		DEBUGASSERT_MM_FREE_NODE(heap, node);
-		REMOVE_NODE_FROM_LIST(node);
+		REMOVE_NODE_FROM_LIST(heap, node);
 
 		/* Check if there is free space at the beginning of the aligned chunk */
 		if ((size_t)newnode - (size_t)node >= SIZEOF_MM_FREENODE) {
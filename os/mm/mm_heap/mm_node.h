@@ -45,7 +45,7 @@
 		}		\
 	} while (0)
 
-#define REMOVE_NODE_FROM_LIST(node)				\
+#define UNLINK_FREE_NODE(node)					\
 	do {							\
 		(node)->blink->flink = (node)->flink;		\
 		if ((node)->flink) {				\
@@ -53,6 +53,16 @@
 		}						\
 	} while (0)
 
+/* Free nodes must be removed through mm_removefreechunk() when the two
+ * level index is in use, so that it can be kept up to date.
+ */
+
+#ifdef CONFIG_MM_FREELIST_BITMAP
+#define REMOVE_NODE_FROM_LIST(heap, node) mm_removefreechunk(heap, node)
+#else
+#define REMOVE_NODE_FROM_LIST(heap, node) UNLINK_FREE_NODE(node)
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -0,0 +1,312 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_heap/mm_percpu_cache.c
+ *
+ * Per-CPU cache of small chunks in front of the mm_nodelist allocator.
+ *
+ * Chunks parked in the cache keep MM_ALLOC_BIT set, so the rest of the
+ * allocator sees them as ordinary allocated chunks.  Each cpu works on its
+ * own bins, with local interrupts disabled and the spinlock of the bins
+ * held, without taking the heap semaphore.  The spinlock is only contended
+ * when mm_cache_flush() empties the bins of every cpu.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <debug.h>
+
+#include <tinyara/irq.h>
+#include <tinyara/arch.h>
+#include <tinyara/mm/mm.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MM_CACHE_NODE(mem) \
+	((FAR struct mm_allocnode_s *)((FAR char *)(mem) - SIZEOF_MM_ALLOCNODE))
+#define MM_CACHE_MEM(node) \
+	((FAR struct mm_cachenode_s *)((FAR char *)(node) + SIZEOF_MM_ALLOCNODE))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+/****************************************************************************
+ * Name: mm_cache_put
+ *
+ * Description:
+ *   Park an allocated chunk in the bin of the current cpu.  Returns false
+ *   if the bin is already full.  The caller must hold the cache spinlock.
+ *
+ ****************************************************************************/
+
+static bool mm_cache_put(FAR struct mm_percpu_cache_s *cache, FAR struct mm_allocnode_s *node)
+{
+	FAR struct mm_cachenode_s *cnode = MM_CACHE_MEM(node);
+	FAR struct mm_cachenode_s *tmp;
+	int ndx = MM_CACHE_NDX(node->size);
+
+	if (cache->count[ndx] >= CONFIG_MM_PERCPU_CACHE_DEPTH) {
+		return false;
+	}
+
+	/* The bins are short, so catch a double free of a cached chunk here
+	 * rather than corrupting the bin.
+	 */
+
+	for (tmp = cache->bin[ndx]; tmp; tmp = tmp->flink) {
+		if (tmp == cnode) {
+			mdbg("Attempt for double freeing a cached pointer %p\n", (FAR char *)node + SIZEOF_MM_ALLOCNODE);
+			return true;
+		}
+	}
+
+	cnode->flink = cache->bin[ndx];
+	cache->bin[ndx] = cnode;
+	cache->count[ndx]++;
+	return true;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_cache_alloc
+ *
+ * Description:
+ *   Take a chunk of exactly 'size' bytes (already aligned and including the
+ *   allocation node) from the cache of the current cpu.  Returns NULL if the
+ *   size is not cached or the bin is empty; the caller then falls back to
+ *   the normal allocator, which refills the bin.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+FAR void *mm_cache_alloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr)
+#else
+FAR void *mm_cache_alloc(FAR struct mm_heap_s *heap, size_t size)
+#endif
+{
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+	FAR struct mm_percpu_cache_s *cache;
+	FAR struct mm_cachenode_s *cnode;
+	FAR struct mm_allocnode_s *node;
+	irqstate_t flags;
+	int ndx;
+
+	if (size > MM_CACHE_MAXCHUNK) {
+		return NULL;
+	}
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	/* The owner accounting below needs the heap semaphore */
+
+	if (up_interrupt_context()) {
+		return NULL;
+	}
+#endif
+
+	ndx = MM_CACHE_NDX(size);
+
+	/* Being moved to another cpu after up_cpu_index() is harmless, the
+	 * spinlock protects the bins of whichever cpu was picked.
+	 */
+
+	cache = &heap->mm_cache[up_cpu_index()];
+	flags = spin_lock_irqsave(&cache->lock);
+	cnode = cache->bin[ndx];
+	if (cnode) {
+		cache->bin[ndx] = cnode->flink;
+		cache->count[ndx]--;
+	}
+	spin_unlock_irqrestore(&cache->lock, flags);
+
+	if (!cnode) {
+		return NULL;
+	}
+
+	node = MM_CACHE_NODE(cnode);
+	DEBUGASSERT((node->preceding & MM_ALLOC_BIT) != 0 && node->size == size);
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	/* The chunk is already counted in total_alloc_size, only the new owner
+	 * has to be charged for it.
+	 */
+
+	heapinfo_update_node(node, caller_retaddr);
+	mm_takesemaphore(heap);
+	heapinfo_add_size(heap, node->pid, node->size);
+	mm_givesemaphore(heap);
+#endif
+
+	return (FAR void *)cnode;
+#else
+	return NULL;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_cache_free
+ *
+ * Description:
+ *   Try to park a chunk being freed in the cache of the current cpu.
+ *   Returns true if the chunk was consumed by the cache.  Otherwise the
+ *   caller must release it with mm_free_nocache().
+ *
+ ****************************************************************************/
+
+bool mm_cache_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+	FAR struct mm_allocnode_s *node = MM_CACHE_NODE(mem);
+	FAR struct mm_percpu_cache_s *cache;
+	irqstate_t flags;
+	bool ret;
+
+	/* Leave invalid pointers, large chunks and chunks that are not a whole
+	 * number of granules (e.g. trimmed by mm_memalign) to mm_free_nocache()
+	 */
+
+	if ((node->preceding & MM_ALLOC_BIT) == 0 || node->size < MM_MIN_CHUNK ||
+		node->size > MM_CACHE_MAXCHUNK || (node->size & MM_GRAN_MASK) != 0) {
+		return false;
+	}
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	if (up_interrupt_context() || !mm_takesemaphore(heap)) {
+		return false;
+	}
+#endif
+
+	cache = &heap->mm_cache[up_cpu_index()];
+	flags = spin_lock_irqsave(&cache->lock);
+	ret = mm_cache_put(cache, node);
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	if (ret && node->pid != HEAPINFO_CACHED) {
+		/* Release the owner but keep the chunk in total_alloc_size */
+
+		heapinfo_subtract_size(heap, node->pid, node->size);
+		node->pid = HEAPINFO_CACHED;
+		node->alloc_call_addr = 0;
+	}
+#endif
+	spin_unlock_irqrestore(&cache->lock, flags);
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	mm_givesemaphore(heap);
+#endif
+
+	return ret;
+#else
+	return false;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_cache_push
+ *
+ * Description:
+ *   Park a chunk freshly split off by mm_malloc() in the cache of the
+ *   current cpu.  Used to refill a bin in batches while the heap semaphore
+ *   is held.  If false is returned, the chunk must be released with
+ *   mm_free_nocache().
+ *
+ ****************************************************************************/
+
+bool mm_cache_push(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node)
+{
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+	FAR struct mm_percpu_cache_s *cache;
+	irqstate_t flags;
+	bool ret;
+
+	if (node->size > MM_CACHE_MAXCHUNK) {
+		return false;
+	}
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	heapinfo_update_node(node, 0);
+	node->pid = HEAPINFO_CACHED;
+	heapinfo_update_total_size(heap, node->size, HEAPINFO_CACHED);
+#endif
+
+	cache = &heap->mm_cache[up_cpu_index()];
+	flags = spin_lock_irqsave(&cache->lock);
+	ret = mm_cache_put(cache, node);
+	spin_unlock_irqrestore(&cache->lock, flags);
+
+	return ret;
+#else
+	return false;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_cache_flush
+ *
+ * Description:
+ *   Return every chunk cached by any cpu to mm_nodelist so that they can
+ *   be merged with their neighbours.  Called when an allocation cannot be
+ *   satisfied from the free lists.
+ *
+ ****************************************************************************/
+
+void mm_cache_flush(FAR struct mm_heap_s *heap)
+{
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+	FAR struct mm_percpu_cache_s *cache;
+	FAR struct mm_cachenode_s *list = NULL;
+	FAR struct mm_cachenode_s *tmp;
+	irqstate_t flags;
+	int cpu;
+	int ndx;
+
+	/* Move the bins of all cpus to a local list */
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		cache = &heap->mm_cache[cpu];
+		flags = spin_lock_irqsave(&cache->lock);
+		for (ndx = 0; ndx < MM_CACHE_NCLASSES; ndx++) {
+			while ((tmp = cache->bin[ndx]) != NULL) {
+				cache->bin[ndx] = tmp->flink;
+				tmp->flink = list;
+				list = tmp;
+			}
+			cache->count[ndx] = 0;
+		}
+		spin_unlock_irqrestore(&cache->lock, flags);
+	}
+
+	while (list) {
+		tmp = list;
+		list = list->flink;
+		mm_free_nocache(heap, (FAR void *)tmp);
+	}
+#endif
+}
@@ -267,7 +267,7 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem, size_t size)
 			 * there may not be a successor node.
 			 */
 			DEBUGASSERT_MM_FREE_NODE(heap, prev);
-			REMOVE_NODE_FROM_LIST(prev);
+			REMOVE_NODE_FROM_LIST(heap, prev);
 
 			/* Extend the node into the previous free chunk */
 			/* Did we consume the entire preceding chunk? */
@@ -321,7 +321,7 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem, size_t size)
 			 * may not be a successor node.
 			 */
 			DEBUGASSERT_MM_FREE_NODE(heap, next);
-			REMOVE_NODE_FROM_LIST(next);
+			REMOVE_NODE_FROM_LIST(heap, next);
 
 			/* Extend the node into the next chunk */
 			/* Did we consume the entire preceding chunk? */
@@ -105,7 +105,7 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node,
 		 * not be a successor node.
 		 */
 		DEBUGASSERT_MM_FREE_NODE(heap, next);
-		REMOVE_NODE_FROM_LIST(next);
+		REMOVE_NODE_FROM_LIST(heap, next);
 
 		/* Create a new chunk that will hold both the next chunk and the
 		 * tailing memory from the aligned chunk.
@@ -104,3 +104,39 @@ int mm_size2ndx(size_t size)
 		return ndx;
 	}
 }
+
+#ifdef CONFIG_MM_FREELIST_BITMAP
+/****************************************************************************
+ * Name: mm_size2sl
+ *
+ * Description:
+ *    Convert the size to a second level class inside nodelist bin 'ndx'.
+ *    Bin 0 covers [1, 2^MM_SHIFT_FOR_NDX] and bin n covers
+ *    ]2^(n + MM_MIN_SHIFT), 2^(n + MM_MIN_SHIFT + 1)]; both are split into
+ *    MM_SL_COUNT classes of equal width.  The last bin also takes every
+ *    larger size, so it is kept as a single class.
+ *
+ ****************************************************************************/
+
+int mm_size2sl(size_t size, int ndx)
+{
+	size_t base;
+	size_t sl;
+	int shift;
+
+	if (ndx == MM_NNODES - 1) {
+		return 0;
+	}
+
+	if (ndx == 0) {
+		base = 0;
+		shift = MM_SHIFT_FOR_NDX - MM_SL_SHIFT;
+	} else {
+		base = (size_t)1 << (ndx + MM_MIN_SHIFT);
+		shift = ndx + MM_MIN_SHIFT - MM_SL_SHIFT;
+	}
+
+	sl = (size - 1 - base) >> shift;
+	return sl < MM_SL_COUNT ? (int)sl : MM_SL_COUNT - 1;
+}
+#endif
@@ -1223,6 +1223,11 @@
 #define LWIP_NETIF_TX_SINGLE_PBUF             1
 #endif
 
+/* netdev_input_ref() wraps driver buffers in custom pbufs */
+#if defined(CONFIG_NET_NETMGR_SG)
+#define LWIP_SUPPORT_CUSTOM_PBUF              1
+#endif
+
 /*  ---------------Mandatory ---------------- */
 #define LWIP_DHCP_TCPIP_THREAD 1
 #endif							/* __LWIP_LWIPOPTS_H__ */
@@ -36,7 +36,9 @@
 #include "lwip/netifapi.h"
 #include "lwip/snmp.h"
 #include "lwip/igmp.h"
+#include "lwip/memp.h"
 #include "netdev_mgr_internal.h"
+#include "netdev_stats.h"
 #include <tinyara/net/netlog.h>
 
 /* This is really kind of bogus.. When asked for an IP address, this is
@@ -327,18 +329,89 @@ static int lwip_input(struct netdev *dev, void *frame_ptr, uint16_t len)
 	return 0;
 }
 #else /*  CONFIG_NET_NETMGR_ZEROCOPY */
+#ifdef CONFIG_NET_NETMGR_SG
+/* A driver buffer wrapped by netdev_input_ref() */
+
+struct netdev_rxref {
+	struct pbuf_custom pc; /* should be the first member */
+	struct netdev *dev;
+	void *data;
+	netdev_release_t release;
+};
+
+LWIP_MEMPOOL_DECLARE(NETDEV_RXREF, CONFIG_NET_NETMGR_SG_NRXREF, sizeof(struct netdev_rxref), "NETDEV_RXREF")
+
+static int g_rxref_init = 0;
+
+/* Number of non-empty pbufs in the chain, which a gathering driver gets */
+
+static int _lwip_sg_iovcnt(struct pbuf *buf)
+{
+	struct pbuf *tbuf;
+	int iovcnt = 0;
+
+	for (tbuf = buf; tbuf; tbuf = tbuf->next) {
+		if (tbuf->len != 0) {
+			iovcnt++;
+		}
+	}
+
+	return iovcnt;
+}
+
+/*
+ * Pass the pbuf chain as is to a driver which can gather it. The chain
+ * must fit in CONFIG_NET_NETMGR_SG_IOVMAX entries, longer ones are
+ * flattened by the caller.
+ */
+static int _lwip_linkoutput_sg(struct netdev *dev, struct pbuf *buf)
+{
+	struct iovec iov[CONFIG_NET_NETMGR_SG_IOVMAX];
+	struct pbuf *tbuf;
+	int iovcnt = 0;
+
+	for (tbuf = buf; tbuf; tbuf = tbuf->next) {
+		if (tbuf->len == 0) {
+			continue;
+		}
+		iov[iovcnt].iov_base = tbuf->payload;
+		iov[iovcnt].iov_len = tbuf->len;
+		iovcnt++;
+	}
+
+	NETMGR_STATS_INC(g_link_sg_send_cnt);
+	return ND_NETOPS(dev, linkoutput_sg)(dev, iov, iovcnt, buf->tot_len);
+}
+#endif /* CONFIG_NET_NETMGR_SG */
+
 static err_t lwip_linkoutput(struct netif *nic, struct pbuf *buf)
 {
 	struct netdev *dev = LW_GETND(nic);
 	int offset = 0;
 	struct pbuf *tbuf = buf;
+	int res;
+
+#ifdef CONFIG_NET_NETMGR_SG
+	/* Whatever the driver returns is its answer, the frame is never sent
+	 * twice. Only a chain too long for the iovec takes the copy below.
+	 */
+	if (ND_NETOPS(dev, linkoutput_sg) && _lwip_sg_iovcnt(buf) <= CONFIG_NET_NETMGR_SG_IOVMAX) {
+		res = _lwip_linkoutput_sg(dev, buf);
+		if (res < 0) {
+			NET_LOGKE(TAG, "linkoutput fail\n");
+			return ERR_IF;
+		}
+		return ERR_OK;
+	}
+#endif
+
 	while (tbuf) {
 		memcpy((void *)&dev->tx_buf[offset], (void *)tbuf->payload, tbuf->len);
 		offset += tbuf->len;
 		tbuf = tbuf->next;
 	}
 
-	int res = ND_NETOPS(dev, linkoutput)(dev, dev->tx_buf, offset);
+	res = ND_NETOPS(dev, linkoutput)(dev, dev->tx_buf, offset);
 	if (res < 0) {
 		NET_LOGKE(TAG, "linkoutput fail\n");
 		return ERR_IF;
@@ -347,6 +420,39 @@ static err_t lwip_linkoutput(struct netif *nic, struct pbuf *buf)
 	return ERR_OK;
 }
 
+/* Pass a received frame to tcpip thread, p is freed here on error */
+
+static void _lwip_deliver(struct netif *netif, struct pbuf *p)
+{
+	struct eth_hdr *ethhdr = p->payload;
+	switch (htons(ethhdr->type)) {
+	case ETHTYPE_IP:
+#if LWIP_IPV6
+	case ETHTYPE_IPV6:
+#endif
+	case ETHTYPE_ARP:
+#if PPPOE_SUPPORT
+	case ETHTYPE_PPPOEDISC:
+	case ETHTYPE_PPPOE:
+#endif
+	{
+		/* full packet send to tcpip_thread to process */
+		if (netif->input(p, netif) != ERR_OK) {
+			NET_LOGKE(TAG, "input processing\n");
+			LWIP_DEBUGF(NETIF_DEBUG, ("input processing error\n"));
+			LINK_STATS_INC(link.err);
+			pbuf_free(p);
+		} else {
+			LINK_STATS_INC(link.recv);
+		}
+	} break;
+	default:
+		pbuf_free(p);
+		p = NULL;
+		break;
+	}
+}
+
 static int lwip_input(struct netdev *dev, void *frame_ptr, uint16_t len)
 {
 	LWIP_DEBUGF(NETIF_DEBUG, ("passing to LWIP layer, packet len %d \n", len));
@@ -376,36 +482,59 @@ static int lwip_input(struct netdev *dev, void *frame_ptr, uint16_t len)
 		frame_ptr += q->len;
 	}
 
-	struct eth_hdr *ethhdr = p->payload;
-	switch (htons(ethhdr->type)) {
-	case ETHTYPE_IP:
-#if LWIP_IPV6
-	case ETHTYPE_IPV6:
-#endif
-	case ETHTYPE_ARP:
-#if PPPOE_SUPPORT
-	case ETHTYPE_PPPOEDISC:
-	case ETHTYPE_PPPOE:
-#endif
-	{
-		/* full packet send to tcpip_thread to process */
-		if (netif->input(p, netif) != ERR_OK) {
-			NET_LOGKE(TAG, "input processing\n");
-			LWIP_DEBUGF(NETIF_DEBUG, ("input processing error\n"));
-			LINK_STATS_INC(link.err);
-			pbuf_free(p);
-		} else {
-			LINK_STATS_INC(link.recv);
+	_lwip_deliver(netif, p);
+
+	return 0;
+}
+
+#ifdef CONFIG_NET_NETMGR_SG
+static void _lwip_rxref_free(struct pbuf *p)
+{
+	struct netdev_rxref *ref = (struct netdev_rxref *)p;
+
+	ref->release(ref->dev, ref->data);
+	LWIP_MEMPOOL_FREE(NETDEV_RXREF, ref);
+}
+
+static int lwip_input_ref(struct netdev *dev, void *data, uint16_t len, netdev_release_t release)
+{
+	struct netdev_rxref *ref;
+	struct pbuf *p;
+
+	if (!dev || !data || !release || len == 0) {
+		NET_LOGKE(TAG, "invalid parameter\n");
+		return -1;
+	}
+
+	/* Every wrapper is held by lwIP, copy the frame so that the driver
+	 * gets its buffer back.
+	 */
+	ref = (struct netdev_rxref *)LWIP_MEMPOOL_ALLOC(NETDEV_RXREF);
+	if (!ref) {
+		NETMGR_STATS_INC(g_link_ref_copy_cnt);
+		if (lwip_input(dev, data, len) < 0) {
+			return -1;
 		}
-	} break;
-	default:
-		pbuf_free(p);
-		p = NULL;
-		break;
+		release(dev, data);
+		return 0;
 	}
 
+	ref->dev = dev;
+	ref->data = data;
+	ref->release = release;
+	ref->pc.custom_free_function = _lwip_rxref_free;
+	p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &ref->pc, data, len);
+	if (!p) {
+		LWIP_MEMPOOL_FREE(NETDEV_RXREF, ref);
+		return -1;
+	}
+
+	NETMGR_STATS_INC(g_link_ref_recv_cnt);
+	_lwip_deliver(GET_NETIF_FROM_NETDEV(dev), p);
+
 	return 0;
 }
+#endif /* CONFIG_NET_NETMGR_SG */
 #endif /*  CONFIG_NET_NETMGR_ZEROCOPY */
 
 static err_t lwip_set_multicast_list(struct netif *nic, const ip4_addr_t *group, enum netif_mac_filter_action action)
@@ -788,6 +917,9 @@ static int lwip_init_nic(struct netdev *dev, struct nic_config *config)
 	}
 	((struct netdev_ops *)dev->ops)->linkoutput = config->io_ops.linkoutput;
 	((struct netdev_ops *)dev->ops)->igmp_mac_filter = config->io_ops.igmp_mac_filter;
+#ifdef CONFIG_NET_NETMGR_SG
+	((struct netdev_ops *)dev->ops)->linkoutput_sg = config->io_ops.linkoutput_sg;
+#endif
 
 	nic->mtu = CONFIG_NET_ETH_MTU;
 	nic->hwaddr_len = config->hwaddr_len;
@@ -918,6 +1050,14 @@ struct netdev_ops *get_netdev_ops_lwip(void)
 	netdev_ops->leavegroup = lwip_leavegroup;
 
 	netdev_ops->input = lwip_input;
+#ifdef CONFIG_NET_NETMGR_SG
+	netdev_ops->input_ref = lwip_input_ref;
+	netdev_ops->linkoutput_sg = NULL;
+	if (!g_rxref_init) {
+		LWIP_MEMPOOL_INIT(NETDEV_RXREF);
+		g_rxref_init = 1;
+	}
+#endif
 	netdev_ops->get_stats = lwip_get_stats;
 	netdev_ops->nic = NULL;
 
@@ -76,6 +76,17 @@ int netdev_input(struct netdev *dev, void *data, uint16_t len)
 	return ND_NETOPS(dev, input)(dev, data, len);
 }
 
+#ifdef CONFIG_NET_NETMGR_SG
+int netdev_input_ref(struct netdev *dev, void *data, uint16_t len, netdev_release_t release)
+{
+	if (len > 0) {
+		NETMGR_STATS_ADD(g_link_recv_byte, len);
+		NETMGR_STATS_INC(g_link_recv_cnt);
+	}
+	return ND_NETOPS(dev, input_ref)(dev, data, len, release);
+}
+#endif
+
 int netdev_get_mtu(struct netdev *dev, int *mtu)
 {
 	return ND_NETOPS(dev, get_mtu)(dev, mtu);
@@ -78,6 +78,10 @@ struct netdev_ops {
 	int (*input)(struct netdev *dev, void *data, uint16_t len);
 	int (*linkoutput)(struct netdev *dev, void *data, uint16_t len);
 	int (*igmp_mac_filter)(struct netdev *dev, const struct in_addr *group, netdev_mac_filter_action action);
+#ifdef CONFIG_NET_NETMGR_SG
+	int (*input_ref)(struct netdev *dev, void *data, uint16_t len, netdev_release_t release);
+	int (*linkoutput_sg)(struct netdev *dev, const struct iovec *iov, int iovcnt, uint16_t len);
+#endif
 
 	/* statistics */
 	int (*get_stats)(struct netdev *dev, void *arg);
@@ -24,6 +24,11 @@
 uint32_t g_link_recv_byte = 0;
 uint32_t g_link_recv_cnt = 0;
 uint32_t g_link_recv_err = 0;
+#ifdef CONFIG_NET_NETMGR_SG
+uint32_t g_link_sg_send_cnt = 0;
+uint32_t g_link_ref_recv_cnt = 0;
+uint32_t g_link_ref_copy_cnt = 0;
+#endif
 
 uint32_t g_app_recv_byte = 0;
 uint32_t g_app_recv_cnt = 0;
@@ -32,5 +37,8 @@ void netstats_display(void)
 {
 	NET_LOGK(TAG, "[driver] total recv %u\t%u\n", g_link_recv_byte, g_link_recv_cnt);
 	NET_LOGK(TAG, "[driver] mbox err %u\n", g_link_recv_err);
+#ifdef CONFIG_NET_NETMGR_SG
+	NET_LOGK(TAG, "[driver] sg send %u\tref recv %u\tref copied %u\n", g_link_sg_send_cnt, g_link_ref_recv_cnt, g_link_ref_copy_cnt);
+#endif
 	NET_LOGK(TAG, "[app] total recv %u\t%u\n", g_app_recv_byte, g_app_recv_cnt);
 }
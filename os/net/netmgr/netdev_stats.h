@@ -23,6 +23,11 @@
 extern uint32_t g_link_recv_byte;
 extern uint32_t g_link_recv_cnt;
 extern uint32_t g_link_recv_err;
+#ifdef CONFIG_NET_NETMGR_SG
+extern uint32_t g_link_sg_send_cnt;
+extern uint32_t g_link_ref_recv_cnt;
+extern uint32_t g_link_ref_copy_cnt;
+#endif
 
 extern uint32_t g_app_recv_byte;
 extern uint32_t g_app_recv_cnt;
@@ -205,10 +205,17 @@ SYSCALL_LOOKUP(aio_read,                1, SYS_aio_read)
 SYSCALL_LOOKUP(aio_write,               1, SYS_aio_write)
 SYSCALL_LOOKUP(aio_fsync,               2, SYS_aio_fsync)
 SYSCALL_LOOKUP(aio_cancel,              2, SYS_aio_cancel)
+SYSCALL_LOOKUP(lio_listio,              4, STUB_lio_listio)
 #  endif
 #  ifndef CONFIG_DISABLE_POLL
 SYSCALL_LOOKUP(poll,                    3, STUB_poll)
 SYSCALL_LOOKUP(select,                  5, STUB_select)
+#    ifdef CONFIG_FS_EPOLL
+SYSCALL_LOOKUP(epoll_create,            1, STUB_epoll_create)
+SYSCALL_LOOKUP(epoll_ctl,               4, STUB_epoll_ctl)
+SYSCALL_LOOKUP(epoll_wait,              4, STUB_epoll_wait)
+SYSCALL_LOOKUP(epoll_close,             1, STUB_epoll_close)
+#    endif
 #  endif
 #endif
 
@@ -74,6 +74,11 @@
  * Private Types
  ****************************************************************************/
 
+struct symbol_s {
+	char *name;					/* Name of the symbol */
+	char *cond;					/* Condition to compile the entry, or NULL */
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -81,17 +86,22 @@
 static const char *g_hdrfiles[MAX_HEADER_FILES];
 static int nhdrfiles;
 
+static struct symbol_s *g_symbols;
+static int nsymbols;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 static void show_usage(const char *progname)
 {
-	fprintf(stderr, "USAGE: %s <cvs-file> <symtab-file>\n\n", progname);
+	fprintf(stderr, "USAGE: %s [-d] [-s] <cvs-file> <symtab-file>\n\n", progname);
 	fprintf(stderr, "Where:\n\n");
 	fprintf(stderr, "  <cvs-file>   : The path to the input CSV file\n");
 	fprintf(stderr, "  <symtab-file>: The path to the output symbol table file\n");
 	fprintf(stderr, "  -d           : Enable debug output\n");
+	fprintf(stderr, "  -s           : Sort the symbol table by name, for use with\n");
+	fprintf(stderr, "                 CONFIG_SYMTAB_ORDEREDBYNAME\n");
 	exit(EXIT_FAILURE);
 }
 
@@ -122,6 +132,29 @@ static void add_hdrfile(const char *hdrfile)
 	}
 }
 
+static void add_symbol(const char *name, const char *cond)
+{
+	struct symbol_s *symbols;
+
+	symbols = realloc(g_symbols, (nsymbols + 1) * sizeof(struct symbol_s));
+	if (!symbols) {
+		fprintf(stderr, "ERROR:  Failed to allocate symbol %d\n", nsymbols);
+		exit(EXIT_FAILURE);
+	}
+
+	g_symbols = symbols;
+	g_symbols[nsymbols].name = strdup(name);
+	g_symbols[nsymbols].cond = (cond && strlen(cond) > 0) ? strdup(cond) : NULL;
+	nsymbols++;
+}
+
+static int compare_symbols(const void *a, const void *b)
+{
+	/* Same order as the strcmp() of symtab_findorderedbyname() */
+
+	return strcmp(((const struct symbol_s *)a)->name, ((const struct symbol_s *)b)->name);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -134,6 +167,7 @@ int main(int argc, char **argv, char **envp)
 	char *finalterm;
 	char *ptr;
 	bool cond;
+	bool sort = false;
 	FILE *instream;
 	FILE *outstream;
 	int ch;
@@ -143,12 +177,16 @@ int main(int argc, char **argv, char **envp)
 
 	set_debug(false);
 
-	while ((ch = getopt(argc, argv, ":d")) > 0) {
+	while ((ch = getopt(argc, argv, ":ds")) > 0) {
 		switch (ch) {
 		case 'd':
 			set_debug(true);
 			break;
 
+		case 's':
+			sort = true;
+			break;
+
 		case '?':
 			fprintf(stderr, "Unrecognized option: %c\n", optopt);
 			show_usage(argv[0]);
@@ -200,7 +238,7 @@ int main(int argc, char **argv, char **envp)
 		exit(EXIT_FAILURE);
 	}
 
-	/* Get all of the header files that we need to include */
+	/* Get all of the header files that we need to include and the symbols */
 
 	while ((ptr = read_line(instream)) != NULL) {
 		/* Parse the line from the CVS file */
@@ -214,11 +252,12 @@ int main(int argc, char **argv, char **envp)
 		/* Add the header file to the list of header files we need to include */
 
 		add_hdrfile(get_parm(HEADER_INDEX));
+		add_symbol(get_parm(NAME_INDEX), get_parm(COND_INDEX));
 	}
 
-	/* Back to the beginning */
-
-	rewind(instream);
+	if (sort) {
+		qsort(g_symbols, nsymbols, sizeof(struct symbol_s), compare_symbols);
+	}
 
 	/* Output up-front file boilerplate */
 
@@ -236,31 +275,23 @@ int main(int argc, char **argv, char **envp)
 	fprintf(outstream, "\nstruct symtab_s %s[] =\n", SYMTAB_NAME);
 	fprintf(outstream, "{\n");
 
-	/* Parse each line in the CVS file */
+	/* Output each symbol */
 
 	nextterm = "";
 	finalterm = "";
 
-	while ((ptr = read_line(instream)) != NULL) {
-		/* Parse the line from the CVS file */
-
-		int nargs = parse_csvline(ptr);
-		if (nargs < PARM1_INDEX) {
-			fprintf(stderr, "Only %d arguments found: %s\n", nargs, get_line());
-			exit(EXIT_FAILURE);
-		}
-
+	for (i = 0; i < nsymbols; i++) {
 		/* Output any conditional compilation */
 
-		cond = (get_parm(COND_INDEX) && strlen(get_parm(COND_INDEX)) > 0);
+		cond = (g_symbols[i].cond != NULL);
 		if (cond) {
-			fprintf(outstream, "%s#if %s\n", nextterm, get_parm(COND_INDEX));
+			fprintf(outstream, "%s#if %s\n", nextterm, g_symbols[i].cond);
 			nextterm = "";
 		}
 
 		/* Output the symbol table entry */
 
-		fprintf(outstream, "%s  { \"%s\", (FAR const void *)%s }", nextterm, get_parm(NAME_INDEX), get_parm(NAME_INDEX));
+		fprintf(outstream, "%s  { \"%s\", (FAR const void *)%s }", nextterm, g_symbols[i].name, g_symbols[i].name);
 
 		if (cond) {
 			nextterm = ",\n#endif\n";
@@ -112,6 +112,23 @@
 
 int work_cancel(int qid, FAR struct work_s *work)
 {
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	FAR struct wqueue_s *wqueue;
+
+	/* The work can only be on the queue of the cpu it was queued on */
+
+	DEBUGASSERT(work != NULL);
+	if (work->cpu >= CONFIG_SMP_NCPUS) {
+		return -ENOENT;
+	}
+
+	wqueue = work_getqueue(qid, work->cpu);
+	if (wqueue == NULL) {
+		return -EINVAL;
+	}
+
+	return work_qcancel(wqueue, work);
+#else
 #ifdef CONFIG_SCHED_HPWORK
 	if (qid == HPWORK) {
 		/* Cancel high priority work */
@@ -129,4 +146,5 @@ int work_cancel(int qid, FAR struct work_s *work)
 		{
 			return -EINVAL;
 		}
+#endif
 }
@@ -56,6 +56,8 @@
 
 #include <tinyara/config.h>
 
+#include <unistd.h>
+#include <sched.h>
 #include <errno.h>
 #include <queue.h>
 #include <debug.h>
@@ -64,6 +66,10 @@
 #include <tinyara/kthread.h>
 #include <tinyara/kmalloc.h>
 #include <tinyara/clock.h>
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+#include <tinyara/semaphore.h>
+#include <tinyara/spinlock.h>
+#endif
 
 #include "wqueue.h"
 
@@ -81,7 +87,11 @@
 
 /* The state of the kernel mode, high priority work queue. */
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+static struct hp_wqueue_s g_hpwork[CONFIG_SMP_NCPUS];
+#else
 static struct hp_wqueue_s g_hpwork;
+#endif
 
 /****************************************************************************
  * Private Data
@@ -117,6 +127,43 @@ static struct hp_wqueue_s g_hpwork;
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+static int work_hpthread(int argc, char *argv[])
+{
+	pid_t me = getpid();
+	int cpu;
+
+	/* Find out which cpu this worker serves */
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		if (g_hpwork[cpu].worker[0].pid == me) {
+			break;
+		}
+	}
+
+	DEBUGASSERT(cpu < CONFIG_SMP_NCPUS);
+
+	/* Loop forever */
+
+	for (;;) {
+#ifndef CONFIG_SCHED_LPWORK
+		/* Only the worker of cpu 0 performs garbage collection */
+
+		if (cpu == 0) {
+			sched_garbagecollection();
+		}
+#endif
+
+		/* Run one work from this cpu, or one stolen from another cpu, or
+		 * wait until there is work to do.
+		 */
+
+		work_percpu_process(HPWORK, cpu, 0);
+	}
+
+	return OK;					/* To keep some compilers happy */
+}
+#else
 static int work_hpthread(int argc, char *argv[])
 {
 	/* Loop forever */
@@ -147,15 +194,23 @@ static int work_hpthread(int argc, char *argv[])
 
 	return OK;					/* To keep some compilers happy */
 }
+#endif
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+struct hp_wqueue_s *get_hpwork_cpu(int cpu)
+{
+	return &g_hpwork[cpu];
+}
+#else
 struct hp_wqueue_s *get_hpwork(void)
 {
 	return &g_hpwork;
 }
+#endif
 
 /****************************************************************************
  * Name: work_hpstart
@@ -172,6 +227,62 @@ struct hp_wqueue_s *get_hpwork(void)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+int work_hpstart(void)
+{
+	FAR struct hp_wqueue_s *hwq;
+	cpu_set_t cpuset;
+	int pid;
+	int cpu;
+
+	/* Don't permit any of the threads to run until we have fully initialized
+	 * g_hpwork.
+	 */
+
+	sched_lock();
+
+	/* Start one high-priority, kernel mode worker thread per cpu */
+
+	svdbg("Starting high-priority kernel worker threads\n");
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		hwq = &g_hpwork[cpu];
+
+		dq_init(&hwq->q);
+		spin_initialize(&hwq->pcpu.lock, SP_UNLOCKED);
+		sem_init(&hwq->pcpu.wake, 0, 0);
+		sem_setprotocol(&hwq->pcpu.wake, SEM_PRIO_NONE);
+
+		pid = kernel_thread(HPWORKNAME, CONFIG_SCHED_HPWORKPRIORITY, CONFIG_SCHED_HPWORKSTACKSIZE, (main_t)work_hpthread, (FAR char *const *)NULL);
+
+		DEBUGASSERT(pid > 0);
+		if (pid < 0) {
+			int errcode = errno;
+			DEBUGASSERT(errcode > 0);
+
+			sdbg("kernel_thread %d failed: %d\n", cpu, errcode);
+			sched_unlock();
+			return -errcode;
+		}
+
+		hwq->worker[0].pid = pid;
+		hwq->worker[0].busy = true;
+
+		/* Bind the worker to its cpu.  This is only a locality hint, the
+		 * queues are protected by their own locks.
+		 */
+
+		CPU_ZERO(&cpuset);
+		CPU_SET(cpu, &cpuset);
+		if (sched_setaffinity(pid, sizeof(cpu_set_t), &cpuset) < 0) {
+			sdbg("Failed to bind worker %d to its cpu: %d\n", pid, errno);
+		}
+	}
+
+	sched_unlock();
+	return g_hpwork[0].worker[0].pid;
+}
+#else
 int work_hpstart(void)
 {
 	int pid;
@@ -199,3 +310,4 @@ int work_hpstart(void)
 	g_hpwork.worker[0].busy = true;
 	return pid;
 }
+#endif
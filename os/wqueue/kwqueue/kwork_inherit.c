@@ -319,6 +319,9 @@ void lpwork_boostpriority(uint8_t reqprio)
 {
 	irqstate_t flags;
 	int wndx;
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	int cpu;
+#endif
 
 	/* Clip to the configured maximum priority */
 
@@ -333,10 +336,19 @@ void lpwork_boostpriority(uint8_t reqprio)
 
 	/* Adjust the priority of every worker thread */
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		struct lp_wqueue_s *lwq = get_lpwork_cpu(cpu);
+		for (wndx = 0; wndx < CONFIG_SCHED_LPNTHREADS; wndx++) {
+			lpwork_boostworker(lwq->worker[wndx].pid, reqprio);
+		}
+	}
+#else
 	struct lp_wqueue_s *lwq = get_lpwork();
 	for (wndx = 0; wndx < CONFIG_SCHED_LPNTHREADS; wndx++) {
 		lpwork_boostworker(lwq->worker[wndx].pid, reqprio);
 	}
+#endif
 
 	sched_unlock();
 	leave_critical_section(flags);
@@ -364,6 +376,9 @@ void lpwork_restorepriority(uint8_t reqprio)
 {
 	irqstate_t flags;
 	int wndx;
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	int cpu;
+#endif
 
 	/* Clip to the configured maximum priority */
 
@@ -378,10 +393,19 @@ void lpwork_restorepriority(uint8_t reqprio)
 
 	/* Adjust the priority of every worker thread */
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		struct lp_wqueue_s *lwq = get_lpwork_cpu(cpu);
+		for (wndx = 0; wndx < CONFIG_SCHED_LPNTHREADS; wndx++) {
+			lpwork_restoreworker(lwq->worker[wndx].pid, reqprio);
+		}
+	}
+#else
 	struct lp_wqueue_s *lwq = get_lpwork();
 	for (wndx = 0; wndx < CONFIG_SCHED_LPNTHREADS; wndx++) {
 		lpwork_restoreworker(lwq->worker[wndx].pid, reqprio);
 	}
+#endif
 
 	sched_unlock();
 	leave_critical_section(flags);
@@ -67,6 +67,10 @@
 #include <tinyara/kthread.h>
 #include <tinyara/kmalloc.h>
 #include <tinyara/clock.h>
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+#include <tinyara/semaphore.h>
+#include <tinyara/spinlock.h>
+#endif
 
 #include "wqueue.h"
 
@@ -84,7 +88,11 @@
 
 /* The state of the kernel mode, low priority work queue(s). */
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+static struct lp_wqueue_s g_lpwork[CONFIG_SMP_NCPUS];
+#else
 static struct lp_wqueue_s g_lpwork;
+#endif
 
 /****************************************************************************
  * Private Data
@@ -119,6 +127,43 @@ static struct lp_wqueue_s g_lpwork;
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+static int work_lpthread(int argc, char *argv[])
+{
+	pid_t me = getpid();
+	int wndx = 0;
+	int cpu;
+	int i;
+
+	/* Find out the cpu and the thread index of this worker */
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		for (i = 0; i < CONFIG_SCHED_LPNTHREADS; i++) {
+			if (g_lpwork[cpu].worker[i].pid == me) {
+				wndx = i;
+				goto found;
+			}
+		}
+	}
+
+found:
+	DEBUGASSERT(cpu < CONFIG_SMP_NCPUS);
+
+	/* Loop forever */
+
+	for (;;) {
+		/* Only thread 0 of cpu 0 performs garbage collection */
+
+		if (cpu == 0 && wndx == 0) {
+			sched_garbagecollection();
+		}
+
+		work_percpu_process(LPWORK, cpu, wndx);
+	}
+
+	return OK;					/* To keep some compilers happy */
+}
+#else
 static int work_lpthread(int argc, char *argv[])
 {
 #if CONFIG_SCHED_LPNTHREADS > 0
@@ -180,15 +225,23 @@ static int work_lpthread(int argc, char *argv[])
 
 	return OK;					/* To keep some compilers happy */
 }
+#endif
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+struct lp_wqueue_s *get_lpwork_cpu(int cpu)
+{
+	return &g_lpwork[cpu];
+}
+#else
 struct lp_wqueue_s *get_lpwork(void)
 {
 	return &g_lpwork;
 }
+#endif
 
 /****************************************************************************
  * Name: work_lpstart
@@ -205,6 +258,65 @@ struct lp_wqueue_s *get_lpwork(void)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+int work_lpstart(void)
+{
+	FAR struct lp_wqueue_s *lwq;
+	cpu_set_t cpuset;
+	int pid;
+	int wndx;
+	int cpu;
+
+	/* Don't permit any of the threads to run until we have fully initialized
+	 * g_lpwork.
+	 */
+
+	sched_lock();
+
+	/* Start CONFIG_SCHED_LPNTHREADS low-priority, kernel mode worker threads
+	 * per cpu.
+	 */
+
+	svdbg("Starting low-priority kernel worker threads\n");
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		lwq = &g_lpwork[cpu];
+		memset(lwq, 0, sizeof(struct lp_wqueue_s));
+
+		dq_init(&lwq->q);
+		spin_initialize(&lwq->pcpu.lock, SP_UNLOCKED);
+		sem_init(&lwq->pcpu.wake, 0, 0);
+		sem_setprotocol(&lwq->pcpu.wake, SEM_PRIO_NONE);
+
+		CPU_ZERO(&cpuset);
+		CPU_SET(cpu, &cpuset);
+
+		for (wndx = 0; wndx < CONFIG_SCHED_LPNTHREADS; wndx++) {
+			pid = kernel_thread(LPWORKNAME, CONFIG_SCHED_LPWORKPRIORITY, CONFIG_SCHED_LPWORKSTACKSIZE, (main_t)work_lpthread, (FAR char *const *)NULL);
+
+			DEBUGASSERT(pid > 0);
+			if (pid < 0) {
+				int errcode = errno;
+				DEBUGASSERT(errcode > 0);
+
+				sdbg("kernel_thread %d/%d failed: %d\n", cpu, wndx, errcode);
+				sched_unlock();
+				return -errcode;
+			}
+
+			lwq->worker[wndx].pid = (pid_t)pid;
+			lwq->worker[wndx].busy = true;
+
+			if (sched_setaffinity(pid, sizeof(cpu_set_t), &cpuset) < 0) {
+				sdbg("Failed to bind worker %d to its cpu: %d\n", pid, errno);
+			}
+		}
+	}
+
+	sched_unlock();
+	return g_lpwork[0].worker[0].pid;
+}
+#else
 int work_lpstart(void)
 {
 	int pid;
@@ -247,3 +359,4 @@ int work_lpstart(void)
 	sched_unlock();
 	return lwq->worker[0].pid;
 }
+#endif
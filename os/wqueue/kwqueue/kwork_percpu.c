@@ -0,0 +1,275 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * wqueue/kwqueue/kwork_percpu.c
+ *
+ * Per-cpu kernel work queues.  Each of the HP and LP work queues is split
+ * into one queue per cpu, protected by its own spinlock and served by
+ * workers bound to that cpu.  A worker whose queue has no ready work takes
+ * ready work from the queues of the other cpus, so that a slow callback
+ * only delays the work queued behind it on its own cpu.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <queue.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/clock.h>
+#include <tinyara/semaphore.h>
+#include <tinyara/spinlock.h>
+#include <tinyara/wqueue.h>
+
+#include "wqueue.h"
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#if defined(CONFIG_DEBUG_WORKQUEUE)
+static worker_t cur_worker[CONFIG_SMP_NCPUS];
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_percpu_account
+ *
+ * Description:
+ *   Account the start latency of a work, i.e. the time between its
+ *   deadline and the moment a worker takes it.
+ *
+ ****************************************************************************/
+
+static void work_percpu_account(FAR struct wqueue_s *wqueue, FAR struct work_s *work, clock_t now)
+{
+	clock_t latency = now - (work->qtime + work->delay);
+	int bucket = 0;
+
+	while (latency > 0 && bucket < WORK_HIST_NBUCKETS - 1) {
+		latency >>= 1;
+		bucket++;
+	}
+
+	wqueue->pcpu.hist[bucket]++;
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	wqueue->wheel.stats.nexecuted++;
+#endif
+}
+
+/****************************************************************************
+ * Name: work_percpu_take
+ *
+ * Description:
+ *   Remove the first ready work from a queue and return its callback and
+ *   argument.  '*next' is set to the number of ticks until the next
+ *   deadline, or zero if there is no delayed work.  The queue must be
+ *   locked.
+ *
+ ****************************************************************************/
+
+static worker_t work_percpu_take(FAR struct wqueue_s *wqueue, clock_t now, FAR void **arg, FAR clock_t *next)
+{
+	FAR struct work_s *work;
+	worker_t worker;
+
+	*next = 0;
+
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	*next = work_wheel_expire(wqueue, now);
+#endif
+
+	while ((work = (FAR struct work_s *)wqueue->q.head) != NULL) {
+#ifndef CONFIG_SCHED_WORKQUEUE_WHEEL
+		/* The queue is sorted by deadline */
+
+		if (now - work->qtime < work->delay) {
+			*next = work->delay - (now - work->qtime);
+			return NULL;
+		}
+#endif
+
+		dq_rem((FAR dq_entry_t *)work, &wqueue->q);
+
+		worker = work->worker;
+		if (worker != NULL) {
+			*arg = work->arg;
+			work->worker = NULL;
+			work_percpu_account(wqueue, work, now);
+			return worker;
+		}
+	}
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_getqueue
+ ****************************************************************************/
+
+FAR struct wqueue_s *work_getqueue(int qid, int cpu)
+{
+	if (cpu < 0 || cpu >= CONFIG_SMP_NCPUS) {
+		return NULL;
+	}
+
+#ifdef CONFIG_SCHED_HPWORK
+	if (qid == HPWORK) {
+		return (FAR struct wqueue_s *)get_hpwork_cpu(cpu);
+	}
+#endif
+#ifdef CONFIG_SCHED_LPWORK
+	if (qid == LPWORK) {
+		return (FAR struct wqueue_s *)get_lpwork_cpu(cpu);
+	}
+#endif
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: work_percpu_process
+ ****************************************************************************/
+
+void work_percpu_process(int qid, int cpu, int wndx)
+{
+	FAR struct wqueue_s *wqueue = work_getqueue(qid, cpu);
+	FAR struct wqueue_s *victim;
+	worker_t worker;
+	FAR void *arg = NULL;
+	irqstate_t flags;
+	clock_t now;
+	clock_t next;
+	clock_t vnext;
+	int i;
+
+	/* Look at our own queue first.  If it has nothing ready, count
+	 * ourselves idle right away, under the same lock, so that work queued
+	 * from now on wakes us up even while we look at the other queues.
+	 */
+
+	flags = work_qlock(wqueue);
+	now = clock();
+	worker = work_percpu_take(wqueue, now, &arg, &next);
+	if (worker == NULL) {
+		wqueue->pcpu.nidle++;
+		wqueue->worker[wndx].busy = false;
+	}
+	work_qunlock(wqueue, flags);
+
+	/* Then try to steal ready work from the other cpus.  The deadlines of
+	 * queues whose workers are all busy are ours to watch as well.
+	 */
+
+	for (i = 1; worker == NULL && i < CONFIG_SMP_NCPUS; i++) {
+		victim = work_getqueue(qid, (cpu + i) % CONFIG_SMP_NCPUS);
+
+		flags = work_qlock(victim);
+		worker = work_percpu_take(victim, now, &arg, &vnext);
+		if (worker != NULL) {
+			victim->pcpu.nstolen++;
+		} else if (victim->pcpu.nidle == 0 && vnext > 0 && (next == 0 || vnext < next)) {
+			next = vnext;
+		}
+		work_qunlock(victim, flags);
+
+		if (worker != NULL) {
+			flags = work_qlock(wqueue);
+			wqueue->pcpu.nidle--;
+			wqueue->worker[wndx].busy = true;
+			work_qunlock(wqueue, flags);
+		}
+	}
+
+	if (worker != NULL) {
+#if defined(CONFIG_DEBUG_WORKQUEUE)
+		cur_worker[cpu] = worker;
+#endif
+		worker(arg);
+		return;
+	}
+
+	/* Nothing to do anywhere.  Wait for work or for the next deadline. */
+
+	if (next > 0) {
+		sem_tickwait(&wqueue->pcpu.wake, clock(), next);
+	} else {
+		sem_wait(&wqueue->pcpu.wake);
+	}
+
+	flags = work_qlock(wqueue);
+	wqueue->pcpu.nidle--;
+	wqueue->worker[wndx].busy = true;
+	work_qunlock(wqueue, flags);
+}
+
+/****************************************************************************
+ * Name: work_percpu_signal
+ ****************************************************************************/
+
+int work_percpu_signal(int qid, int cpu)
+{
+	FAR struct wqueue_s *wqueue;
+	int i;
+
+	for (i = 0; i < CONFIG_SMP_NCPUS; i++) {
+		wqueue = work_getqueue(qid, (cpu + i) % CONFIG_SMP_NCPUS);
+		if (wqueue == NULL) {
+			return -EINVAL;
+		}
+
+		if (wqueue->pcpu.nidle > 0) {
+			return sem_post(&wqueue->pcpu.wake);
+		}
+	}
+
+	/* Every worker is busy, the work is picked up when one returns */
+
+	return OK;
+}
+
+#if defined(CONFIG_DEBUG_WORKQUEUE)
+/****************************************************************************
+ * Name: work_get_current
+ ****************************************************************************/
+
+worker_t work_get_current(void)
+{
+	return cur_worker[up_cpu_index()];
+}
+#endif
+
+#endif /* CONFIG_SCHED_WORKQUEUE_PERCPU */
@@ -0,0 +1,409 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * wqueue/kwqueue/kwork_procfs.c
+ *
+ * /proc/wqueue reports the statistics of the kernel work queues: the
+ * timing wheel counters and, with per-cpu queues, the number of stolen
+ * works and a histogram of the start latencies.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/irq.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/wqueue.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#include "wqueue.h"
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+	(defined(CONFIG_SCHED_WORKQUEUE_WHEEL) || defined(CONFIG_SCHED_WORKQUEUE_PERCPU)) && \
+	!defined(CONFIG_FS_PROCFS_EXCLUDE_WQUEUE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Determines the size of an intermediate buffer that must be large enough
+ * to handle the longest line generated by this logic: a histogram row with
+ * every counter at its maximum of 10 digits takes 126 bytes.  The titles
+ * are copied from the string literals directly.
+ */
+
+#define WQUEUE_LINELEN 128
+#define WQUEUE_NAMELEN 12
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+#define WQUEUE_NCPUS CONFIG_SMP_NCPUS
+#else
+#define WQUEUE_NCPUS 1
+#endif
+
+#define WQUEUE_INFO_TITLE \
+	"  QUEUE  |   QUEUED   |  EXECUTED  | CANCELLED  | DELAYED |  MAXDLY | MAXLATE\n" \
+	" --------|------------|------------|------------|---------|---------|--------\n"
+#define WQUEUE_INFO_FMT " %7s | %10u | %10u | %10u | %7u | %7u | %7u\n"
+
+/* Start latency histogram, in ticks past the deadline */
+
+#define WQUEUE_HIST_TITLE \
+	"  QUEUE  |  STOLEN  |    0   |    1   |   2-3  |   4-7  |  8-15  | 16-31  | 32-63  |  64+\n" \
+	" --------|----------|--------|--------|--------|--------|--------|--------|--------|-------\n"
+#define WQUEUE_HIST_FMT " %7s | %8u | %6u | %6u | %6u | %6u | %6u | %6u | %6u | %6u\n"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct wqueue_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	char line[WQUEUE_LINELEN];	/* Pre-allocated buffer for formatted lines */
+};
+
+/* Formats the line of one work queue in one of the tables */
+
+typedef size_t (*wqueue_readline_t)(FAR struct wqueue_file_s *attr, FAR const char *name, FAR struct wqueue_s *wqueue);
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int wqueue_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int wqueue_close(FAR struct file *filep);
+static ssize_t wqueue_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int wqueue_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int wqueue_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there. */
+
+const struct procfs_operations wqueue_operations = {
+	wqueue_open,				/* open */
+	wqueue_close,				/* close */
+	wqueue_read,				/* read */
+	NULL,						/* write */
+
+	wqueue_dup,					/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	wqueue_stat					/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wqueue_open
+ ****************************************************************************/
+
+static int wqueue_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct wqueue_file_s *attr;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	if (strcmp(relpath, "wqueue") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	attr = (FAR struct wqueue_file_s *)kmm_zalloc(sizeof(struct wqueue_file_s));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: wqueue_close
+ ****************************************************************************/
+
+static int wqueue_close(FAR struct file *filep)
+{
+	FAR struct wqueue_file_s *attr;
+
+	attr = (FAR struct wqueue_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: wqueue_getqueue
+ *
+ * Description:
+ *   Return the queue 'qid' of 'cpu' and its name, or NULL if there is no
+ *   such queue.
+ *
+ ****************************************************************************/
+
+static FAR struct wqueue_s *wqueue_getqueue(int qid, int cpu, FAR char *name)
+{
+	FAR struct wqueue_s *wqueue = NULL;
+	FAR const char *prefix = (qid == HPWORK) ? "hpwork" : "lpwork";
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	wqueue = work_getqueue(qid, cpu);
+	snprintf(name, WQUEUE_NAMELEN, "%s%d", prefix, cpu);
+#else
+	if (cpu == 0) {
+#ifdef CONFIG_SCHED_HPWORK
+		if (qid == HPWORK) {
+			wqueue = (FAR struct wqueue_s *)get_hpwork();
+		}
+#endif
+#ifdef CONFIG_SCHED_LPWORK
+		if (qid == LPWORK) {
+			wqueue = (FAR struct wqueue_s *)get_lpwork();
+		}
+#endif
+	}
+
+	snprintf(name, WQUEUE_NAMELEN, "%s", prefix);
+#endif
+
+	return wqueue;
+}
+
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+/****************************************************************************
+ * Name: wqueue_readline
+ *
+ * Description:
+ *   Format the statistics of one work queue into the line buffer.
+ *
+ ****************************************************************************/
+
+static size_t wqueue_readline(FAR struct wqueue_file_s *attr, FAR const char *name, FAR struct wqueue_s *wqueue)
+{
+	struct work_stats_s stats;
+	irqstate_t flags;
+
+	/* Take a consistent snapshot, the counters are updated with the queue
+	 * locked.
+	 */
+
+	flags = work_qlock(wqueue);
+	stats = wqueue->wheel.stats;
+	work_qunlock(wqueue, flags);
+
+	return snprintf(attr->line, WQUEUE_LINELEN, WQUEUE_INFO_FMT, name, stats.nqueued, stats.nexecuted, stats.ncancelled, stats.ndelayed, stats.maxdelayed, (unsigned int)stats.maxlate);
+}
+#endif
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+/****************************************************************************
+ * Name: wqueue_readhist
+ *
+ * Description:
+ *   Format the number of stolen works and the start latency histogram of
+ *   one per-cpu work queue into the line buffer.
+ *
+ ****************************************************************************/
+
+static size_t wqueue_readhist(FAR struct wqueue_file_s *attr, FAR const char *name, FAR struct wqueue_s *wqueue)
+{
+	struct work_percpu_s pcpu;
+	irqstate_t flags;
+
+	flags = work_qlock(wqueue);
+	pcpu = wqueue->pcpu;
+	work_qunlock(wqueue, flags);
+
+	return snprintf(attr->line, WQUEUE_LINELEN, WQUEUE_HIST_FMT, name, pcpu.nstolen, pcpu.hist[0], pcpu.hist[1], pcpu.hist[2], pcpu.hist[3], pcpu.hist[4], pcpu.hist[5], pcpu.hist[6], pcpu.hist[7]);
+}
+#endif
+
+/****************************************************************************
+ * Name: wqueue_readtable
+ *
+ * Description:
+ *   Copy one table, a title and a line per work queue, to the user buffer.
+ *   Returns the number of bytes copied.
+ *
+ ****************************************************************************/
+
+static size_t wqueue_readtable(FAR struct wqueue_file_s *attr, FAR char *buffer, size_t buflen, FAR off_t *offset, FAR const char *title, wqueue_readline_t readline)
+{
+	FAR struct wqueue_s *wqueue;
+	char name[WQUEUE_NAMELEN];
+	size_t linesize;
+	size_t copysize;
+	size_t totalsize = 0;
+	int qid;
+	int cpu;
+
+	copysize = procfs_memcpy(title, strlen(title), buffer, buflen, offset);
+	totalsize += copysize;
+
+	for (qid = HPWORK; qid <= LPWORK && totalsize < buflen; qid++) {
+		for (cpu = 0; cpu < WQUEUE_NCPUS && totalsize < buflen; cpu++) {
+			wqueue = wqueue_getqueue(qid, cpu, name);
+			if (wqueue == NULL) {
+				continue;
+			}
+
+			/* snprintf() returns the untruncated length */
+
+			linesize = readline(attr, name, wqueue);
+			if (linesize >= WQUEUE_LINELEN) {
+				linesize = WQUEUE_LINELEN - 1;
+			}
+
+			copysize = procfs_memcpy(attr->line, linesize, buffer + totalsize, buflen - totalsize, offset);
+			totalsize += copysize;
+		}
+	}
+
+	return totalsize;
+}
+
+/****************************************************************************
+ * Name: wqueue_read
+ ****************************************************************************/
+
+static ssize_t wqueue_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct wqueue_file_s *attr;
+	size_t totalsize;
+	off_t offset;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	attr = (FAR struct wqueue_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	offset = filep->f_pos;
+	totalsize = 0;
+
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	totalsize += wqueue_readtable(attr, buffer, buflen, &offset, WQUEUE_INFO_TITLE, wqueue_readline);
+#endif
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	if (totalsize < buflen) {
+		totalsize += wqueue_readtable(attr, buffer + totalsize, buflen - totalsize, &offset, WQUEUE_HIST_TITLE, wqueue_readhist);
+	}
+#endif
+
+	/* Update the file position */
+
+	if (totalsize > 0) {
+		filep->f_pos += totalsize;
+	}
+
+	return totalsize;
+}
+
+/****************************************************************************
+ * Name: wqueue_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int wqueue_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct wqueue_file_s *oldattr;
+	FAR struct wqueue_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	oldattr = (FAR struct wqueue_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	newattr = (FAR struct wqueue_file_s *)kmm_malloc(sizeof(struct wqueue_file_s));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	memcpy(newattr, oldattr, sizeof(struct wqueue_file_s));
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: wqueue_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int wqueue_stat(const char *relpath, struct stat *buf)
+{
+	if (strcmp(relpath, "wqueue") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* "wqueue" is the name for a read-only file */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS && (CONFIG_SCHED_WORKQUEUE_WHEEL || CONFIG_SCHED_WORKQUEUE_PERCPU) */
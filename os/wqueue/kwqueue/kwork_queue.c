@@ -121,6 +121,53 @@
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay)
+{
+	return work_queue_cpu(qid, -1, work, worker, arg, delay);
+}
+
+/****************************************************************************
+ * Name: work_queue_cpu
+ *
+ * Description:
+ *   Queue kernel-mode work on the queue of a given cpu.  See
+ *   include/tinyara/wqueue.h.
+ *
+ ****************************************************************************/
+
+int work_queue_cpu(int qid, int cpu, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay)
+{
+	FAR struct wqueue_s *wqueue;
+	int result;
+
+	DEBUGASSERT(work != NULL);
+
+	/* A work which is still queued stays on its queue, so that it is found
+	 * there by the duplicate check below and by work_cancel().
+	 */
+
+	if (work_available(work) || work->cpu >= CONFIG_SMP_NCPUS) {
+		if (cpu < 0 || cpu >= CONFIG_SMP_NCPUS) {
+			cpu = up_cpu_index();
+		}
+
+		work->cpu = cpu;
+	}
+
+	wqueue = work_getqueue(qid, work->cpu);
+	if (wqueue == NULL) {
+		return -EINVAL;
+	}
+
+	result = work_qqueue(wqueue, work, worker, arg, delay);
+	if (result != OK) {
+		return result;
+	}
+
+	return work_percpu_signal(qid, work->cpu);
+}
+#else
 int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay)
 {
 #if defined(CONFIG_SCHED_HPWORK) || defined(CONFIG_SCHED_LPWORK)
@@ -154,3 +201,4 @@ int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg,
 			return -EINVAL;
 		}
 }
+#endif
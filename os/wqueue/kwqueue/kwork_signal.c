@@ -23,6 +23,7 @@
 #include <tinyara/config.h>
 
 #include <signal.h>
+#include <semaphore.h>
 #include <errno.h>
 
 #include <tinyara/wqueue.h>
@@ -48,6 +49,28 @@
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+int work_signal(int qid)
+{
+	FAR struct wqueue_s *wqueue;
+	int cpu;
+
+	/* Wake up every idle worker so that all queues are re-assessed */
+
+	for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++) {
+		wqueue = work_getqueue(qid, cpu);
+		if (wqueue == NULL) {
+			return -EINVAL;
+		}
+
+		if (wqueue->pcpu.nidle > 0) {
+			sem_post(&wqueue->pcpu.wake);
+		}
+	}
+
+	return OK;
+}
+#else
 int work_signal(int qid)
 {
 	pid_t pid;
@@ -90,3 +113,4 @@ int work_signal(int qid)
 
 	return work_qsignal(pid);
 }
+#endif
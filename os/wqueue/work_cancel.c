@@ -112,7 +112,9 @@
 
 int work_qcancel(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
 {
+#ifndef CONFIG_SCHED_WORKQUEUE_WHEEL
 	struct work_s *cur_work;
+#endif
 	int ret = -ENOENT;
 
 	DEBUGASSERT(work != NULL);
@@ -126,8 +128,16 @@ int work_qcancel(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
 	while (work_lock() < 0);
 #else
 	irqstate_t flags;
-	flags = enter_critical_section();
+	flags = work_qlock(wqueue);
 #endif
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	if (work_wheel_queued(wqueue, work)) {
+		work_wheel_remove(wqueue, work);
+		work->worker = NULL;
+		wqueue->wheel.stats.ncancelled++;
+		ret = OK;
+	}
+#else
 	if (work->worker != NULL) {
 		/* A little test of the integrity of the work queue */
 
@@ -141,7 +151,7 @@ int work_qcancel(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
 				work_unlock();
 #else
-				leave_critical_section(flags);
+				work_qunlock(wqueue, flags);
 #endif
 				return -ENOENT;
 			} else if (cur_work == work) {
@@ -159,11 +169,12 @@ int work_qcancel(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
 		work->worker = NULL;
 		ret = OK;
 	}
+#endif
 
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
 	work_unlock();
 #else
-	leave_critical_section(flags);
+	work_qunlock(wqueue, flags);
 #endif
 	return ret;
 }
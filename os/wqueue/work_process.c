@@ -84,7 +84,7 @@
  * Private Data
  ****************************************************************************/
 #if defined(CONFIG_DEBUG_WORKQUEUE)
-#if defined(CONFIG_BUILD_FLAT) || (defined(CONFIG_BUILD_PROTECTED) && defined(__KERNEL__))
+#if (defined(CONFIG_BUILD_FLAT) || (defined(CONFIG_BUILD_PROTECTED) && defined(__KERNEL__))) && !defined(CONFIG_SCHED_WORKQUEUE_PERCPU)
 static worker_t cur_worker;
 #endif
 #endif
@@ -97,7 +97,7 @@ static worker_t cur_worker;
  * Public Functions
  ****************************************************************************/
 #if defined(CONFIG_DEBUG_WORKQUEUE)
-#if defined(CONFIG_BUILD_FLAT) || (defined(CONFIG_BUILD_PROTECTED) && defined(__KERNEL__))
+#if (defined(CONFIG_BUILD_FLAT) || (defined(CONFIG_BUILD_PROTECTED) && defined(__KERNEL__))) && !defined(CONFIG_SCHED_WORKQUEUE_PERCPU)
 worker_t work_get_current(void)
 {
 	return cur_worker;
@@ -126,9 +126,12 @@ void work_process(FAR struct wqueue_s *wqueue, int wndx)
 	volatile FAR struct work_s *work;
 	worker_t worker;
 	FAR void *arg;
+#ifndef CONFIG_SCHED_WORKQUEUE_WHEEL
 	clock_t elapsed;
 	clock_t ctick;
+#endif
 	clock_t next;
+	bool idle;
 
 	/* Then process queued work.  We need to keep interrupts disabled while
 	 * we process items in the work list.
@@ -144,6 +147,54 @@ void work_process(FAR struct wqueue_s *wqueue, int wndx)
 #endif
 
 
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	/* Move the expired delayed works to the ready queue and perform them
+	 * in order.  The wheel is checked again after each work since time
+	 * passes while the work runs.
+	 */
+
+	for (;;) {
+		next = work_wheel_expire(wqueue, clock());
+
+		work = (FAR struct work_s *)dq_remfirst(&wqueue->q);
+		if (work == NULL) {
+			break;
+		}
+
+		worker = work->worker;
+		if (worker == NULL) {
+			continue;
+		}
+
+		arg = work->arg;
+		work->worker = NULL;
+		wqueue->wheel.stats.nexecuted++;
+
+#if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
+		work_unlock();
+#else
+		leave_critical_section(flags);
+#endif
+#if defined(CONFIG_DEBUG_WORKQUEUE)
+#if (defined(CONFIG_BUILD_FLAT) || (defined(CONFIG_BUILD_PROTECTED) && defined(__KERNEL__))) && !defined(CONFIG_SCHED_WORKQUEUE_PERCPU)
+		cur_worker = worker;
+#endif
+#endif
+		worker(arg);
+
+#if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
+		while (work_lock() < 0);
+#else
+		flags = enter_critical_section();
+#endif
+	}
+
+	/* Sleep until the next deadline, or until signalled if there is no
+	 * delayed work at all.
+	 */
+
+	idle = (wqueue->wheel.stats.ndelayed == 0);
+#else
 	/* And check each entry in the work queue.  Since we have disabled
 	 * interrupts we know:  (1) we will not be suspended unless we do
 	 * so ourselves, and (2) there will be no changes to the work queue
@@ -196,7 +247,7 @@ void work_process(FAR struct wqueue_s *wqueue, int wndx)
 				leave_critical_section(flags);
 #endif
 #if defined(CONFIG_DEBUG_WORKQUEUE)
-#if defined(CONFIG_BUILD_FLAT) || (defined(CONFIG_BUILD_PROTECTED) && defined(__KERNEL__))
+#if (defined(CONFIG_BUILD_FLAT) || (defined(CONFIG_BUILD_PROTECTED) && defined(__KERNEL__))) && !defined(CONFIG_SCHED_WORKQUEUE_PERCPU)
 				cur_worker = worker;
 #endif
 #endif
@@ -229,7 +280,10 @@ void work_process(FAR struct wqueue_s *wqueue, int wndx)
 		}
 	}
 
-	if (wqueue->q.head == NULL) {
+	idle = (wqueue->q.head == NULL);
+#endif
+
+	if (idle) {
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
 		work_unlock();
 #endif
@@ -120,6 +120,30 @@ int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t w
 {
 	DEBUGASSERT(work != NULL);
 
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+#if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
+	while (work_lock() < 0);
+#else
+	irqstate_t flags;
+	flags = work_qlock(wqueue);
+#endif
+
+	if (work_wheel_queued(wqueue, work)) {
+#if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
+		work_unlock();
+#else
+		work_qunlock(wqueue, flags);
+#endif
+		return -EALREADY;
+	}
+
+	work->worker = worker;		/* Work callback */
+	work->arg = arg;		/* Callback argument */
+	work->delay = delay;		/* Delay until work performed */
+	work->qtime = clock();		/* Time work queued */
+
+	work_wheel_add(wqueue, work);
+#else
 	struct work_s *next_work = NULL;
 	struct work_s *cur_work;
 	clock_t elapsed;
@@ -130,7 +154,7 @@ int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t w
 	while (work_lock() < 0);
 #else
 	irqstate_t flags;
-	flags = enter_critical_section();
+	flags = work_qlock(wqueue);
 #endif
 
 	/* check whether requested work is in queue list or not */
@@ -140,7 +164,7 @@ int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t w
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
 			work_unlock();
 #else
-			leave_critical_section(flags);
+			work_qunlock(wqueue, flags);
 #endif
 			return -EALREADY;
 		}
@@ -165,10 +189,11 @@ int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t w
 	} else {
 		dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
 	}
+#endif
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
 	work_unlock();
 #else
-	leave_critical_section(flags);
+	work_qunlock(wqueue, flags);
 #endif
 
 	return OK;
@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * Copyright 2024 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * wqueue/work_wheel.c
+ *
+ * Hashed timing wheel for delayed work.  A delayed work is hashed into the
+ * slot of its deadline tick, so queueing and cancelling are O(1) and the
+ * worker only visits the slots of the ticks which elapsed since it last
+ * looked, instead of the whole delay-sorted queue.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <tinyara/clock.h>
+#include <tinyara/wqueue.h>
+
+#include "wqueue.h"
+
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define WORK_DEADLINE(w)       ((clock_t)((w)->qtime + (w)->delay))
+
+/* True if 'a' is at or before 'b', allowing for clock wrap-around */
+
+#define WORK_TIME_BEFORE_EQ(a, b) \
+	((clock_t)((b) - (a)) < ((clock_t)1 << (sizeof(clock_t) * 8 - 1)))
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_wheel_add
+ ****************************************************************************/
+
+void work_wheel_add(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	FAR struct work_wheel_s *wheel = &wqueue->wheel;
+
+	wheel->stats.nqueued++;
+
+	if (work->delay == 0) {
+		dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+		return;
+	}
+
+	/* Nothing older than this work can be in the wheel, so there is no
+	 * need to walk the slots of the ticks that passed while it was empty.
+	 */
+
+	if (wheel->stats.ndelayed == 0) {
+		wheel->cursor = work->qtime;
+	}
+
+	dq_addlast((FAR dq_entry_t *)work, &wheel->slot[WORK_DEADLINE(work) & WORK_WHEEL_MASK]);
+
+	if (++wheel->stats.ndelayed > wheel->stats.maxdelayed) {
+		wheel->stats.maxdelayed = wheel->stats.ndelayed;
+	}
+}
+
+/****************************************************************************
+ * Name: work_wheel_remove
+ ****************************************************************************/
+
+void work_wheel_remove(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	FAR struct work_wheel_s *wheel = &wqueue->wheel;
+
+	if (work->delay == 0) {
+		dq_rem((FAR dq_entry_t *)work, &wqueue->q);
+	} else {
+		dq_rem((FAR dq_entry_t *)work, &wheel->slot[WORK_DEADLINE(work) & WORK_WHEEL_MASK]);
+		DEBUGASSERT(wheel->stats.ndelayed > 0);
+		wheel->stats.ndelayed--;
+	}
+}
+
+/****************************************************************************
+ * Name: work_wheel_queued
+ *
+ * Description:
+ *   A work is queued as long as its worker is set (see work_available()).
+ *   Every path that takes a work off the ready queue or the wheel clears
+ *   the worker under the queue lock.  The links are not looked at, they
+ *   hold garbage until the work is queued for the first time.
+ *
+ ****************************************************************************/
+
+bool work_wheel_queued(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	return work->worker != NULL;
+}
+
+/****************************************************************************
+ * Name: work_wheel_expire
+ ****************************************************************************/
+
+clock_t work_wheel_expire(FAR struct wqueue_s *wqueue, clock_t now)
+{
+	FAR struct work_wheel_s *wheel = &wqueue->wheel;
+	FAR struct work_s *work;
+	FAR struct work_s *next;
+	FAR dq_queue_t *slot;
+	clock_t nticks;
+	clock_t deadline;
+	clock_t late;
+	clock_t mindelay;
+	clock_t tick;
+	int i;
+
+	if (wheel->stats.ndelayed == 0) {
+		wheel->cursor = now + 1;
+		return 0;
+	}
+
+	/* Visit the slots of the ticks from the cursor up to now.  After a full
+	 * turn every slot has been visited, so there is no point in going on.
+	 */
+
+	if (WORK_TIME_BEFORE_EQ(wheel->cursor, now)) {
+		nticks = now - wheel->cursor + 1;
+		if (nticks > WORK_WHEEL_SLOTS) {
+			nticks = WORK_WHEEL_SLOTS;
+		}
+
+		for (i = 0; i < nticks; i++) {
+			slot = &wheel->slot[(wheel->cursor + i) & WORK_WHEEL_MASK];
+			for (work = (FAR struct work_s *)slot->head; work; work = next) {
+				next = (FAR struct work_s *)work->dq.flink;
+				deadline = WORK_DEADLINE(work);
+				if (!WORK_TIME_BEFORE_EQ(deadline, now)) {
+					/* Due in a later turn of the wheel */
+
+					continue;
+				}
+
+				late = now - deadline;
+				if (late > wheel->stats.maxlate) {
+					wheel->stats.maxlate = late;
+				}
+
+				/* Keep qtime + delay equal to the deadline */
+
+				dq_rem((FAR dq_entry_t *)work, slot);
+				work->qtime = deadline;
+				work->delay = 0;
+				dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+				wheel->stats.ndelayed--;
+			}
+		}
+
+		wheel->cursor = now + 1;
+	}
+
+	if (wheel->stats.ndelayed == 0) {
+		return 0;
+	}
+
+	/* Find the next deadline.  The first slot holding a work due in the
+	 * current turn gives it directly; otherwise every work is more than a
+	 * turn away and the nearest one seen is used.
+	 */
+
+	mindelay = 0;
+	for (i = 0; i < WORK_WHEEL_SLOTS; i++) {
+		tick = wheel->cursor + i;
+		slot = &wheel->slot[tick & WORK_WHEEL_MASK];
+		for (work = (FAR struct work_s *)slot->head; work; work = (FAR struct work_s *)work->dq.flink) {
+			deadline = WORK_DEADLINE(work);
+			if (deadline == tick) {
+				return tick - now;
+			}
+
+			if (mindelay == 0 || deadline - now < mindelay) {
+				mindelay = deadline - now;
+			}
+		}
+	}
+
+	return mindelay;
+}
+
+#endif /* CONFIG_SCHED_WORKQUEUE_WHEEL */
@@ -60,18 +60,93 @@
 #include <tinyara/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <queue.h>
 #include <semaphore.h>
 
 #include <tinyara/wqueue.h>
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+#include <tinyara/spinlock.h>
+#endif
 
 #ifdef CONFIG_SCHED_WORKQUEUE
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+#define WORK_WHEEL_SLOTS  CONFIG_SCHED_WORKQUEUE_WHEEL_SLOTS
+#define WORK_WHEEL_MASK   (WORK_WHEEL_SLOTS - 1)
+
+#if (WORK_WHEEL_SLOTS & WORK_WHEEL_MASK) != 0
+#error "CONFIG_SCHED_WORKQUEUE_WHEEL_SLOTS must be a power of two"
+#endif
+#endif
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+/* Buckets of the start latency histogram: 0, 1, 2-3, 4-7, ... and the
+ * last one for everything above.  Latencies are in ticks.
+ */
+
+#define WORK_HIST_NBUCKETS 8
+#endif
+
+/* Lock a kernel work queue.  Per-cpu queues have their own spinlock so
+ * that the queues of different cpus do not serialize each other.
+ */
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+#define work_qlock(wq)          spin_lock_irqsave(&(wq)->pcpu.lock)
+#define work_qunlock(wq, flags) spin_unlock_irqrestore(&(wq)->pcpu.lock, (flags))
+#else
+#define work_qlock(wq)          enter_critical_section()
+#define work_qunlock(wq, flags) leave_critical_section(flags)
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+/* Statistics of one work queue, reported through /proc/wqueue */
+
+struct work_stats_s {
+	uint32_t nqueued;			/* Number of works queued */
+	uint32_t nexecuted;			/* Number of works performed */
+	uint32_t ncancelled;		/* Number of works cancelled */
+	uint16_t ndelayed;			/* Delayed works currently in the wheel */
+	uint16_t maxdelayed;		/* Peak of ndelayed */
+	clock_t maxlate;			/* Worst expiry time past a deadline (ticks) */
+};
+
+/* Delayed work is kept in a hashed timing wheel indexed by the tick of its
+ * deadline.  Works with a deadline more than WORK_WHEEL_SLOTS ticks away
+ * share a slot with nearer ones and are simply skipped until their round
+ * comes.  Expired works are moved to the tail of 'q' with 'delay' cleared,
+ * so 'q' only holds works which are ready to run.
+ */
+
+struct work_wheel_s {
+	clock_t cursor;				/* First tick whose slot is not expired yet */
+	struct dq_queue_s slot[WORK_WHEEL_SLOTS];
+	struct work_stats_s stats;
+};
+#endif
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+/* State of the queue of one cpu of a kernel work queue */
+
+struct work_percpu_s {
+	spinlock_t lock;			/* Protects this queue */
+	sem_t wake;					/* Posted to wake up an idle worker */
+	volatile uint8_t nidle;		/* Number of workers waiting on 'wake' */
+	uint32_t nstolen;			/* Works taken by workers of other cpus */
+	uint32_t hist[WORK_HIST_NBUCKETS];	/* Start latency histogram */
+};
+#endif
+
 /* This represents one worker */
 
 struct worker_s {
@@ -83,6 +158,12 @@ struct worker_s {
 
 struct wqueue_s {
 	struct dq_queue_s q;		/* The queue of pending work */
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	struct work_wheel_s wheel;	/* Delayed work */
+#endif
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	struct work_percpu_s pcpu;	/* Per-cpu queue state */
+#endif
 	struct worker_s worker[1];	/* Describes a worker thread */
 };
 
@@ -93,6 +174,12 @@ struct wqueue_s {
 #ifdef CONFIG_SCHED_HPWORK
 struct hp_wqueue_s {
 	struct dq_queue_s q;		/* The queue of pending work */
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	struct work_wheel_s wheel;	/* Delayed work */
+#endif
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	struct work_percpu_s pcpu;	/* Per-cpu queue state */
+#endif
 	struct worker_s worker[1];	/* Describes the single high priority worker */
 };
 #endif
@@ -104,6 +191,12 @@ struct hp_wqueue_s {
 #ifdef CONFIG_SCHED_LPWORK
 struct lp_wqueue_s {
 	struct dq_queue_s q;		/* The queue of pending work */
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+	struct work_wheel_s wheel;	/* Delayed work */
+#endif
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+	struct work_percpu_s pcpu;	/* Per-cpu queue state */
+#endif
 
 	/* Describes each thread in the low priority queue's thread pool */
 	struct worker_s worker[CONFIG_SCHED_LPNTHREADS];
@@ -118,6 +211,15 @@ struct lp_wqueue_s {
 
 struct wqueue_s *get_usrwork(void);
 
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+#ifdef CONFIG_SCHED_HPWORK
+struct hp_wqueue_s *get_hpwork_cpu(int cpu);
+#endif
+
+#ifdef CONFIG_SCHED_LPWORK
+struct lp_wqueue_s *get_lpwork_cpu(int cpu);
+#endif
+#else
 #ifdef CONFIG_SCHED_HPWORK
 struct hp_wqueue_s *get_hpwork(void);
 #endif
@@ -125,6 +227,7 @@ struct hp_wqueue_s *get_hpwork(void);
 #ifdef CONFIG_SCHED_LPWORK
 struct lp_wqueue_s *get_lpwork(void); 
 #endif
+#endif
 
 /* This semaphore/mutex supports exclusive access to the user-mode work queue */
 
@@ -228,6 +331,75 @@ int work_qcancel(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
 
 int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay);
 
+#ifdef CONFIG_SCHED_WORKQUEUE_WHEEL
+/****************************************************************************
+ * Name: work_wheel_add, work_wheel_remove, work_wheel_queued
+ *
+ * Description:
+ *   Add a work to the ready queue or to the timing wheel, remove it from
+ *   wherever it is, or check whether it is queued.  All of these are O(1)
+ *   and must be called with the work queue locked.
+ *
+ ****************************************************************************/
+
+void work_wheel_add(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
+void work_wheel_remove(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
+bool work_wheel_queued(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
+
+/****************************************************************************
+ * Name: work_wheel_expire
+ *
+ * Description:
+ *   Move every delayed work whose deadline is not after 'now' to the ready
+ *   queue.  Must be called with the work queue locked.
+ *
+ * Returned Value:
+ *   The number of ticks until the next deadline, or zero if there is no
+ *   delayed work left.
+ *
+ ****************************************************************************/
+
+clock_t work_wheel_expire(FAR struct wqueue_s *wqueue, clock_t now);
+#endif
+
+#ifdef CONFIG_SCHED_WORKQUEUE_PERCPU
+/****************************************************************************
+ * Name: work_getqueue
+ *
+ * Description:
+ *   Return the queue of 'cpu' of the kernel work queue 'qid', or NULL if
+ *   either is invalid.
+ *
+ ****************************************************************************/
+
+FAR struct wqueue_s *work_getqueue(int qid, int cpu);
+
+/****************************************************************************
+ * Name: work_percpu_process
+ *
+ * Description:
+ *   Per-cpu counterpart of work_process().  Perform one ready work of the
+ *   queue of 'cpu', or steal one from the queue of another cpu if there is
+ *   none.  If there is nothing to do at all, wait until woken up by
+ *   work_percpu_signal() or until the next deadline.
+ *
+ ****************************************************************************/
+
+void work_percpu_process(int qid, int cpu, int wndx);
+
+/****************************************************************************
+ * Name: work_percpu_signal
+ *
+ * Description:
+ *   Wake up an idle worker after work was queued on the queue of 'cpu':
+ *   one of that cpu if possible, otherwise one of another cpu which will
+ *   steal the work.
+ *
+ ****************************************************************************/
+
+int work_percpu_signal(int qid, int cpu);
+#endif
+
 /****************************************************************************
  * Name: work_process
  *
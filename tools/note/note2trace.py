@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+###########################################################################
+#
+# Copyright 2024 Samsung Electronics All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific
+# language governing permissions and limitations under the License.
+#
+###########################################################################
+# File : note2trace.py
+# Description: Convert scheduler notes read from /dev/note into a
+#              Chrome/Perfetto trace (JSON trace event format).
+
+"""
+TizenRT Scheduler Note to Trace Converter
+-----------------------------------------
+Input is either the raw binary written by 'notedump -o FILE', or a console
+log holding the 'NOTE: xx xx ...' lines printed by 'notedump'.  The output
+can be opened with chrome://tracing or https://ui.perfetto.dev.
+
+Tracks:
+  CPUs    - one lane per CPU with the task running on it
+  IRQs    - one lane per CPU with the interrupt handlers
+  Tasks   - one lane per task with its system calls, critical sections,
+            spinlocks and dump notes
+"""
+
+import argparse
+import json
+import re
+import sys
+
+# enum note_type_e of os/include/tinyara/sched_note.h
+NOTE_START = 0
+NOTE_STOP = 1
+NOTE_SUSPEND = 2
+NOTE_RESUME = 3
+NOTE_CPU_START = 4
+NOTE_CPU_STARTED = 5
+NOTE_CPU_PAUSE = 6
+NOTE_CPU_PAUSED = 7
+NOTE_CPU_RESUME = 8
+NOTE_CPU_RESUMED = 9
+NOTE_PREEMPT_LOCK = 10
+NOTE_PREEMPT_UNLOCK = 11
+NOTE_CSECTION_ENTER = 12
+NOTE_CSECTION_LEAVE = 13
+NOTE_SPINLOCK_LOCK = 14
+NOTE_SPINLOCK_LOCKED = 15
+NOTE_SPINLOCK_UNLOCK = 16
+NOTE_SPINLOCK_ABORT = 17
+NOTE_SYSCALL_ENTER = 18
+NOTE_SYSCALL_LEAVE = 19
+NOTE_IRQ_ENTER = 20
+NOTE_IRQ_LEAVE = 21
+NOTE_DUMP_STRING = 22
+NOTE_DUMP_BINARY = 23
+
+CPU_PID = 0
+IRQ_PID = 1
+TASK_PID = 2
+
+NOTE_LINE = re.compile(r'NOTE:((?:\s+[0-9a-fA-F]{2})+)')
+
+
+class Layout:
+    """Sizes of the variable fields of struct note_common_s"""
+
+    def __init__(self, args):
+        self.smp = args.smp
+        self.pid = args.pid_size
+        self.time = args.time_size
+        self.long = args.long_size
+        self.ptr = args.ptr_size
+        self.common = 3 + (1 if self.smp else 0) + self.pid + self.time + self.long
+
+
+def read_input(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    # A console log holds 'NOTE:' lines, anything else is raw binary
+    try:
+        text = data.decode('ascii')
+    except UnicodeDecodeError:
+        return data
+
+    lines = NOTE_LINE.findall(text)
+    if not lines:
+        return data
+    return bytes(int(b, 16) for line in lines for b in line.split())
+
+
+def le(buf, off, size):
+    return int.from_bytes(buf[off:off + size], 'little')
+
+
+def cstring(buf):
+    return buf.split(b'\0', 1)[0].decode('utf-8', 'replace')
+
+
+def parse(data, layout):
+    """Split the stream into notes, dropping the ones that are not valid"""
+    notes = []
+    off = 0
+    dropped = 0
+    while off < len(data):
+        length = data[off]
+        if length < layout.common or off + length > len(data):
+            # Resync on the next byte
+            off += 1
+            dropped += 1
+            continue
+
+        buf = data[off:off + length]
+        pos = 3
+        note = {'type': buf[1], 'prio': buf[2], 'cpu': 0}
+        if layout.smp:
+            note['cpu'] = buf[pos]
+            pos += 1
+        note['pid'] = le(buf, pos, layout.pid)
+        pos += layout.pid
+        sec = le(buf, pos, layout.time)
+        pos += layout.time
+        nsec = le(buf, pos, layout.long)
+        pos += layout.long
+        if note['type'] > NOTE_DUMP_BINARY or nsec >= 1000000000:
+            off += 1
+            dropped += 1
+            continue
+
+        note['ts'] = sec * 1000000.0 + nsec / 1000.0
+        note['payload'] = buf[pos:]
+        notes.append(note)
+        off += length
+
+    if dropped:
+        print('note2trace: skipped %d invalid bytes' % dropped, file=sys.stderr)
+
+    # Notes come ring by ring, one ring per CPU
+    notes.sort(key=lambda n: n['ts'])
+    return notes
+
+
+class Trace:
+    def __init__(self, layout, syscalls):
+        self.layout = layout
+        self.syscalls = syscalls
+        self.events = []
+        self.names = {}
+        self.running = {}
+        self.cpus = set()
+        self.tasks = set()
+
+    def name(self, pid):
+        return self.names.get(pid, 'pid %d' % pid)
+
+    def emit(self, ph, pid, tid, ts, name, args=None):
+        ev = {'ph': ph, 'pid': pid, 'tid': tid, 'ts': ts, 'name': name}
+        if ph == 'i':
+            ev['s'] = 't'
+        if args:
+            ev['args'] = args
+        self.events.append(ev)
+
+    def task(self, ph, note, name, args=None):
+        self.tasks.add(note['pid'])
+        self.emit(ph, TASK_PID, note['pid'], note['ts'], name, args)
+
+    def switch(self, note):
+        cpu = note['cpu']
+        self.cpus.add(cpu)
+        prev = self.running.get(cpu)
+        if prev is not None:
+            pid, start = prev
+            self.events.append({'ph': 'X', 'pid': CPU_PID, 'tid': cpu, 'ts': start,
+                                'dur': note['ts'] - start, 'name': self.name(pid),
+                                'args': {'pid': pid}})
+        self.running[cpu] = (note['pid'], note['ts'])
+
+    def syscall(self, nr):
+        if nr < len(self.syscalls):
+            return self.syscalls[nr]
+        return 'syscall %d' % nr
+
+    def add(self, note):
+        t = note['type']
+        p = note['payload']
+        ptr = self.layout.ptr
+
+        if t == NOTE_START:
+            if p:
+                self.names[note['pid']] = cstring(p)
+            self.task('i', note, 'start', {'priority': note['prio']})
+        elif t == NOTE_STOP:
+            self.task('i', note, 'stop')
+            cpu = note['cpu']
+            if cpu in self.running and self.running[cpu][0] == note['pid']:
+                self.switch(dict(note, pid=-1))
+                del self.running[cpu]
+        elif t == NOTE_RESUME:
+            self.switch(note)
+        elif t == NOTE_SUSPEND:
+            self.task('i', note, 'suspend', {'state': p[0] if p else None})
+        elif NOTE_CPU_START <= t <= NOTE_CPU_RESUMED:
+            names = ['cpu start', 'cpu started', 'cpu pause', 'cpu paused', 'cpu resume', 'cpu resumed']
+            args = {'target': p[0]} if t in (NOTE_CPU_START, NOTE_CPU_PAUSE, NOTE_CPU_RESUME) and p else None
+            self.cpus.add(note['cpu'])
+            self.emit('i', CPU_PID, note['cpu'], note['ts'], names[t - NOTE_CPU_START], args)
+        elif t in (NOTE_PREEMPT_LOCK, NOTE_PREEMPT_UNLOCK):
+            self.task('i', note, 'sched_lock' if t == NOTE_PREEMPT_LOCK else 'sched_unlock')
+        elif t == NOTE_CSECTION_ENTER:
+            self.task('B', note, 'csection')
+        elif t == NOTE_CSECTION_LEAVE:
+            self.task('E', note, 'csection')
+        elif NOTE_SPINLOCK_LOCK <= t <= NOTE_SPINLOCK_ABORT:
+            names = ['spin lock', 'spin locked', 'spin unlock', 'spin abort']
+            self.task('i', note, names[t - NOTE_SPINLOCK_LOCK], {'lock': hex(le(p, 0, ptr))})
+        elif t == NOTE_SYSCALL_ENTER:
+            argc = p[1] if len(p) > 1 else 0
+            args = {'arg%d' % i: hex(le(p, 2 + i * ptr, ptr)) for i in range(argc)}
+            self.task('B', note, self.syscall(p[0]), args)
+        elif t == NOTE_SYSCALL_LEAVE:
+            self.task('E', note, self.syscall(p[0]), {'result': hex(le(p, 1, ptr))})
+        elif t in (NOTE_IRQ_ENTER, NOTE_IRQ_LEAVE):
+            self.emit('B' if t == NOTE_IRQ_ENTER else 'E', IRQ_PID, note['cpu'], note['ts'], 'irq %d' % p[0])
+        elif t == NOTE_DUMP_STRING:
+            text = cstring(p[ptr:])
+            m = re.match(r'([BE])\|(\d+)\|(.*)', text)
+            if m:
+                # sched_note_beginex()/endex() use the systrace format
+                self.task(m.group(1), dict(note, pid=int(m.group(2))), m.group(3))
+            else:
+                self.task('i', note, text, {'ip': hex(le(p, 0, ptr))})
+        elif t == NOTE_DUMP_BINARY:
+            self.task('i', note, 'dump %d' % p[ptr], {'ip': hex(le(p, 0, ptr)), 'data': p[ptr + 1:].hex()})
+
+    def metadata(self):
+        meta = []
+        for pid, name in ((CPU_PID, 'CPUs'), (IRQ_PID, 'IRQs'), (TASK_PID, 'Tasks')):
+            meta.append({'ph': 'M', 'pid': pid, 'name': 'process_name', 'args': {'name': name}})
+        for cpu in sorted(self.cpus):
+            meta.append({'ph': 'M', 'pid': CPU_PID, 'tid': cpu, 'name': 'thread_name', 'args': {'name': 'CPU %d' % cpu}})
+            meta.append({'ph': 'M', 'pid': IRQ_PID, 'tid': cpu, 'name': 'thread_name', 'args': {'name': 'CPU %d' % cpu}})
+        for pid in sorted(self.tasks):
+            meta.append({'ph': 'M', 'pid': TASK_PID, 'tid': pid, 'name': 'thread_name', 'args': {'name': '%s (%d)' % (self.name(pid), pid)}})
+        return meta
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert TizenRT scheduler notes to a Chrome/Perfetto trace')
+    parser.add_argument('input', help='notedump output, raw binary or console log')
+    parser.add_argument('-o', '--output', default='trace.json', help='output JSON file (default: trace.json)')
+    parser.add_argument('--smp', action='store_true', help='notes carry a CPU number (CONFIG_SMP=y)')
+    parser.add_argument('--pid-size', type=int, default=2, help='sizeof(pid_t) of the target (default: 2)')
+    parser.add_argument('--time-size', type=int, default=4, help='sizeof(time_t) of the target (default: 4)')
+    parser.add_argument('--long-size', type=int, default=4, help='sizeof(long) of the target (default: 4)')
+    parser.add_argument('--ptr-size', type=int, default=4, help='sizeof(uintptr_t) of the target (default: 4)')
+    parser.add_argument('--syscalls', help='file with one system call name per line, in g_funcnames[] order')
+    args = parser.parse_args()
+
+    syscalls = []
+    if args.syscalls:
+        with open(args.syscalls) as f:
+            syscalls = [line.strip() for line in f if line.strip()]
+
+    layout = Layout(args)
+    notes = parse(read_input(args.input), layout)
+
+    trace = Trace(layout, syscalls)
+    for note in notes:
+        trace.add(note)
+
+    # Close the slices still running at the end of the capture
+    if notes:
+        end = notes[-1]['ts']
+        for cpu in list(trace.running):
+            trace.switch({'cpu': cpu, 'pid': -1, 'ts': end})
+
+    with open(args.output, 'w') as f:
+        json.dump({'traceEvents': trace.metadata() + trace.events, 'displayTimeUnit': 'ns'}, f)
+
+    print('note2trace: %d notes, %d events written to %s' % (len(notes), len(trace.events), args.output))
+
+
+if __name__ == '__main__':
+    main()